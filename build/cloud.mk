@@ -3,19 +3,30 @@ CLOUD_SERVER_SOURCES = \
 	$(SRC)/Tracking/SkyLines/Assemble.cpp \
 	$(SRC)/Cloud/Serialiser.cpp \
 	$(SRC)/Cloud/Client.cpp \
+	$(SRC)/Cloud/KeyIndex.cpp \
+	$(SRC)/Cloud/Shards.cpp \
 	$(SRC)/Cloud/Thermal.cpp \
+	$(SRC)/Cloud/Hotspot.cpp \
 	$(SRC)/Cloud/Data.cpp \
+	$(SRC)/Cloud/Snapshot.cpp \
+	$(SRC)/Cloud/Journal.cpp \
 	$(SRC)/Cloud/Sender.cpp \
+	$(SRC)/Cloud/Batch.cpp \
 	$(SRC)/Cloud/Main.cpp
-CLOUD_SERVER_DEPENDS = ASYNC IO OS GEO MATH UTIL
+CLOUD_SERVER_DEPENDS = ASYNC IO OS THREAD GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-server,CLOUD_SERVER))
 
 CLOUD_TO_KML_SOURCES = \
 	$(SRC)/Tracking/SkyLines/Assemble.cpp \
 	$(SRC)/Cloud/Serialiser.cpp \
 	$(SRC)/Cloud/Client.cpp \
+	$(SRC)/Cloud/KeyIndex.cpp \
+	$(SRC)/Cloud/Shards.cpp \
 	$(SRC)/Cloud/Thermal.cpp \
+	$(SRC)/Cloud/Hotspot.cpp \
 	$(SRC)/Cloud/Data.cpp \
+	$(SRC)/Cloud/Snapshot.cpp \
+	$(SRC)/Cloud/Journal.cpp \
 	$(SRC)/Cloud/ToKML.cpp
 CLOUD_TO_KML_DEPENDS = ASYNC IO OS GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-to-kml,CLOUD_TO_KML))
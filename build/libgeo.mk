@@ -15,6 +15,7 @@ GEO_SOURCES := \
 	$(GEO_SRC_DIR)/Flat/TaskProjection.cpp \
 	$(GEO_SRC_DIR)/Flat/FlatBoundingBox.cpp \
 	$(GEO_SRC_DIR)/Flat/FlatGeoPoint.cpp \
+	$(GEO_SRC_DIR)/Flat/FlatDistanceBatch.cpp \
 	$(GEO_SRC_DIR)/Flat/FlatRay.cpp \
 	$(GEO_SRC_DIR)/Flat/FlatPoint.cpp \
 	$(GEO_SRC_DIR)/Flat/FlatEllipse.cpp \
@@ -29,6 +30,7 @@ GEO_SOURCES := \
 	$(GEO_SRC_DIR)/Quadrilateral.cpp \
 	$(GEO_SRC_DIR)/SearchPoint.cpp \
 	$(GEO_SRC_DIR)/SearchPointVector.cpp \
+	$(GEO_SRC_DIR)/PackedPolygon.cpp \
 	$(GEO_SRC_DIR)/GeoEllipse.cpp \
 	$(GEO_SRC_DIR)/UTM.cpp
 
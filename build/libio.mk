@@ -11,6 +11,7 @@ IO_SOURCES = \
 	$(IO_SRC_DIR)/ZlibError.cxx \
 	$(IO_SRC_DIR)/FileTransaction.cpp \
 	$(IO_SRC_DIR)/FileCache.cpp \
+	$(IO_SRC_DIR)/BinaryCache.cpp \
 	$(IO_SRC_DIR)/ZipArchive.cpp \
 	$(IO_SRC_DIR)/ZipReader.cpp \
 	$(IO_SRC_DIR)/ConvertLineReader.cpp \
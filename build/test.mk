@@ -94,7 +94,8 @@ TEST_NAMES = \
 	TestUnits TestEarth TestSunEphemeris \
 	TestValidity TestUTM TestProfile \
 	TestAllocatedGrid \
-	TestRadixTree TestGeoBounds TestGeoClip \
+	TestRadixTree TestGeoBounds TestGeoClip TestPackedPolygon \
+	TestWaypointIndex \
 	TestLogger TestGRecord TestDriver TestClimbAvCalc \
 	TestWaypointReader TestThermalBase \
 	TestFlarmNet \
@@ -122,8 +123,21 @@ TEST_NAMES = \
 	TestIGCFilenameFormatter \
 	TestLXNToIGC \
 	TestLeastSquares \
-	TestThermalBand
+	TestThermalBand \
+	TestWorkerPool \
+	TestSnapshotBuffer \
+	TestComputerProfiler \
+	TestJobGraph \
+	TestAlternates \
+	TestRasterTileStore \
+	TestRasterLineStepper \
+	TestBinaryCache
 
+ifeq ($(TARGET),UNIX)
+TEST_NAMES += TestCloudHotspot
+TEST_NAMES += TestShapefileView
+TEST_NAMES += TestTopographyPyramid
+endif
 
 TESTS = $(call name-to-bin,$(TEST_NAMES))
 
@@ -133,6 +147,78 @@ TEST_CRC_SOURCES = \
 	$(TEST_SRC_DIR)/TestCRC.cpp
 $(eval $(call link-program,TestCRC,TEST_CRC))
 
+TEST_CLOUD_HOTSPOT_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/Cloud/Hotspot.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestCloudHotspot.cpp
+TEST_CLOUD_HOTSPOT_DEPENDS = GEO MATH UTIL
+$(eval $(call link-program,TestCloudHotspot,TEST_CLOUD_HOTSPOT))
+
+TEST_SHAPEFILE_VIEW_SOURCES = \
+	$(SRC)/Topography/MappedShapefile.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestShapefileView.cpp
+TEST_SHAPEFILE_VIEW_DEPENDS = IO OS UTIL SHAPELIB ZZIP
+$(eval $(call link-program,TestShapefileView,TEST_SHAPEFILE_VIEW))
+
+TEST_TOPOGRAPHY_PYRAMID_SOURCES = \
+	$(SRC)/Topography/MappedShapefile.cpp \
+	$(SRC)/Topography/TopographyPyramid.cpp \
+	$(TEST_SRC_DIR)/TopographyPyramidBuilder.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestTopographyPyramid.cpp
+TEST_TOPOGRAPHY_PYRAMID_DEPENDS = GEO MATH IO OS UTIL SHAPELIB ZZIP
+$(eval $(call link-program,TestTopographyPyramid,TEST_TOPOGRAPHY_PYRAMID))
+
+TEST_WORKER_POOL_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestWorkerPool.cpp
+TEST_WORKER_POOL_DEPENDS = THREAD
+$(eval $(call link-program,TestWorkerPool,TEST_WORKER_POOL))
+
+TEST_SNAPSHOT_BUFFER_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestSnapshotBuffer.cpp
+TEST_SNAPSHOT_BUFFER_DEPENDS = THREAD
+$(eval $(call link-program,TestSnapshotBuffer,TEST_SNAPSHOT_BUFFER))
+
+TEST_COMPUTER_PROFILER_SOURCES = \
+	$(SRC)/Computer/Profiler.cpp \
+	$(SRC)/JSON/Writer.cpp \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestComputerProfiler.cpp
+TEST_COMPUTER_PROFILER_DEPENDS = IO OS UTIL
+$(eval $(call link-program,TestComputerProfiler,TEST_COMPUTER_PROFILER))
+
+TEST_JOB_GRAPH_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestJobGraph.cpp
+TEST_JOB_GRAPH_DEPENDS =
+$(eval $(call link-program,TestJobGraph,TEST_JOB_GRAPH))
+
+TEST_RASTER_TILE_STORE_SOURCES = \
+	$(SRC)/Terrain/RasterBuffer.cpp \
+	$(SRC)/Terrain/RasterTileStore.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterTileStore.cpp
+TEST_RASTER_TILE_STORE_DEPENDS = MATH OS UTIL
+$(eval $(call link-program,TestRasterTileStore,TEST_RASTER_TILE_STORE))
+
+TEST_BINARY_CACHE_SOURCES = \
+	$(SRC)/Airspace/AirspaceCache.cpp \
+	$(SRC)/Waypoint/WaypointCache.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestBinaryCache.cpp
+TEST_BINARY_CACHE_DEPENDS = AIRSPACE WAYPOINT IO OS GEO MATH UTIL
+$(eval $(call link-program,TestBinaryCache,TEST_BINARY_CACHE))
+
+TEST_RASTER_LINE_STEPPER_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestRasterLineStepper.cpp
+$(eval $(call link-program,TestRasterLineStepper,TEST_RASTER_LINE_STEPPER))
+
 TEST_LEASTSQUARES_SOURCES = \
 	$(SRC)/Math/LeastSquares.cpp \
 	$(SRC)/Math/XYDataStore.cpp \
@@ -194,7 +280,7 @@ TEST_AIRSPACE_PARSER_SOURCES = \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestAirspaceParser.cpp
 TEST_AIRSPACE_PARSER_LDADD = $(FAKE_LIBS)
-TEST_AIRSPACE_PARSER_DEPENDS = IO OS AIRSPACE ZZIP GEO MATH UTIL
+TEST_AIRSPACE_PARSER_DEPENDS = IO OS AIRSPACE ZZIP GEO MATH THREAD UTIL
 $(eval $(call link-program,TestAirspaceParser,TEST_AIRSPACE_PARSER))
 
 TEST_DATE_TIME_SOURCES = \
@@ -250,6 +336,14 @@ TEST_AAT_POINT_OBJS = $(call SRC_TO_OBJ,$(TEST_AAT_POINT_SOURCES))
 TEST_AAT_POINT_DEPENDS = TASK ROUTE GLIDE WAYPOINT GEO TIME MATH UTIL
 $(eval $(call link-program,TestAATPoint,TEST_AAT_POINT))
 
+TEST_ALTERNATES_SOURCES = \
+	$(SRC)/Engine/Util/Gradient.cpp \
+	$(SRC)/Engine/Navigation/Aircraft.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestAlternates.cpp
+TEST_ALTERNATES_DEPENDS = TASK ROUTE GLIDE WAYPOINT GEO TIME MATH THREAD UTIL
+$(eval $(call link-program,TestAlternates,TEST_ALTERNATES))
+
 TEST_PLANES_SOURCES = \
 	$(SRC)/Polar/Parser.cpp \
 	$(SRC)/Plane/PlaneFileGlue.cpp \
@@ -410,6 +504,18 @@ TEST_GEO_CLIP_SOURCES = \
 TEST_GEO_CLIP_DEPENDS = GEO MATH
 $(eval $(call link-program,TestGeoClip,TEST_GEO_CLIP))
 
+TEST_PACKED_POLYGON_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestPackedPolygon.cpp
+TEST_PACKED_POLYGON_DEPENDS = GEO MATH
+$(eval $(call link-program,TestPackedPolygon,TEST_PACKED_POLYGON))
+
+TEST_WAYPOINT_INDEX_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestWaypointIndex.cpp
+TEST_WAYPOINT_INDEX_DEPENDS = WAYPOINT GEO MATH UTIL
+$(eval $(call link-program,TestWaypointIndex,TEST_WAYPOINT_INDEX))
+
 TEST_CLIMB_AV_CALC_SOURCES = \
 	$(SRC)/Computer/ClimbAverageCalculator.cpp \
 	$(TEST_SRC_DIR)/tap.c \
@@ -731,6 +837,7 @@ DEBUG_PROGRAM_NAMES = \
 	FlightPath \
 	BenchmarkProjection \
 	BenchmarkFAITriangleSector \
+	BenchmarkOLCTriangle \
 	DumpTextFile DumpTextZip DumpTextInflate WriteTextFile RunTextWriter \
 	DumpHexColor \
 	RunXMLParser \
@@ -740,7 +847,10 @@ DEBUG_PROGRAM_NAMES = \
 	ReadGRecord VerifyGRecord AppendGRecord FixGRecord \
 	AddChecksum \
 	KeyCodeDumper \
-	LoadTopography LoadTerrain \
+	LoadTopography BuildTopographyPyramid LoadTerrain \
+	BenchmarkTerrainIntersection \
+	BenchmarkWaypoints \
+	BenchmarkNMEAParser \
 	RunHeightMatrix \
 	RunInputParser \
 	RunWaypointParser RunAirspaceParser \
@@ -809,6 +919,10 @@ ifeq ($(TARGET_IS_LINUX),y)
 DEBUG_PROGRAM_NAMES += RunWPASupplicant
 endif
 
+ifeq ($(TARGET),UNIX)
+DEBUG_PROGRAM_NAMES += RunCloudLoad
+endif
+
 ifeq ($(HAVE_PCM_PLAYER),y)
 DEBUG_PROGRAM_NAMES += PlayTone PlayVario DumpVario
 endif
@@ -905,6 +1019,16 @@ BENCHMARK_FAI_TRIANGLE_SECTOR_SOURCES = \
 BENCHMARK_FAI_TRIANGLE_SECTOR_DEPENDS = GEO MATH
 $(eval $(call link-program,BenchmarkFAITriangleSector,BENCHMARK_FAI_TRIANGLE_SECTOR))
 
+BENCHMARK_OLC_TRIANGLE_SOURCES = \
+	$(DEBUG_REPLAY_SOURCES) \
+	$(ENGINE_SRC_DIR)/Trace/Point.cpp \
+	$(ENGINE_SRC_DIR)/Trace/Trace.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkOLCTriangle.cpp
+BENCHMARK_OLC_TRIANGLE_LDADD = $(DEBUG_REPLAY_LDADD)
+BENCHMARK_OLC_TRIANGLE_DEPENDS = CONTEST UTIL GEO MATH TIME
+$(eval $(call link-program,BenchmarkOLCTriangle,BENCHMARK_OLC_TRIANGLE))
+
 DUMP_TEXT_FILE_SOURCES = \
 	$(TEST_SRC_DIR)/DumpTextFile.cpp
 DUMP_TEXT_FILE_DEPENDS = IO OS ZZIP UTIL
@@ -1014,6 +1138,12 @@ RUN_SL_TRACKING_LDADD = $(DEBUG_REPLAY_LDADD)
 RUN_SL_TRACKING_DEPENDS = LIBNET OS GEO MATH UTIL TIME
 $(eval $(call link-program,RunSkyLinesTracking,RUN_SL_TRACKING))
 
+RUN_CLOUD_LOAD_SOURCES = \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(TEST_SRC_DIR)/RunCloudLoad.cpp
+RUN_CLOUD_LOAD_DEPENDS = OS GEO MATH UTIL TIME
+$(eval $(call link-program,RunCloudLoad,RUN_CLOUD_LOAD))
+
 RUN_LIVETRACK24_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/Tracking/LiveTrack24.cpp \
@@ -1099,6 +1229,7 @@ FIX_GRECORD_DEPENDS = IO OS UTIL
 $(eval $(call link-program,FixGRecord,FIX_GRECORD))
 
 ADD_CHECKSUM_SOURCES = \
+	$(SRC)/NMEA/Checksum.cpp \
 	$(TEST_SRC_DIR)/AddChecksum.cpp
 ADD_CHECKSUM_DEPENDS = IO
 $(eval $(call link-program,AddChecksum,ADD_CHECKSUM))
@@ -1118,6 +1249,9 @@ LOAD_TOPOGRAPHY_SOURCES = \
 	$(SRC)/Topography/TopographyStore.cpp \
 	$(SRC)/Topography/TopographyFile.cpp \
 	$(SRC)/Topography/XShape.cpp \
+	$(SRC)/Topography/ShapeGeneration.cpp \
+	$(SRC)/Topography/MappedShapefile.cpp \
+	$(SRC)/Topography/TopographyPyramid.cpp \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Projection/WindowProjection.cpp \
 	$(SRC)/Operation/Operation.cpp \
@@ -1126,17 +1260,29 @@ ifeq ($(OPENGL),y)
 LOAD_TOPOGRAPHY_SOURCES += \
 	$(SCREEN_SRC_DIR)/OpenGL/Triangulate.cpp
 endif
-LOAD_TOPOGRAPHY_DEPENDS = RESOURCE GEO MATH THREAD IO UTIL SHAPELIB ZZIP
+LOAD_TOPOGRAPHY_DEPENDS = RESOURCE GEO MATH THREAD IO OS UTIL SHAPELIB ZZIP
 LOAD_TOPOGRAPHY_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,LoadTopography,LOAD_TOPOGRAPHY))
 
+BUILD_TOPOGRAPHY_PYRAMID_SOURCES = \
+	$(TEST_SRC_DIR)/TopographyPyramidBuilder.cpp \
+	$(TEST_SRC_DIR)/BuildTopographyPyramid.cpp
+BUILD_TOPOGRAPHY_PYRAMID_DEPENDS = GEO MATH IO OS UTIL SHAPELIB ZZIP
+$(eval $(call link-program,BuildTopographyPyramid,BUILD_TOPOGRAPHY_PYRAMID))
+
 LOAD_TERRAIN_SOURCES = \
 	$(SRC)/Operation/Operation.cpp \
 	$(TEST_SRC_DIR)/LoadTerrain.cpp
 LOAD_TERRAIN_CPPFLAGS = $(SCREEN_CPPFLAGS)
-LOAD_TERRAIN_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+LOAD_TERRAIN_DEPENDS = TERRAIN GEO MATH IO OS ZZIP THREAD UTIL
 $(eval $(call link-program,LoadTerrain,LOAD_TERRAIN))
 
+BENCHMARK_TERRAIN_INTERSECTION_SOURCES = \
+	$(SRC)/Operation/Operation.cpp \
+	$(TEST_SRC_DIR)/BenchmarkTerrainIntersection.cpp
+BENCHMARK_TERRAIN_INTERSECTION_DEPENDS = TERRAIN GEO MATH IO OS ZZIP UTIL
+$(eval $(call link-program,BenchmarkTerrainIntersection,BENCHMARK_TERRAIN_INTERSECTION))
+
 RUN_HEIGHT_MATRIX_SOURCES = \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Projection/WindowProjection.cpp \
@@ -1201,6 +1347,28 @@ NEAREST_WAYPOINTS_LDADD = $(FAKE_LIBS)
 NEAREST_WAYPOINTS_DEPENDS = WAYPOINT IO OS THREAD ZZIP GEO MATH UTIL
 $(eval $(call link-program,NearestWaypoints,NEAREST_WAYPOINTS))
 
+BENCHMARK_WAYPOINTS_SOURCES = \
+	$(SRC)/Waypoint/WaypointFileType.cpp \
+	$(SRC)/Waypoint/WaypointReaderBase.cpp \
+	$(SRC)/Waypoint/WaypointReader.cpp \
+	$(SRC)/Waypoint/WaypointReaderWinPilot.cpp \
+	$(SRC)/Waypoint/WaypointReaderFS.cpp \
+	$(SRC)/Waypoint/WaypointReaderOzi.cpp \
+	$(SRC)/Waypoint/WaypointReaderSeeYou.cpp \
+	$(SRC)/Waypoint/WaypointReaderZander.cpp \
+	$(SRC)/Waypoint/WaypointReaderCompeGPS.cpp \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Compatibility/fmode.c \
+	$(SRC)/Operation/Operation.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkWaypoints.cpp
+BENCHMARK_WAYPOINTS_LDADD = $(FAKE_LIBS)
+BENCHMARK_WAYPOINTS_DEPENDS = WAYPOINT IO OS THREAD ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkWaypoints,BENCHMARK_WAYPOINTS))
+
 RUN_FLIGHT_PARSER_SOURCES = \
 	$(SRC)/Logger/FlightParser.cpp \
 	$(TEST_SRC_DIR)/RunFlightParser.cpp
@@ -1218,7 +1386,7 @@ RUN_AIRSPACE_PARSER_SOURCES = \
 	$(TEST_SRC_DIR)/FakeLanguage.cpp \
 	$(TEST_SRC_DIR)/RunAirspaceParser.cpp
 RUN_AIRSPACE_PARSER_LDADD = $(FAKE_LIBS)
-RUN_AIRSPACE_PARSER_DEPENDS = IO OS AIRSPACE ZZIP GEO MATH UTIL
+RUN_AIRSPACE_PARSER_DEPENDS = IO OS AIRSPACE ZZIP GEO MATH THREAD UTIL
 $(eval $(call link-program,RunAirspaceParser,RUN_AIRSPACE_PARSER))
 
 ENUMERATE_PORTS_SOURCES = \
@@ -1301,6 +1469,41 @@ RUN_DEVICE_DRIVER_SOURCES = \
 RUN_DEVICE_DRIVER_DEPENDS = DRIVER IO OS THREAD GEO MATH UTIL TIME
 $(eval $(call link-program,RunDeviceDriver,RUN_DEVICE_DRIVER))
 
+BENCHMARK_NMEA_PARSER_SOURCES = \
+	$(SRC)/FLARM/FlarmId.cpp \
+	$(SRC)/Units/Descriptor.cpp \
+	$(SRC)/Units/System.cpp \
+	$(SRC)/Device/Port/Port.cpp \
+	$(SRC)/Device/Port/NullPort.cpp \
+	$(SRC)/Device/Parser.cpp \
+	$(SRC)/Device/Util/NMEAWriter.cpp \
+	$(SRC)/Device/Util/NMEAReader.cpp \
+	$(SRC)/Device/Config.cpp \
+	$(SRC)/FLARM/Traffic.cpp \
+	$(SRC)/FLARM/List.cpp \
+	$(SRC)/NMEA/Info.cpp \
+	$(SRC)/NMEA/Acceleration.cpp \
+	$(SRC)/NMEA/Attitude.cpp \
+	$(SRC)/NMEA/ExternalSettings.cpp \
+	$(SRC)/NMEA/SwitchState.cpp \
+	$(SRC)/NMEA/InputLine.cpp \
+	$(SRC)/NMEA/Checksum.cpp \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/Generator.cpp \
+	$(SRC)/FLARM/FlarmCalculations.cpp \
+	$(SRC)/Computer/ClimbAverageCalculator.cpp \
+	$(SRC)/Operation/Operation.cpp \
+	$(SRC)/Operation/ProxyOperationEnvironment.cpp \
+	$(SRC)/Operation/NoCancelOperationEnvironment.cpp \
+	$(SRC)/Atmosphere/AirDensity.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(TEST_SRC_DIR)/FakeMessage.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/FakeGeoid.cpp \
+	$(TEST_SRC_DIR)/BenchmarkNMEAParser.cpp
+BENCHMARK_NMEA_PARSER_DEPENDS = DRIVER IO OS THREAD GEO MATH UTIL TIME
+$(eval $(call link-program,BenchmarkNMEAParser,BENCHMARK_NMEA_PARSER))
+
 RUN_DECLARE_SOURCES = \
 	$(SRC)/Device/Port/ConfiguredPort.cpp \
 	$(SRC)/Units/Descriptor.cpp \
@@ -1375,6 +1578,7 @@ RUN_VEGA_SETTINGS_SOURCES = \
 	$(SRC)/Device/Port/ConfiguredPort.cpp \
 	$(SRC)/Device/Config.cpp \
 	$(SRC)/NMEA/InputLine.cpp \
+	$(SRC)/NMEA/Checksum.cpp \
 	$(SRC)/NMEA/ExternalSettings.cpp \
 	$(SRC)/OS/LogError.cpp \
 	$(SRC)/Operation/Operation.cpp \
@@ -1683,7 +1887,7 @@ RUN_OLC_SOURCES = \
 	$(TEST_SRC_DIR)/ContestPrinting.cpp \
 	$(TEST_SRC_DIR)/RunOLCAnalysis.cpp
 RUN_OLC_LDADD = $(DEBUG_REPLAY_LDADD)
-RUN_OLC_DEPENDS = CONTEST UTIL GEO MATH TIME
+RUN_OLC_DEPENDS = CONTEST THREAD UTIL GEO MATH TIME
 $(eval $(call link-program,RunOLCAnalysis,RUN_OLC))
 
 RUN_WAVE_COMPUTER_SOURCES = \
@@ -1882,6 +2086,9 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Topography/TopographyRenderer.cpp \
 	$(SRC)/Topography/TopographyGlue.cpp \
 	$(SRC)/Topography/XShape.cpp \
+	$(SRC)/Topography/ShapeGeneration.cpp \
+	$(SRC)/Topography/MappedShapefile.cpp \
+	$(SRC)/Topography/TopographyPyramid.cpp \
 	$(SRC)/Topography/CachedTopographyRenderer.cpp \
 	$(SRC)/Units/Units.cpp \
 	$(SRC)/Units/Settings.cpp \
@@ -1907,6 +2114,7 @@ RUN_MAP_WINDOW_SOURCES = \
 	$(SRC)/Waypoint/LastUsed.cpp \
 	$(SRC)/Waypoint/WaypointFileType.cpp \
 	$(SRC)/Waypoint/WaypointGlue.cpp \
+	$(SRC)/Waypoint/WaypointCache.cpp \
 	$(SRC)/Waypoint/WaypointReader.cpp \
 	$(SRC)/Waypoint/WaypointReaderBase.cpp \
 	$(SRC)/Waypoint/WaypointReaderOzi.cpp \
@@ -2330,6 +2538,8 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Computer/AverageVarioComputer.cpp \
 	$(SRC)/Computer/GlideRatioComputer.cpp \
 	$(SRC)/Computer/GlideComputer.cpp \
+	$(SRC)/Computer/Profiler.cpp \
+	$(SRC)/JSON/Writer.cpp \
 	$(SRC)/Computer/GlideComputerBlackboard.cpp \
 	$(SRC)/Computer/TaskComputer.cpp \
 	$(SRC)/Computer/RouteComputer.cpp \
@@ -2359,6 +2569,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
 	$(SRC)/Renderer/AirspaceRendererSettings.cpp \
@@ -2506,6 +2717,7 @@ RUN_TASK_EDITOR_DIALOG_SOURCES = \
 	$(SRC)/Formatter/Units.cpp \
 	$(SRC)/Waypoint/WaypointFileType.cpp \
 	$(SRC)/Waypoint/WaypointGlue.cpp \
+	$(SRC)/Waypoint/WaypointCache.cpp \
 	$(SRC)/Waypoint/WaypointReaderBase.cpp \
 	$(SRC)/Waypoint/WaypointReader.cpp \
 	$(SRC)/Waypoint/WaypointReaderOzi.cpp \
@@ -0,0 +1,177 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "IO/BinaryCache.hpp"
+#include "OS/FileMapping.hpp"
+
+#include <algorithm>
+#include <vector>
+
+static constexpr const TCHAR *airspace_cache_name = _T("airspace");
+
+/**
+ * Increment this when the record layout changes.
+ */
+static constexpr uint32_t AIRSPACE_CACHE_VERSION = 1;
+
+static void
+WriteCachedAirspace(BinaryCacheWriter &writer, const AbstractAirspace &airspace)
+{
+  const auto shape = airspace.GetShape();
+  writer.WriteT(shape);
+  writer.WriteT(airspace.GetType());
+  writer.WriteT(airspace.GetBase());
+  writer.WriteT(airspace.GetTop());
+  writer.WriteT(airspace.GetDays());
+  writer.WriteString(airspace.GetName());
+  writer.WriteString(airspace.GetRadioText());
+
+  switch (shape) {
+  case AbstractAirspace::Shape::CIRCLE: {
+    const auto &circle = (const AirspaceCircle &)airspace;
+    writer.WriteT(circle.GetReferenceLocation());
+    writer.WriteT(circle.GetRadius());
+    break;
+  }
+
+  case AbstractAirspace::Shape::POLYGON: {
+    const auto &points = airspace.GetPoints();
+    writer.WriteT(uint32_t(points.size()));
+    for (const auto &i : points)
+      writer.WriteT(i.GetLocation());
+    break;
+  }
+  }
+}
+
+bool
+SaveAirspaceCache(FileCache &cache, uint64_t key,
+                  const Airspaces &airspaces)
+{
+  BinaryCacheWriter writer;
+  writer.WriteT(uint32_t(airspaces.GetSize()));
+
+  for (const auto &i : airspaces.QueryAll())
+    WriteCachedAirspace(writer, i.GetAirspace());
+
+  return SaveBinaryCache(cache, airspace_cache_name,
+                         AIRSPACE_CACHE_VERSION, key, writer.GetData());
+}
+
+static AbstractAirspace *
+ReadCachedAirspace(BinaryCacheReader &reader, std::vector<GeoPoint> &points)
+{
+  AbstractAirspace::Shape shape;
+  AirspaceClass type;
+  AirspaceAltitude base, top;
+  AirspaceActivity days;
+  tstring name, radio;
+  if (!reader.ReadT(shape) || !reader.ReadT(type) ||
+      unsigned(type) >= AIRSPACECLASSCOUNT ||
+      !reader.ReadT(base) || !reader.ReadT(top) ||
+      !reader.ReadT(days) ||
+      !reader.ReadString(name) || !reader.ReadString(radio))
+    return nullptr;
+
+  AbstractAirspace *airspace;
+  switch (shape) {
+  case AbstractAirspace::Shape::CIRCLE: {
+    GeoPoint center;
+    double radius;
+    if (!reader.ReadT(center) || !reader.ReadT(radius))
+      return nullptr;
+
+    airspace = new AirspaceCircle(center, radius);
+    break;
+  }
+
+  case AbstractAirspace::Shape::POLYGON: {
+    uint32_t n;
+    if (!reader.ReadT(n) || n < 3)
+      return nullptr;
+
+    points.clear();
+    for (uint32_t i = 0; i < n; ++i) {
+      GeoPoint point;
+      if (!reader.ReadT(point))
+        return nullptr;
+
+      points.push_back(point);
+    }
+
+    airspace = new AirspacePolygon(points);
+    break;
+  }
+
+  default:
+    return nullptr;
+  }
+
+  airspace->SetProperties(std::move(name), type, base, top);
+  airspace->SetRadio(radio);
+  airspace->SetDays(days);
+  return airspace;
+}
+
+bool
+LoadAirspaceCache(FileCache &cache, uint64_t key, Airspaces &airspaces)
+{
+  ConstBuffer<void> payload;
+  const auto mapping = LoadBinaryCache(cache, airspace_cache_name,
+                                       AIRSPACE_CACHE_VERSION, key,
+                                       payload);
+  if (!mapping)
+    return false;
+
+  BinaryCacheReader reader(payload);
+
+  uint32_t n;
+  if (!reader.ReadT(n))
+    return false;
+
+  /* decode everything before adding anything, so a corrupt file
+     leaves the database untouched */
+  std::vector<AbstractAirspace *> list;
+  list.reserve(std::min<size_t>(n, payload.size));
+
+  std::vector<GeoPoint> points;
+  for (uint32_t i = 0; i < n; ++i) {
+    AbstractAirspace *airspace = ReadCachedAirspace(reader, points);
+    if (airspace == nullptr) {
+      for (auto *j : list)
+        delete j;
+      return false;
+    }
+
+    list.push_back(airspace);
+  }
+
+  for (auto *i : list)
+    airspaces.Add(i);
+
+  return true;
+}
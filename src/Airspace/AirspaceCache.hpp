@@ -0,0 +1,55 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_AIRSPACE_CACHE_HPP
+#define XCSOAR_AIRSPACE_CACHE_HPP
+
+#include <stdint.h>
+
+class Airspaces;
+class FileCache;
+
+/**
+ * Save all airspaces in a binary cache file, in the order of the
+ * airspace tree.  This should be called after Airspaces::Optimise(),
+ * but before applying QNH and terrain.
+ *
+ * @param key identifies the airspace files (see
+ * UpdateBinaryCacheKey())
+ */
+bool
+SaveAirspaceCache(FileCache &cache, uint64_t key,
+                  const Airspaces &airspaces);
+
+/**
+ * Load the airspaces from the binary cache file, if its key matches.
+ * On success, the airspaces have been added, but
+ * Airspaces::Optimise() has not been called yet.
+ *
+ * @return false if there is no valid cache (nothing has been added
+ * then)
+ */
+bool
+LoadAirspaceCache(FileCache &cache, uint64_t key, Airspaces &airspaces);
+
+#endif
@@ -23,6 +23,7 @@ Copyright_License {
 
 #include "Airspace/AirspaceGlue.hpp"
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Profile/ProfileKeys.hpp"
 #include "Operation/Operation.hpp"
@@ -33,7 +34,11 @@ Copyright_License {
 #include "IO/ZipArchive.hpp"
 #include "IO/ZipLineReader.hpp"
 #include "IO/MapFile.hpp"
+#include "IO/BinaryCache.hpp"
+#include "IO/FileCache.hpp"
+#include "Util/FNV1a.hpp"
 #include "Profile/Profile.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #include <string.h>
 
@@ -74,10 +79,27 @@ try {
   return false;
 }
 
+/**
+ * Calculate the binary cache key for the configured airspace files.
+ */
+gcc_pure
+static uint64_t
+CalculateAirspaceCacheKey()
+{
+  uint64_t key = FNV1A_INIT;
+  key = UpdateBinaryCacheKey(key,
+                             Profile::GetPath(ProfileKeys::AirspaceFile));
+  key = UpdateBinaryCacheKey(key,
+                             Profile::GetPath(ProfileKeys::AdditionalAirspaceFile));
+  key = UpdateBinaryCacheKey(key, Profile::GetPath(ProfileKeys::MapFile));
+  return key;
+}
+
 void
 ReadAirspace(Airspaces &airspaces,
              RasterTerrain *terrain,
              const AtmosphericPressure &press,
+             FileCache *cache,
              OperationEnvironment &operation)
 {
   LogFormat("ReadAirspace");
@@ -85,24 +107,67 @@ ReadAirspace(Airspaces &airspaces,
 
   bool airspace_ok = false;
 
-  AirspaceParser parser(airspaces);
-
-  // Read the airspace filenames from the registry
-  auto path = Profile::GetPath(ProfileKeys::AirspaceFile);
-  if (!path.IsNull())
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
-
-  path = Profile::GetPath(ProfileKeys::AdditionalAirspaceFile);
-  if (!path.IsNull())
-    airspace_ok |= ParseAirspaceFile(parser, path, operation);
-
-  auto archive = OpenMapFile();
-  if (archive)
-    airspace_ok |= ParseAirspaceFile(parser, archive->get(), "airspace.txt",
-                                     operation);
+  /* parse and project on all processors; the pool lives only while
+     loading */
+  WorkerPool pool(WorkerPool::GetDefaultThreads(8));
+
+  const uint64_t cache_key = cache != nullptr
+    ? CalculateAirspaceCacheKey()
+    : 0;
+
+  if (cache != nullptr && LoadAirspaceCache(*cache, cache_key, airspaces)) {
+    LogFormat("Loaded %u airspaces from cache", airspaces.GetSize());
+    airspace_ok = true;
+    airspaces.Optimise(&pool);
+  } else {
+    AirspaceParser parser(airspaces, &pool);
+
+    /* did every configured source load without error?  Only then
+       may the result be cached */
+    bool complete = true;
+
+    // Read the airspace filenames from the registry
+    auto path = Profile::GetPath(ProfileKeys::AirspaceFile);
+    if (!path.IsNull()) {
+      if (ParseAirspaceFile(parser, path, operation))
+        airspace_ok = true;
+      else
+        complete = false;
+    }
+
+    path = Profile::GetPath(ProfileKeys::AdditionalAirspaceFile);
+    if (!path.IsNull()) {
+      if (ParseAirspaceFile(parser, path, operation))
+        airspace_ok = true;
+      else
+        complete = false;
+    }
+
+    auto archive = OpenMapFile();
+    if (archive) {
+      if (archive->Exists("airspace.txt")) {
+        if (ParseAirspaceFile(parser, archive->get(), "airspace.txt",
+                              operation))
+          airspace_ok = true;
+        else
+          complete = false;
+      }
+    } else if (!Profile::GetPath(ProfileKeys::MapFile).IsNull())
+      /* the map file is configured, but could not be opened */
+      complete = false;
+
+    if (airspace_ok) {
+      airspaces.Optimise(&pool);
+
+      /* save before QNH and terrain are applied, because those are
+         not part of the cache key */
+      if (complete && cache != nullptr &&
+          !SaveAirspaceCache(*cache, cache_key, airspaces))
+        LogFormat("Failed to save the airspace cache");
+    }
+  }
 
   if (airspace_ok) {
-    airspaces.Optimise();
     airspaces.SetFlightLevels(press);
 
     if (terrain != NULL)
@@ -27,15 +27,20 @@ Copyright_License {
 class RasterTerrain;
 class AtmosphericPressure;
 class Airspaces;
+class FileCache;
 class OperationEnvironment;
 
 /**
  * Reads the airspace files into the memory
+ *
+ * @param cache if not nullptr, then the parsed airspaces are loaded
+ * from (or saved to) a binary cache file in this directory
  */
 void
 ReadAirspace(Airspaces &airspaces,
              RasterTerrain *terrain,
              const AtmosphericPressure &press,
+             FileCache *cache,
              OperationEnvironment &operation);
 
 #endif
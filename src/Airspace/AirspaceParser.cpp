@@ -39,6 +39,9 @@ Copyright_License {
 #include "Engine/Airspace/AirspaceClass.hpp"
 #include "Util/StaticString.hxx"
 #include "Util/StringCompare.hxx"
+#include "Util/ParallelExecutor.hpp"
+
+#include <vector>
 
 #include <tchar.h>
 
@@ -113,6 +116,11 @@ static constexpr AirspaceClassStringCouple airspace_tnp_type_strings[] = {
   { _T("RMZ"), RMZ },
 };
 
+/**
+ * The airspaces parsed from one chunk of a file, in file order.
+ */
+typedef std::vector<AbstractAirspace *> AirspaceList;
+
 // this can now be called multiple times to load several airspaces.
 
 struct TempAirspaceType
@@ -144,6 +152,7 @@ struct TempAirspaceType
   Reset()
   {
     days_of_operation.SetAll();
+    name.clear();
     radio = _T("");
     type = OTHER;
     base = top = AirspaceAltitude();
@@ -166,7 +175,7 @@ struct TempAirspaceType
   }
 
   void
-  AddPolygon(Airspaces &airspace_database)
+  AddPolygon(AirspaceList &airspace_database)
   {
     if (points.size() < 3)
       return;
@@ -175,17 +184,17 @@ struct TempAirspaceType
     as->SetProperties(std::move(name), type, base, top);
     as->SetRadio(radio);
     as->SetDays(days_of_operation);
-    airspace_database.Add(as);
+    airspace_database.push_back(as);
   }
 
   void
-  AddCircle(Airspaces &airspace_database)
+  AddCircle(AirspaceList &airspace_database)
   {
     AbstractAirspace *as = new AirspaceCircle(center, radius);
     as->SetProperties(std::move(name), type, base, top);
     as->SetRadio(radio);
     as->SetDays(days_of_operation);
-    airspace_database.Add(as);
+    airspace_database.push_back(as);
   }
 
   static int
@@ -496,7 +505,7 @@ ParseType(const TCHAR *buffer)
 }
 
 static bool
-ParseLine(Airspaces &airspace_database, StringParser<TCHAR> &&input,
+ParseLine(AirspaceList &airspace_database, StringParser<TCHAR> &&input,
           TempAirspaceType &temp_area)
 {
   double d;
@@ -606,7 +615,7 @@ ParseLine(Airspaces &airspace_database, StringParser<TCHAR> &&input,
 }
 
 static bool
-ParseLine(Airspaces &airspace_database, TCHAR *line,
+ParseLine(AirspaceList &airspace_database, TCHAR *line,
           TempAirspaceType &temp_area)
 {
   // Strip comments
@@ -758,7 +767,7 @@ ParseCircleTNP(StringParser<TCHAR> &input, TempAirspaceType &temp_area)
 }
 
 static bool
-ParseLineTNP(Airspaces &airspace_database, StringParser<TCHAR> &input,
+ParseLineTNP(AirspaceList &airspace_database, StringParser<TCHAR> &input,
              TempAirspaceType &temp_area, bool &ignore)
 {
   if (input.Match('#'))
@@ -841,22 +850,139 @@ DetectFileType(const TCHAR *line)
   return AirspaceFileType::UNKNOWN;
 }
 
-bool
-AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
+/**
+ * Does this OpenAir line start a new airspace?  Files are split only
+ * at these lines, because they reset the whole parser state.
+ */
+static bool
+IsAirspaceStart(const TCHAR *line)
+{
+  const TCHAR *p = StringAfterPrefixCI(line, _T("AC"));
+  return p != nullptr && IsWhitespaceNotNull(*p);
+}
+
+/**
+ * The non-empty lines of an airspace file, copied into one buffer,
+ * so they can be parsed after the whole file has been read.
+ */
+class AirspaceLines {
+  std::vector<TCHAR> buffer;
+
+  struct Line {
+    size_t offset;
+    unsigned number;
+  };
+
+  std::vector<Line> lines;
+
+public:
+  unsigned size() const {
+    return lines.size();
+  }
+
+  void Add(unsigned number, const TCHAR *line) {
+    lines.push_back({buffer.size(), number});
+    buffer.insert(buffer.end(), line, line + StringLength(line) + 1);
+  }
+
+  TCHAR *Get(unsigned i) {
+    return buffer.data() + lines[i].offset;
+  }
+
+  unsigned GetNumber(unsigned i) const {
+    return lines[i].number;
+  }
+};
+
+struct AirspaceChunk {
+  /**
+   * The range of line indices.
+   */
+  unsigned begin, end;
+
+  /**
+   * The index of the line which failed to parse; #end if there was
+   * no error.
+   */
+  unsigned error;
+
+  AirspaceList airspaces;
+
+  AirspaceChunk(unsigned _begin, unsigned _end)
+    :begin(_begin), end(_end), error(_end) {}
+};
+
+static void
+ParseChunk(AirspaceLines &lines, AirspaceChunk &chunk)
 {
+  TempAirspaceType temp_area;
+
+  for (unsigned i = chunk.begin; i < chunk.end; ++i) {
+    if (!ParseLine(chunk.airspaces, lines.Get(i), temp_area)) {
+      chunk.error = i;
+      return;
+    }
+  }
+
+  // Process final area (if any)
+  temp_area.AddPolygon(chunk.airspaces);
+}
+
+static void
+ParseChunkTNP(AirspaceLines &lines, AirspaceChunk &chunk)
+{
+  TempAirspaceType temp_area;
   bool ignore = false;
 
+  for (unsigned i = chunk.begin; i < chunk.end; ++i) {
+    StringParser<TCHAR> input(lines.Get(i));
+    if (!ParseLineTNP(chunk.airspaces, input, temp_area, ignore)) {
+      chunk.error = i;
+      return;
+    }
+  }
+
+  // Process final area (if any)
+  temp_area.AddPolygon(chunk.airspaces);
+}
+
+/**
+ * Split the lines of an OpenAir file into chunks of at least the
+ * given size.  Each chunk (except the first) begins with an "AC"
+ * line.
+ */
+static std::vector<AirspaceChunk>
+SplitChunks(AirspaceLines &lines, unsigned chunk_size)
+{
+  std::vector<AirspaceChunk> chunks;
+
+  unsigned begin = 0;
+  for (unsigned i = chunk_size, n = lines.size(); i < n; ++i) {
+    if (i - begin >= chunk_size && IsAirspaceStart(lines.Get(i))) {
+      chunks.emplace_back(begin, i);
+      begin = i;
+    }
+  }
+
+  chunks.emplace_back(begin, lines.size());
+  return chunks;
+}
+
+bool
+AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
+{
   // Create and init ProgressDialog
   operation.SetProgressRange(1024);
 
   const long file_size = reader.GetSize();
 
-  TempAirspaceType temp_area;
   AirspaceFileType filetype = AirspaceFileType::UNKNOWN;
+  AirspaceLines lines;
 
   TCHAR *line;
 
-  // Iterate through the lines
+  /* read the whole file first; the (slow) parsing is done below,
+     possibly in parallel */
   for (unsigned line_num = 1; (line = reader.ReadLine()) != nullptr; line_num++) {
     StripRight(line);
 
@@ -870,18 +996,7 @@ AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
         continue;
     }
 
-    // Parse the line
-    if (filetype == AirspaceFileType::OPENAIR)
-      if (!ParseLine(airspaces, line, temp_area) &&
-          !ShowParseWarning(line_num, line, operation))
-        return false;
-
-    if (filetype == AirspaceFileType::TNP) {
-      StringParser<TCHAR> input(line);
-      if (!ParseLineTNP(airspaces, input, temp_area, ignore) &&
-          !ShowParseWarning(line_num, line, operation))
-        return false;
-    }
+    lines.Add(line_num, line);
 
     // Update the ProgressDialog
     if ((line_num & 0xff) == 0)
@@ -893,8 +1008,38 @@ AirspaceParser::Parse(TLineReader &reader, OperationEnvironment &operation)
     return false;
   }
 
-  // Process final area (if any)
-  temp_area.AddPolygon(airspaces);
+  std::vector<AirspaceChunk> chunks;
+  if (filetype == AirspaceFileType::OPENAIR) {
+    chunks = SplitChunks(lines, chunk_size);
+    ParallelForEach(executor, chunks.size(), [&lines, &chunks](unsigned i){
+        ParseChunk(lines, chunks[i]);
+      });
+  } else {
+    /* TNP files carry the class, radio and activity over to the
+       following airspaces; don't split them */
+    chunks.emplace_back(0, lines.size());
+    ParseChunkTNP(lines, chunks.front());
+  }
+
+  /* add the airspaces in file order, up to the first error */
+  const AirspaceChunk *failed = nullptr;
+  for (auto &chunk : chunks) {
+    if (failed != nullptr) {
+      for (auto *as : chunk.airspaces)
+        delete as;
+      continue;
+    }
+
+    for (auto *as : chunk.airspaces)
+      airspaces.Add(as);
+
+    if (chunk.error != chunk.end)
+      failed = &chunk;
+  }
+
+  if (failed != nullptr)
+    return ShowParseWarning(lines.GetNumber(failed->error),
+                            lines.Get(failed->error), operation);
 
   return true;
 }
@@ -27,13 +27,30 @@ Copyright_License {
 class Airspaces;
 class TLineReader;
 class OperationEnvironment;
+class ParallelExecutor;
 
 class AirspaceParser
 {
   Airspaces &airspaces;
 
+  /**
+   * If not nullptr, then OpenAir files are split into chunks at
+   * airspace boundaries, which are parsed in parallel on this
+   * executor.
+   */
+  ParallelExecutor *const executor;
+
+  /**
+   * The minimum number of lines per OpenAir chunk.  Only unit tests
+   * should need to change it.
+   */
+  const unsigned chunk_size;
+
 public:
-  AirspaceParser(Airspaces &_airspaces): airspaces(_airspaces) {}
+  AirspaceParser(Airspaces &_airspaces,
+                 ParallelExecutor *_executor=nullptr,
+                 unsigned _chunk_size=2048)
+    :airspaces(_airspaces), executor(_executor), chunk_size(_chunk_size) {}
 
   bool Parse(TLineReader &reader, OperationEnvironment &operation);
 };
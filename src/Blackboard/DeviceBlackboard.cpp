@@ -35,9 +35,8 @@ Copyright_License {
 DeviceBlackboard::DeviceBlackboard()
   :devices(nullptr)
 {
-  // Clear the gps_info and calculated_info
+  // Clear the gps_info
   gps_info.Reset();
-  calculated_info.Reset();
 
   // Set GPS assumed time to system time
   gps_info.UpdateClock();
@@ -52,6 +51,12 @@ DeviceBlackboard::DeviceBlackboard()
 
   real_clock.Reset();
   replay_clock.Reset();
+
+  PublishBasic();
+
+  DerivedInfo calculated;
+  calculated.Reset();
+  PublishCalculated(calculated);
 }
 
 /**
@@ -66,7 +71,7 @@ DeviceBlackboard::SetStartupLocation(const GeoPoint &loc, const double alt)
 {
   ScopeLock protect(mutex);
 
-  if (Calculated().flight.flying)
+  if (ReadCalculated()->flight.flying)
     return;
 
   for (unsigned i = 0; i < unsigned(NUMDEV); ++i)
@@ -172,18 +177,6 @@ DeviceBlackboard::SetAltitude(double val)
   ScheduleMerge();
 }
 
-/**
- * Reads the given derived_info usually provided by the
- * GlideComputerBlackboard and saves it to the own Blackboard
- * @param derived_info Calculated information usually provided
- * by the GlideComputerBlackboard
- */
-void
-DeviceBlackboard::ReadBlackboard(const DerivedInfo &derived_info)
-{
-  calculated_info = derived_info;
-}
-
 /**
  * Reads the given settings usually provided by the InterfaceBlackboard
  * and saves it to the own Blackboard
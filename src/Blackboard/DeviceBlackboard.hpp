@@ -24,12 +24,15 @@ Copyright_License {
 #ifndef DEVICE_BLACKBOARD_H
 #define DEVICE_BLACKBOARD_H
 
-#include "Blackboard/BaseBlackboard.hpp"
 #include "Blackboard/ComputerSettingsBlackboard.hpp"
+#include "NMEA/MoreData.hpp"
+#include "NMEA/Derived.hpp"
 #include "Device/Simulator.hpp"
 #include "Device/Features.hpp"
 #include "Thread/Mutex.hpp"
+#include "Thread/SnapshotBuffer.hpp"
 #include "Time/WrapClock.hpp"
+#include "Compiler.h"
 
 #include <cassert>
 
@@ -46,10 +49,15 @@ class RadioFrequency;
  * since it is accessed quickly with only one mutex
  */
 class DeviceBlackboard
-  : public BaseBlackboard, public ComputerSettingsBlackboard
+  : public ComputerSettingsBlackboard
 {
   friend class MergeThread;
 
+  /**
+   * The merged data from all sources, written by the #MergeThread.
+   */
+  MoreData gps_info;
+
   Simulator simulator;
 
   MultipleDevices *devices;
@@ -79,9 +87,25 @@ class DeviceBlackboard
    */
   WrapClock real_clock, replay_clock;
 
+  /**
+   * Copies of Basic() (published by the #MergeThread) and of the
+   * GlideComputer results (published by the CalculationThread),
+   * which can be read without locking #mutex.
+   *
+   * Both are read concurrently by the CalculationThread, the UI
+   * thread and the DrawThread; 5 slots allow these three readers to
+   * hold a #Reader at the same time without blocking the writer (see
+   * #SnapshotBuffer).
+   */
+  SnapshotBuffer<MoreData, 5> basic_snapshot;
+  SnapshotBuffer<DerivedInfo, 5> calculated_snapshot;
+
 public:
   Mutex mutex;
 
+  typedef SnapshotBuffer<MoreData, 5>::Reader BasicReader;
+  typedef SnapshotBuffer<DerivedInfo, 5>::Reader CalculatedReader;
+
 public:
   DeviceBlackboard();
 
@@ -91,7 +115,43 @@ public:
     devices = &_devices;
   }
 
-  void ReadBlackboard(const DerivedInfo &derived_info);
+  gcc_pure
+  const MoreData &Basic() const {
+    return gps_info;
+  }
+
+  /**
+   * Obtain the most recently published copy of Basic().  This does
+   * not need #mutex.
+   */
+  BasicReader ReadBasic() const {
+    return basic_snapshot.Read();
+  }
+
+  /**
+   * Obtain the most recently published calculated values.  This does
+   * not need #mutex.
+   */
+  CalculatedReader ReadCalculated() const {
+    return calculated_snapshot.Read();
+  }
+
+  /**
+   * Publish the current Basic() value for ReadBasic().  The caller
+   * must hold #mutex.
+   */
+  void PublishBasic() {
+    basic_snapshot.Write(gps_info);
+  }
+
+  /**
+   * Publish new calculated values for ReadCalculated().  Only one
+   * thread (the CalculationThread) may call this method.
+   */
+  void PublishCalculated(const DerivedInfo &derived_info) {
+    calculated_snapshot.Write(derived_info);
+  }
+
   void ReadComputerSettings(const ComputerSettings &settings);
 
 protected:
@@ -0,0 +1,72 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_BLACKBOARD_TRANSFER_STATS_HPP
+#define XCSOAR_BLACKBOARD_TRANSFER_STATS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Diagnostic counters about a thread's blackboard transfers: how
+ * many bytes it copies per tick, and how long it holds the
+ * blackboard (i.e. the mutex or a pinned snapshot).
+ */
+struct TransferStats {
+  unsigned ticks;
+
+  uint64_t copy_bytes;
+
+  /**
+   * The total and the maximum hold time [us].
+   */
+  uint64_t hold_us, max_hold_us;
+
+  TransferStats() {
+    Reset();
+  }
+
+  void Reset() {
+    ticks = 0;
+    copy_bytes = 0;
+    hold_us = max_hold_us = 0;
+  }
+
+  void Add(size_t bytes, uint64_t us) {
+    ++ticks;
+    copy_bytes += bytes;
+    hold_us += us;
+    if (us > max_hold_us)
+      max_hold_us = us;
+  }
+
+  unsigned GetBytesPerTick() const {
+    return ticks > 0 ? unsigned(copy_bytes / ticks) : 0;
+  }
+
+  unsigned GetHoldPerTick() const {
+    return ticks > 0 ? unsigned(hold_us / ticks) : 0;
+  }
+};
+
+#endif
@@ -27,6 +27,7 @@ Copyright_License {
 #include "Blackboard/DeviceBlackboard.hpp"
 #include "Components.hpp"
 #include "Hardware/CPU.hpp"
+#include "OS/Clock.hpp"
 
 /**
  * Constructor of the CalculationThread class
@@ -65,14 +66,16 @@ CalculationThread::Tick()
   bool gps_updated;
 
   // update and transfer master info to glide computer
+  uint64_t hold_start = MonotonicClockUS();
   {
-    ScopeLock protect(device_blackboard->mutex);
+    const auto basic = device_blackboard->ReadBasic();
 
-    gps_updated = device_blackboard->Basic().location_available.Modified(glide_computer.Basic().location_available);
+    gps_updated = basic->location_available.Modified(glide_computer.Basic().location_available);
 
     // Copy data from DeviceBlackboard to GlideComputerBlackboard
-    glide_computer.ReadBlackboard(device_blackboard->Basic());
+    glide_computer.ReadBlackboard(*basic);
   }
+  uint64_t hold_us = MonotonicClockUS() - hold_start;
 
   bool force;
   {
@@ -98,10 +101,11 @@ CalculationThread::Tick()
   // values changed, so copy them back now: ONLY CALCULATED INFO
   // should be changed in DoCalculations, so we only need to write
   // that one back (otherwise we may write over new data)
-  {
-    ScopeLock protect(device_blackboard->mutex);
-    device_blackboard->ReadBlackboard(glide_computer.Calculated());
-  }
+  hold_start = MonotonicClockUS();
+  device_blackboard->PublishCalculated(glide_computer.Calculated());
+  hold_us += MonotonicClockUS() - hold_start;
+
+  stats.Add(sizeof(MoreData) + sizeof(DerivedInfo), hold_us);
 
   // if (new GPS data)
   if (gps_updated || force)
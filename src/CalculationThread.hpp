@@ -27,6 +27,7 @@ Copyright_License {
 #include "Thread/WorkerThread.hpp"
 #include "Thread/Mutex.hpp"
 #include "Computer/Settings.hpp"
+#include "Blackboard/TransferStats.hpp"
 
 class GlideComputer;
 
@@ -56,12 +57,22 @@ class CalculationThread final : public WorkerThread {
   /** Pointer to the GlideComputer that should be used */
   GlideComputer &glide_computer;
 
+  TransferStats stats;
+
 public:
   CalculationThread(GlideComputer &_glide_computer);
 
   void SetComputerSettings(const ComputerSettings &new_value);
   void SetScreenDistanceMeters(double new_value);
 
+  /**
+   * Statistics about the blackboard transfers.  May be read only
+   * after the thread has been joined.
+   */
+  const TransferStats &GetTransferStats() const {
+    return stats;
+  }
+
   bool Start(bool suspended=false) {
     if (!WorkerThread::Start(suspended))
       return false;
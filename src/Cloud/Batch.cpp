@@ -0,0 +1,123 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Batch.hpp"
+#include "Tracking/SkyLines/Export.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "OS/ByteOrder.hpp"
+#include "Util/CRC.hpp"
+
+#include <algorithm>
+
+void
+TrafficBatch::Add(const SkyLinesTracking::Server::Client &c,
+                  uint32_t pilot_id, uint32_t time,
+                  GeoPoint location, int altitude)
+{
+  auto &recipient = recipients[c.key];
+  recipient.endpoint = c.endpoint;
+
+  Traffic traffic;
+  traffic.pilot_id = ToBE32(pilot_id);
+  traffic.time = ToBE32(time);
+  traffic.location = SkyLinesTracking::ExportGeoPoint(location);
+  traffic.altitude = ToBE16(altitude);
+  traffic.reserved = 0;
+  traffic.reserved2 = 0;
+  recipient.traffic.push_back(traffic);
+}
+
+/**
+ * Remove all but the last update of each pilot.
+ */
+static void
+Coalesce(std::vector<SkyLinesTracking::TrafficResponsePacket::Traffic> &v)
+{
+  if (v.size() < 2)
+    return;
+
+  /* a stable sort keeps the chronological order within each pilot,
+     so the last one of each group is the newest */
+  std::stable_sort(v.begin(), v.end(), [](const SkyLinesTracking::TrafficResponsePacket::Traffic &a,
+                                          const SkyLinesTracking::TrafficResponsePacket::Traffic &b){
+                     return a.pilot_id < b.pilot_id;
+                   });
+
+  auto o = v.begin();
+  for (auto i = v.begin(); i != v.end(); ++i) {
+    const auto next = std::next(i);
+    if (next == v.end() || next->pilot_id != i->pilot_id)
+      *o++ = *i;
+  }
+
+  v.erase(o, v.end());
+}
+
+void
+TrafficBatch::Flush(SkyLinesTracking::Server &server)
+{
+  /* count the datagrams first, so the "packets" vector does not get
+     reallocated while "datagrams" points into it */
+  size_t n_packets = 0;
+  for (auto &i : recipients) {
+    Coalesce(i.second.traffic);
+    n_packets += (i.second.traffic.size() + MAX_TRAFFIC - 1) / MAX_TRAFFIC;
+  }
+
+  packets.resize(n_packets);
+  datagrams.clear();
+
+  auto packet = packets.begin();
+  for (const auto &i : recipients) {
+    const uint64_t key = i.first;
+    const auto &recipient = i.second;
+
+    for (size_t offset = 0; offset < recipient.traffic.size();
+         offset += MAX_TRAFFIC, ++packet) {
+      const size_t n = std::min(recipient.traffic.size() - offset,
+                                MAX_TRAFFIC);
+
+      auto &header = packet->header;
+      header.header.magic = ToBE32(SkyLinesTracking::MAGIC);
+      header.header.type = ToBE16(SkyLinesTracking::Type::TRAFFIC_RESPONSE);
+      header.header.key = ToBE64(key);
+      header.traffic_count = n;
+      header.reserved = 0;
+      header.reserved2 = 0;
+      header.reserved3 = 0;
+
+      std::copy_n(recipient.traffic.begin() + offset, n, packet->traffic);
+
+      const size_t size = sizeof(header) + sizeof(packet->traffic[0]) * n;
+      header.header.crc = 0;
+      header.header.crc = ToBE16(UpdateCRC16CCITT(&*packet, size, 0));
+
+      datagrams.push_back({&recipient.endpoint,
+            boost::asio::const_buffer(&*packet, size)});
+    }
+  }
+
+  server.SendBuffers({datagrams.data(), datagrams.size()});
+
+  recipients.clear();
+}
@@ -0,0 +1,100 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_BATCH_HPP
+#define XCSOAR_CLOUD_BATCH_HPP
+
+#include "Tracking/SkyLines/Server.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+
+#include <boost/asio/ip/udp.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+struct GeoPoint;
+
+/**
+ * Collects traffic updates per recipient, to be sent later in as few
+ * #SkyLinesTracking::TrafficResponsePacket datagrams as possible.  If
+ * one pilot moves several times before Flush(), only the most recent
+ * location is sent.
+ *
+ * This class is not thread-safe; each receiver thread owns one
+ * instance.
+ */
+class TrafficBatch {
+  typedef SkyLinesTracking::TrafficResponsePacket::Traffic Traffic;
+
+  /**
+   * The maximum number of #Traffic records per datagram.  The
+   * #SkyLinesTracking::TrafficResponsePacket::traffic_count field
+   * allows 255, but the client's receive buffer is 4096 bytes.
+   */
+  static constexpr size_t MAX_TRAFFIC =
+    (4096 - sizeof(SkyLinesTracking::TrafficResponsePacket)) / sizeof(Traffic);
+  static_assert(MAX_TRAFFIC <= 255, "traffic_count overflow");
+
+  struct Recipient {
+    boost::asio::ip::udp::endpoint endpoint;
+
+    /**
+     * Pending updates in the order they were added.  Duplicates are
+     * eliminated by Flush().
+     */
+    std::vector<Traffic> traffic;
+  };
+
+  std::unordered_map<uint64_t, Recipient> recipients;
+
+  struct Packet {
+    SkyLinesTracking::TrafficResponsePacket header;
+    Traffic traffic[MAX_TRAFFIC];
+  };
+
+  /**
+   * Buffers for the assembled datagrams; kept across Flush() calls
+   * to avoid reallocation.
+   */
+  std::vector<Packet> packets;
+  std::vector<SkyLinesTracking::Server::Datagram> datagrams;
+
+public:
+  bool empty() const {
+    return recipients.empty();
+  }
+
+  /**
+   * Queue a traffic update for the given recipient.
+   */
+  void Add(const SkyLinesTracking::Server::Client &recipient,
+           uint32_t pilot_id, uint32_t time,
+           GeoPoint location, int altitude);
+
+  /**
+   * Send all pending updates and clear the queue.
+   */
+  void Flush(SkyLinesTracking::Server &server);
+};
+
+#endif
@@ -123,8 +123,7 @@ CloudClientContainer::Remove(CloudClient &client)
 void
 CloudClientContainer::Expire(std::chrono::steady_clock::time_point before)
 {
-  while (!list.empty() && list.back().stamp < before)
-    Remove(list.back());
+  Expire(before, [](const CloudClient &){});
 }
 
 CloudClientContainer::query_iterator_range
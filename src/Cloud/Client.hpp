@@ -259,6 +259,18 @@ public:
 
   void Expire(std::chrono::steady_clock::time_point before);
 
+  /**
+   * Like Expire(), but invoke the given function for each client
+   * before it is removed.
+   */
+  template<typename F>
+  void Expire(std::chrono::steady_clock::time_point before, F &&f) {
+    while (!list.empty() && list.back().stamp < before) {
+      f(list.back());
+      Remove(list.back());
+    }
+  }
+
   typedef Tree::const_query_iterator query_iterator;
   typedef boost::iterator_range<query_iterator> query_iterator_range;
 
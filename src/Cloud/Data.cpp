@@ -24,6 +24,10 @@ Copyright_License {
 #include "Data.hpp"
 #include "Dump.hpp"
 #include "Serialiser.hpp"
+#include "Snapshot.hpp"
+#include "Journal.hpp"
+#include "IO/FileReader.hxx"
+#include "OS/FileUtil.hpp"
 
 #include <iostream>
 #include <iomanip>
@@ -38,13 +42,13 @@ static constexpr uint32_t CLOUD_VERSION = 1;
 void
 CloudData::DumpClients()
 {
-  for (const auto &client : clients) {
-    cout << client.endpoint << '\t'
-         << std::hex << client.key << std::dec << '\t'
-         << client.id << '\t'
-         << client.location << '\t'
-         << client.altitude << "m\n";
-  }
+  clients.ForEach([](const CloudClient &client){
+      cout << client.endpoint << '\t'
+           << std::hex << client.key << std::dec << '\t'
+           << client.id << '\t'
+           << client.location << '\t'
+           << client.altitude << "m\n";
+    });
 
   cout.flush();
 }
@@ -56,7 +60,12 @@ CloudData::Save(Serialiser &s) const
   s.Write32(CLOUD_VERSION);
   clients.Save(s);
   s.Write8(1);
-  thermals.Save(s);
+
+  {
+    ScopeLock protect(thermals_mutex);
+    thermals.Save(s);
+  }
+
   s.Write8(0);
 }
 
@@ -72,7 +81,22 @@ CloudData::Load(Deserialiser &s)
   clients.Load(s);
 
   if (s.Read8() != 0) {
+    ScopeLock protect(thermals_mutex);
     thermals.Load(s);
     s.Read8();
   }
 }
+
+void
+CloudData::Load(Path db_path)
+{
+  /* the journal may exist without a snapshot if the server crashed
+     before saving for the first time */
+  if (File::Exists(db_path) && !CloudSnapshot::Load(db_path, *this)) {
+    FileReader fr(db_path);
+    Deserialiser s(fr);
+    Load(s);
+  }
+
+  CloudJournal::Replay(db_path, *this);
+}
@@ -24,20 +24,42 @@ Copyright_License {
 #ifndef XCSOAR_CLOUD_DATA_HPP
 #define XCSOAR_CLOUD_DATA_HPP
 
-#include "Client.hpp"
+#include "Shards.hpp"
 #include "Thermal.hpp"
+#include "Thread/Mutex.hpp"
 
 class Serialiser;
 class Deserialiser;
+class Path;
 
 struct CloudData {
-  CloudClientContainer clients;
+  CloudClientShards clients;
+
+  /**
+   * Protects #thermals, which may be accessed by several receiver
+   * threads.
+   */
+  mutable Mutex thermals_mutex;
   CloudThermalContainer thermals;
 
+  /**
+   * The sequence number of the most recently submitted thermal.  It
+   * allows the journal replay to skip thermals which are already in
+   * the snapshot.  Protected by #thermals_mutex.
+   */
+  uint64_t thermal_sequence = 0;
+
   void DumpClients();
 
   void Save(Serialiser &s) const;
   void Load(Deserialiser &s);
+
+  /**
+   * Load the database from the given path: a #CloudSnapshot (or the
+   * old #Serialiser format) plus the #CloudJournal.  Throws on
+   * error.
+   */
+  void Load(Path db_path);
 };
 
 #endif
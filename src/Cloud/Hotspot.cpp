@@ -0,0 +1,201 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Hotspot.hpp"
+#include "Thermal.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Tracking/SkyLines/Assemble.hpp"
+
+#include <boost/geometry/algorithms/intersection.hpp>
+#include <boost/geometry/strategies/strategies.hpp>
+
+#include <algorithm>
+
+#include <math.h>
+
+/**
+ * The size of one grid cell [degrees].  This is roughly 1 km in
+ * latitude.
+ */
+static constexpr double CELL_SIZE = 0.01;
+
+static constexpr uint64_t N_LONGITUDE_CELLS = 360 / CELL_SIZE;
+
+/**
+ * After this duration, the weight of a report has decayed to one
+ * half.
+ */
+static constexpr std::chrono::steady_clock::duration HALF_LIFE =
+  std::chrono::minutes(10);
+
+gcc_const
+static double
+Decay(std::chrono::steady_clock::duration age)
+{
+  const double half_lives = std::chrono::duration<double>(age).count()
+    / std::chrono::duration<double>(HALF_LIFE).count();
+  return exp2(-half_lives);
+}
+
+void
+CloudHotspot::Add(const CloudThermal &thermal)
+{
+  double w = 1;
+  if (weight <= 0) {
+    time = thermal.time;
+    client_key = thermal.client_key;
+  } else {
+    if (thermal.time >= time) {
+      /* decay the old sums to the new report's time */
+      const double f = Decay(thermal.time - time);
+      weight *= f;
+      bottom_latitude *= f;
+      bottom_longitude *= f;
+      bottom_altitude *= f;
+      top_latitude *= f;
+      top_longitude *= f;
+      top_altitude *= f;
+      lift *= f;
+      time = thermal.time;
+    } else
+      /* an old report (e.g. while loading the database) */
+      w = Decay(time - thermal.time);
+
+    if (thermal.client_key != client_key)
+      client_key = 0;
+  }
+
+  weight += w;
+  bottom_latitude += w * thermal.bottom_location.latitude.Degrees();
+  bottom_longitude += w * thermal.bottom_location.longitude.Degrees();
+  bottom_altitude += w * thermal.bottom_location.altitude;
+  top_latitude += w * thermal.top_location.latitude.Degrees();
+  top_longitude += w * thermal.top_location.longitude.Degrees();
+  top_altitude += w * thermal.top_location.altitude;
+  lift += w * thermal.lift;
+}
+
+double
+CloudHotspot::GetWeight(std::chrono::steady_clock::time_point now) const
+{
+  return now > time
+    ? weight * Decay(now - time)
+    : weight;
+}
+
+SkyLinesTracking::Thermal
+CloudHotspot::Pack() const
+{
+  const GeoPoint bottom(Angle::Degrees(bottom_longitude / weight),
+                        Angle::Degrees(bottom_latitude / weight));
+  const GeoPoint top(Angle::Degrees(top_longitude / weight),
+                     Angle::Degrees(top_latitude / weight));
+
+  // TODO: fill "time" properly
+  return SkyLinesTracking::MakeThermal(0,
+                                       bottom, lround(bottom_altitude / weight),
+                                       top, lround(top_altitude / weight),
+                                       GetLift());
+}
+
+uint64_t
+CloudHotspotContainer::ToCell(GeoPoint location)
+{
+  const double latitude = location.latitude.Degrees() + 90;
+  const double longitude = location.longitude.Degrees() + 180;
+
+  const uint64_t y = std::max(latitude / CELL_SIZE, 0.);
+  const uint64_t x = uint64_t(std::max(longitude / CELL_SIZE, 0.))
+    % N_LONGITUDE_CELLS;
+  return y * N_LONGITUDE_CELLS + x;
+}
+
+GeoPoint
+CloudHotspotContainer::GetCellCenter(uint64_t cell)
+{
+  const uint64_t y = cell / N_LONGITUDE_CELLS;
+  const uint64_t x = cell % N_LONGITUDE_CELLS;
+  return GeoPoint(Angle::Degrees((x + 0.5) * CELL_SIZE - 180),
+                  Angle::Degrees((y + 0.5) * CELL_SIZE - 90));
+}
+
+void
+CloudHotspotContainer::Add(const CloudThermal &thermal)
+{
+  const uint64_t cell = ToCell(thermal.top_location);
+  auto i = map.find(cell);
+  if (i == map.end()) {
+    i = map.emplace(cell, CloudHotspot(GetCellCenter(cell))).first;
+    rtree.insert(Value(i->second.center, &i->second));
+  }
+
+  i->second.Add(thermal);
+}
+
+void
+CloudHotspotContainer::Expire(std::chrono::steady_clock::time_point before)
+{
+  for (auto i = map.begin(); i != map.end();) {
+    if (i->second.time < before) {
+      rtree.remove(Value(i->second.center, &i->second));
+      i = map.erase(i);
+    } else
+      ++i;
+  }
+}
+
+std::vector<const CloudHotspot *>
+CloudHotspotContainer::QueryTop(GeoPoint location, double range,
+                                std::chrono::steady_clock::time_point now,
+                                std::chrono::steady_clock::time_point min_time,
+                                uint64_t exclude_key,
+                                unsigned max_results) const
+{
+  std::vector<std::pair<double, const CloudHotspot *>> candidates;
+
+  const auto q = boost::geometry::index::intersects(BoostRangeBox(location, range));
+  for (auto i = rtree.qbegin(q), end = rtree.qend(); i != end; ++i) {
+    const CloudHotspot &hotspot = *i->second;
+    if (hotspot.time < min_time ||
+        (exclude_key != 0 && hotspot.client_key == exclude_key))
+      continue;
+
+    candidates.emplace_back(hotspot.GetScore(now), &hotspot);
+  }
+
+  const auto n = std::min<size_t>(candidates.size(), max_results);
+  std::partial_sort(candidates.begin(), candidates.begin() + n,
+                    candidates.end(),
+                    [](const std::pair<double, const CloudHotspot *> &a,
+                       const std::pair<double, const CloudHotspot *> &b){
+                      return a.first > b.first;
+                    });
+
+  std::vector<const CloudHotspot *> result;
+  result.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+    result.push_back(candidates[i].second);
+
+  return result;
+}
@@ -0,0 +1,174 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_HOTSPOT_HPP
+#define XCSOAR_CLOUD_HOTSPOT_HPP
+
+#include "Geo/Boost/GeoPoint.hpp"
+#include "Compiler.h"
+
+#include <boost/geometry/index/rtree.hpp>
+
+#include <unordered_map>
+#include <vector>
+#include <chrono>
+#include <utility>
+
+#include <stdint.h>
+
+struct CloudThermal;
+namespace SkyLinesTracking { struct Thermal; }
+
+/**
+ * All thermal reports within one grid cell, merged into
+ * exponentially time-decayed averages.  Recent reports weigh more,
+ * and a cell which has been reported by many pilots outranks one
+ * which has been reported only once.
+ */
+struct CloudHotspot {
+  /**
+   * The centre of the grid cell; this is the rtree key.
+   */
+  GeoPoint center;
+
+  /**
+   * Time of the most recent report.  All sums are decayed to this
+   * point in time.
+   */
+  std::chrono::steady_clock::time_point time;
+
+  /**
+   * The decayed number of reports.
+   */
+  double weight = 0;
+
+  /**
+   * Weighted sums of the reported values.
+   */
+  double bottom_latitude = 0, bottom_longitude = 0, bottom_altitude = 0;
+  double top_latitude = 0, top_longitude = 0, top_altitude = 0;
+  double lift = 0;
+
+  /**
+   * The client which has submitted all reports in this cell, or 0 if
+   * there were several.
+   */
+  uint64_t client_key = 0;
+
+  explicit CloudHotspot(GeoPoint _center):center(_center) {}
+
+  void Add(const CloudThermal &thermal);
+
+  /**
+   * Returns the decayed number of reports at the given time.
+   */
+  gcc_pure
+  double GetWeight(std::chrono::steady_clock::time_point now) const;
+
+  gcc_pure
+  double GetLift() const {
+    return lift / weight;
+  }
+
+  /**
+   * The ranking of this hotspot: average lift times the number of
+   * recent reports.
+   */
+  gcc_pure
+  double GetScore(std::chrono::steady_clock::time_point now) const {
+    return GetWeight(now) * GetLift();
+  }
+
+  gcc_pure
+  SkyLinesTracking::Thermal Pack() const;
+};
+
+/**
+ * A grid of #CloudHotspot instances.  Its size depends only on the
+ * area covered by thermal reports, not on the number of reports, and
+ * so does the cost of a query.
+ */
+class CloudHotspotContainer {
+  /**
+   * Maps the cell number to the #CloudHotspot.  Its nodes are stable,
+   * so the rtree can point to them.
+   */
+  typedef std::unordered_map<uint64_t, CloudHotspot> Map;
+
+  typedef std::pair<GeoPoint, CloudHotspot *> Value;
+  typedef boost::geometry::index::rtree<Value, boost::geometry::index::rstar<16>> Tree;
+
+  Map map;
+  Tree rtree;
+
+public:
+  void clear() {
+    rtree.clear();
+    map.clear();
+  }
+
+  bool empty() const {
+    return map.empty();
+  }
+
+  Map::size_type size() const {
+    return map.size();
+  }
+
+  /**
+   * Merge a thermal report into the hotspot of its cell.
+   */
+  void Add(const CloudThermal &thermal);
+
+  /**
+   * Remove all hotspots which have not been reported since the given
+   * time.
+   */
+  void Expire(std::chrono::steady_clock::time_point before);
+
+  /**
+   * Find the hotspots with the highest score within the given range.
+   *
+   * @param min_time ignore hotspots which have not been reported
+   * since
+   * @param exclude_key ignore hotspots which have been reported only
+   * by this client
+   * @param max_results the maximum number of results
+   * @return the hotspots, best first
+   */
+  gcc_pure
+  std::vector<const CloudHotspot *>
+  QueryTop(GeoPoint location, double range,
+           std::chrono::steady_clock::time_point now,
+           std::chrono::steady_clock::time_point min_time,
+           uint64_t exclude_key, unsigned max_results) const;
+
+private:
+  gcc_const
+  static uint64_t ToCell(GeoPoint location);
+
+  gcc_const
+  static GeoPoint GetCellCenter(uint64_t cell);
+};
+
+#endif
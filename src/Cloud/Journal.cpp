@@ -0,0 +1,270 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Journal.hpp"
+#include "Snapshot.hpp"
+#include "Data.hpp"
+#include "IO/FileOutputStream.hxx"
+#include "OS/FileMapping.hpp"
+#include "OS/FileUtil.hpp"
+#include "OS/ByteOrder.hpp"
+#include "OS/Error.hxx"
+#include "Util/CRC.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <string.h>
+#include <unistd.h>
+
+static constexpr uint32_t JOURNAL_MAGIC = 0x5753f611;
+static constexpr uint32_t JOURNAL_VERSION = 1;
+
+enum JournalEntryType : uint8_t {
+  CLIENT = 1,
+  THERMAL = 2,
+};
+
+struct JournalHeader {
+  uint32_t magic;
+  uint32_t version;
+};
+
+struct JournalEntry {
+  uint8_t type;
+  uint8_t reserved;
+
+  /**
+   * CRC16-CCITT of the payload, seeded with the #type.
+   */
+  uint16_t crc;
+};
+
+static constexpr size_t MAX_PAYLOAD =
+  std::max(sizeof(CloudClientRecord), sizeof(CloudThermalRecord));
+
+gcc_const
+static size_t
+GetPayloadSize(uint8_t type)
+{
+  switch (type) {
+  case CLIENT:
+    return sizeof(CloudClientRecord);
+
+  case THERMAL:
+    return sizeof(CloudThermalRecord);
+  }
+
+  return 0;
+}
+
+static void
+WriteHeader(FileOutputStream &file)
+{
+  JournalHeader header;
+  header.magic = ToBE32(JOURNAL_MAGIC);
+  header.version = ToBE32(JOURNAL_VERSION);
+  file.Write(&header, sizeof(header));
+}
+
+CloudJournal::CloudJournal(Path db_path)
+  :path(db_path + ".journal"), old_path(db_path + ".journal.old") {}
+
+CloudJournal::~CloudJournal()
+{
+  if (file)
+    file->Commit();
+}
+
+void
+CloudJournal::Open()
+{
+  ScopeLock protect(mutex);
+
+  /* with O_APPEND, FileOutputStream::Tell() does not know the file
+     size, so ask the file system */
+  const bool empty = !File::Exists(path) || File::GetSize(path) == 0;
+
+  file.reset(new FileOutputStream(path,
+                                  FileOutputStream::Mode::APPEND_OR_CREATE));
+  if (empty)
+    WriteHeader(*file);
+}
+
+void
+CloudJournal::Append(uint8_t type, const void *payload, size_t size)
+{
+  assert(size == GetPayloadSize(type));
+
+  struct {
+    JournalEntry entry;
+    uint8_t payload[MAX_PAYLOAD];
+  } buffer;
+
+  buffer.entry.type = type;
+  buffer.entry.reserved = 0;
+  buffer.entry.crc = ToBE16(UpdateCRC16CCITT(payload, size, type));
+  memcpy(buffer.payload, payload, size);
+
+  ScopeLock protect(mutex);
+  if (file)
+    file->Write(&buffer, sizeof(buffer.entry) + size);
+}
+
+void
+CloudJournal::Append(const CloudClientRecord &client)
+{
+  Append(CLIENT, &client, sizeof(client));
+}
+
+void
+CloudJournal::Append(const CloudThermalRecord &thermal)
+{
+  Append(THERMAL, &thermal, sizeof(thermal));
+}
+
+void
+CloudJournal::Rotate()
+{
+  ScopeLock protect(mutex);
+
+  if (File::Exists(old_path))
+    return;
+
+  if (file) {
+    file->Commit();
+    file.reset();
+  }
+
+  if (File::Exists(path) && !File::Rename(path, old_path))
+    throw std::runtime_error("Failed to rotate journal");
+
+  file.reset(new FileOutputStream(path,
+                                  FileOutputStream::Mode::APPEND_OR_CREATE));
+  WriteHeader(*file);
+}
+
+void
+CloudJournal::DeleteOld()
+{
+  File::Delete(old_path);
+}
+
+/**
+ * @return the size of the valid part of the file
+ */
+static size_t
+ReplayFile(const FileMapping &map, CloudData &data, uint64_t thermal_sequence)
+{
+  const auto *p = (const uint8_t *)map.data();
+  const auto *end = (const uint8_t *)map.end();
+
+  const auto &header = *(const JournalHeader *)p;
+  if (map.size() < sizeof(header) ||
+      FromBE32(header.magic) != JOURNAL_MAGIC)
+    throw std::runtime_error("Bad journal magic");
+
+  if (FromBE32(header.version) != JOURNAL_VERSION)
+    throw std::runtime_error("Bad journal version");
+
+  p += sizeof(header);
+
+  const CloudClock clock;
+
+  while (size_t(end - p) >= sizeof(JournalEntry)) {
+    const auto &entry = *(const JournalEntry *)p;
+    const size_t size = GetPayloadSize(entry.type);
+    const void *payload = &entry + 1;
+    if (size == 0 || size_t(end - p) < sizeof(entry) + size ||
+        FromBE16(entry.crc) != UpdateCRC16CCITT(payload, size, entry.type))
+      /* truncated by a crash; ignore the rest */
+      break;
+
+    p += sizeof(entry) + size;
+
+    switch (entry.type) {
+    case CLIENT:
+      data.clients.Restore(ImportClient(*(const CloudClientRecord *)payload,
+                                        clock));
+      break;
+
+    case THERMAL:
+      {
+        const auto &record = *(const CloudThermalRecord *)payload;
+        const uint64_t sequence = FromBE64(record.sequence);
+        if (sequence <= thermal_sequence)
+          /* already in the snapshot */
+          break;
+
+        auto thermal =
+          std::make_shared<CloudThermal>(ImportThermal(record, clock));
+
+        ScopeLock protect(data.thermals_mutex);
+        data.thermals.Insert(*thermal);
+        data.thermal_sequence = std::max(data.thermal_sequence, sequence);
+      }
+      break;
+    }
+  }
+
+  return p - (const uint8_t *)map.data();
+}
+
+static void
+ReplayFile(Path path, CloudData &data, uint64_t thermal_sequence)
+{
+  if (!File::Exists(path))
+    return;
+
+  size_t valid_size;
+
+  {
+    FileMapping map(path);
+    if (map.error())
+      /* empty file? */
+      return;
+
+    valid_size = ReplayFile(map, data, thermal_sequence);
+    if (valid_size == map.size())
+      return;
+  }
+
+  /* chop off the garbage left by a crash, or else new entries
+     appended after it would be ignored by the next replay */
+  if (truncate(path.c_str(), valid_size) < 0)
+    throw MakeErrno("Failed to truncate journal");
+}
+
+void
+CloudJournal::Replay(Path db_path, CloudData &data)
+{
+  uint64_t thermal_sequence;
+
+  {
+    ScopeLock protect(data.thermals_mutex);
+    thermal_sequence = data.thermal_sequence;
+  }
+
+  ReplayFile(db_path + ".journal.old", data, thermal_sequence);
+  ReplayFile(db_path + ".journal", data, thermal_sequence);
+}
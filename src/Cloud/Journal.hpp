@@ -0,0 +1,108 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_JOURNAL_HPP
+#define XCSOAR_CLOUD_JOURNAL_HPP
+
+#include "Thread/Mutex.hpp"
+#include "OS/Path.hpp"
+
+#include <memory>
+
+#include <stdint.h>
+
+struct CloudData;
+struct CloudClientRecord;
+struct CloudThermalRecord;
+class FileOutputStream;
+
+/**
+ * An append-only log of changes to #CloudData since the last
+ * #CloudSnapshot.  Each entry is written with one write() call and
+ * protected by a checksum, so a crash leaves at most one truncated
+ * entry at the end, which is ignored on replay.
+ *
+ * Client locations are not logged; they change with every fix and
+ * are only persisted by snapshots.
+ *
+ * When a snapshot is taken, the journal is rotated to a second file,
+ * which is deleted after the snapshot has been committed.  Replaying
+ * entries which are already contained in the snapshot is harmless:
+ * clients are only inserted if unknown, and thermals carry a sequence
+ * number.
+ */
+class CloudJournal {
+  const AllocatedPath path, old_path;
+
+  Mutex mutex;
+
+  std::unique_ptr<FileOutputStream> file;
+
+public:
+  /**
+   * @param db_path the path of the snapshot; the journal files are
+   * created next to it
+   */
+  explicit CloudJournal(Path db_path);
+  ~CloudJournal();
+
+  /**
+   * Open the journal for appending.  Throws on error.
+   */
+  void Open();
+
+  /**
+   * Append a new client.  Throws on error.
+   */
+  void Append(const CloudClientRecord &client);
+
+  /**
+   * Append a new thermal.  Throws on error.
+   */
+  void Append(const CloudThermalRecord &thermal);
+
+  /**
+   * Start a new journal file, to be called right before capturing a
+   * snapshot.  If the previous snapshot has failed, the old journal
+   * is still needed, and the current one is kept.  Throws on error.
+   */
+  void Rotate();
+
+  /**
+   * Delete the journal file which was rotated out by Rotate(), after
+   * the snapshot has been committed.
+   */
+  void DeleteOld();
+
+  /**
+   * Apply all journal entries to the given #CloudData, which has
+   * just been loaded from the snapshot at the given path.  Throws on
+   * error.
+   */
+  static void Replay(Path db_path, CloudData &data);
+
+private:
+  void Append(uint8_t type, const void *payload, size_t size);
+};
+
+#endif
@@ -0,0 +1,96 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "KeyIndex.hpp"
+
+CloudKeyIndex::CloudKeyIndex()
+  :slots(new Slot[CAPACITY])
+{
+  Clear();
+}
+
+void
+CloudKeyIndex::Clear()
+{
+  for (size_t i = 0; i < CAPACITY; ++i) {
+    slots[i].key.store(0, std::memory_order_relaxed);
+    slots[i].shard.store(NONE, std::memory_order_relaxed);
+  }
+
+  zero_shard.store(NONE, std::memory_order_release);
+}
+
+unsigned
+CloudKeyIndex::Lookup(uint64_t key) const
+{
+  if (key == 0)
+    return zero_shard.load(std::memory_order_acquire);
+
+  for (size_t i = Hash(key), n = 0; n < MAX_PROBE;
+       i = (i + 1) & (CAPACITY - 1), ++n) {
+    const Slot &slot = slots[i];
+    const uint64_t k = slot.key.load(std::memory_order_acquire);
+    if (k == key)
+      return slot.shard.load(std::memory_order_acquire);
+
+    if (k == 0)
+      /* empty slot: end of the probe sequence */
+      return NONE;
+  }
+
+  return NONE;
+}
+
+bool
+CloudKeyIndex::Set(uint64_t key, unsigned shard)
+{
+  if (key == 0) {
+    zero_shard.store(shard, std::memory_order_release);
+    return true;
+  }
+
+  for (size_t i = Hash(key), n = 0; n < MAX_PROBE;
+       i = (i + 1) & (CAPACITY - 1), ++n) {
+    Slot &slot = slots[i];
+    uint64_t k = slot.key.load(std::memory_order_acquire);
+
+    if (k == 0) {
+      if (shard == NONE)
+        /* not present; nothing to remove */
+        return true;
+
+      /* try to claim this empty slot; if another thread was faster,
+         "k" receives its key */
+      if (slot.key.compare_exchange_strong(k, key,
+                                           std::memory_order_acq_rel))
+        k = key;
+    }
+
+    if (k == key) {
+      slot.shard.store(shard, std::memory_order_release);
+      return true;
+    }
+  }
+
+  return shard == NONE;
+}
@@ -0,0 +1,100 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_KEY_INDEX_HPP
+#define XCSOAR_CLOUD_KEY_INDEX_HPP
+
+#include "Compiler.h"
+
+#include <atomic>
+#include <memory>
+
+#include <stdint.h>
+
+/**
+ * A lock-free hash table which maps a client's secret key to the
+ * number of the #CloudClientShards shard which currently owns the
+ * client.  Readers never block; writers use compare-and-swap to claim
+ * slots.
+ *
+ * Slots are never freed: removing a key only clears its shard number,
+ * so a client which comes back later reuses its old slot.  If the
+ * table overflows, Set() fails and the caller must fall back to
+ * scanning all shards.
+ */
+class CloudKeyIndex {
+public:
+  static constexpr unsigned NONE = 0xff;
+
+private:
+  static constexpr unsigned CAPACITY_BITS = 20;
+  static constexpr size_t CAPACITY = size_t(1) << CAPACITY_BITS;
+  static constexpr size_t MAX_PROBE = 64;
+
+  /**
+   * A slot with key==0 is empty.  Since 0 is a valid key, that one
+   * is stored separately in #zero_shard.
+   */
+  struct Slot {
+    std::atomic<uint64_t> key;
+    std::atomic<uint8_t> shard;
+  };
+
+  std::unique_ptr<Slot[]> slots;
+
+  std::atomic<uint8_t> zero_shard;
+
+public:
+  CloudKeyIndex();
+
+  CloudKeyIndex(const CloudKeyIndex &) = delete;
+  CloudKeyIndex &operator=(const CloudKeyIndex &) = delete;
+
+  /**
+   * Forget all keys.  Not thread-safe.
+   */
+  void Clear();
+
+  /**
+   * @return the shard number or #NONE if the key is unknown
+   */
+  gcc_pure
+  unsigned Lookup(uint64_t key) const;
+
+  /**
+   * Assign a shard to the given key (may be #NONE to mark the client
+   * as removed).
+   *
+   * @return false if the table is full
+   */
+  bool Set(uint64_t key, unsigned shard);
+
+private:
+  static constexpr size_t Hash(uint64_t key) {
+    /* Fibonacci hashing; keys are usually random, but we don't
+       trust clients to choose them well */
+    return size_t((key * 0x9e3779b97f4a7c15ull) >> (64 - CAPACITY_BITS));
+  }
+};
+
+#endif
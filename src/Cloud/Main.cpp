@@ -24,12 +24,14 @@ Copyright_License {
 #include "Data.hpp"
 #include "Dump.hpp"
 #include "Sender.hpp"
-#include "Serialiser.hpp"
+#include "Batch.hpp"
+#include "Snapshot.hpp"
+#include "Journal.hpp"
 #include "Tracking/SkyLines/Server.hpp"
 #include "Tracking/SkyLines/Protocol.hpp"
+#include "Thread/Thread.hpp"
 #include "OS/ByteOrder.hpp"
-#include "IO/FileOutputStream.hxx"
-#include "IO/FileReader.hxx"
+#include "Util/NumberParser.hpp"
 #include "Util/PrintException.hxx"
 #include "Util/Exception.hxx"
 #include "Compiler.h"
@@ -41,6 +43,9 @@ Copyright_License {
 #include <boost/asio/steady_timer.hpp>
 
 #include <array>
+#include <vector>
+#include <atomic>
+#include <memory>
 #include <iostream>
 #include <iomanip>
 
@@ -53,65 +58,88 @@ static constexpr std::chrono::steady_clock::duration MAX_THERMAL_AGE = std::chro
 
 static constexpr std::chrono::steady_clock::duration REQUEST_EXPIRY = std::chrono::minutes(5);
 
+/**
+ * The maximum number of hotspots in one thermal response.
+ */
+static constexpr unsigned MAX_HOTSPOTS = 64;
+
+static constexpr unsigned MAX_THREADS = 64;
+
+/**
+ * The default interval for collecting traffic updates before sending
+ * them in one datagram per recipient.
+ */
+static constexpr unsigned DEFAULT_BATCH_MS = 250;
+
 using std::cout;
 using std::cerr;
 using std::endl;
 
-class CloudServer final
-  : public SkyLinesTracking::Server,
-#ifdef __linux__
-    SignalListener,
-#endif
-    CloudData
-{
-  const AllocatedPath db_path;
+/**
+ * Serialises access to std::cout from several receiver threads.
+ */
+static Mutex cout_mutex;
 
-  boost::asio::steady_timer save_timer, expire_timer;
+/**
+ * Receives datagrams on one socket and handles them.  There is one
+ * instance per receiver thread; all of them share one #CloudData
+ * instance.
+ */
+class CloudServer final : public SkyLinesTracking::Server {
+  CloudData &data;
 
-public:
-  CloudServer(AllocatedPath &&_db_path, boost::asio::io_service &io_service,
-              boost::asio::ip::udp::endpoint endpoint)
-    :SkyLinesTracking::Server(io_service, endpoint),
-#ifdef __linux__
-    SignalListener(io_service),
-#endif
-    db_path(std::move(_db_path)),
-    save_timer(io_service),
-    expire_timer(io_service)
-  {
-#ifdef __linux__
-    SignalListener::Create(SIGTERM, SIGINT, SIGHUP, SIGUSR1);
-#endif
+  CloudJournal &journal;
 
-    ScheduleSave();
-  }
+  /**
+   * The io_service of the main thread, to be stopped on fatal
+   * errors.
+   */
+  boost::asio::io_service &main_io_service;
 
-  using SkyLinesTracking::Server::get_io_service;
+  /**
+   * Traffic updates are collected for this duration before they are
+   * sent.  Zero disables batching.
+   */
+  const std::chrono::steady_clock::duration batch_interval;
 
-  void Load();
-  void Save();
+  TrafficBatch traffic_batch;
 
-private:
-  void ScheduleSave() {
-    save_timer.expires_from_now(std::chrono::minutes(1));
-    save_timer.async_wait([this](const boost::system::error_code &ec){
-        if (ec)
-          return;
+  boost::asio::steady_timer batch_timer;
 
-        Save();
-        ScheduleSave();
-      });
+public:
+  CloudServer(CloudData &_data, CloudJournal &_journal,
+              boost::asio::io_service &_main_io_service,
+              boost::asio::io_service &io_service,
+              boost::asio::ip::udp::endpoint endpoint,
+              bool reuse_port,
+              std::chrono::steady_clock::duration _batch_interval)
+    :SkyLinesTracking::Server(io_service, endpoint, reuse_port),
+     data(_data), journal(_journal), main_io_service(_main_io_service),
+     batch_interval(_batch_interval),
+     batch_timer(io_service) {}
+
+private:
+  /**
+   * Append a record to the journal.  Errors are logged, but are not
+   * fatal: the next snapshot will contain the record.
+   */
+  template<typename R>
+  void AppendToJournal(const R &record) {
+    try {
+      journal.Append(record);
+    } catch (const std::exception &e) {
+      ScopeLock protect(cout_mutex);
+      cerr << "Failed to write journal: " << GetFullMessage(e) << endl;
+    }
   }
 
-  void ScheduleExpire() {
-    expire_timer.expires_from_now(std::chrono::minutes(5));
-    expire_timer.async_wait([this](const boost::system::error_code &ec){
+  void ScheduleBatchFlush() {
+    batch_timer.expires_from_now(batch_interval);
+    batch_timer.async_wait([this](const boost::system::error_code &ec){
         if (ec)
           return;
 
-        clients.Expire(expire_timer.expires_at() - std::chrono::minutes(10));
-        if (!clients.empty())
-          ScheduleExpire();
+        traffic_batch.Flush(*this);
       });
   }
 
@@ -143,14 +171,187 @@ protected:
 
   void OnSendError(const boost::asio::ip::udp::endpoint &endpoint,
                    std::exception_ptr e) override {
+    ScopeLock protect(cout_mutex);
     cerr << "Failed to send to " << endpoint
          << ": " << GetFullMessage(e)
          << endl;
   }
 
   void OnError(std::exception_ptr e) override {
-    cerr << GetFullMessage(e) << endl;
-    get_io_service().stop();
+    {
+      ScopeLock protect(cout_mutex);
+      cerr << GetFullMessage(e) << endl;
+    }
+
+    main_io_service.stop();
+  }
+};
+
+/**
+ * A thread which runs one additional #CloudServer instance with its
+ * own io_service.
+ */
+class CloudServerThread final : Thread {
+  boost::asio::io_service io_service;
+  CloudServer server;
+
+public:
+  CloudServerThread(CloudData &data, CloudJournal &journal,
+                    boost::asio::io_service &main_io_service,
+                    boost::asio::ip::udp::endpoint endpoint,
+                    std::chrono::steady_clock::duration batch_interval)
+    :Thread("CloudServer"),
+     server(data, journal, main_io_service, io_service, endpoint, true,
+            batch_interval) {
+    if (!Start())
+      throw std::runtime_error("Failed to start thread");
+  }
+
+  ~CloudServerThread() {
+    io_service.stop();
+    Join();
+  }
+
+protected:
+  /* virtual methods from class Thread */
+  void Run() override {
+    io_service.run();
+  }
+};
+
+/**
+ * Writes a #CloudSnapshot to disk, so the main thread does not block
+ * on file I/O.
+ */
+class CloudSnapshotThread final : public Thread {
+  const AllocatedPath path;
+
+  std::exception_ptr error;
+
+  std::atomic<bool> finished;
+
+public:
+  CloudSnapshot snapshot;
+
+  explicit CloudSnapshotThread(Path _path)
+    :Thread("CloudSnapshot"), path(_path), finished(false) {}
+
+  bool IsFinished() const {
+    return finished.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Wait for the thread to finish.  Rethrows the exception thrown by
+   * CloudSnapshot::Save().
+   */
+  void Finish() {
+    Join();
+
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+protected:
+  /* virtual methods from class Thread */
+  void Run() override {
+    try {
+      snapshot.Save(path);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    finished.store(true, std::memory_order_release);
+  }
+};
+
+/**
+ * The main thread's part of the server: owns the #CloudData, loads
+ * and saves it and expires old clients periodically.
+ */
+class CloudDaemon final
+#ifdef __linux__
+  : SignalListener
+#endif
+{
+  boost::asio::io_service &io_service;
+
+  const AllocatedPath db_path;
+
+  boost::asio::steady_timer save_timer, expire_timer;
+
+  /**
+   * The snapshot which is currently being written, or nullptr.
+   */
+  std::unique_ptr<CloudSnapshotThread> save_thread;
+
+public:
+  CloudData data;
+
+  CloudJournal journal;
+
+  CloudDaemon(AllocatedPath &&_db_path, boost::asio::io_service &_io_service)
+    :
+#ifdef __linux__
+    SignalListener(_io_service),
+#endif
+    io_service(_io_service),
+    db_path(std::move(_db_path)),
+    save_timer(io_service),
+    expire_timer(io_service),
+    journal(db_path)
+  {
+#ifdef __linux__
+    SignalListener::Create(SIGTERM, SIGINT, SIGHUP, SIGUSR1);
+#endif
+
+    ScheduleSave();
+    ScheduleExpire();
+  }
+
+  void Load();
+
+  /**
+   * Write a snapshot and wait for it to be committed.
+   */
+  void Save();
+
+private:
+  /**
+   * Capture a snapshot and write it in a #CloudSnapshotThread.
+   */
+  void StartSave();
+
+  /**
+   * Wait for the #CloudSnapshotThread and clean up after it.
+   */
+  void FinishSave();
+
+  void ScheduleSave() {
+    save_timer.expires_from_now(std::chrono::minutes(1));
+    save_timer.async_wait([this](const boost::system::error_code &ec){
+        if (ec)
+          return;
+
+        StartSave();
+        ScheduleSave();
+      });
+  }
+
+  void ScheduleExpire() {
+    expire_timer.expires_from_now(std::chrono::minutes(5));
+    expire_timer.async_wait([this](const boost::system::error_code &ec){
+        if (ec)
+          return;
+
+        data.clients.Expire(expire_timer.expires_at() - std::chrono::minutes(10));
+
+        {
+          ScopeLock protect(data.thermals_mutex);
+          data.thermals.Expire(expire_timer.expires_at() - MAX_THERMAL_AGE);
+        }
+
+        ScheduleExpire();
+      });
   }
 
 #ifdef __linux__
@@ -158,15 +359,18 @@ protected:
   void OnSignal(int signo) override {
     switch (signo) {
     case SIGHUP:
-      Save();
+      StartSave();
       break;
 
     case SIGUSR1:
-      DumpClients();
+      {
+        ScopeLock protect(cout_mutex);
+        data.DumpClients();
+      }
       break;
 
     default:
-      get_io_service().stop();
+      io_service.stop();
       break;
     }
   }
@@ -180,46 +384,82 @@ CloudServer::OnFix(const Client &c,
 {
   (void)time_of_day; // TODO: use this parameter
 
-  CloudClient *client;
-  if (location.IsValid()) {
-    bool was_empty = clients.empty();
+  if (!location.IsValid()) {
+    data.clients.Visit(c.key, [&c](CloudClient &client){
+        client.Refresh(c.endpoint);
+      });
+
+    /* without a location, there is nothing to send to other
+       clients */
+    return;
+  }
 
-    client = &clients.Make(c.endpoint, c.key, location, altitude);
+  bool created;
+  const unsigned id = data.clients.Make(c.endpoint, c.key, location, altitude,
+                                        &created);
 
+  if (created) {
+    CloudClientRecord record;
+    if (data.clients.Visit(c.key, [&record](const CloudClient &client){
+          record = ExportClient(client, CloudClock());
+        }))
+      AppendToJournal(record);
+  }
+
+  {
+    ScopeLock protect(cout_mutex);
     cout << "FIX\t"
-         << client->endpoint << '\t'
-         << std::hex << client->key << std::dec << '\t'
-         << client->id << '\t'
-         << client->location << '\t'
-         << client->altitude << 'm'
+         << c.endpoint << '\t'
+         << std::hex << c.key << std::dec << '\t'
+         << id << '\t'
+         << location << '\t'
+         << altitude << 'm'
          << endl;
-
-    if (was_empty)
-      ScheduleExpire();
-  } else {
-    client = clients.Find(c.key);
-    if (client != nullptr)
-      clients.Refresh(*client, c.endpoint);
   }
 
-  /* send this new traffic location to all interested clients
-     immediately */
+  /* collect all interested clients first, because we must not send
+     while holding the shard locks */
+  std::vector<Client> recipients;
+
   const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(location, TRAFFIC_RANGE)) {
-    if (i->key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
-
-    if (now > i->wants_traffic)
-      /* not interested (anymore) */
-      continue;
-
-    TrafficResponseSender s(*this, {i->endpoint, i->key});
-    s.Add(client->id, 0, //TODO: time?
-          client->location, client->altitude);
-    s.Flush();
+  data.clients.VisitWithinRange(location, TRAFFIC_RANGE,
+                                [&c, now, &recipients](const CloudClient &i){
+      if (i.key == c.key)
+        /* ignore this client's own submissions - he knows them
+           already */
+        return;
+
+      if (now > i.wants_traffic)
+        /* not interested (anymore) */
+        return;
+
+      recipients.push_back({i.endpoint, i.key});
+    });
+
+  if (batch_interval <= std::chrono::steady_clock::duration::zero()) {
+    /* send this new traffic location to all interested clients
+       immediately */
+    for (const auto &i : recipients) {
+      TrafficResponseSender s(*this, i);
+      s.Add(id, 0, //TODO: time?
+            location, altitude);
+      s.Flush();
+    }
+
+    return;
   }
+
+  /* queue the update; all updates for one recipient will be sent in
+     one datagram when the batch timer expires */
+  if (recipients.empty())
+    return;
+
+  if (traffic_batch.empty())
+    ScheduleBatchFlush();
+
+  for (const auto &i : recipients)
+    traffic_batch.Add(i, id, 0, //TODO: time?
+                      location, altitude);
 }
 
 void
@@ -229,36 +469,38 @@ CloudServer::OnTrafficRequest(const Client &c, bool near)
     /* "near" is the only selection flag we know */
     return;
 
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  const auto now = std::chrono::steady_clock::now();
+
+  GeoPoint location;
+  if (!data.clients.Visit(c.key, [now, &location](CloudClient &client){
+        client.wants_traffic = now + REQUEST_EXPIRY;
+        location = client.location;
+      }))
     /* we don't send our data to clients who didn't sent anything to
        us yet */
     return;
 
-  const auto now = std::chrono::steady_clock::now();
-
-  client->wants_traffic = now + REQUEST_EXPIRY;
-
   const auto min_stamp = now - MAX_TRAFFIC_AGE;
 
   TrafficResponseSender s(*this, c);
 
   unsigned n = 0;
-  for (const auto &traffic : clients.QueryWithinRange(client->location,
-                                                      TRAFFIC_RANGE)) {
-    if (traffic.get() == client)
-      continue;
+  data.clients.VisitWithinRange(location, TRAFFIC_RANGE,
+                                [&c, min_stamp, &s, &n](const CloudClient &traffic){
+      if (traffic.key == c.key)
+        return;
 
-    if (traffic->stamp < min_stamp)
-      /* don't send stale traffic, it's probably not there anymore */
-      continue;
+      if (traffic.stamp < min_stamp)
+        /* don't send stale traffic, it's probably not there anymore */
+        return;
 
-    s.Add(traffic->id, 0, //TODO: time?
-          traffic->location, traffic->altitude);
+      if (n > 64)
+        return;
 
-    if (++n > 64)
-      break;
-  }
+      s.Add(traffic.id, 0, //TODO: time?
+            traffic.location, traffic.altitude);
+      ++n;
+    });
 
   s.Flush();
 }
@@ -271,16 +513,19 @@ CloudServer::OnWaveSubmit(const Client &c,
                           int top_altitude,
                           double lift)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  unsigned id;
+  if (!data.clients.Visit(c.key, [&id](const CloudClient &client){
+        id = client.id;
+      }))
     /* we don't trust the client if he didn't sent anything to us
        yet */
     return;
 
+  ScopeLock protect(cout_mutex);
   cout << "WAVE\t"
-       << client->endpoint << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
+       << c.endpoint << '\t'
+       << std::hex << c.key << std::dec << '\t'
+       << id << '\t'
        << a << '\t'
        << b << '\t'
        << bottom_altitude << '-' << top_altitude << "m\t"
@@ -297,42 +542,63 @@ CloudServer::OnThermalSubmit(const Client &c,
                              int top_altitude,
                              double lift)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  unsigned id;
+  if (!data.clients.Visit(c.key, [&id](const CloudClient &client){
+        id = client.id;
+      }))
     /* we don't trust the client if he didn't sent anything to us
        yet */
     return;
 
-  cout << "THERMAL\t"
-       << client->endpoint << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << top_location << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
+  {
+    ScopeLock protect(cout_mutex);
+    cout << "THERMAL\t"
+         << c.endpoint << '\t'
+         << std::hex << c.key << std::dec << '\t'
+         << id << '\t'
+         << top_location << '\t'
+         << bottom_altitude << '-' << top_altitude << "m\t"
+         << lift << "m/s"
+         << endl;
+  }
 
-  const auto &thermal =
-    thermals.Make(c.key,
-                  AGeoPoint(bottom_location, bottom_altitude),
-                  AGeoPoint(top_location, top_altitude),
-                  lift);
+  SkyLinesTracking::Thermal packed;
+  CloudThermalRecord record;
+
+  {
+    ScopeLock protect(data.thermals_mutex);
+    const auto &thermal =
+      data.thermals.Make(c.key,
+                         AGeoPoint(bottom_location, bottom_altitude),
+                         AGeoPoint(top_location, top_altitude),
+                         lift);
+    packed = thermal.Pack();
+    record = ExportThermal(thermal, ++data.thermal_sequence, CloudClock());
+  }
+
+  AppendToJournal(record);
+
+  std::vector<Client> recipients;
 
-  /* send this new thermal to all interested clients immediately */
   const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(bottom_location,
-                                                THERMAL_RANGE)) {
-    if (i->key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
-
-    if (now > i->wants_thermals)
-      /* not interested (anymore) */
-      continue;
-
-    ThermalResponseSender s(*this, {i->endpoint, i->key});
-    s.Add(thermal.Pack());
+  data.clients.VisitWithinRange(bottom_location, THERMAL_RANGE,
+                                [&c, now, &recipients](const CloudClient &i){
+      if (i.key == c.key)
+        /* ignore this client's own submissions - he knows them
+           already */
+        return;
+
+      if (now > i.wants_thermals)
+        /* not interested (anymore) */
+        return;
+
+      recipients.push_back({i.endpoint, i.key});
+    });
+
+  /* send this new thermal to all interested clients immediately */
+  for (const auto &i : recipients) {
+    ThermalResponseSender s(*this, i);
+    s.Add(packed);
     s.Flush();
   }
 }
@@ -340,92 +606,170 @@ CloudServer::OnThermalSubmit(const Client &c,
 void
 CloudServer::OnThermalRequest(const Client &c)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  const auto now = std::chrono::steady_clock::now();
+
+  GeoPoint location;
+  if (!data.clients.Visit(c.key, [now, &location](CloudClient &client){
+        client.wants_thermals = now + REQUEST_EXPIRY;
+        location = client.location;
+      }))
     /* we don't send our data to clients who didn't sent anything to
        us yet */
     return;
 
-  const auto now = std::chrono::steady_clock::now();
-
-  client->wants_thermals = now + REQUEST_EXPIRY;
-
   const auto min_time = now - MAX_THERMAL_AGE;
 
   ThermalResponseSender s(*this, c);
 
-  unsigned n = 0;
-  for (const auto &thermal : thermals.QueryWithinRange(client->location,
-                                                       THERMAL_RANGE)) {
-    if (thermal->client_key == c.key)
-      /* ignore this client's own submissions - he knows them
-         already */
-      continue;
+  ScopeLock protect(data.thermals_mutex);
 
-    if (thermal->time < min_time)
-      /* don't send old thermals, they're useless */
-      continue;
+  /* send only the best hotspots; ignore the ones submitted only by
+     this client - he knows them already; and don't send old
+     thermals, they're useless */
+  for (const auto *hotspot :
+         data.thermals.GetHotspots().QueryTop(location, THERMAL_RANGE,
+                                              now, min_time, c.key,
+                                              MAX_HOTSPOTS))
+    s.Add(hotspot->Pack());
 
-    s.Add(thermal->Pack());
+  s.Flush();
+}
 
-    if (++n > 256)
-      break;
+void
+CloudDaemon::Load()
+{
+  try {
+    data.Load(db_path);
+  } catch (const std::runtime_error &e) {
+    cerr << "Failed to load database" << endl;
+    PrintException(e);
   }
 
-  s.Flush();
+  journal.Open();
 }
 
 void
-CloudServer::Load()
+CloudDaemon::FinishSave()
 {
-  FileReader fr(db_path);
-  Deserialiser s(fr);
-  CloudData::Load(s);
+  try {
+    save_thread->Finish();
+    journal.DeleteOld();
+  } catch (const std::exception &e) {
+    /* the old journal is kept, and will be replayed together with
+       the previous snapshot */
+    ScopeLock protect(cout_mutex);
+    cerr << "Failed to save data: " << GetFullMessage(e) << endl;
+  }
+
+  save_thread.reset();
 }
 
 void
-CloudServer::Save()
+CloudDaemon::StartSave()
 {
-  cout << "Saving data to " << db_path.c_str() << endl;
+  if (save_thread) {
+    if (!save_thread->IsFinished())
+      /* still busy with the previous snapshot */
+      return;
 
-  FileOutputStream fos(db_path);
+    FinishSave();
+  }
 
   {
-    Serialiser s(fos);
-    CloudData::Save(s);
-    s.Flush();
+    ScopeLock protect(cout_mutex);
+    cout << "Saving data to " << db_path.c_str() << endl;
   }
 
-  fos.Commit();
+  try {
+    /* rotate first: all entries in the new journal are newer than
+       the snapshot */
+    journal.Rotate();
+  } catch (const std::exception &e) {
+    ScopeLock protect(cout_mutex);
+    cerr << "Failed to rotate journal: " << GetFullMessage(e) << endl;
+    return;
+  }
+
+  save_thread.reset(new CloudSnapshotThread(db_path));
+  save_thread->snapshot.Capture(data);
+
+  if (!save_thread->Start()) {
+    save_thread.reset();
+    ScopeLock protect(cout_mutex);
+    cerr << "Failed to start thread" << endl;
+  }
+}
+
+void
+CloudDaemon::Save()
+{
+  if (save_thread)
+    FinishSave();
+
+  StartSave();
+
+  if (save_thread)
+    FinishSave();
 }
 
 int
 main(int argc, char **argv)
 try {
-  if (argc != 2) {
-    cerr << "Usage: " << argv[0] << " DBPATH" << endl;
+  if (argc < 2 || argc > 4) {
+    cerr << "Usage: " << argv[0] << " DBPATH [THREADS [BATCH_MS]]" << endl;
     return EXIT_FAILURE;
   }
 
   const Path db_path(argv[1]);
 
+  unsigned n_threads = 1;
+  if (argc > 2) {
+    char *endptr;
+    n_threads = ParseUnsigned(argv[2], &endptr);
+    if (*endptr != 0 || n_threads < 1 || n_threads > MAX_THREADS) {
+      cerr << "Invalid number of threads: " << argv[2] << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  unsigned batch_ms = DEFAULT_BATCH_MS;
+  if (argc > 3) {
+    char *endptr;
+    batch_ms = ParseUnsigned(argv[3], &endptr);
+    if (*endptr != 0) {
+      cerr << "Invalid batch interval: " << argv[3] << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  const auto batch_interval = std::chrono::milliseconds(batch_ms);
+
   boost::asio::io_service io_service;
 
   const boost::asio::ip::udp::endpoint endpoint(boost::asio::ip::udp::v4(),
                                                 CloudServer::GetDefaultPort());
 
-  CloudServer server(db_path, io_service, endpoint);
+  CloudDaemon daemon(db_path, io_service);
+  daemon.Load();
 
-  try {
-    server.Load();
-  } catch (const std::runtime_error &e) {
-    cerr << "Failed to load database" << endl;
-    PrintException(e);
-  }
+  /* the main thread receives, too; with more than one thread, all
+     sockets are bound with SO_REUSEPORT, and the kernel distributes
+     clients among them */
+  CloudServer server(daemon.data, daemon.journal, io_service, io_service,
+                     endpoint, n_threads > 1, batch_interval);
+
+  std::vector<std::unique_ptr<CloudServerThread>> threads;
+  for (unsigned i = 1; i < n_threads; ++i)
+    threads.emplace_back(new CloudServerThread(daemon.data, daemon.journal,
+                                               io_service, endpoint,
+                                               batch_interval));
 
   io_service.run();
 
-  server.Save();
+  /* stop and join all receiver threads before saving */
+  threads.clear();
+
+  daemon.Save();
 
   return EXIT_SUCCESS;
 } catch (const std::exception &exception) {
@@ -0,0 +1,258 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Shards.hpp"
+#include "Serialiser.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+
+#include <algorithm>
+
+#include <math.h>
+
+CloudClientShards::CloudClientShards()
+  :shards(new Shard[N_SHARDS]), index_overflow(false), next_id(1) {}
+
+CloudClientShards::~CloudClientShards() = default;
+
+unsigned
+CloudClientShards::LocationToShard(GeoPoint location)
+{
+  return LongitudeToShard((int)floor(location.longitude.Degrees()));
+}
+
+CloudClientShards::ShardMask
+CloudClientShards::GetShardMask(GeoPoint location, double range)
+{
+  const auto box = BoostRangeBox(location, range);
+
+  int west = (int)floor(box.min_corner().longitude.Degrees());
+  int east = (int)floor(box.max_corner().longitude.Degrees());
+  if (east < west)
+    /* crossing the date line */
+    east += 360;
+
+  if (unsigned(east - west) + 1 >= N_SHARDS)
+    return ~ShardMask(0);
+
+  ShardMask mask = 0;
+  for (int i = west; i <= east; ++i)
+    mask |= ShardMask(1) << LongitudeToShard(i);
+  return mask;
+}
+
+void
+CloudClientShards::clear()
+{
+  for (unsigned i = 0; i < N_SHARDS; ++i) {
+    Shard &shard = shards[i];
+    ScopeLock protect(shard.mutex);
+    shard.clients.clear();
+  }
+
+  index.Clear();
+  index_overflow = false;
+}
+
+bool
+CloudClientShards::empty() const
+{
+  for (unsigned i = 0; i < N_SHARDS; ++i) {
+    const Shard &shard = shards[i];
+    ScopeLock protect(shard.mutex);
+    if (!shard.clients.empty())
+      return false;
+  }
+
+  return true;
+}
+
+unsigned
+CloudClientShards::FindShard(uint64_t key) const
+{
+  const unsigned i = index.Lookup(key);
+  if (i != CloudKeyIndex::NONE ||
+      !index_overflow.load(std::memory_order_relaxed))
+    return i;
+
+  for (unsigned j = 0; j < N_SHARDS; ++j) {
+    Shard &shard = shards[j];
+    ScopeLock protect(shard.mutex);
+    if (shard.clients.Find(key) != nullptr)
+      return j;
+  }
+
+  return CloudKeyIndex::NONE;
+}
+
+void
+CloudClientShards::SetIndex(uint64_t key, unsigned shard)
+{
+  if (!index.Set(key, shard))
+    index_overflow = true;
+}
+
+unsigned
+CloudClientShards::Make(const boost::asio::ip::udp::endpoint &endpoint,
+                        uint64_t key,
+                        const GeoPoint &location, int altitude,
+                        bool *created_r)
+{
+  if (created_r != nullptr)
+    *created_r = false;
+
+  const unsigned new_shard = LocationToShard(location);
+
+  if (FindShard(key) == new_shard) {
+    /* fast path: the client exists and stays in its shard */
+    Shard &shard = shards[new_shard];
+    ScopeLock protect(shard.mutex);
+
+    auto *client = shard.clients.Find(key);
+    if (client != nullptr) {
+      shard.clients.Refresh(*client, endpoint, location, altitude);
+      return client->id;
+    }
+
+    /* it has just been moved or expired by another thread; fall
+       back to the slow path */
+  }
+
+  ScopeLock protect_move(move_mutex);
+
+  while (true) {
+    const unsigned old_shard = FindShard(key);
+
+    if (old_shard == CloudKeyIndex::NONE) {
+      Shard &shard = shards[new_shard];
+      ScopeLock protect(shard.mutex);
+
+      auto ptr = std::make_shared<CloudClient>(endpoint, key, next_id++,
+                                               location, altitude);
+      shard.clients.Insert(*ptr);
+      SetIndex(key, new_shard);
+
+      if (created_r != nullptr)
+        *created_r = true;
+      return ptr->id;
+    }
+
+    if (old_shard == new_shard) {
+      Shard &shard = shards[new_shard];
+      ScopeLock protect(shard.mutex);
+
+      auto *client = shard.clients.Find(key);
+      if (client == nullptr)
+        /* expired meanwhile; look it up again */
+        continue;
+
+      shard.clients.Refresh(*client, endpoint, location, altitude);
+      return client->id;
+    }
+
+    /* the client has crossed a shard border: lock both shards (in
+       ascending order to avoid deadlocks) and move it */
+
+    Shard &from = shards[old_shard], &to = shards[new_shard];
+    ScopeLock protect1(shards[std::min(old_shard, new_shard)].mutex);
+    ScopeLock protect2(shards[std::max(old_shard, new_shard)].mutex);
+
+    auto *client = from.clients.Find(key);
+    if (client == nullptr)
+      /* expired meanwhile; look it up again instead of creating a
+         duplicate here */
+      continue;
+
+    CloudClientPtr ptr = client->shared_from_this();
+    from.clients.Remove(*client);
+
+    ptr->Refresh(endpoint);
+    ptr->location = location;
+    ptr->altitude = altitude;
+
+    to.clients.Insert(*ptr);
+    SetIndex(key, new_shard);
+    return ptr->id;
+  }
+}
+
+void
+CloudClientShards::Restore(CloudClient &&_client)
+{
+  unsigned expected = next_id;
+  while (expected <= _client.id &&
+         !next_id.compare_exchange_weak(expected, _client.id + 1)) {}
+
+  ScopeLock protect_move(move_mutex);
+
+  if (FindShard(_client.key) != CloudKeyIndex::NONE)
+    /* already known; the in-memory copy is at least as recent */
+    return;
+
+  const unsigned i = LocationToShard(_client.location);
+  Shard &shard = shards[i];
+  ScopeLock protect(shard.mutex);
+
+  if (shard.clients.Find(_client.key) != nullptr)
+    return;
+
+  auto client = std::make_shared<CloudClient>(std::move(_client));
+  shard.clients.Insert(*client);
+  SetIndex(client->key, i);
+}
+
+void
+CloudClientShards::Expire(std::chrono::steady_clock::time_point before)
+{
+  for (unsigned i = 0; i < N_SHARDS; ++i) {
+    Shard &shard = shards[i];
+    ScopeLock protect(shard.mutex);
+    shard.clients.Expire(before, [this](const CloudClient &client){
+        SetIndex(client.key, CloudKeyIndex::NONE);
+      });
+  }
+}
+
+void
+CloudClientShards::Save(Serialiser &s) const
+{
+  s.Write32(next_id);
+
+  ForEach([&s](const CloudClient &client){
+      s.Write8(1);
+      client.Save(s);
+    });
+
+  s.Write8(0);
+  s.Write8(0);
+}
+
+void
+CloudClientShards::Load(Deserialiser &s)
+{
+  next_id = s.Read32();
+
+  while (s.Read8() != 0)
+    Restore(CloudClient::Load(s));
+
+  s.Read8();
+}
@@ -0,0 +1,223 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_SHARDS_HPP
+#define XCSOAR_CLOUD_SHARDS_HPP
+
+#include "Client.hpp"
+#include "KeyIndex.hpp"
+#include "Thread/Mutex.hpp"
+
+#include <atomic>
+#include <memory>
+
+/**
+ * A thread-safe wrapper for several #CloudClientContainer instances.
+ * Clients are partitioned into geographic shards (one-degree
+ * longitude stripes, distributed round-robin), each protected by its
+ * own #Mutex, so receiver threads handling clients in different areas
+ * do not contend.  A lock-free #CloudKeyIndex finds the shard which
+ * owns a given key.
+ *
+ * Because the shard locks are held while a visitor runs, visitors
+ * must not call back into this object.
+ */
+class CloudClientShards {
+public:
+  static constexpr unsigned N_SHARDS = 16;
+
+private:
+  typedef uint32_t ShardMask;
+  static_assert(N_SHARDS <= sizeof(ShardMask) * 8, "Mask too small");
+
+  struct Shard {
+    mutable Mutex mutex;
+    CloudClientContainer clients;
+  };
+
+  /**
+   * Allocated on the heap because each #CloudClientContainer is
+   * rather large.
+   */
+  const std::unique_ptr<Shard[]> shards;
+
+  CloudKeyIndex index;
+
+  /**
+   * Set when #index could not store a key.  From then on, lookups
+   * which miss the index need to scan all shards.
+   */
+  std::atomic<bool> index_overflow;
+
+  /**
+   * Serialises the creation of clients and moves between shards, so
+   * the result of FindShard() stays valid for the caller.  Only
+   * Expire() may still remove the client meanwhile.  Lock order:
+   * this one before any shard mutex.
+   */
+  Mutex move_mutex;
+
+  /**
+   * The public id assigned to the next new #CloudClient.
+   */
+  std::atomic<unsigned> next_id;
+
+public:
+  CloudClientShards();
+  ~CloudClientShards();
+
+  gcc_const
+  static unsigned LongitudeToShard(int degrees) {
+    return unsigned(((degrees % 360) + 360) % 360) % N_SHARDS;
+  }
+
+  gcc_pure
+  static unsigned LocationToShard(GeoPoint location);
+
+  void clear();
+
+  gcc_pure
+  bool empty() const;
+
+  unsigned GetNextId() const {
+    return next_id;
+  }
+
+  void SetNextId(unsigned id) {
+    next_id = id;
+  }
+
+  /**
+   * Insert a client loaded from disk, unless a client with the same
+   * key exists already.  The id counter is advanced past the
+   * client's id.
+   */
+  void Restore(CloudClient &&client);
+
+  /**
+   * Create a new #CloudClient, or refresh the existing one, possibly
+   * moving it to another shard.
+   *
+   * @param created_r if not nullptr, this is set to true if a new
+   * client was created
+   * @return the client's public id
+   */
+  unsigned Make(const boost::asio::ip::udp::endpoint &endpoint,
+                uint64_t key, const GeoPoint &location, int altitude,
+                bool *created_r=nullptr);
+
+  /**
+   * Look up a client by its secret key and invoke the given function
+   * with a #CloudClient reference while its shard is locked.
+   *
+   * @return false if no such client exists
+   */
+  template<typename F>
+  bool Visit(uint64_t key, F &&f) {
+    for (unsigned retry = 0; retry < 2; ++retry) {
+      const unsigned i = index.Lookup(key);
+      if (i == CloudKeyIndex::NONE)
+        break;
+
+      Shard &shard = shards[i];
+      ScopeLock protect(shard.mutex);
+      auto *client = shard.clients.Find(key);
+      if (client != nullptr) {
+        f(*client);
+        return true;
+      }
+
+      /* the client has just been moved to another shard; try
+         again */
+    }
+
+    if (!index_overflow.load(std::memory_order_relaxed))
+      return false;
+
+    for (unsigned i = 0; i < N_SHARDS; ++i) {
+      Shard &shard = shards[i];
+      ScopeLock protect(shard.mutex);
+      auto *client = shard.clients.Find(key);
+      if (client != nullptr) {
+        f(*client);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /**
+   * Invoke the given function for all clients within the given
+   * range (approximated by a bounding box).  The query fans out to
+   * all shards whose longitude stripes intersect the range.
+   */
+  template<typename F>
+  void VisitWithinRange(GeoPoint location, double range, F &&f) const {
+    const ShardMask mask = GetShardMask(location, range);
+
+    for (unsigned i = 0; i < N_SHARDS; ++i) {
+      if ((mask & (ShardMask(1) << i)) == 0)
+        continue;
+
+      const Shard &shard = shards[i];
+      ScopeLock protect(shard.mutex);
+      for (const auto &client : shard.clients.QueryWithinRange(location,
+                                                                range))
+        f(*client);
+    }
+  }
+
+  /**
+   * Invoke the given function for all clients, in unspecified order.
+   */
+  template<typename F>
+  void ForEach(F &&f) const {
+    for (unsigned i = 0; i < N_SHARDS; ++i) {
+      const Shard &shard = shards[i];
+      ScopeLock protect(shard.mutex);
+      for (const auto &client : shard.clients)
+        f(client);
+    }
+  }
+
+  void Expire(std::chrono::steady_clock::time_point before);
+
+  /**
+   * Serialise all clients.  The format is compatible with
+   * CloudClientContainer::Save().
+   */
+  void Save(Serialiser &s) const;
+  void Load(Deserialiser &s);
+
+private:
+  gcc_pure
+  static ShardMask GetShardMask(GeoPoint location, double range);
+
+  gcc_pure
+  unsigned FindShard(uint64_t key) const;
+
+  void SetIndex(uint64_t key, unsigned shard);
+};
+
+#endif
@@ -0,0 +1,227 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Snapshot.hpp"
+#include "Data.hpp"
+#include "Tracking/SkyLines/Export.hpp"
+#include "Tracking/SkyLines/Import.hpp"
+#include "IO/FileOutputStream.hxx"
+#include "OS/FileMapping.hpp"
+#include "OS/ByteOrder.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+
+#include <string.h>
+
+static constexpr uint32_t SNAPSHOT_MAGIC = 0x5753f610;
+static constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+int64_t
+CloudClock::Export(std::chrono::steady_clock::time_point t) const
+{
+  const auto delta =
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(steady_now - t);
+  const auto u = system_now - delta;
+  return std::chrono::duration_cast<std::chrono::milliseconds>(u.time_since_epoch()).count();
+}
+
+std::chrono::steady_clock::time_point
+CloudClock::Import(int64_t ms) const
+{
+  const std::chrono::system_clock::time_point u{std::chrono::milliseconds(ms)};
+  const auto delta = system_now - u;
+  return steady_now -
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(delta);
+}
+
+CloudClientRecord
+ExportClient(const CloudClient &client, const CloudClock &clock)
+{
+  CloudClientRecord r;
+  memset(&r, 0, sizeof(r));
+
+  r.key = ToBE64(client.key);
+  r.id = ToBE32(client.id);
+  r.altitude = ToBE16(client.altitude);
+  r.port = ToBE16(client.endpoint.port());
+  r.stamp = ToBE64(clock.Export(client.stamp));
+  r.location = SkyLinesTracking::ExportGeoPoint(client.location);
+
+  const auto address = client.endpoint.address();
+  if (address.is_v4()) {
+    const auto bytes = address.to_v4().to_bytes();
+    std::copy(bytes.begin(), bytes.end(), r.address);
+    r.ip_version = 4;
+  } else {
+    const auto bytes = address.to_v6().to_bytes();
+    std::copy(bytes.begin(), bytes.end(), r.address);
+    r.ip_version = 6;
+  }
+
+  return r;
+}
+
+CloudClient
+ImportClient(const CloudClientRecord &r, const CloudClock &clock)
+{
+  boost::asio::ip::address address;
+  if (r.ip_version == 6) {
+    boost::asio::ip::address_v6::bytes_type bytes;
+    std::copy_n(r.address, bytes.size(), bytes.begin());
+    address = boost::asio::ip::address_v6(bytes);
+  } else {
+    boost::asio::ip::address_v4::bytes_type bytes;
+    std::copy_n(r.address, bytes.size(), bytes.begin());
+    address = boost::asio::ip::address_v4(bytes);
+  }
+
+  CloudClient client({address, FromBE16(r.port)},
+                     FromBE64(r.key), FromBE32(r.id),
+                     SkyLinesTracking::ImportGeoPoint(r.location),
+                     (int16_t)FromBE16(r.altitude));
+  client.stamp = clock.Import(FromBE64(r.stamp));
+  return client;
+}
+
+CloudThermalRecord
+ExportThermal(const CloudThermal &thermal, uint64_t sequence,
+              const CloudClock &clock)
+{
+  CloudThermalRecord r;
+  r.client_key = ToBE64(thermal.client_key);
+  r.sequence = ToBE64(sequence);
+  r.time = ToBE64(clock.Export(thermal.time));
+  r.thermal = thermal.Pack();
+  return r;
+}
+
+CloudThermal
+ImportThermal(const CloudThermalRecord &r, const CloudClock &clock)
+{
+  const auto &t = r.thermal;
+  CloudThermal thermal(FromBE64(r.client_key),
+                       AGeoPoint(SkyLinesTracking::ImportGeoPoint(t.bottom_location),
+                                 (int16_t)FromBE16(t.bottom_altitude)),
+                       AGeoPoint(SkyLinesTracking::ImportGeoPoint(t.top_location),
+                                 (int16_t)FromBE16(t.top_altitude)),
+                       FromBE16(t.lift) / 256.);
+  thermal.time = clock.Import(FromBE64(r.time));
+  return thermal;
+}
+
+void
+CloudSnapshot::Capture(const CloudData &data)
+{
+  const CloudClock clock;
+
+  clients.clear();
+  thermals.clear();
+
+  /* read the id first; clients created meanwhile will be restored
+     from the journal, and CloudClientShards::Restore() bumps the id
+     counter past them */
+  next_client_id = data.clients.GetNextId();
+
+  data.clients.ForEach([this, &clock](const CloudClient &client){
+      clients.push_back(ExportClient(client, clock));
+    });
+
+  ScopeLock protect(data.thermals_mutex);
+  thermal_sequence = data.thermal_sequence;
+
+  thermals.reserve(std::distance(data.thermals.begin(),
+                                 data.thermals.end()));
+  for (const auto &thermal : data.thermals)
+    thermals.push_back(ExportThermal(thermal, 0, clock));
+}
+
+void
+CloudSnapshot::Save(Path path) const
+{
+  Header header;
+  header.magic = ToBE32(SNAPSHOT_MAGIC);
+  header.version = ToBE32(SNAPSHOT_VERSION);
+  header.next_client_id = ToBE32(next_client_id);
+  header.n_clients = ToBE32(clients.size());
+  header.n_thermals = ToBE64(thermals.size());
+  header.thermal_sequence = ToBE64(thermal_sequence);
+
+  FileOutputStream fos(path);
+  fos.Write(&header, sizeof(header));
+  fos.Write(clients.data(), clients.size() * sizeof(clients.front()));
+  fos.Write(thermals.data(), thermals.size() * sizeof(thermals.front()));
+  fos.Commit();
+}
+
+bool
+CloudSnapshot::Load(Path path, CloudData &data)
+{
+  FileMapping map(path);
+  if (map.error())
+    throw std::runtime_error("Failed to map snapshot");
+
+  if (map.size() < sizeof(Header))
+    return false;
+
+  const auto &header = *(const Header *)map.data();
+  if (FromBE32(header.magic) != SNAPSHOT_MAGIC)
+    return false;
+
+  if (FromBE32(header.version) != SNAPSHOT_VERSION)
+    throw std::runtime_error("Bad snapshot version");
+
+  const size_t n_clients = FromBE32(header.n_clients);
+  const uint64_t n_thermals = FromBE64(header.n_thermals);
+  if (map.size() != sizeof(header) + n_clients * sizeof(CloudClientRecord)
+      + n_thermals * sizeof(CloudThermalRecord))
+    throw std::runtime_error("Truncated snapshot");
+
+  const CloudClock clock;
+
+  /* the records are used directly from the mapping; no parsing
+     besides byte order conversion is needed */
+
+  const auto *client_records = (const CloudClientRecord *)(&header + 1);
+  for (size_t i = 0; i < n_clients; ++i)
+    data.clients.Restore(ImportClient(client_records[i], clock));
+
+  data.clients.SetNextId(FromBE32(header.next_client_id));
+
+  const auto *thermal_records =
+    (const CloudThermalRecord *)(client_records + n_clients);
+
+  ScopeLock protect(data.thermals_mutex);
+  data.thermal_sequence = FromBE64(header.thermal_sequence);
+
+  /* the snapshot lists the newest thermals first; insert them in
+     reverse order to restore the container's order */
+  for (size_t i = n_thermals; i-- > 0;) {
+    auto thermal =
+      std::make_shared<CloudThermal>(ImportThermal(thermal_records[i],
+                                                   clock));
+    data.thermals.Insert(*thermal);
+  }
+
+  return true;
+}
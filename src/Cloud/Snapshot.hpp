@@ -0,0 +1,172 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_CLOUD_SNAPSHOT_HPP
+#define XCSOAR_CLOUD_SNAPSHOT_HPP
+
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Compiler.h"
+
+#include <chrono>
+#include <vector>
+
+#include <stdint.h>
+
+struct CloudData;
+struct CloudClient;
+struct CloudThermal;
+class Path;
+
+/**
+ * Converts between the in-memory time stamps (monotonic server-side
+ * clock) and the wall-clock milliseconds stored on disk.
+ */
+class CloudClock {
+  const std::chrono::steady_clock::time_point steady_now =
+    std::chrono::steady_clock::now();
+  const std::chrono::system_clock::time_point system_now =
+    std::chrono::system_clock::now();
+
+public:
+  gcc_pure
+  int64_t Export(std::chrono::steady_clock::time_point t) const;
+
+  gcc_pure
+  std::chrono::steady_clock::time_point Import(int64_t ms) const;
+};
+
+/**
+ * A #CloudClient in the fixed-size on-disk layout used by snapshots
+ * and the journal.  All integers are big-endian.
+ */
+struct CloudClientRecord {
+  uint64_t key;
+  uint32_t id;
+  int16_t altitude;
+  uint16_t port;
+
+  /**
+   * Last fix, wall-clock milliseconds since the epoch.
+   */
+  int64_t stamp;
+
+  SkyLinesTracking::GeoPoint location;
+
+  /**
+   * IPv4 addresses use only the first 4 bytes.
+   */
+  uint8_t address[16];
+
+  /**
+   * 4 or 6.
+   */
+  uint8_t ip_version;
+
+  uint8_t reserved[7];
+};
+
+static_assert(sizeof(CloudClientRecord) == 56, "Wrong struct size");
+
+/**
+ * A #CloudThermal in the fixed-size on-disk layout.  All integers
+ * are big-endian.
+ */
+struct CloudThermalRecord {
+  uint64_t client_key;
+
+  /**
+   * See CloudData::thermal_sequence.  Zero in snapshots.
+   */
+  uint64_t sequence;
+
+  /**
+   * Wall-clock milliseconds since the epoch.
+   */
+  int64_t time;
+
+  SkyLinesTracking::Thermal thermal;
+};
+
+static_assert(sizeof(CloudThermalRecord) == 56, "Wrong struct size");
+
+gcc_pure
+CloudClientRecord
+ExportClient(const CloudClient &client, const CloudClock &clock);
+
+gcc_pure
+CloudClient
+ImportClient(const CloudClientRecord &record, const CloudClock &clock);
+
+gcc_pure
+CloudThermalRecord
+ExportThermal(const CloudThermal &thermal, uint64_t sequence,
+              const CloudClock &clock);
+
+gcc_pure
+CloudThermal
+ImportThermal(const CloudThermalRecord &record, const CloudClock &clock);
+
+/**
+ * A copy of all #CloudData in the on-disk layout.  Capturing it only
+ * copies fixed-size records while the locks are held; the slow
+ * Save() can then run in another thread.
+ *
+ * File layout: a #Header, followed by the client records and the
+ * thermal records, suitable for loading via mmap().
+ */
+struct CloudSnapshot {
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t next_client_id;
+    uint32_t n_clients;
+    uint64_t n_thermals;
+    uint64_t thermal_sequence;
+  };
+
+  static_assert(sizeof(Header) == 32, "Wrong struct size");
+
+  uint32_t next_client_id;
+  uint64_t thermal_sequence;
+
+  std::vector<CloudClientRecord> clients;
+  std::vector<CloudThermalRecord> thermals;
+
+  void Capture(const CloudData &data);
+
+  /**
+   * Atomically replace the file.  Throws on error.
+   */
+  void Save(Path path) const;
+
+  /**
+   * Load a snapshot file into the given (empty) #CloudData.  Throws
+   * on error.
+   *
+   * @return false if the file is not a snapshot (e.g. in the old
+   * #Serialiser format)
+   */
+  static bool Load(Path path, CloudData &data);
+};
+
+#endif
@@ -45,6 +45,8 @@ CloudThermalContainer::clear()
 {
   while (!list.empty())
     Remove(list.back());
+
+  hotspots.clear();
 }
 
 CloudThermal &
@@ -64,6 +66,7 @@ CloudThermalContainer::Insert(CloudThermal &thermal)
 {
   list.push_front(thermal);
   rtree.insert(thermal.shared_from_this());
+  hotspots.Add(thermal);
 }
 
 void
@@ -78,6 +81,8 @@ CloudThermalContainer::Expire(std::chrono::steady_clock::time_point before)
 {
   while (!list.empty() && list.back().time < before)
     Remove(list.back());
+
+  hotspots.Expire(before);
 }
 
 CloudThermalContainer::query_iterator_range
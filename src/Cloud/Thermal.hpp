@@ -24,6 +24,7 @@ Copyright_License {
 #ifndef XCSOAR_CLOUD_THERMAL_HPP
 #define XCSOAR_CLOUD_THERMAL_HPP
 
+#include "Hotspot.hpp"
 #include "Geo/Boost/GeoPoint.hpp"
 
 #include <boost/intrusive/list.hpp>
@@ -106,6 +107,12 @@ class CloudThermalContainer {
    */
   List list;
 
+  /**
+   * All thermals merged into grid cells.  This is what clients get
+   * to see.
+   */
+  CloudHotspotContainer hotspots;
+
 public:
   CloudThermalContainer();
   ~CloudThermalContainer();
@@ -152,6 +159,10 @@ public:
   gcc_pure
   query_iterator_range QueryWithinRange(GeoPoint location, double range) const;
 
+  const CloudHotspotContainer &GetHotspots() const {
+    return hotspots;
+  }
+
   void Save(Serialiser &s) const;
   void Load(Deserialiser &s);
 };
@@ -22,9 +22,7 @@ Copyright_License {
 */
 
 #include "Data.hpp"
-#include "Serialiser.hpp"
 #include "IO/FileOutputStream.hxx"
-#include "IO/FileReader.hxx"
 #include "IO/BufferedOutputStream.hxx"
 #include "Util/PrintException.hxx"
 #include "Compiler.h"
@@ -70,7 +68,7 @@ ToKML(BufferedOutputStream &os, const CloudClient &client)
 }
 
 static void
-ToKML(BufferedOutputStream &os, const CloudClientContainer &clients)
+ToKML(BufferedOutputStream &os, const CloudClientShards &clients)
 {
   os.Write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
            "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n"
@@ -83,9 +81,10 @@ ToKML(BufferedOutputStream &os, const CloudClientContainer &clients)
 
   const auto min_stamp = std::chrono::steady_clock::now() - MAX_TRAFFIC_AGE;
 
-  for (const auto &client : clients)
-    if (client.stamp >= min_stamp)
-      ToKML(os, client);
+  clients.ForEach([&os, min_stamp](const CloudClient &client){
+      if (client.stamp >= min_stamp)
+        ToKML(os, client);
+    });
 
   os.Write("    </Folder>\n");
   os.Write("  </Document>\n"
@@ -165,11 +164,7 @@ try {
 
   /* read the database saved by xcsoar-cloud-server */
 
-  {
-    FileReader fr(db_path);
-    Deserialiser s(fr);
-    data.Load(s);
-  }
+  data.Load(db_path);
 
   /* write the clients to KML */
 
@@ -24,12 +24,14 @@ Copyright_License {
 #include "ContestComputer.hpp"
 #include "Engine/Contest/Settings.hpp"
 
-ContestComputer::ContestComputer(const Trace &trace_full,
+ContestComputer::ContestComputer(ParallelExecutor *executor,
+                                 const Trace &trace_full,
                                  const Trace &trace_triangle,
                                  const Trace &trace_sprint)
   :contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
 {
   contest_manager.SetIncremental(true);
+  contest_manager.SetExecutor(executor);
 }
 
 void
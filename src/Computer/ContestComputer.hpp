@@ -34,7 +34,12 @@ class ContestComputer {
   ContestManager contest_manager;
 
 public:
-  ContestComputer(const Trace &trace_full,
+  /**
+   * @param executor runs the independent solvers of composite
+   * contests (e.g. OLC Plus) concurrently; may be nullptr
+   */
+  ContestComputer(ParallelExecutor *executor,
+                  const Trace &trace_full,
                   const Trace &trace_triangle,
                   const Trace &trace_sprint);
 
@@ -28,19 +28,84 @@ Copyright_License {
 #include "GlideComputerInterface.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 
+#include "Util/Macros.hpp"
+
 static PeriodClock last_team_code_update;
 
+/**
+ * The data accessed by the ProcessIdle() jobs, for #JobAccess.
+ */
+enum IdleData : unsigned {
+  /**
+   * Basic() and the parts of Calculated() which are written by
+   * ProcessGPS(); during ProcessIdle(), they are only read.
+   */
+  IDLE_BASIC = 0x1,
+
+  IDLE_FLIGHT_STATISTICS = 0x2,
+  IDLE_LOGGER = 0x4,
+  IDLE_CONTEST_STATS = 0x8,
+  IDLE_TASK_MANAGER = 0x10,
+
+  /**
+   * The #TaskComputer's #WorkerPool, which may be used by only one
+   * thread at a time.
+   */
+  IDLE_TASK_POOL = 0x20,
+
+  /**
+   * The airspace objects; they are shared by the warning manager and
+   * the route planner.
+   */
+  IDLE_AIRSPACES = 0x40,
+
+  IDLE_AIRSPACE_WARNINGS = 0x80,
+  IDLE_RETROSPECTIVE = 0x100,
+};
+
+struct IdleJob {
+  ComputerProfiler::Stage stage;
+  JobAccess access;
+};
+
+static constexpr IdleJob idle_jobs[] = {
+  { ComputerProfiler::Stage::LOG,
+    { IDLE_BASIC, IDLE_FLIGHT_STATISTICS|IDLE_LOGGER } },
+  { ComputerProfiler::Stage::CONTEST,
+    { IDLE_BASIC, IDLE_CONTEST_STATS|IDLE_TASK_POOL } },
+  { ComputerProfiler::Stage::ALTERNATES,
+    { IDLE_BASIC|IDLE_AIRSPACES, IDLE_TASK_MANAGER|IDLE_TASK_POOL } },
+  { ComputerProfiler::Stage::WARNING,
+    { IDLE_BASIC|IDLE_AIRSPACES, IDLE_AIRSPACE_WARNINGS } },
+  { ComputerProfiler::Stage::RETROSPECTIVE,
+    { IDLE_BASIC, IDLE_RETROSPECTIVE } },
+};
+
+static constexpr unsigned N_IDLE_JOBS = ARRAY_SIZE(idle_jobs);
+
+static JobGraph
+MakeIdleGraph()
+{
+  JobAccess access[N_IDLE_JOBS];
+  for (unsigned i = 0; i < N_IDLE_JOBS; ++i)
+    access[i] = idle_jobs[i].access;
+
+  return JobGraph(access, N_IDLE_JOBS);
+}
+
 GlideComputer::GlideComputer(const ComputerSettings &_settings,
                              const Waypoints &_way_points,
                              Airspaces &_airspace_database,
                              ProtectedTaskManager &task,
                              GlideComputerTaskEvents& events)
-  :air_data_computer(_way_points),
+  :air_data_computer(_way_points, profiler),
    warning_computer(_settings.airspace.warnings, _airspace_database),
    task_computer(task, _airspace_database, &warning_computer.GetManager()),
    waypoints(_way_points),
    retrospective(_way_points),
-   team_code_ref_id(-1)
+   team_code_ref_id(-1),
+   idle_graph(MakeIdleGraph()),
+   idle_pool(WorkerPool::GetDefaultThreads(idle_graph.GetGroupCount() - 1))
 {
   ReadComputerSettings(_settings);
   events.SetComputer(*this);
@@ -72,6 +137,8 @@ GlideComputer::Initialise()
 bool
 GlideComputer::ProcessGPS(bool force)
 {
+  const ScopeProfile total(profiler, ComputerProfiler::Stage::PROCESS_GPS);
+
   const MoreData &basic = Basic();
   DerivedInfo &calculated = SetCalculated();
   const ComputerSettings &settings = GetComputerSettings();
@@ -96,40 +163,62 @@ GlideComputer::ProcessGPS(bool force)
   calculated.Expire(basic.clock);
 
   // Process basic information
-  air_data_computer.ProcessBasic(Basic(), SetCalculated(),
-                                 settings);
+  {
+    const ScopeProfile profile(profiler, ComputerProfiler::Stage::AIR_DATA);
+    air_data_computer.ProcessBasic(Basic(), SetCalculated(),
+                                   settings);
+  }
 
   // Process basic task information
   const bool last_finished = calculated.ordered_task_stats.task_finished;
 
-  task_computer.ProcessBasicTask(basic,
-                                 calculated,
-                                 settings,
-                                 force);
+  {
+    const ScopeProfile profile(profiler, ComputerProfiler::Stage::TASK);
+    task_computer.ProcessBasicTask(basic,
+                                   calculated,
+                                   settings,
+                                   force);
+  }
 
   CalculateWorkingBand();
 
-  task_computer.ProcessMoreTask(basic, calculated, settings);
+  {
+    const ScopeProfile profile(profiler, ComputerProfiler::Stage::ROUTE);
+    task_computer.ProcessMoreTask(basic, calculated, settings);
+  }
 
   if (!last_finished && calculated.ordered_task_stats.task_finished)
     OnFinishTask();
 
-  // Check if everything is okay with the gps time and process it
-  air_data_computer.FlightTimes(Basic(), SetCalculated(),
-                                settings);
+  {
+    const ScopeProfile profile(profiler, ComputerProfiler::Stage::FLIGHT);
+
+    // Check if everything is okay with the gps time and process it
+    air_data_computer.FlightTimes(Basic(), SetCalculated(),
+                                  settings);
 
-  TakeoffLanding(last_flying);
+    TakeoffLanding(last_flying);
 
-  task_computer.ProcessAutoTask(basic, calculated);
+    task_computer.ProcessAutoTask(basic, calculated);
+  }
 
   // Process extended information
-  air_data_computer.ProcessVertical(Basic(),
-                                    SetCalculated(),
-                                    settings);
+  {
+    const ScopeProfile profile(profiler, ComputerProfiler::Stage::VERTICAL);
+    air_data_computer.ProcessVertical(Basic(),
+                                      SetCalculated(),
+                                      settings);
+  }
 
-  stats_computer.ProcessClimbEvents(calculated);
+  {
+    const ScopeProfile profile(profiler, ComputerProfiler::Stage::STATS);
+    stats_computer.ProcessClimbEvents(calculated);
+  }
 
-  cu_computer.Compute(basic, calculated, settings);
+  {
+    const ScopeProfile profile(profiler, ComputerProfiler::Stage::CU);
+    cu_computer.Compute(basic, calculated, settings);
+  }
 
   // Calculate the team code
   CalculateOwnTeamCode();
@@ -150,31 +239,74 @@ GlideComputer::ProcessGPS(bool force)
   CalculateVarioScale();
 
   // Update the ConditionMonitors
-  ConditionMonitorsUpdate(Basic(), Calculated(), settings);
+  {
+    const ScopeProfile profile(profiler,
+                               ComputerProfiler::Stage::CONDITION_MONITORS);
+    ConditionMonitorsUpdate(Basic(), Calculated(), settings);
+  }
 
   return idle_clock.CheckUpdate(500);
 }
 
-void
-GlideComputer::ProcessIdle(bool exhaustive)
+inline void
+GlideComputer::RunIdleJob(unsigned job, bool exhaustive, unsigned lane)
 {
+  const auto stage = idle_jobs[job].stage;
+  const ScopeProfile profile(profiler, stage, lane);
+
   const MoreData &basic = Basic();
   DerivedInfo &calculated = SetCalculated();
 
-  // Log GPS fixes for internal usage
-  // (snail trail, stats, olc, ...)
-  stats_computer.DoLogging(basic, calculated);
-  log_computer.Run(basic, calculated, GetComputerSettings().logger);
-
-  task_computer.ProcessIdle(basic, calculated, GetComputerSettings(),
-                            exhaustive);
-
-  warning_computer.Update(GetComputerSettings(), basic,
-                          calculated, calculated.airspace_warnings);
+  switch (stage) {
+  case ComputerProfiler::Stage::LOG:
+    // Log GPS fixes for internal usage
+    // (snail trail, stats, olc, ...)
+    stats_computer.DoLogging(basic, calculated);
+    log_computer.Run(basic, calculated, GetComputerSettings().logger);
+    break;
+
+  case ComputerProfiler::Stage::CONTEST:
+    task_computer.ProcessContest(basic, calculated, GetComputerSettings(),
+                                 exhaustive);
+    break;
+
+  case ComputerProfiler::Stage::ALTERNATES:
+    task_computer.ProcessIdleTask(basic, calculated);
+    break;
+
+  case ComputerProfiler::Stage::WARNING:
+    warning_computer.Update(GetComputerSettings(), basic,
+                            calculated, calculated.airspace_warnings);
+    break;
+
+  case ComputerProfiler::Stage::RETROSPECTIVE:
+    // Calculate summary of flight
+    if (basic.location_available)
+      retrospective.UpdateSample(basic.location);
+    break;
+
+  default:
+    gcc_unreachable();
+  }
+}
 
-  // Calculate summary of flight
-  if (basic.location_available)
-    retrospective.UpdateSample(basic.location);
+void
+GlideComputer::ProcessIdle(bool exhaustive)
+{
+  const ScopeProfile total(profiler, ComputerProfiler::Stage::PROCESS_IDLE);
+
+  /* this modifies the airspaces, which the jobs below read */
+  warning_computer.UpdateAirspaces(GetComputerSettings(), Basic(),
+                                   Calculated());
+
+  /* the groups are independent of each other; the jobs of a group
+     run in their original order */
+  ParallelForEach(&idle_pool, idle_graph.GetGroupCount(),
+                  [this, exhaustive](unsigned group){
+                    idle_graph.VisitGroup(group, [=](unsigned job){
+                        RunIdleJob(job, exhaustive, 2 + group);
+                      });
+                  });
 }
 
 bool
@@ -33,6 +33,9 @@ Copyright_License {
 #include "LogComputer.hpp"
 #include "WarningComputer.hpp"
 #include "CuComputer.hpp"
+#include "Profiler.hpp"
+#include "JobGraph.hpp"
+#include "Thread/WorkerPool.hpp"
 #include "Compiler.h"
 #include "Engine/Contest/Solvers/Retrospective.hpp"
 
@@ -47,6 +50,8 @@ class RasterTerrain;
 
 class GlideComputer : public GlideComputerBlackboard
 {
+  ComputerProfiler profiler;
+
   GlideComputerAirData air_data_computer;
   WarningComputer warning_computer;
   TaskComputer task_computer;
@@ -63,6 +68,18 @@ class GlideComputer : public GlideComputerBlackboard
 
   PeriodClock idle_clock;
 
+  /**
+   * The jobs of ProcessIdle(), grouped by the data they access.
+   */
+  const JobGraph idle_graph;
+
+  /**
+   * Runs the groups of #idle_graph in parallel.  This is separate
+   * from the #TaskComputer's pool, because one of the jobs uses that
+   * one.
+   */
+  WorkerPool idle_pool;
+
   /**
    * This object is used to check whether to update
    * DerivedInfo::trace_history.
@@ -162,6 +179,14 @@ public:
     task_computer.SetContestIncremental(incremental);
   }
 
+  /**
+   * Returns the per-stage timing statistics.  Must not be accessed
+   * while another thread runs ProcessGPS() or ProcessIdle().
+   */
+  const ComputerProfiler &GetProfiler() const {
+    return profiler;
+  }
+
 protected:
   void OnTakeoff();
   void OnLanding();
@@ -184,6 +209,14 @@ private:
 
   void CalculateTeammateBearingRange();
 
+  /**
+   * Run one job of ProcessIdle().
+   *
+   * @param job an index into the job table
+   * @param lane the row in the Chrome trace
+   */
+  void RunIdleJob(unsigned job, bool exhaustive, unsigned lane);
+
   /**
    * Calculates the own TeamCode and saves it to Calculated
    */
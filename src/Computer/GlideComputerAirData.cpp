@@ -39,8 +39,9 @@ static constexpr double CLIMB_RATE_G_MIN = 0.25;
 static constexpr double LOW_PASS_FILTER_VARIO_LD_ALPHA = 0.3;
 static constexpr double LOW_PASS_FILTER_THERMAL_AVERAGE_ALPHA = 0.3;
 
-GlideComputerAirData::GlideComputerAirData(const Waypoints &_way_points)
-  :waypoints(_way_points),
+GlideComputerAirData::GlideComputerAirData(const Waypoints &_way_points,
+                                           ComputerProfiler &_profiler)
+  :waypoints(_way_points), profiler(_profiler),
    terrain(NULL)
 {
   // JMW TODO enhancement: seed initial wind store with start conditions
@@ -102,13 +103,19 @@ GlideComputerAirData::ProcessVertical(const MoreData &basic,
                              calculated.flight);
   Turning(basic, calculated, settings);
 
-  wave_computer.Compute(basic, calculated.flight,
-                        calculated.wave, settings.wave);
+  {
+    const ScopeProfile profile(profiler, ComputerProfiler::Stage::WAVE);
+    wave_computer.Compute(basic, calculated.flight,
+                          calculated.wave, settings.wave);
+  }
 
-  wind_computer.Compute(settings.wind, settings.polar.glide_polar_task,
-                        basic, calculated);
-  wind_computer.Select(settings.wind, basic, calculated);
-  wind_computer.ComputeHeadWind(basic, calculated);
+  {
+    const ScopeProfile profile(profiler, ComputerProfiler::Stage::WIND);
+    wind_computer.Compute(settings.wind, settings.polar.glide_polar_task,
+                          basic, calculated);
+    wind_computer.Select(settings.wind, basic, calculated);
+    wind_computer.ComputeHeadWind(basic, calculated);
+  }
 
   thermallocator.Process(calculated.circling && calculated.turning,
                          basic.time, basic.location,
@@ -288,6 +295,7 @@ GlideComputerAirData::Turning(const MoreData &basic,
   // Calculate circling time percentage and call thermal band calculation
   circling_computer.PercentCircling(basic, calculated.flight, calculated);
 
+  const ScopeProfile profile(profiler, ComputerProfiler::Stage::THERMAL_BAND);
   thermal_band_computer.Compute(basic, calculated,
                                 calculated.thermal_encounter_band,
                                 calculated.thermal_encounter_collection);
@@ -35,6 +35,7 @@ Copyright_License {
 #include "LiftDatabaseComputer.hpp"
 #include "AverageVarioComputer.hpp"
 #include "ThermalLocator.hpp"
+#include "Profiler.hpp"
 
 struct VarioInfo;
 struct OneClimbInfo;
@@ -50,6 +51,7 @@ class GlidePolar;
 
 class GlideComputerAirData {
   const Waypoints &waypoints;
+  ComputerProfiler &profiler;
   const RasterTerrain *terrain;
 
   AutoQNH auto_qnh;
@@ -74,7 +76,8 @@ class GlideComputerAirData {
   DeltaTime delta_time;
 
 public:
-  GlideComputerAirData(const Waypoints &way_points);
+  GlideComputerAirData(const Waypoints &way_points,
+                       ComputerProfiler &_profiler);
 
   void SetTerrain(const RasterTerrain* _terrain) {
     terrain = _terrain;
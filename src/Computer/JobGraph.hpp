@@ -0,0 +1,125 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_COMPUTER_JOB_GRAPH_HPP
+#define XCSOAR_COMPUTER_JOB_GRAPH_HPP
+
+#include <assert.h>
+#include <stdint.h>
+
+/**
+ * Declares which data a job accesses.  Each bit stands for one data
+ * structure (or another resource); the meaning of the bits is
+ * defined by the caller.
+ */
+struct JobAccess {
+  unsigned reads, writes;
+
+  /**
+   * May the two jobs not run in parallel?
+   */
+  constexpr bool ConflictsWith(const JobAccess &other) const {
+    return (writes & (other.reads | other.writes)) != 0 ||
+      (reads & other.writes) != 0;
+  }
+};
+
+/**
+ * Partitions a list of jobs into groups which may run in parallel.
+ * Conflicting jobs (and, transitively, all jobs conflicting with
+ * those) are in the same group, and must run sequentially in their
+ * original order.
+ */
+class JobGraph {
+public:
+  static constexpr unsigned MAX_JOBS = 16;
+
+private:
+  uint8_t groups[MAX_JOBS];
+
+  unsigned n_jobs, n_groups;
+
+public:
+  JobGraph(const JobAccess *jobs, unsigned _n_jobs)
+    :n_jobs(_n_jobs), n_groups(0) {
+    assert(n_jobs <= MAX_JOBS);
+
+    /* union-find with the lowest job index as representative */
+    uint8_t parent[MAX_JOBS];
+    for (unsigned i = 0; i < n_jobs; ++i) {
+      parent[i] = i;
+
+      for (unsigned j = 0; j < i; ++j) {
+        if (!jobs[i].ConflictsWith(jobs[j]))
+          continue;
+
+        const unsigned a = Find(parent, i), b = Find(parent, j);
+        if (a < b)
+          parent[b] = a;
+        else
+          parent[a] = b;
+      }
+    }
+
+    /* number the groups in the order of their first job */
+    for (unsigned i = 0; i < n_jobs; ++i) {
+      const unsigned root = Find(parent, i);
+      groups[i] = root == i ? n_groups++ : groups[root];
+    }
+  }
+
+  unsigned GetJobCount() const {
+    return n_jobs;
+  }
+
+  unsigned GetGroupCount() const {
+    return n_groups;
+  }
+
+  unsigned GetGroup(unsigned job) const {
+    assert(job < n_jobs);
+
+    return groups[job];
+  }
+
+  /**
+   * Invoke f(job) for each job of the given group, in order.
+   */
+  template<typename F>
+  void VisitGroup(unsigned group, F &&f) const {
+    assert(group < n_groups);
+
+    for (unsigned i = 0; i < n_jobs; ++i)
+      if (groups[i] == group)
+        f(i);
+  }
+
+private:
+  static unsigned Find(const uint8_t *parent, unsigned i) {
+    while (parent[i] != i)
+      i = parent[i];
+    return i;
+  }
+};
+
+#endif
@@ -0,0 +1,251 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Profiler.hpp"
+#include "JSON/Writer.hpp"
+#include "IO/FileOutputStream.hxx"
+#include "IO/BufferedOutputStream.hxx"
+#include "LogFile.hpp"
+
+#include <algorithm>
+
+#include <inttypes.h>
+#include <limits.h>
+
+void
+ComputerProfiler::StageStats::Reset()
+{
+  count = 0;
+  total_us = 0;
+  max_us = 0;
+  std::fill_n(buckets, N_BUCKETS, 0u);
+}
+
+void
+ComputerProfiler::StageStats::Add(unsigned us)
+{
+  history[count % HISTORY_SIZE] = us;
+  ++count;
+  total_us += us;
+  max_us = std::max(max_us, us);
+
+  unsigned bucket = 0;
+  while (bucket < N_BUCKETS - 1 && (us >> (bucket + 1)) != 0)
+    ++bucket;
+
+  ++buckets[bucket];
+}
+
+unsigned
+ComputerProfiler::StageStats::GetRecentPercentile(unsigned percent) const
+{
+  const unsigned n = std::min(count, HISTORY_SIZE);
+  if (n == 0)
+    return 0;
+
+  unsigned sorted[HISTORY_SIZE];
+  std::copy_n(history, n, sorted);
+
+  const unsigned i = std::min(n * percent / 100, n - 1);
+  std::nth_element(sorted, sorted + i, sorted + n);
+  return sorted[i];
+}
+
+const char *
+ComputerProfiler::GetStageName(Stage stage)
+{
+  switch (stage) {
+  case Stage::PROCESS_GPS:
+    return "ProcessGPS";
+
+  case Stage::AIR_DATA:
+    return "air data";
+
+  case Stage::TASK:
+    return "task";
+
+  case Stage::ROUTE:
+    return "route";
+
+  case Stage::FLIGHT:
+    return "flight";
+
+  case Stage::VERTICAL:
+    return "vertical";
+
+  case Stage::THERMAL_BAND:
+    return "thermal band";
+
+  case Stage::WAVE:
+    return "wave";
+
+  case Stage::WIND:
+    return "wind";
+
+  case Stage::STATS:
+    return "stats";
+
+  case Stage::CU:
+    return "cu";
+
+  case Stage::CONDITION_MONITORS:
+    return "condition monitors";
+
+  case Stage::PROCESS_IDLE:
+    return "ProcessIdle";
+
+  case Stage::LOG:
+    return "log";
+
+  case Stage::CONTEST:
+    return "contest";
+
+  case Stage::ALTERNATES:
+    return "alternates";
+
+  case Stage::WARNING:
+    return "warning";
+
+  case Stage::RETROSPECTIVE:
+    return "retrospective";
+
+  case Stage::COUNT:
+    break;
+  }
+
+  gcc_unreachable();
+}
+
+void
+ComputerProfiler::Reset()
+{
+  for (auto &i : stages)
+    i.Reset();
+
+  n_events = 0;
+  origin_us = MonotonicClockUS();
+}
+
+void
+ComputerProfiler::Add(Stage stage, uint64_t start_us, uint64_t end_us,
+                      unsigned lane)
+{
+  const unsigned duration_us =
+    unsigned(std::min<uint64_t>(end_us - start_us, UINT_MAX));
+
+  const ScopeLock protect(mutex);
+
+  stages[unsigned(stage)].Add(duration_us);
+
+  Event &event = events[n_events % MAX_EVENTS];
+  event.start_us = start_us - origin_us;
+  event.duration_us = duration_us;
+  event.stage = stage;
+  event.lane = lane;
+  ++n_events;
+}
+
+void
+ComputerProfiler::LogSummary() const
+{
+  for (unsigned i = 0; i < unsigned(Stage::COUNT); ++i) {
+    const StageStats &s = stages[i];
+    if (s.count == 0)
+      continue;
+
+    LogFormat("GlideComputer %s: %u calls, %u us avg, %u us p95, %u us max",
+              GetStageName(Stage(i)), s.count,
+              unsigned(s.total_us / s.count),
+              s.GetRecentPercentile(95), s.max_us);
+  }
+}
+
+static void
+WriteStageStats(BufferedOutputStream &os,
+                const ComputerProfiler::StageStats &s)
+{
+  JSON::ObjectWriter object(os);
+  object.WriteElement("count", JSON::WriteUnsigned, s.count);
+  object.BeginElement("total_us");
+  os.Format("%" PRIu64, s.total_us);
+  object.EndElement();
+  object.WriteElement("max_us", JSON::WriteUnsigned, s.max_us);
+  object.WriteElement("p50_us", JSON::WriteUnsigned,
+                      s.GetRecentPercentile(50));
+  object.WriteElement("p95_us", JSON::WriteUnsigned,
+                      s.GetRecentPercentile(95));
+
+  object.BeginElement("histogram_log2_us");
+  {
+    JSON::ArrayWriter array(os);
+    for (unsigned i : s.buckets)
+      array.WriteElement(JSON::WriteUnsigned, i);
+  }
+  object.EndElement();
+}
+
+void
+ComputerProfiler::WriteChromeTrace(BufferedOutputStream &os) const
+{
+  JSON::ObjectWriter root(os);
+
+  root.BeginElement("traceEvents");
+  {
+    JSON::ArrayWriter array(os);
+
+    const uint64_t first = n_events > MAX_EVENTS ? n_events - MAX_EVENTS : 0;
+    for (uint64_t i = first; i < n_events; ++i) {
+      const Event &event = events[i % MAX_EVENTS];
+
+      array.BeginElement();
+      os.Write("{\"name\":");
+      JSON::WriteString(os, GetStageName(event.stage));
+      os.Format(",\"cat\":\"GlideComputer\",\"ph\":\"X\","
+                "\"ts\":%" PRIu64 ",\"dur\":%u,\"pid\":1,\"tid\":%u}",
+                event.start_us, event.duration_us, unsigned(event.lane));
+      array.EndElement();
+    }
+  }
+  root.EndElement();
+
+  root.WriteElement("displayTimeUnit", JSON::WriteString, "ms");
+
+  root.BeginElement("otherData");
+  {
+    JSON::ObjectWriter other(os);
+    for (unsigned i = 0; i < unsigned(Stage::COUNT); ++i)
+      other.WriteElement(GetStageName(Stage(i)), WriteStageStats,
+                         stages[i]);
+  }
+  root.EndElement();
+}
+
+void
+ComputerProfiler::WriteChromeTrace(Path path) const
+{
+  FileOutputStream file(path);
+  BufferedOutputStream buffered(file);
+  WriteChromeTrace(buffered);
+  buffered.Flush();
+  file.Commit();
+}
@@ -0,0 +1,211 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_COMPUTER_PROFILER_HPP
+#define XCSOAR_COMPUTER_PROFILER_HPP
+
+#include "OS/Clock.hpp"
+#include "Thread/Mutex.hpp"
+#include "Compiler.h"
+
+#include <stdint.h>
+
+class Path;
+class BufferedOutputStream;
+
+/**
+ * Measures the time spent in each stage of the #GlideComputer.  For
+ * each stage, it keeps a histogram of all samples and a ring buffer
+ * of the most recent ones; in addition, the most recent events are
+ * kept for exporting them in the Chrome trace format (see
+ * chrome://tracing).
+ *
+ * Add() may be called by several threads (the jobs of
+ * GlideComputer::ProcessIdle() run in parallel), but the statistics
+ * may be read only while no thread updates them (e.g. after the
+ * calculation thread has been stopped).
+ */
+class ComputerProfiler {
+public:
+  enum class Stage : uint8_t {
+    PROCESS_GPS,
+    AIR_DATA,
+    TASK,
+    ROUTE,
+    FLIGHT,
+    VERTICAL,
+    THERMAL_BAND,
+    WAVE,
+    WIND,
+    STATS,
+    CU,
+    CONDITION_MONITORS,
+    PROCESS_IDLE,
+    LOG,
+    CONTEST,
+    ALTERNATES,
+    WARNING,
+    RETROSPECTIVE,
+    COUNT
+  };
+
+  /**
+   * The number of histogram buckets; bucket i counts durations
+   * below 2^(i+1) microseconds, the last one everything else.
+   */
+  static constexpr unsigned N_BUCKETS = 24;
+
+  /**
+   * The number of recent samples kept for each stage.
+   */
+  static constexpr unsigned HISTORY_SIZE = 128;
+
+  /**
+   * The number of recent events kept for the trace export.
+   */
+  static constexpr unsigned MAX_EVENTS = 4096;
+
+  struct StageStats {
+    unsigned count;
+    uint64_t total_us;
+    unsigned max_us;
+
+    unsigned buckets[N_BUCKETS];
+
+    /**
+     * A ring buffer of the most recent durations [us].
+     */
+    unsigned history[HISTORY_SIZE];
+
+    void Reset();
+    void Add(unsigned us);
+
+    /**
+     * Calculate a percentile (0..100) of the most recent durations.
+     */
+    gcc_pure
+    unsigned GetRecentPercentile(unsigned percent) const;
+  };
+
+private:
+  struct Event {
+    /**
+     * Relative to #origin_us.
+     */
+    uint64_t start_us;
+
+    unsigned duration_us;
+
+    Stage stage;
+
+    /**
+     * The "tid" in the Chrome trace; parallel jobs are shown in
+     * separate rows.
+     */
+    uint8_t lane;
+  };
+
+  /**
+   * Protects all attributes modified by Add().
+   */
+  Mutex mutex;
+
+  StageStats stages[unsigned(Stage::COUNT)];
+
+  Event events[MAX_EVENTS];
+
+  /**
+   * The total number of events added since Reset(); only the most
+   * recent #MAX_EVENTS are available.
+   */
+  uint64_t n_events;
+
+  uint64_t origin_us;
+
+public:
+  ComputerProfiler() {
+    Reset();
+  }
+
+  ComputerProfiler(const ComputerProfiler &) = delete;
+  ComputerProfiler &operator=(const ComputerProfiler &) = delete;
+
+  gcc_const
+  static const char *GetStageName(Stage stage);
+
+  void Reset();
+
+  /**
+   * @param lane the row in the Chrome trace
+   */
+  void Add(Stage stage, uint64_t start_us, uint64_t end_us,
+           unsigned lane=1);
+
+  const StageStats &GetStats(Stage stage) const {
+    return stages[unsigned(stage)];
+  }
+
+  /**
+   * Write a one-line summary of each stage to the log file.
+   */
+  void LogSummary() const;
+
+  /**
+   * Write the recent events in the Chrome trace format (JSON), with
+   * the statistics of each stage in "otherData".
+   */
+  void WriteChromeTrace(BufferedOutputStream &os) const;
+
+  /**
+   * Write the Chrome trace to a file.
+   *
+   * Throws std::runtime_error on error.
+   */
+  void WriteChromeTrace(Path path) const;
+};
+
+/**
+ * Measures the duration of the enclosing scope and adds it to the
+ * #ComputerProfiler.
+ */
+class ScopeProfile {
+  ComputerProfiler &profiler;
+  const ComputerProfiler::Stage stage;
+  const unsigned lane;
+  const uint64_t start_us;
+
+public:
+  ScopeProfile(ComputerProfiler &_profiler, ComputerProfiler::Stage _stage,
+               unsigned _lane=1)
+    :profiler(_profiler), stage(_stage), lane(_lane),
+     start_us(MonotonicClockUS()) {}
+
+  ~ScopeProfile() {
+    profiler.Add(stage, start_us, MonotonicClockUS(), lane);
+  }
+
+  ScopeProfile(const ScopeProfile &) = delete;
+  ScopeProfile &operator=(const ScopeProfile &) = delete;
+};
+
+#endif
@@ -145,6 +145,8 @@ RouteComputer::Reach(const MoreData &basic, DerivedInfo &calculated,
                                (int)calculated.common_stats.height_max_working));
 
   if (reach_clock.CheckAdvance(basic.time, PERIOD)) {
+    /* no incremental solve: checking the recycled fans against the
+       terrain costs more than scanning them again */
     protected_route_planner.SolveReach(start, config, h_ceiling, do_solve);
 
     if (do_solve) {
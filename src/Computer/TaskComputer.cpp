@@ -42,10 +42,13 @@ TaskComputer::TaskComputer(ProtectedTaskManager &_task,
                            const Airspaces &airspace_database,
                            const ProtectedAirspaceWarningManager *warnings)
   :task(_task),
+   worker_pool(WorkerPool::GetDefaultThreads(3)),
    route(airspace_database, warnings),
-   contest(trace.GetFull(), trace.GetContest(), trace.GetSprint())
+   contest(&worker_pool,
+           trace.GetFull(), trace.GetContest(), trace.GetSprint())
 {
   task.SetRoutePlanner(&route.GetRoutePlanner());
+  task.SetExecutor(&worker_pool);
 }
 
 void
@@ -146,9 +149,9 @@ Predicted(const ContestSettings &settings,
 }
 
 void
-TaskComputer::ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
-                          const ComputerSettings &settings_computer,
-                          bool exhaustive)
+TaskComputer::ProcessContest(const MoreData &basic, DerivedInfo &calculated,
+                             const ComputerSettings &settings_computer,
+                             bool exhaustive)
 {
   contest.SetPredicted(Predicted(settings_computer.contest, basic,
                                  calculated.task_stats.current_leg));
@@ -158,7 +161,12 @@ TaskComputer::ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
                             calculated.contest_stats);
   else
     contest.Solve(settings_computer.contest, calculated.contest_stats);
+}
 
+void
+TaskComputer::ProcessIdleTask(const MoreData &basic,
+                              const DerivedInfo &calculated)
+{
   const AircraftState as = ToAircraftState(basic, calculated);
 
   ProtectedTaskManager::ExclusiveLease _task(task);
@@ -27,6 +27,7 @@ Copyright_License {
 #include "RouteComputer.hpp"
 #include "TraceComputer.hpp"
 #include "ContestComputer.hpp"
+#include "Thread/WorkerPool.hpp"
 #include "Engine/Navigation/Aircraft.hpp"
 #include "NMEA/Validity.hpp"
 
@@ -38,6 +39,13 @@ class TaskComputer
 {
   ProtectedTaskManager &task;
 
+  /**
+   * Shared by the contest solvers and the evaluation of the
+   * abort/alternate landables.  Both run in the calculation thread,
+   * never at the same time.
+   */
+  WorkerPool worker_pool;
+
   RouteComputer route;
 
   TraceComputer trace;
@@ -101,9 +109,20 @@ public:
    */
   void ProcessAutoTask(const NMEAInfo &basic, const DerivedInfo &calculated);
 
-  void ProcessIdle(const MoreData &basic, DerivedInfo &calculated,
-                   const ComputerSettings &settings_computer,
-                   bool exhaustive=false);
+  /**
+   * Update the contest solvers and DerivedInfo::contest_stats.
+   * This uses the #WorkerPool, and must therefore not run in
+   * parallel with ProcessIdleTask().
+   */
+  void ProcessContest(const MoreData &basic, DerivedInfo &calculated,
+                      const ComputerSettings &settings_computer,
+                      bool exhaustive=false);
+
+  /**
+   * Run the slow task calculations (e.g. the alternates).  This
+   * modifies only the task manager.
+   */
+  void ProcessIdleTask(const MoreData &basic, const DerivedInfo &calculated);
 };
 
 #endif
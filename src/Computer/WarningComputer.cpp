@@ -37,6 +37,20 @@ WarningComputer::WarningComputer(const AirspaceWarningConfig &_config,
 {
 }
 
+void
+WarningComputer::UpdateAirspaces(const ComputerSettings &settings_computer,
+                                 const MoreData &basic,
+                                 const DerivedInfo &calculated)
+{
+  if (!basic.time_available)
+    return;
+
+  airspaces.SetFlightLevels(settings_computer.pressure);
+
+  AirspaceActivity day(calculated.date_time_local.day_of_week);
+  airspaces.SetActivity(day);
+}
+
 void
 WarningComputer::Update(const ComputerSettings &settings_computer,
                         const MoreData &basic,
@@ -54,11 +68,6 @@ WarningComputer::Update(const ComputerSettings &settings_computer,
   if (dt <= 0)
     return;
 
-  airspaces.SetFlightLevels(settings_computer.pressure);
-
-  AirspaceActivity day(calculated.date_time_local.day_of_week);
-  airspaces.SetActivity(day);
-
   if (!settings_computer.airspace.enable_warnings ||
       !basic.location_available || !basic.NavAltitudeAvailable()) {
     if (initialised) {
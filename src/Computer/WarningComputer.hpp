@@ -64,6 +64,16 @@ public:
     initialised = false;
   }
 
+  /**
+   * Apply the QNH and the day of week to the #Airspaces.  This
+   * modifies the airspace objects which are shared with the route
+   * planner, and must not run in parallel with anything that reads
+   * them; therefore it is separate from Update().
+   */
+  void UpdateAirspaces(const ComputerSettings &settings_computer,
+                       const MoreData &basic,
+                       const DerivedInfo &calculated);
+
   void Update(const ComputerSettings &settings_computer,
               const MoreData &basic,
               const DerivedInfo &calculated,
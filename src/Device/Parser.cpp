@@ -28,6 +28,7 @@ Copyright_License {
 #include "NMEA/Info.hpp"
 #include "NMEA/Checksum.hpp"
 #include "NMEA/InputLine.hpp"
+#include "NMEA/SentenceId.hpp"
 #include "Units/System.hpp"
 #include "Driver/FLARM/StaticParser.hpp"
 #include "Util/CharUtil.hxx"
@@ -62,55 +63,55 @@ NMEAParser::ParseLine(const char *string, NMEAInfo &info)
   line.Read(type, 16);
 
   if (IsAlphaASCII(type[1]) && IsAlphaASCII(type[2])) {
-    if (StringIsEqual(type + 3, "GSA"))
+    switch (NMEASentenceId(type + 3)) {
+    case NMEASentenceId("GSA"):
       return GSA(line, info);
 
-    if (StringIsEqual(type + 3, "GLL"))
+    case NMEASentenceId("GLL"):
       return GLL(line, info);
 
-    if (StringIsEqual(type + 3, "RMC"))
+    case NMEASentenceId("RMC"):
       return RMC(line, info);
 
-    if (StringIsEqual(type + 3, "GGA"))
+    case NMEASentenceId("GGA"):
       return GGA(line, info);
 
-    if (StringIsEqual(type + 3, "HDM"))
+    case NMEASentenceId("HDM"):
       return HDM(line, info);
 
-    if (StringIsEqual(type + 3, "MWV"))
+    case NMEASentenceId("MWV"):
       return MWV(line, info);
+    }
   }
 
   // if (proprietary sentence) ...
   if (type[1] == 'P') {
+    switch (NMEASentenceId(type + 1)) {
     // Airspeed and vario sentence
-    if (StringIsEqual(type + 1, "PTAS1"))
+    case NMEASentenceId("PTAS1"):
       return PTAS1(line, info);
 
     // FLARM sentences
-    if (StringIsEqual(type + 1, "PFLAE")) {
+    case NMEASentenceId("PFLAE"):
       ParsePFLAE(line, info.flarm.error, info.clock);
       return true;
-    }
 
-    if (StringIsEqual(type + 1, "PFLAV")) {
+    case NMEASentenceId("PFLAV"):
       ParsePFLAV(line, info.flarm.version, info.clock);
       return true;
-    }
 
-    if (StringIsEqual(type + 1, "PFLAA")) {
+    case NMEASentenceId("PFLAA"):
       ParsePFLAA(line, info.flarm.traffic, info.clock);
       return true;
-    }
 
-    if (StringIsEqual(type + 1, "PFLAU")) {
+    case NMEASentenceId("PFLAU"):
       ParsePFLAU(line, info.flarm.status, info.clock);
       return true;
-    }
 
     // Garmin altitude sentence
-    if (StringIsEqual(type + 1, "PGRMZ"))
+    case NMEASentenceId("PGRMZ"):
       return RMZ(line, info);
+    }
 
     return false;
   }
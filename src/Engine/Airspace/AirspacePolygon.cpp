@@ -26,6 +26,8 @@
 #include "AirspaceIntersectSort.hpp"
 #include "AirspaceIntersectionVector.hpp"
 
+#include <algorithm>
+
 AirspacePolygon::AirspacePolygon(const std::vector<GeoPoint> &pts,
                                  const bool prune)
   :AbstractAirspace(Shape::POLYGON)
@@ -79,10 +81,19 @@ AirspacePolygon::GetCenter() const
   return GeoPoint(Angle::Native(lon), Angle::Native(lat));
 }
 
+void
+AirspacePolygon::Project(const FlatProjection &projection)
+{
+  AbstractAirspace::Project(projection);
+  packed.Build(m_border);
+}
+
 bool
 AirspacePolygon::Inside(const GeoPoint &loc) const
 {
-  return m_border.IsInside(loc);
+  return packed.IsDefined()
+    ? packed.IsInside(loc)
+    : m_border.IsInside(loc);
 }
 
 AirspaceIntersectionVector
@@ -94,6 +105,29 @@ AirspacePolygon::Intersects(const GeoPoint &start, const GeoPoint &end,
 
   AirspaceIntersectSort sorter(start, *this);
 
+  if (packed.IsDefined()) {
+    /* only edges whose bounding box overlaps the ray's can intersect
+       it; they are visited in the same order as below */
+    const FlatGeoPoint &a = ray.point;
+    const FlatGeoPoint b = ray.point + ray.vector;
+    const FlatBoundingBox box(FlatGeoPoint(std::min(a.x, b.x),
+                                           std::min(a.y, b.y)),
+                              FlatGeoPoint(std::max(a.x, b.x),
+                                           std::max(a.y, b.y)));
+
+    std::vector<unsigned> edges;
+    packed.FindEdges(box, edges);
+
+    for (unsigned i : edges) {
+      const FlatRay r_seg(packed.GetFlatPoint(i), packed.GetFlatPoint(i + 1));
+      auto t = ray.DistinctIntersection(r_seg);
+      if (t >= 0)
+        sorter.add(t, projection.Unproject(ray.Parametric(t)));
+    }
+
+    return sorter.all();
+  }
+
   for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
 
     const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
@@ -27,12 +27,23 @@
 #include "AirspaceIntersectionVisitor.hpp"
 #include "AirspaceAircraftPerformance.hpp"
 #include "Task/Stats/TaskStats.hpp"
+#include "Geo/Flat/BoostFlatBoundingBox.hpp"
+
+#include <boost/geometry/geometries/linestring.hpp>
+#include <boost/geometry/algorithms/intersects.hpp>
 
 #define CRUISE_FILTER_FACT 0.5
 
+/**
+ * The candidate box is this much larger than the area swept by the
+ * prediction vectors [m], so the candidate list can be reused for a
+ * while.
+ */
+static constexpr double CANDIDATE_MARGIN = 2000;
+
 AirspaceWarningManager::AirspaceWarningManager(const AirspaceWarningConfig &_config,
                                                const Airspaces &_airspaces)
-  :airspaces(_airspaces), serial(0)
+  :airspaces(_airspaces), serial(0), candidates_valid(false)
 {
   /* force filter initialisation in the first SetConfig() call */
   config.warning_time = -1;
@@ -136,11 +147,24 @@ AirspaceWarningManager::Update(const AircraftState& state,
   for (auto &w : warnings)
     w.SaveState();
 
+  /* collect the prediction vectors first, so the airspaces near all
+     of them can be obtained with one query */
+  PredictionList predictions;
+  PredictGlide(state, glide_polar, predictions);
+  PredictFilter(state, circling, predictions);
+  PredictTask(state, glide_polar, task_stats, predictions);
+
+  const FlatProjection &projection = GetProjection();
+  FlatBoundingBox box(projection.ProjectInteger(state.location));
+  for (const auto &p : predictions)
+    box.Expand(projection.ProjectInteger(p.location));
+
+  UpdateCandidates(state, box);
+
   // check from strongest to weakest alerts
   UpdateInside(state, glide_polar);
-  UpdateGlide(state, glide_polar);
-  UpdateFilter(state, circling);
-  UpdateTask(state, glide_polar, task_stats);
+  for (const auto &p : predictions)
+    UpdatePredicted(state, p);
 
   // action changes
   for (auto it = warnings.begin(), end = warnings.end(); it != end;) {
@@ -243,6 +267,18 @@ public:
     }
   }
 
+  /**
+   * Cheap checks which rule out an airspace before its intersections
+   * are calculated.  Intersection() repeats them.
+   */
+  bool IsCandidate(const AbstractAirspace &airspace) const {
+    if (ExcludeAltitude(airspace))
+      return false;
+
+    const AirspaceWarning *warning = warning_manager.GetWarningPtr(airspace);
+    return warning == nullptr || warning->IsStateAccepted(warning_state);
+  }
+
   void Visit(const AbstractAirspace &as) override {
     Intersection(as);
   }
@@ -261,7 +297,7 @@ public:
   }
 
 private:
-  bool ExcludeAltitude(const AbstractAirspace& airspace) {
+  bool ExcludeAltitude(const AbstractAirspace& airspace) const {
     if (max_alt <= 0)
       return false;
 
@@ -270,18 +306,52 @@ private:
 };
 
 
+void
+AirspaceWarningManager::UpdateCandidates(const AircraftState &state,
+                                         const FlatBoundingBox &box)
+{
+  const FlatProjection &projection = GetProjection();
+
+  if (!candidates_valid || candidate_serial != airspaces.GetSerial() ||
+      !candidate_box.IsInside(box.GetLowerLeft()) ||
+      !candidate_box.IsInside(box.GetUpperRight())) {
+    candidate_box = box;
+    candidate_box.Grow(projection.ProjectRangeInteger(state.location,
+                                                      CANDIDATE_MARGIN));
+
+    candidates.clear();
+    for (const auto &i : airspaces.QueryIntersecting(candidate_box))
+      candidates.push_back({&i, false, false});
+
+    candidate_serial = airspaces.GetSerial();
+    candidates_valid = true;
+  }
+
+  const auto flat_location = projection.ProjectInteger(state.location);
+
+  for (auto &c : candidates) {
+    const AbstractAirspace &airspace = c.airspace->GetAirspace();
+    const FlatBoundingBox &bounds = *c.airspace;
+
+    c.enabled = airspace.IsActive() &&
+      config.IsClassEnabled(airspace.GetType());
+
+    /* same as Airspaces::QueryInside() */
+    c.inside = c.enabled && bounds.IsInside(flat_location) &&
+      c.airspace->IsInside(state.location);
+  }
+}
+
 bool 
-AirspaceWarningManager::UpdatePredicted(const AircraftState& state, 
-                                         const GeoPoint &location_predicted,
-                                         const AirspaceAircraftPerformance &perf,
-                                         const AirspaceWarning::State warning_state,
-                                        const double max_time)
+AirspaceWarningManager::UpdatePredicted(const AircraftState &state,
+                                        const Prediction &prediction)
 {
   // this is the time limit of intrusions, beyond which we are not interested.
   // it can be the minimum of the user set warning time, or the time of the 
   // task segment
 
-  const auto max_time_limit = std::min(double(config.warning_time), max_time);
+  const auto max_time_limit = std::min(double(config.warning_time),
+                                       prediction.max_time);
 
   // the ceiling is the max height for predicted intrusions, given
   // that you may be climbing.  the ceiling is nominally set at 1000m
@@ -294,41 +364,59 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
   const auto ceiling = state.altitude
     + std::max((unsigned)1000, config.altitude_warning_margin);
 
-  AirspaceIntersectionWarningVisitor visitor(state, perf, 
-                                             *this, 
-                                             warning_state, max_time_limit,
+  AirspaceIntersectionWarningVisitor visitor(state, prediction.perf,
+                                             *this,
+                                             prediction.warning_state,
+                                             max_time_limit,
                                              ceiling);
 
-  airspaces.VisitIntersecting(state.location, location_predicted, visitor);
+  /* like Airspaces::VisitIntersecting(), but on the candidate list,
+     and the intersections are calculated only for airspaces which
+     pass the visitor's cheap checks */
+  const FlatProjection &projection = GetProjection();
+  boost::geometry::model::linestring<FlatGeoPoint> line;
+  line.push_back(projection.ProjectInteger(state.location));
+  line.push_back(projection.ProjectInteger(prediction.location));
+
+  for (const auto &c : candidates) {
+    const AbstractAirspace &airspace = c.airspace->GetAirspace();
+    const FlatBoundingBox &bounds = *c.airspace;
+    if (c.enabled && boost::geometry::intersects(bounds, line) &&
+        visitor.IsCandidate(airspace) &&
+        visitor.SetIntersections(c.airspace->Intersects(state.location,
+                                                        prediction.location,
+                                                        projection)))
+      visitor.Visit(airspace);
+  }
 
   visitor.SetMode(true);
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    const AbstractAirspace &airspace = i.GetAirspace();
-    visitor.Visit(airspace);
-  }
+  for (const auto &c : candidates)
+    if (c.inside)
+      visitor.Visit(c.airspace->GetAirspace());
 
   return visitor.Found();
 }
 
 
-bool 
-AirspaceWarningManager::UpdateTask(const AircraftState &state,
-                                   const GlidePolar &glide_polar,
-                                   const TaskStats &task_stats)
+void
+AirspaceWarningManager::PredictTask(const AircraftState &state,
+                                    const GlidePolar &glide_polar,
+                                    const TaskStats &task_stats,
+                                    PredictionList &predictions)
 {
   if (!glide_polar.IsValid())
-    return false;
+    return;
 
   const ElementStat &current_leg = task_stats.current_leg;
 
   if (!task_stats.task_valid || !current_leg.location_remaining.IsValid())
-    return false;
+    return;
 
   const GlideResult &solution = current_leg.solution_remaining;
   if (!solution.IsOk() || !solution.IsAchievable())
     /* glide solver failed, cannot continue */
-    return false;
+    return;
 
   const AirspaceAircraftPerformance perf_task(glide_polar,
                                               current_leg.solution_remaining);
@@ -342,47 +430,43 @@ AirspaceWarningManager::UpdateTask(const AircraftState &state,
        the configured warning time */
     location_tp = state.location.IntermediatePoint(location_tp, max_distance);
 
-  return UpdatePredicted(state, location_tp, perf_task,
-                          AirspaceWarning::WARNING_TASK, time_remaining);
+  predictions.append(Prediction(AirspaceWarning::WARNING_TASK, location_tp,
+                                perf_task, time_remaining));
 }
 
 
-bool 
-AirspaceWarningManager::UpdateFilter(const AircraftState& state, const bool circling)
+void
+AirspaceWarningManager::PredictFilter(const AircraftState& state,
+                                      const bool circling,
+                                      PredictionList &predictions)
 {
   // update both filters even though we are using only one
   cruise_filter.Update(state);
   circling_filter.Update(state);
 
-  const GeoPoint location_predicted = circling?
-    circling_filter.GetPredictedState(prediction_time_filter).location:
-    cruise_filter.GetPredictedState(prediction_time_filter).location;
-
-  if (circling) 
-    return UpdatePredicted(state, location_predicted,
-                           AirspaceAircraftPerformance(circling_filter),
-                            AirspaceWarning::WARNING_FILTER, prediction_time_filter);
-  else
-    return UpdatePredicted(state, location_predicted,
-                           AirspaceAircraftPerformance(cruise_filter),
-                            AirspaceWarning::WARNING_FILTER, prediction_time_filter);
+  const AircraftStateFilter &filter = circling
+    ? circling_filter
+    : cruise_filter;
+
+  predictions.append(Prediction(AirspaceWarning::WARNING_FILTER,
+                                filter.GetPredictedState(prediction_time_filter).location,
+                                AirspaceAircraftPerformance(filter),
+                                prediction_time_filter));
 }
 
 
-bool 
-AirspaceWarningManager::UpdateGlide(const AircraftState &state,
-                                    const GlidePolar &glide_polar)
+void
+AirspaceWarningManager::PredictGlide(const AircraftState &state,
+                                     const GlidePolar &glide_polar,
+                                     PredictionList &predictions)
 {
   if (!glide_polar.IsValid())
-    return false;
-
-  const GeoPoint location_predicted = 
-    state.GetPredictedState(prediction_time_glide).location;
+    return;
 
-  const AirspaceAircraftPerformance perf_glide(glide_polar);
-  return UpdatePredicted(state, location_predicted,
-                          perf_glide,
-                          AirspaceWarning::WARNING_GLIDE, prediction_time_glide);
+  predictions.append(Prediction(AirspaceWarning::WARNING_GLIDE,
+                                state.GetPredictedState(prediction_time_glide).location,
+                                AirspaceAircraftPerformance(glide_polar),
+                                prediction_time_glide));
 }
 
 bool
@@ -394,14 +478,14 @@ AirspaceWarningManager::UpdateInside(const AircraftState& state,
 
   bool found = false;
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    const AbstractAirspace &airspace = i.GetAirspace();
+  for (const auto &i : candidates) {
+    if (!i.inside)
+      continue;
+
+    const AbstractAirspace &airspace = i.airspace->GetAirspace();
 
     const AltitudeState &altitude = state;
-    if (// ignore inactive airspaces
-        !airspace.IsActive() ||
-        !config.IsClassEnabled(airspace.GetType()) ||
-        !airspace.Inside(altitude))
+    if (!airspace.Inside(altitude))
       continue;
 
     AirspaceWarning *warning = GetWarningPtr(airspace);
@@ -24,16 +24,21 @@
 
 #include "AirspaceWarning.hpp"
 #include "AirspaceWarningConfig.hpp"
+#include "AirspaceAircraftPerformance.hpp"
 #include "Util/AircraftStateFilter.hpp"
+#include "Util/Serial.hpp"
+#include "Util/StaticArray.hxx"
+#include "Geo/Flat/FlatBoundingBox.hpp"
 #include "Compiler.h"
 
 #include <list>
+#include <vector>
 
 class TaskStats;
 class GlidePolar;
+class Airspace;
 class Airspaces;
 class FlatProjection;
-class AirspaceAircraftPerformance;
 
 /**
  * Class to detect and track airspace warnings
@@ -66,6 +71,45 @@ class AirspaceWarningManager {
    */
   unsigned serial;
 
+  /**
+   * An airspace near the aircraft, see #candidates.
+   */
+  struct Candidate {
+    const Airspace *airspace;
+
+    /**
+     * Is this airspace active, and are warnings enabled for its
+     * class?  Updated by each Update() call.
+     */
+    bool enabled;
+
+    /**
+     * Is the aircraft inside this airspace (ignoring altitude)?
+     * Updated by each Update() call.
+     */
+    bool inside;
+  };
+
+  /**
+   * The airspaces whose bounding box intersects #candidate_box,
+   * collected by one R-tree query, in the order of the R-tree.  All
+   * checks of one Update() call use this list instead of querying
+   * the tree again, and it is reused by subsequent calls while the
+   * area swept by the prediction vectors remains inside
+   * #candidate_box.
+   */
+  std::vector<Candidate> candidates;
+
+  FlatBoundingBox candidate_box;
+
+  /**
+   * The Airspaces::GetSerial() value #candidates was collected
+   * from.
+   */
+  Serial candidate_serial;
+
+  bool candidates_valid;
+
 public:
   typedef AirspaceWarningList::const_iterator const_iterator;
 
@@ -261,17 +305,47 @@ public:
   bool IsActive(const AbstractAirspace &airspace) const;
 
 private:
-  bool UpdateTask(const AircraftState &state, const GlidePolar &glide_polar,
-                  const TaskStats &task_stats);
-  bool UpdateFilter(const AircraftState& state, const bool circling);
-  bool UpdateGlide(const AircraftState& state, const GlidePolar &glide_polar);
+  /**
+   * A prediction vector: from the current location to #location,
+   * flown with the given performance.
+   */
+  struct Prediction {
+    AirspaceWarning::State warning_state;
+    GeoPoint location;
+    AirspaceAircraftPerformance perf;
+    double max_time;
+
+    Prediction()
+      :perf(AirspaceAircraftPerformance::Simple()) {}
+
+    Prediction(AirspaceWarning::State _warning_state,
+               const GeoPoint &_location,
+               const AirspaceAircraftPerformance &_perf,
+               double _max_time)
+      :warning_state(_warning_state), location(_location),
+       perf(_perf), max_time(_max_time) {}
+  };
+
+  typedef StaticArray<Prediction, 3> PredictionList;
+
+  /**
+   * Make sure #candidates covers the given box, and update the
+   * per-update attributes of all candidates.
+   */
+  void UpdateCandidates(const AircraftState &state,
+                        const FlatBoundingBox &box);
+
+  void PredictTask(const AircraftState &state, const GlidePolar &glide_polar,
+                   const TaskStats &task_stats, PredictionList &predictions);
+  void PredictFilter(const AircraftState& state, const bool circling,
+                     PredictionList &predictions);
+  void PredictGlide(const AircraftState& state, const GlidePolar &glide_polar,
+                    PredictionList &predictions);
+
   bool UpdateInside(const AircraftState& state, const GlidePolar &glide_polar);
 
-  bool UpdatePredicted(const AircraftState& state, 
-                       const GeoPoint &location_predicted,
-                       const AirspaceAircraftPerformance &perf,
-                       const AirspaceWarning::State warning_state,
-                       double max_time);
+  bool UpdatePredicted(const AircraftState &state,
+                       const Prediction &prediction);
 };
 
 #endif
@@ -25,11 +25,14 @@
 #include "AirspaceIntersectionVisitor.hpp"
 #include "Predicate/AirspacePredicate.hpp"
 #include "Navigation/Aircraft.hpp"
+#include "Util/ParallelExecutor.hpp"
 
 #include <boost/geometry/geometries/linestring.hpp>
 #include <boost/geometry/algorithms/intersection.hpp>
 #include <boost/geometry/strategies/strategies.hpp>
 
+#include <algorithm>
+
 namespace bgi = boost::geometry::index;
 
 Airspaces::const_iterator_range
@@ -58,6 +61,16 @@ Airspaces::QueryIntersecting(const GeoPoint &a, const GeoPoint &b) const
   return {airspace_tree.qbegin(bgi::intersects(line)), airspace_tree.qend()};
 }
 
+Airspaces::const_iterator_range
+Airspaces::QueryIntersecting(const FlatBoundingBox &box) const
+{
+  if (IsEmpty())
+    // nothing to do
+    return {airspace_tree.qend(), airspace_tree.qend()};
+
+  return {airspace_tree.qbegin(bgi::intersects(box)), airspace_tree.qend()};
+}
+
 void
 Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
                              bool include_inside,
@@ -84,12 +97,14 @@ Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
 }
 
 void
-Airspaces::Optimise()
+Airspaces::Optimise(ParallelExecutor *executor)
 {
   if (IsEmpty())
     /* avoid assertion failure in uninitialised task_projection */
     return;
 
+  std::vector<Airspace> items;
+
   if (!owns_children || task_projection.Update()) {
     // dont update task_projection if not owner!
 
@@ -100,15 +115,35 @@ Airspaces::Optimise()
       tmp_as.push_back(&i.GetAirspace());
 
     airspace_tree.clear();
+  } else {
+    /* keep the envelopes of the airspaces which are already in the
+       tree */
+    items.reserve(airspace_tree.size() + tmp_as.size());
+    items.insert(items.end(), airspace_tree.begin(), airspace_tree.end());
   }
 
-  for (AbstractAirspace *i : tmp_as) {
-    Airspace as(*i, task_projection);
-    airspace_tree.insert(as);
-  }
+  /* projecting the border is independent for each airspace; split
+     the new ones into chunks which may run in parallel */
+  const unsigned n = tmp_as.size();
+  std::vector<FlatBoundingBox> boxes(n);
+
+  const unsigned n_chunks = std::min(n / 64 + 1, 64u);
+  ParallelForEach(executor, n_chunks, [this, n, n_chunks, &boxes](unsigned chunk){
+      const unsigned end = (unsigned long)n * (chunk + 1) / n_chunks;
+      for (unsigned i = (unsigned long)n * chunk / n_chunks; i < end; ++i)
+        boxes[i] = tmp_as[i]->GetBoundingBox(task_projection);
+    });
+
+  for (unsigned i = 0; i < n; ++i)
+    items.emplace_back(*tmp_as[i], boxes[i]);
 
   tmp_as.clear();
 
+  /* bulk loading packs the tree much better than inserting one
+     airspace after another, and it is faster */
+  AirspaceTree tree(items.begin(), items.end());
+  airspace_tree.swap(tree);
+
   ++serial;
 }
 
@@ -159,6 +194,8 @@ Airspaces::Clear()
 
   // then delete the tree
   airspace_tree.clear();
+
+  ++serial;
 }
 
 unsigned
@@ -33,6 +33,7 @@
 #include <deque>
 
 class RasterTerrain;
+class ParallelExecutor;
 class AirspaceIntersectionVisitor;
 class AirspacePredicate;
 
@@ -97,8 +98,13 @@ public:
    * Re-organise the internal airspace tree after inserting/deleting.
    * Should be called after inserting/deleting airspaces prior to performing
    * any searches, but can be done once after a batch insert/delete.
+   *
+   * The tree is rebuilt with bulk loading.
+   *
+   * @param executor if not nullptr, then the new airspaces are
+   * projected in parallel on this executor
    */
-  void Optimise();
+  void Optimise(ParallelExecutor *executor=nullptr);
 
   /**
    * Clear the airspace store, deleting airspace objects if m_owner is true
@@ -170,6 +176,14 @@ public:
   const_iterator_range QueryIntersecting(const GeoPoint &a,
                                          const GeoPoint &b) const;
 
+  /**
+   * Query airspaces whose bounding box intersects the given box,
+   * which is in the projection returned by GetProjection().  The
+   * result is in no specific order.
+   */
+  gcc_pure
+  const_iterator_range QueryIntersecting(const FlatBoundingBox &box) const;
+
   /**
    * Call visitor class on airspaces intersected by vector.
    * Note that the visitor is not instantiated separately for each match
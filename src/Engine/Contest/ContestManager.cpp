@@ -21,6 +21,19 @@
  */
 
 #include "ContestManager.hpp"
+#include "Util/ParallelExecutor.hpp"
+#include "Util/Macros.hpp"
+
+struct ContestManager::Job {
+  AbstractContest &solver;
+  ContestResult &result;
+  ContestTraceVector &solution;
+
+  /**
+   * Set by RunJobs(): did the solver find an improved solution?
+   */
+  bool updated;
+};
 
 ContestManager::ContestManager(const Contest _contest,
                                const Trace &trace_full,
@@ -66,14 +79,47 @@ ContestManager::SetPredicted(const TracePoint &predicted)
     olc_league.Reset();
     olc_plus.Reset();
 
-    if (contest == Contest::OLC_CLASSIC || contest == Contest::OLC_LEAGUE ||
-        contest == Contest::OLC_PLUS)
-      stats.Reset();
+    ResetStats(Contest::OLC_CLASSIC);
+    ResetStats(Contest::OLC_LEAGUE);
+    ResetStats(Contest::OLC_PLUS);
   }
 
-  if (dmst_quad.SetPredicted(predicted) &&
-      contest == Contest::DMST)
+  if (dmst_quad.SetPredicted(predicted))
+    ResetStats(Contest::DMST);
+}
+
+void
+ContestManager::SetScoreAll(bool _score_all)
+{
+  if (_score_all == score_all)
+    return;
+
+  score_all = _score_all;
+
+  /* the solvers of the other contests have not been kept up to date
+     (or will not be anymore); start from scratch */
+  Reset();
+}
+
+void
+ContestManager::ResetStats(Contest _contest)
+{
+  if (score_all)
+    all_stats[unsigned(_contest)].Reset();
+
+  if (contest == _contest)
+    stats.Reset();
+}
+
+void
+ContestManager::CopySelectedStats()
+{
+  assert(score_all);
+
+  if (contest == Contest::NONE)
     stats.Reset();
+  else
+    stats = all_stats[unsigned(contest)];
 }
 
 void
@@ -116,8 +162,32 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+bool
+ContestManager::RunJobs(Job *jobs, unsigned n, bool exhaustive)
+{
+  ParallelForEach(executor, n, [jobs, exhaustive](unsigned i){
+      Job &job = jobs[i];
+      job.updated = RunContest(job.solver, job.result, job.solution,
+                               exhaustive);
+    });
+
+  bool retval = false;
+  for (unsigned i = 0; i < n; ++i)
+    retval |= jobs[i].updated;
+
+  return retval;
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive)
+{
+  return score_all
+    ? UpdateAll(exhaustive)
+    : UpdateSelected(exhaustive);
+}
+
+bool
+ContestManager::UpdateSelected(bool exhaustive)
 {
   bool retval = false;
 
@@ -150,12 +220,13 @@ ContestManager::UpdateIdle(bool exhaustive)
                          stats.solution[0], exhaustive);
     break;
 
-  case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
+  case Contest::OLC_PLUS: {
+    Job jobs[] = {
+      { olc_classic, stats.result[0], stats.solution[0], false },
+      { olc_fai, stats.result[1], stats.solution[1], false },
+    };
 
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+    retval = RunJobs(jobs, ARRAY_SIZE(jobs), exhaustive);
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
@@ -166,25 +237,32 @@ ContestManager::UpdateIdle(bool exhaustive)
     }
 
     break;
+  }
 
   case Contest::DMST:
     retval = RunContest(dmst_quad, stats.result[0],
                         stats.solution[0], exhaustive);
     break;
 
-  case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::XCONTEST: {
+    Job jobs[] = {
+      { xcontest_free, stats.result[0], stats.solution[0], false },
+      { xcontest_triangle, stats.result[1], stats.solution[1], false },
+    };
+
+    retval = RunJobs(jobs, ARRAY_SIZE(jobs), exhaustive);
     break;
+  }
 
-  case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::DHV_XC: {
+    Job jobs[] = {
+      { dhv_xc_free, stats.result[0], stats.solution[0], false },
+      { dhv_xc_triangle, stats.result[1], stats.solution[1], false },
+    };
+
+    retval = RunJobs(jobs, ARRAY_SIZE(jobs), exhaustive);
     break;
+  }
 
   case Contest::SIS_AT:
     retval = RunContest(sis_at, stats.result[0],
@@ -201,10 +279,75 @@ ContestManager::UpdateIdle(bool exhaustive)
   return retval;
 }
 
+bool
+ContestManager::UpdateAll(bool exhaustive)
+{
+  ContestStatistics &sprint = all_stats[unsigned(Contest::OLC_SPRINT)];
+  ContestStatistics &fai = all_stats[unsigned(Contest::OLC_FAI)];
+  ContestStatistics &classic = all_stats[unsigned(Contest::OLC_CLASSIC)];
+  ContestStatistics &league = all_stats[unsigned(Contest::OLC_LEAGUE)];
+  ContestStatistics &plus = all_stats[unsigned(Contest::OLC_PLUS)];
+  ContestStatistics &xcontest = all_stats[unsigned(Contest::XCONTEST)];
+  ContestStatistics &dhv_xc = all_stats[unsigned(Contest::DHV_XC)];
+  ContestStatistics &sisat = all_stats[unsigned(Contest::SIS_AT)];
+  ContestStatistics &netcoupe = all_stats[unsigned(Contest::NET_COUPE)];
+  ContestStatistics &dmst = all_stats[unsigned(Contest::DMST)];
+
+  /* first run all solvers which work directly on the traces; they
+     are independent of each other */
+  Job jobs[] = {
+    { olc_classic, classic.result[0], classic.solution[0], false },
+    { olc_fai, fai.result[0], fai.solution[0], false },
+    { olc_sprint, sprint.result[0], sprint.solution[0], false },
+    { dmst_quad, dmst.result[0], dmst.solution[0], false },
+    { xcontest_free, xcontest.result[0], xcontest.solution[0], false },
+    { xcontest_triangle, xcontest.result[1], xcontest.solution[1], false },
+    { dhv_xc_free, dhv_xc.result[0], dhv_xc.solution[0], false },
+    { dhv_xc_triangle, dhv_xc.result[1], dhv_xc.solution[1], false },
+    { sis_at, sisat.result[0], sisat.solution[0], false },
+    { net_coupe, netcoupe.result[0], netcoupe.solution[0], false },
+  };
+
+  bool retval = RunJobs(jobs, ARRAY_SIZE(jobs), exhaustive);
+
+  const bool classic_updated = jobs[0].updated;
+  const bool fai_updated = jobs[1].updated;
+
+  /* now the contests which are derived from the OLC Classic and OLC
+     FAI solutions, with the same layout as in UpdateSelected() */
+
+  if (classic_updated) {
+    league.result[1] = plus.result[0] = classic.result[0];
+    league.solution[1] = plus.solution[0] = classic.solution[0];
+  }
+
+  if (fai_updated) {
+    plus.result[1] = fai.result[0];
+    plus.solution[1] = fai.solution[0];
+  }
+
+  olc_league.Feed(league.solution[1]);
+  retval |= RunContest(olc_league, league.result[0],
+                       league.solution[0], exhaustive);
+
+  if (classic_updated || fai_updated) {
+    olc_plus.Feed(plus.result[0], plus.solution[0],
+                  plus.result[1], plus.solution[1]);
+
+    RunContest(olc_plus, plus.result[2], plus.solution[2], exhaustive);
+  }
+
+  CopySelectedStats();
+  return retval;
+}
+
 void
 ContestManager::Reset()
 {
   stats.Reset();
+  for (auto &i : all_stats)
+    i.Reset();
+
   olc_sprint.Reset();
   olc_fai.Reset();
   olc_classic.Reset();
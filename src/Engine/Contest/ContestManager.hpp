@@ -36,7 +36,10 @@
 #include "Solvers/NetCoupe.hpp"
 #include "ContestStatistics.hpp"
 
+#include <assert.h>
+
 class Trace;
+class ParallelExecutor;
 
 /**
  * Special task holder for Online Contest calculations
@@ -49,6 +52,24 @@ class ContestManager
 
   ContestStatistics stats;
 
+  /**
+   * Run independent solvers on this object, or sequentially if
+   * nullptr.
+   */
+  ParallelExecutor *executor = nullptr;
+
+  /**
+   * Solve all contests, not just the selected one?  See
+   * SetScoreAll().
+   */
+  bool score_all = false;
+
+  /**
+   * The statistics of every contest, indexed by #Contest.  Only
+   * maintained if #score_all is set.
+   */
+  ContestStatistics all_stats[unsigned(Contest::NONE)];
+
   OLCSprint olc_sprint;
   OLCFAI olc_fai;
   OLCClassic olc_classic;
@@ -92,8 +113,30 @@ public:
 
   void SetContest(Contest _contest) {
     contest = _contest;
+
+    if (score_all)
+      CopySelectedStats();
+  }
+
+  /**
+   * Run independent solvers concurrently on the given executor.
+   * Pass nullptr to solve sequentially in the calling thread.  The
+   * #Trace objects must not be modified while UpdateIdle() runs.
+   */
+  void SetExecutor(ParallelExecutor *_executor) {
+    executor = _executor;
   }
 
+  /**
+   * Enable or disable the "score all" mode: UpdateIdle() solves
+   * every supported contest against the same traces, sharing solvers
+   * between contests which use the same rules (e.g. OLC Classic is
+   * solved only once for Classic, League and Plus).  The results are
+   * available from GetStats(Contest); GetStats() still returns the
+   * selected contest.
+   */
+  void SetScoreAll(bool _score_all);
+
   void SetHandicap(unsigned handicap);
 
   /**
@@ -130,6 +173,39 @@ public:
   const ContestStatistics &GetStats() const {
     return stats;
   }
+
+  /**
+   * Returns the statistics of the given contest.  Only available in
+   * "score all" mode.
+   */
+  const ContestStatistics &GetStats(Contest _contest) const {
+    assert(score_all);
+    assert(_contest != Contest::NONE);
+
+    return all_stats[unsigned(_contest)];
+  }
+
+private:
+  struct Job;
+
+  /**
+   * Run the given solvers, concurrently if an executor was set.
+   * Each job writes only to its own result and solution, therefore
+   * the merged statistics do not depend on the execution order.
+   *
+   * @return true if at least one solver found an improved solution
+   */
+  bool RunJobs(Job *jobs, unsigned n, bool exhaustive);
+
+  bool UpdateSelected(bool exhaustive);
+  bool UpdateAll(bool exhaustive);
+
+  /**
+   * Reset the statistics of the given contest.
+   */
+  void ResetStats(Contest _contest);
+
+  void CopySelectedStats();
 };
 
 #endif
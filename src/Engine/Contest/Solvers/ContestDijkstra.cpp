@@ -25,6 +25,7 @@ Copyright_License {
 #include "../ContestResult.hpp"
 #include "Trace/Trace.hpp"
 #include "Cast.hpp"
+#include "Geo/Flat/FlatDistanceBatch.hpp"
 
 #include <algorithm>
 #include <assert.h>
@@ -239,27 +240,31 @@ ContestDijkstra::AddEdges(const ScanTaskPoint origin,
 
   const unsigned weight = GetStageWeight(origin.GetStageNumber());
 
-  bool previous_above = false;
-  for (const ScanTaskPoint end(destination.GetStageNumber(), n_points);
-       destination != end; destination.IncrementPointIndex()) {
-    bool above = GetPoint(destination).GetIntegerAltitude() >= min_altitude;
+  const unsigned first = destination.GetPointIndex();
+  if (first < n_points) {
+    /* calculate the distances to all candidates of this stage in one
+       batch */
+    const unsigned n = n_points - first;
+    edge_distances.resize(n);
+    FlatDistanceBatch(GetPoint(origin).GetFlatLocation(),
+                      flat_x.data() + first, flat_y.data() + first,
+                      n, edge_distances.data());
+
+    bool previous_above = false;
+    for (unsigned i = 0; i < n; ++i, destination.IncrementPointIndex()) {
+      bool above = GetPoint(destination).GetIntegerAltitude() >= min_altitude;
 
-    if (above) {
-      const unsigned d = weight * CalcEdgeDistance(origin, destination);
-      Link(destination, origin, d);
-    } else if (previous_above) {
       /* After excessive thinning, the exact TracePoint that matches
          the required altitude difference may be gone, and the
-         calculated result becomes overly pessimistic.  This code path
-         makes it optimistic, by checking if the previous point
-         matches. */
+         calculated result becomes overly pessimistic.  Checking if
+         the previous point matches makes it optimistic. */
 
       /* TODO: interpolate the distance */
-      const unsigned d = weight * CalcEdgeDistance(origin, destination);
-      Link(destination, origin, d);
-    }
+      if (above || previous_above)
+        Link(destination, origin, weight * edge_distances[i]);
 
-    previous_above = above;
+      previous_above = above;
+    }
   }
 
   if (IsFinal(destination) && predicted.IsDefined()) {
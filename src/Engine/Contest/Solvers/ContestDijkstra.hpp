@@ -28,6 +28,8 @@ Copyright_License {
 #include "PathSolvers/NavDijkstra.hpp"
 #include "TraceManager.hpp"
 
+#include <vector>
+
 #include <assert.h>
 
 class Trace;
@@ -66,6 +68,11 @@ class ContestDijkstra : public AbstractContest, protected NavDijkstra, public Tr
    */
   ContestTraceVector solution;
 
+  /**
+   * Scratch buffer for AddEdges().
+   */
+  std::vector<unsigned> edge_distances;
+
 protected:
   /**
    * The index of the first finish candidate.  During incremental
@@ -25,6 +25,8 @@
 #include "Trace/Trace.hpp"
 #include "Util/QuadTree.hpp"
 
+#include <algorithm>
+
 /*
  @todo potential to use 3d convex hull to speed search
 
@@ -61,8 +63,11 @@ OLCTriangle::OLCTriangle(const Trace &_trace,
   : AbstractContest(_finish_alt_diff),
    TraceManager(_trace),
    is_fai(_is_fai), predict(_predict),
+   incremental(false),
    is_closed(false),
    is_complete(false),
+   running(false),
+   solved_points(0),
    max_iterations(1e6),
    max_tree_size(5e5)
 {
@@ -90,9 +95,135 @@ void
 OLCTriangle::ResetBranchAndBound()
 {
   running = false;
+  solved_points = 0;
   branch_and_bound.clear();
 }
 
+void
+OLCTriangle::CandidateQueue::clear()
+{
+  for (auto &bucket : buckets)
+    bucket.clear();
+
+  mask = 0;
+  shift = 0;
+  n = 0;
+  min_key = 0;
+}
+
+void
+OLCTriangle::CandidateQueue::Rescale()
+{
+  /* merge each pair of buckets; bucket i/2 has already been moved
+     when bucket i gets moved */
+  for (unsigned i = 1; i < N_BUCKETS; ++i) {
+    auto &src = buckets[i];
+    auto &dest = buckets[i / 2];
+    dest.insert(dest.end(), src.begin(), src.end());
+    src.clear();
+  }
+
+  ++shift;
+
+  mask = 0;
+  for (unsigned i = 0; i < N_BUCKETS; ++i) {
+    auto &bucket = buckets[i];
+    if (!bucket.empty()) {
+      std::make_heap(bucket.begin(), bucket.end(), Compare);
+      mask |= uint64_t(1) << i;
+    }
+  }
+}
+
+void
+OLCTriangle::CandidateQueue::Push(const CandidateSet &candidate)
+{
+  while ((candidate.df_max >> shift) >= N_BUCKETS)
+    Rescale();
+
+  const unsigned i = candidate.df_max >> shift;
+  auto &bucket = buckets[i];
+  bucket.push_back(candidate);
+  std::push_heap(bucket.begin(), bucket.end(), Compare);
+
+  mask |= uint64_t(1) << i;
+  ++n;
+}
+
+OLCTriangle::CandidateSet
+OLCTriangle::CandidateQueue::Pop(unsigned i)
+{
+  auto &bucket = buckets[i];
+  assert(!bucket.empty());
+
+  std::pop_heap(bucket.begin(), bucket.end(), Compare);
+  const CandidateSet result = bucket.back();
+  bucket.pop_back();
+
+  if (bucket.empty())
+    mask &= ~(uint64_t(1) << i);
+  --n;
+
+  return result;
+}
+
+OLCTriangle::CandidateSet
+OLCTriangle::CandidateQueue::PopMax()
+{
+  assert(!empty());
+
+  return Pop(GetHighestBucket());
+}
+
+OLCTriangle::CandidateSet
+OLCTriangle::CandidateQueue::PopAbove(unsigned key)
+{
+  assert(!empty());
+
+  const unsigned first = key >> shift;
+  const uint64_t above = first < N_BUCKETS
+    ? mask & (~uint64_t(0) << first)
+    : 0;
+
+  return above != 0
+    ? Pop(__builtin_ctzll(above))
+    : PopMax();
+}
+
+void
+OLCTriangle::CandidateQueue::PruneBelow(unsigned key)
+{
+  if (key <= min_key)
+    return;
+
+  min_key = key;
+
+  const unsigned last = std::min(key >> shift, N_BUCKETS);
+  for (unsigned i = 0; i < last; ++i) {
+    n -= buckets[i].size();
+    buckets[i].clear();
+    mask &= ~(uint64_t(1) << i);
+  }
+
+  if (last == N_BUCKETS)
+    return;
+
+  auto &bucket = buckets[last];
+  const auto end =
+    std::remove_if(bucket.begin(), bucket.end(),
+                   [key](const CandidateSet &c){ return c.df_max < key; });
+  if (end == bucket.end())
+    return;
+
+  n -= std::distance(end, bucket.end());
+  bucket.erase(end, bucket.end());
+
+  if (bucket.empty())
+    mask &= ~(uint64_t(1) << last);
+  else
+    std::make_heap(bucket.begin(), bucket.end(), Compare);
+}
+
 gcc_pure
 static double
 CalcLegDistance(const ContestTraceVector &solution, const unsigned index)
@@ -112,17 +243,23 @@ OLCTriangle::UpdateTrace(bool force)
 {
   if (IsMasterAppended()) return; /* unmodified */
 
-  if (force || IsMasterUpdated(false)) {
+  /* in incremental predictive mode, appended points are searched
+     with the previous bound; the tree is rebuilt only if the master
+     trace was thinned */
+  const bool append = !force && CanAppend();
+
+  if (!append && (force || IsMasterUpdated(false))) {
     UpdateTraceFull();
 
     is_complete = false;
 
     best_d = 0;
+    solved_points = 0;
 
     closing_pairs.Clear();
     is_closed = FindClosingPairs(0);
 
-   } else if (is_complete && incremental) {
+   } else if ((is_complete || append) && incremental) {
     const unsigned old_size = n_points;
     if (UpdateTraceTail()) {
       is_complete = false;
@@ -153,6 +290,8 @@ OLCTriangle::Solve(bool exhaustive)
   if (!running) {
     // branch and bound is currently in finished state, update trace
     UpdateTrace(exhaustive);
+  } else if (!exhaustive) {
+    AppendRunning();
   }
 
   if (!is_complete || running) {
@@ -173,6 +312,32 @@ OLCTriangle::Solve(bool exhaustive)
   }
 }
 
+void
+OLCTriangle::AppendRunning()
+{
+  if (!incremental || !predict || IsMasterAppended() || CheckMasterSerial())
+    return;
+
+  const unsigned old_size = n_points;
+  if (!UpdateTraceTail())
+    return;
+
+  is_closed = FindClosingPairs(old_size) || is_closed;
+
+  /* add the triangles with a turn point in the new part of the
+     trace to the running tree */
+  const unsigned large_triangle_check =
+    trace_master.ProjectRange(GetPoint(0).GetLocation(), 500000) * 0.99;
+
+  const TurnPointRange all(*this, 0, n_points);
+  const CandidateSet root(all, all, TurnPointRange(*this, old_size, n_points));
+  if (root.IsFeasible(is_fai, large_triangle_check) &&
+      root.df_max >= best_d)
+    branch_and_bound.Push(root);
+
+  tick_iterations = n_points * n_points / 8;
+}
+
 void
 OLCTriangle::SolveTriangle(bool exhaustive)
 {
@@ -274,9 +439,18 @@ OLCTriangle::SolveTriangle(bool exhaustive)
      * one closing pair only (0 -> n_points-1) which allows us to suspend the
      * solver...
      */
-    std::tuple<unsigned, unsigned, unsigned, unsigned> triangle;
+    std::tuple<unsigned, unsigned, unsigned, unsigned> triangle(0, 0, 0, 0);
 
-    triangle = RunBranchAndBound(0, n_points - 1, best_d, false);
+    if (running || !incremental || solved_points < n_points) {
+      /* after a complete run, only the appended points need to be
+         searched */
+      const unsigned first_new = incremental ? solved_points : 0;
+
+      triangle = RunBranchAndBound(0, n_points - 1, best_d, false, first_new);
+
+      if (!running)
+        solved_points = n_points;
+    }
 
     if (std::get<3>(triangle) > best_d) {
       // solution is better than best_d
@@ -306,7 +480,8 @@ OLCTriangle::SolveTriangle(bool exhaustive)
 
 
 std::tuple<unsigned, unsigned, unsigned, unsigned>
-OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, bool exhaustive)
+OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d,
+                               bool exhaustive, unsigned first_new)
 {
   /* Some general information about the branch and bound method can be found here:
    * http://eaton.math.rpi.edu/faculty/Mitchell/papers/leeejem.html
@@ -342,9 +517,13 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
 
     // initialize bound-and-branch tree with root node (note: Candidate set interval is [min, max))
     CandidateSet root_candidates(*this, from, to + 1);
+    if (first_new > from)
+      root_candidates = CandidateSet(root_candidates.tp1, root_candidates.tp2,
+                                     TurnPointRange(*this, first_new, to + 1));
+
     if (root_candidates.IsFeasible(is_fai, large_triangle_check) &&
         root_candidates.df_max >= worst_d)
-      branch_and_bound.insert(std::pair<unsigned, CandidateSet>(root_candidates.df_max, root_candidates));
+      branch_and_bound.Push(root_candidates);
   }
 
   // set max_iterations only if non-exhaustive and predictive solving is enabled.
@@ -365,7 +544,7 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
       break;
 
     // first clean up tree, removeing all nodes with d_max < worst_d
-    branch_and_bound.erase(branch_and_bound.begin(), branch_and_bound.lower_bound(worst_d));
+    branch_and_bound.PruneBelow(worst_d);
 
     // we might have cleaned up the whole tree. nothing to do then...
     if (branch_and_bound.empty())
@@ -376,80 +555,76 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
      * this is a mixed depht-first/breadth-first approach, the latter
      * beeing faster, but the first a lot more memory efficient.
      */
-    std::multimap<unsigned, CandidateSet>::iterator node;
+    const CandidateSet node =
+      branch_and_bound.size() > n_points * 4 && iterations % 16 != 0
+      ? branch_and_bound.PopAbove(branch_and_bound.GetMaxKey() / 2)
+      : branch_and_bound.PopMax();
 
-    if (branch_and_bound.size() > n_points * 4 && iterations % 16 != 0) {
-      node = branch_and_bound.upper_bound(branch_and_bound.rbegin()->first / 2);
-      if (node == branch_and_bound.end()) --node;
-    } else {
-      node = --branch_and_bound.end();
-    }
-
-    if (node->second.df_min >= worst_d &&
-        node->second.IsIntegral(*this, is_fai, large_triangle_check)) {
+    if (node.df_min >= worst_d &&
+        node.IsIntegral(*this, is_fai, large_triangle_check)) {
       // node is integral feasible -> a possible solution
 
-      worst_d = node->second.df_min;
+      worst_d = node.df_min;
 
-      tp1 = node->second.tp1.index_min;
-      tp2 = node->second.tp2.index_min;
-      tp3 = node->second.tp3.index_min;
-      best_d = node->first;
+      tp1 = node.tp1.index_min;
+      tp2 = node.tp2.index_min;
+      tp3 = node.tp3.index_min;
+      best_d = node.df_max;
 
       integral_feasible = true;
 
     } else {
       // split largest bounding box of node and create child nodes
 
-      const unsigned tp1_diag = node->second.tp1.GetDiagnoal();
-      const unsigned tp2_diag = node->second.tp2.GetDiagnoal();
-      const unsigned tp3_diag = node->second.tp3.GetDiagnoal();
+      const unsigned tp1_diag = node.tp1.GetDiagnoal();
+      const unsigned tp2_diag = node.tp2.GetDiagnoal();
+      const unsigned tp3_diag = node.tp3.GetDiagnoal();
 
       const unsigned max_diag = std::max({tp1_diag, tp2_diag, tp3_diag});
 
       CandidateSet left, right;
       bool add = false;
 
-      if (tp1_diag == max_diag && node->second.tp1.GetSize() != 1) {
+      if (tp1_diag == max_diag && node.tp1.GetSize() != 1) {
         // split tp1 range
-        const unsigned split = (node->second.tp1.index_min + node->second.tp1.index_max) / 2;
+        const unsigned split = (node.tp1.index_min + node.tp1.index_max) / 2;
 
-        if (split <= node->second.tp2.index_max) {
+        if (split <= node.tp2.index_max) {
           add = true;
 
-          left = CandidateSet(TurnPointRange(*this, node->second.tp1.index_min, split),
-                              node->second.tp2, node->second.tp3);
+          left = CandidateSet(TurnPointRange(*this, node.tp1.index_min, split),
+                              node.tp2, node.tp3);
 
-          right = CandidateSet(TurnPointRange(*this, split, node->second.tp1.index_max),
-                               node->second.tp2, node->second.tp3);
+          right = CandidateSet(TurnPointRange(*this, split, node.tp1.index_max),
+                               node.tp2, node.tp3);
         }
-      } else if (tp2_diag == max_diag && node->second.tp2.GetSize() != 1) {
+      } else if (tp2_diag == max_diag && node.tp2.GetSize() != 1) {
         // split tp2 range
-        const unsigned split = (node->second.tp2.index_min + node->second.tp2.index_max) / 2;
+        const unsigned split = (node.tp2.index_min + node.tp2.index_max) / 2;
 
-        if (split <= node->second.tp3.index_max && split >= node->second.tp1.index_min) {
+        if (split <= node.tp3.index_max && split >= node.tp1.index_min) {
           add = true;
 
-          left = CandidateSet(node->second.tp1,
-                              TurnPointRange(*this, node->second.tp2.index_min, split),
-                              node->second.tp3);
+          left = CandidateSet(node.tp1,
+                              TurnPointRange(*this, node.tp2.index_min, split),
+                              node.tp3);
 
-          right = CandidateSet(node->second.tp1,
-                               TurnPointRange(*this, split, node->second.tp2.index_max),
-                               node->second.tp3);
+          right = CandidateSet(node.tp1,
+                               TurnPointRange(*this, split, node.tp2.index_max),
+                               node.tp3);
         }
-      } else if (node->second.tp3.GetSize() != 1) {
+      } else if (node.tp3.GetSize() != 1) {
         // split tp3 range
-        const unsigned split = (node->second.tp3.index_min + node->second.tp3.index_max) / 2;
+        const unsigned split = (node.tp3.index_min + node.tp3.index_max) / 2;
 
-        if (split >= node->second.tp2.index_min) {
+        if (split >= node.tp2.index_min) {
           add = true;
 
-          left = CandidateSet(node->second.tp1, node->second.tp2,
-                              TurnPointRange(*this, node->second.tp3.index_min, split));
+          left = CandidateSet(node.tp1, node.tp2,
+                              TurnPointRange(*this, node.tp3.index_min, split));
 
-          right = CandidateSet(node->second.tp1, node->second.tp2,
-                               TurnPointRange(*this, split, node->second.tp3.index_max));
+          right = CandidateSet(node.tp1, node.tp2,
+                               TurnPointRange(*this, split, node.tp3.index_max));
         }
       }
 
@@ -457,18 +632,15 @@ OLCTriangle::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d, boo
         // add the new candidate set only if it it's feasible and has d_min >= worst_d
         if (left.df_max >= worst_d &&
             left.IsFeasible(is_fai, large_triangle_check)) {
-          branch_and_bound.insert(std::pair<unsigned, CandidateSet>(left.df_max, left));
+          branch_and_bound.Push(left);
         }
 
         if (right.df_max >= worst_d &&
             right.IsFeasible(is_fai, large_triangle_check)) {
-          branch_and_bound.insert(std::pair<unsigned, CandidateSet>(right.df_max, right));
+          branch_and_bound.Push(right);
         }
       }
     }
-
-    // remove current node
-    branch_and_bound.erase(node);
   }
 
 
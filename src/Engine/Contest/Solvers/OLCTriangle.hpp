@@ -29,6 +29,10 @@
 #include "Geo/Flat/FlatBoundingBox.hpp"
 
 #include <map>
+#include <array>
+#include <vector>
+
+#include <stdint.h>
 
 /**
  * Specialisation of AbstractContest for OLC Triangle (triangle) rules
@@ -79,6 +83,15 @@ private:
    */
   bool running;
 
+  /**
+   * The number of trace points which have been searched completely
+   * by the branch and bound algorithm, or 0 if there was no complete
+   * run since the last full trace update.  In incremental predictive
+   * mode, only triangles with a turn point beyond this index need to
+   * be searched after new points have been appended.
+   */
+  unsigned solved_points;
+
   /**
    * Number of iterations per tick (only for non-exhaustive,
    * predictive runs)
@@ -329,7 +342,97 @@ private:
     }
   };
 
-  std::multimap<unsigned, CandidateSet> branch_and_bound;
+  /**
+   * A priority queue of #CandidateSet instances, ordered by df_max.
+   *
+   * Instead of a node-based container, the candidates are kept in a
+   * fixed number of buckets by df_max range, each of them being a
+   * binary heap in a std::vector.  The vectors keep their memory
+   * across runs.
+   */
+  class CandidateQueue {
+    static constexpr unsigned N_BUCKETS = 64;
+
+    std::array<std::vector<CandidateSet>, N_BUCKETS> buckets;
+
+    /**
+     * A bit mask of non-empty buckets.
+     */
+    uint64_t mask;
+
+    /**
+     * The bucket of a #CandidateSet is df_max >> shift.
+     */
+    unsigned shift;
+
+    unsigned n;
+
+    /**
+     * All candidates with a lower df_max have been removed by
+     * PruneBelow().
+     */
+    unsigned min_key;
+
+  public:
+    CandidateQueue():mask(0), shift(0), n(0), min_key(0) {}
+
+    bool empty() const {
+      return n == 0;
+    }
+
+    unsigned size() const {
+      return n;
+    }
+
+    void clear();
+
+    /**
+     * Returns the largest df_max.  The queue must not be empty.
+     */
+    gcc_pure
+    unsigned GetMaxKey() const {
+      return buckets[GetHighestBucket()].front().df_max;
+    }
+
+    void Push(const CandidateSet &candidate);
+
+    /**
+     * Remove and return the candidate with the largest df_max.
+     */
+    CandidateSet PopMax();
+
+    /**
+     * Remove and return a candidate with a df_max just above the
+     * given value (or the largest one if there is none).  This is
+     * not exact: the best one of the lowest non-empty bucket is
+     * chosen.
+     */
+    CandidateSet PopAbove(unsigned key);
+
+    /**
+     * Remove all candidates with a df_max lower than the given value.
+     */
+    void PruneBelow(unsigned key);
+
+  private:
+    static bool Compare(const CandidateSet &a, const CandidateSet &b) {
+      return a.df_max < b.df_max;
+    }
+
+    gcc_pure
+    unsigned GetHighestBucket() const {
+      return 63 - __builtin_clzll(mask);
+    }
+
+    CandidateSet Pop(unsigned bucket);
+
+    /**
+     * Double the df_max range of each bucket.
+     */
+    void Rescale();
+  };
+
+  CandidateQueue branch_and_bound;
 
 public:
   OLCTriangle(const Trace &_trace,
@@ -345,8 +448,29 @@ protected:
   bool FindClosingPairs(unsigned old_size);
   void SolveTriangle(bool exhaustive);
 
+  /**
+   * @param first_new if this is greater than #from, then only
+   * triangles with a turn point at or after this index are searched
+   */
   std::tuple<unsigned, unsigned, unsigned, unsigned>
-  RunBranchAndBound(unsigned from, unsigned to, unsigned best_d, bool exhaustive);
+  RunBranchAndBound(unsigned from, unsigned to, unsigned best_d, bool exhaustive,
+                    unsigned first_new=0);
+
+  /**
+   * Can new trace points be searched without rebuilding the
+   * branch and bound tree?
+   */
+  gcc_pure
+  bool CanAppend() const {
+    return incremental && predict && solved_points > 0 &&
+      !CheckMasterSerial();
+  }
+
+  /**
+   * Copy new points from the master trace into the running branch
+   * and bound tree.
+   */
+  void AppendRunning();
 
   void UpdateTrace(bool force) override;
   void ResetBranchAndBound();
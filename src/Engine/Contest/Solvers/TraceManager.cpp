@@ -83,7 +83,7 @@ TraceManager::IsMasterUpdated(bool continuous) const
   const unsigned threshold_distance_trace = trace_master.GetAverageDeltaDistance();
 
   const TracePoint &last_master = trace_master.back();
-  const TracePoint &last_point = *trace.back();
+  const TracePoint &last_point = trace.back();
 
   // update trace if time and distance are greater than significance thresholds
 
@@ -96,17 +96,34 @@ TraceManager::ClearTrace()
 {
   append_serial = modify_serial = Serial();
   trace_dirty = true;
-  trace.clear();
+  trace = nullptr;
+  flat_x.clear();
+  flat_y.clear();
   n_points = 0;
   predicted = TracePoint::Invalid();
 }
 
+void
+TraceManager::UpdateFlatLocations(unsigned first)
+{
+  assert(first <= n_points);
+
+  flat_x.resize(n_points);
+  flat_y.resize(n_points);
+
+  for (unsigned i = first; i < n_points; ++i) {
+    const FlatGeoPoint &p = trace[i].GetFlatLocation();
+    flat_x[i] = p.x;
+    flat_y[i] = p.y;
+  }
+}
+
 void
 TraceManager::UpdateTraceFull()
 {
-  trace.reserve(trace_master.GetMaxSize());
-  trace_master.GetPoints(trace);
-  n_points = trace.size();
+  trace = trace_master.GetPoints();
+  n_points = trace.size;
+  UpdateFlatLocations(0);
 
   if (n_points > 0 && predicted.IsDefined())
     predicted.Project(trace_master.GetProjection());
@@ -124,11 +141,16 @@ TraceManager::UpdateTraceTail()
   //assert(incremental == finished || force);
   assert(modify_serial == trace_master.GetModifySerial());
 
-  if (!trace_master.SyncPoints(trace))
+  if (trace_master.size() == n_points)
     /* no new points */
     return false;
 
-  n_points = trace.size();
+  assert(trace_master.size() > n_points);
+
+  const unsigned old_size = n_points;
+  trace = trace_master.GetPoints();
+  n_points = trace.size;
+  UpdateFlatLocations(old_size);
 
   if (n_points > 0 && predicted.IsDefined())
     predicted.Project(trace_master.GetProjection());
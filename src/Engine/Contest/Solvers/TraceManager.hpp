@@ -26,8 +26,10 @@ Copyright_License {
 
 #include "Util/Serial.hpp"
 #include "Trace/Trace.hpp"
-#include "Trace/Vector.hpp"
 #include "Trace/Point.hpp"
+#include "Util/ConstBuffer.hxx"
+
+#include <vector>
 
 class TraceManager {
 protected:
@@ -50,11 +52,17 @@ private:
 
 protected:
   /**
-   * Working trace for solver.  This contains pointers to trace_master
+   * Working trace for solver.  This refers to the trace_master
    * records, which get Invalidated when the trace gets thinned.  Be
    * careful!
    */
-  TracePointerVector trace;
+  ConstBuffer<TracePoint> trace;
+
+  /**
+   * The flat coordinates of the #trace points, as separate arrays
+   * for FlatDistanceBatch().
+   */
+  std::vector<int> flat_x, flat_y;
 
   /** Number of points in current trace set */
   unsigned n_points;
@@ -86,6 +94,14 @@ public:
 protected:
   void ClearTrace();
 
+private:
+  /**
+   * Copy the flat coordinates of the points starting at #first to
+   * #flat_x and #flat_y.
+   */
+  void UpdateFlatLocations(unsigned first);
+
+protected:
   /**
    * Obtain a new #Trace copy.
    */
@@ -102,7 +118,7 @@ protected:
   const TracePoint &GetPoint(unsigned i) const {
     assert(i < n_points);
 
-    return *trace[i];
+    return trace[i];
   }
 
   gcc_pure
@@ -24,10 +24,14 @@ Copyright_License {
 #ifndef ASTAR_HPP
 #define ASTAR_HPP
 
-#include "Util/ReservablePriorityQueue.hpp"
 #include "Compiler.h"
 
-#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#include <assert.h>
+#include <stddef.h>
 
 struct AStarPriorityValue
 {
@@ -69,59 +73,58 @@ struct AStarPriorityValue
  * AStar search algorithm, based on Dijkstra algorithm
  * Modifications by John Wharington to track optimal solution
  * @see http://en.giswiki.net/wiki/Dijkstra%27s_algorithm
+ *
+ * All nodes seen during a search are stored in one flat array; an
+ * open-addressing hash table maps nodes to their position in that
+ * array, and the search queue is an indexed binary heap of array
+ * positions, which allows improving a queued node in place instead
+ * of queueing it again.  Clear() keeps all allocations, therefore
+ * repeated searches do not touch the heap allocator.
  */
 template <class Node, class Hash=std::hash<Node>,
           class KeyEqual=std::equal_to<Node>,
           bool m_min=true>
 class AStar
 {
-  typedef std::unordered_map<Node, AStarPriorityValue, Hash, KeyEqual> node_value_map;
-
-  typedef typename node_value_map::iterator node_value_iterator;
-  typedef typename node_value_map::const_iterator node_value_const_iterator;
+  static constexpr unsigned NONE = 0 - 1;
 
-  typedef std::unordered_map<Node, Node, Hash, KeyEqual> node_parent_map;
+  struct Entry {
+    Node node;
 
-  typedef typename node_parent_map::iterator node_parent_iterator;
-  typedef typename node_parent_map::const_iterator node_parent_const_iterator;
+    AStarPriorityValue value;
 
-  struct NodeValue {
-    AStarPriorityValue priority;
+    /** Best predecessor found so far */
+    Node parent;
 
-    node_value_iterator iterator;
+    /** Position in #heap, or #NONE if this node is not queued */
+    unsigned heap_index;
 
     constexpr
-    NodeValue(const AStarPriorityValue &_priority,
-              node_value_iterator _iterator)
-      :priority(_priority), iterator(_iterator) {}
-  };
-
-  struct Rank: public std::binary_function<NodeValue, NodeValue, bool>
-  {
-    gcc_pure
-    bool operator()(const NodeValue &x, const NodeValue &y) const {
-      return x.priority.f() > y.priority.f();
-    }
+    Entry(const Node &_node, const AStarPriorityValue &_value,
+          const Node &_parent)
+      :node(_node), value(_value), parent(_parent), heap_index(NONE) {}
   };
 
   /**
-   * Stores the value of each node.  It is updated by push(), if a
-   * value lower than the current one is found.
+   * All nodes which have been reached so far, with their best value
+   * and predecessor.
    */
-  node_value_map node_values;
+  std::vector<Entry> entries;
 
   /**
-   * Stores the predecessor of each node.  It is maintained by
-   * set_predecessor().
+   * Open-addressing hash table (linear probing, power of two size)
+   * of indices into #entries; #NONE marks an empty slot.
    */
-  node_parent_map node_parents;
+  std::vector<unsigned> table;
 
   /**
-   * A sorted list of all possible node paths, lowest distance first.
+   * The search queue: a binary min-heap (ranked by f) of indices
+   * into #entries.
    */
-  reservable_priority_queue<NodeValue, std::vector<NodeValue>, Rank> q;
+  std::vector<unsigned> heap;
 
-  node_value_iterator cur;
+  /** Index of the node most recently returned by Pop() */
+  unsigned cur;
 
 public:
   static constexpr unsigned DEFAULT_QUEUE_SIZE = 1024;
@@ -132,6 +135,7 @@ public:
    * @param is_min Whether this algorithm will search for min or max distance
    */
   AStar(unsigned reserve_default = DEFAULT_QUEUE_SIZE)
+    :cur(NONE)
   {
     Reserve(reserve_default);
   }
@@ -143,6 +147,7 @@ public:
    * @param is_min Whether this algorithm will search for min or max distance
    */
   AStar(const Node &node, unsigned reserve_default = DEFAULT_QUEUE_SIZE)
+    :cur(NONE)
   {
     Reserve(reserve_default);
     Push(node, node, AStarPriorityValue(0));
@@ -158,15 +163,14 @@ public:
     Push(node, node, AStarPriorityValue(0));
   }
 
-  /** Clears the queues */
+  /** Clears the queues (but keeps the allocated memory) */
   void Clear() {
-    // Clear the search queue
-    q.clear();
+    if (!entries.empty())
+      std::fill(table.begin(), table.end(), unsigned(NONE));
 
-    // Clear the node_parent_map
-    node_parents.clear();
-    // Clear the node_value_map
-    node_values.clear();
+    entries.clear();
+    heap.clear();
+    cur = NONE;
   }
 
   /**
@@ -176,7 +180,7 @@ public:
    */
   gcc_pure
   bool IsEmpty() const {
-    return q.empty();
+    return heap.empty();
   }
 
   /**
@@ -186,23 +190,29 @@ public:
    */
   gcc_pure
   unsigned QueueSize() const {
-    return q.size();
+    return heap.size();
   }
 
   /**
-   * Return top element of queue for processing
+   * Return top element of queue for processing.  The reference is
+   * only valid until the next Link() call.
    *
    * @return Node for processing
    */
   const Node &Pop() {
-    cur = q.top().iterator;
+    assert(!heap.empty());
 
-    do { // remove this item
-      q.pop();
-    } while (!q.empty() && (q.top().priority > q.top().iterator->second));
-    // and all lower rank than this
+    cur = heap.front();
+    entries[cur].heap_index = NONE;
 
-    return cur->first;
+    const unsigned last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+      Place(0, last);
+      SiftDown(0);
+    }
+
+    return entries[cur].node;
   }
 
   /**
@@ -227,22 +237,25 @@ public:
    */
   gcc_pure
   Node GetPredecessor(const Node &node) const {
-    // Try to find the given node in the node_parent_map
-    node_parent_const_iterator it = node_parents.find(node);
-    if (it == node_parents.end())
-      // first entry
+    const unsigned i = Find(node);
+    if (i == NONE)
       // If the node wasn't found
       // -> Return the given node itself
       return node;
 
-    // If the node was found
-    // -> Return the parent node
-    return it->second;
+    return entries[i].parent;
   }
 
   /** Reserve queue size (if available) */
   void Reserve(unsigned size) {
-    q.reserve(size);
+    if (size <= entries.capacity())
+      return;
+
+    entries.reserve(size);
+    heap.reserve(size);
+
+    if (table.size() < 2 * size)
+      Rehash(2 * size);
   }
 
   /**
@@ -251,19 +264,114 @@ public:
    */
   gcc_pure
   AStarPriorityValue GetNodeValue(const Node &node) const {
-    node_value_const_iterator it = node_values.find(node);
-    if (cur->first == node)
-      return cur->second;
+    if (cur != NONE && KeyEqual()(entries[cur].node, node))
+      return entries[cur].value;
 
-    if (it == node_values.end())
+    const unsigned i = Find(node);
+    if (i == NONE)
       return AStarPriorityValue(0);
 
-    return it->second;
+    return entries[i].value;
   }
 
 private:
+  gcc_pure
+  size_t Bucket(const Node &node) const {
+    /* scramble the bits, the hash functions used with this class
+       are usually cheap linear combinations of coordinates */
+    size_t h = Hash()(node);
+    h ^= h >> 16;
+    h *= size_t(0x9e3779b1);
+    h ^= h >> 15;
+    return h & (table.size() - 1);
+  }
+
+  /**
+   * @return the index of the node in #entries or #NONE
+   */
+  gcc_pure
+  unsigned Find(const Node &node) const {
+    if (table.empty())
+      return NONE;
+
+    const size_t mask = table.size() - 1;
+    for (size_t slot = Bucket(node);; slot = (slot + 1) & mask) {
+      const unsigned i = table[slot];
+      if (i == NONE || KeyEqual()(entries[i].node, node))
+        return i;
+    }
+  }
+
+  void Insert(unsigned i) {
+    const size_t mask = table.size() - 1;
+    size_t slot = Bucket(entries[i].node);
+    while (table[slot] != NONE)
+      slot = (slot + 1) & mask;
+    table[slot] = i;
+  }
+
   /**
-   * Add node to search queue
+   * Resize the hash table to at least the given number of slots and
+   * re-insert all entries.
+   */
+  void Rehash(size_t min_size) {
+    size_t size = 16;
+    while (size < min_size)
+      size <<= 1;
+
+    table.assign(size, unsigned(NONE));
+    for (unsigned i = 0, n = entries.size(); i < n; ++i)
+      Insert(i);
+  }
+
+  gcc_pure
+  bool Less(unsigned a, unsigned b) const {
+    return entries[a].value.f() < entries[b].value.f();
+  }
+
+  void Place(unsigned heap_index, unsigned i) {
+    heap[heap_index] = i;
+    entries[i].heap_index = heap_index;
+  }
+
+  void SiftUp(unsigned heap_index) {
+    const unsigned i = heap[heap_index];
+    while (heap_index > 0) {
+      const unsigned parent = (heap_index - 1) / 2;
+      if (!Less(i, heap[parent]))
+        break;
+
+      Place(heap_index, heap[parent]);
+      heap_index = parent;
+    }
+
+    Place(heap_index, i);
+  }
+
+  void SiftDown(unsigned heap_index) {
+    const unsigned n = heap.size();
+    const unsigned i = heap[heap_index];
+    while (true) {
+      unsigned child = 2 * heap_index + 1;
+      if (child >= n)
+        break;
+
+      if (child + 1 < n && Less(heap[child + 1], heap[child]))
+        ++child;
+
+      if (!Less(heap[child], i))
+        break;
+
+      Place(heap_index, heap[child]);
+      heap_index = child;
+    }
+
+    Place(heap_index, i);
+  }
+
+  /**
+   * Add node to search queue, or improve its value if it has been
+   * seen before
    *
    * @param n Destination node to add
    * @param pn Previous node
@@ -271,39 +379,39 @@ private:
    */
   void Push(const Node &node, const Node &parent,
             const AStarPriorityValue &edge_value) {
-    // Try to find the given node n in the node_value_map
-    node_value_iterator it = node_values.find(node);
-    if (it == node_values.end()) {
+    unsigned i = Find(node);
+    if (i == NONE) {
       // first entry
       // If the node wasn't found
-      // -> Insert a new node into the node_value_map
-      it = node_values.insert(std::make_pair(node, edge_value)).first;
-
-      // Remember the parent node
-      SetPredecessor(node, parent);
-    } else if (it->second > edge_value) {
+      // -> Append a new entry and index it
+      if (2 * (entries.size() + 1) > table.size())
+        Rehash(4 * (entries.size() + 1));
+
+      i = entries.size();
+      entries.emplace_back(node, edge_value, parent);
+      Insert(i);
+    } else if (entries[i].value > edge_value) {
       // If the node was found and the new value is smaller
-      // -> Replace the value with the new one
-      it->second = edge_value;
-      // replace, it's bigger
-
-      // Remember the new parent node
-      SetPredecessor(node, parent);
+      // -> Replace the value and the parent with the new ones
+      entries[i].value = edge_value;
+      entries[i].parent = parent;
     } else
       // If the node was found but the value is higher or equal
       // -> Don't use this new leg
       return;
 
-    q.push(NodeValue(edge_value, it));
-  }
-
-  void SetPredecessor(const Node &node, const Node &parent) {
-    // Try to find the given node in the node_parent_map
-    auto result = node_parents.insert(std::make_pair(node, parent));
-    if (!result.second)
-      // If the node was found
-      // -> Replace the according parent node with the new one
-      result.first->second = parent;
+    Entry &entry = entries[i];
+    if (entry.heap_index == NONE) {
+      // not (or no longer) queued: (re-)open it
+      entry.heap_index = heap.size();
+      heap.push_back(i);
+      SiftUp(entry.heap_index);
+    } else {
+      /* the heuristic part may have changed, too, so the rank may
+         move in either direction */
+      SiftUp(entry.heap_index);
+      SiftDown(entries[i].heap_index);
+    }
   }
 };
 
@@ -27,6 +27,10 @@
 #include "Util/GlobalSliceAllocator.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
 
+#include <algorithm>
+
+#include <math.h>
+
 #define REACH_BUFFER 1
 #define REACH_SWEEP (ROUTEPOLAR_Q1-REACH_BUFFER)
 
@@ -34,6 +38,12 @@
 #define REACH_MIN_STEP 25
 #define REACH_MAX_VERTICES 2000
 
+/**
+ * Maximum difference (m) between the origin height of a recycled fan
+ * and the height at the new origin.
+ */
+static constexpr int REUSE_MAX_HEIGHT_ERROR = 20;
+
 static bool
 AlmostTheSame(const FlatGeoPoint p1, const FlatGeoPoint p2)
 {
@@ -50,6 +60,44 @@ TooClose(const FlatGeoPoint p1, const FlatGeoPoint p2)
   return dmax < REACH_MIN_STEP;
 }
 
+void
+FlatTriangleFanTree::Swap(FlatTriangleFanTree &other)
+{
+  assert(depth == other.depth);
+
+  vs.swap(other.vs);
+  std::swap(bounding_box, other.bounding_box);
+  std::swap(height, other.height);
+  std::swap(bb_children, other.bb_children);
+  children.swap(other.children);
+  std::swap(gaps_filled, other.gaps_filled);
+  std::swap(scan_low, other.scan_low);
+  std::swap(scan_high, other.scan_high);
+}
+
+static bool
+CompareReusable(const FlatTriangleFanTree *a, const FlatTriangleFanTree *b)
+{
+  return a->CompareIndex(*b) < 0;
+}
+
+void
+FlatTriangleFanTree::CollectDescendants(std::vector<const FlatTriangleFanTree *> &dest) const
+{
+  for (const auto &child : children) {
+    dest.push_back(&child);
+    child.CollectDescendants(dest);
+  }
+}
+
+void
+FlatTriangleFanTree::CollectReusable(std::vector<const FlatTriangleFanTree *> &dest) const
+{
+  dest.clear();
+  CollectDescendants(dest);
+  std::sort(dest.begin(), dest.end(), CompareReusable);
+}
+
 void
 FlatTriangleFanTree::CalcBB()
 {
@@ -120,6 +168,8 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
 {
   const GeoPoint geo_origin = parms.projection.Unproject(origin);
   height = origin.altitude;
+  scan_low = index_low;
+  scan_high = index_high;
 
   // fill vector
   if (!IsRoot()) {
@@ -146,6 +196,122 @@ FlatTriangleFanTree::FillReach(const AFlatGeoPoint &origin, const int index_low,
   return CommitPoints(IsRoot());
 }
 
+/**
+ * Is the straight glide from the origin to the given point clear of
+ * terrain, of the floor and of MSL?  Unlike the Intersection() scan
+ * of ReachIntercept(), which samples only a few dozen points per
+ * ray, this samples every terrain pixel along the line, so a
+ * recycled fan can never reach further than the terrain allows.
+ *
+ * A fan vertex is where the glide meets the terrain; the scan stops
+ * one flat unit (the resolution of the vertices) short of it.
+ */
+gcc_pure
+static bool
+IsGlideClear(const AFlatGeoPoint &origin, const GeoPoint &geo_origin,
+             const FlatGeoPoint p, const ReachFanParms &parms)
+{
+  const unsigned length = p.Distance(origin);
+  if (length <= 1)
+    return true;
+
+  const int h_origin = origin.altitude - parms.rpolars.GetSafetyHeight();
+  const int h_glide = origin.altitude -
+    parms.rpolars.CalcGlideArrival(origin, p, parms.projection);
+  const int h_min = std::max(parms.rpolars.GetFloor(), 0);
+  if (h_origin - h_glide < h_min)
+    /* the glide reaches the floor or MSL before this point */
+    return false;
+
+  const double t_max = double(length - 1) / length;
+  const GeoPoint geo_p = parms.projection.Unproject(p);
+
+  /* four samples per terrain pixel; each sample is compared with
+     the lowest glide height until the next one */
+  const double pixel = parms.terrain->PixelDistance(geo_origin, 1);
+  const unsigned n_samples =
+    unsigned(4 * length * parms.projection.GetApproximateScale() / pixel) + 2;
+
+  for (unsigned i = 0; i <= n_samples; ++i) {
+    const double t = t_max * i / n_samples;
+    const double t_next = t_max * std::min(i + 1, n_samples) / n_samples;
+    const int h = h_origin - int(ceil(t_next * h_glide));
+    const auto terrain =
+      parms.terrain->GetHeight(geo_origin.Interpolate(geo_p, t));
+    if (h < std::max<int>(terrain.GetValueOr0(), h_min))
+      return false;
+  }
+
+  return true;
+}
+
+bool
+FlatTriangleFanTree::IsStillValid(const FlatTriangleFanTree &fan,
+                                  const AFlatGeoPoint &origin,
+                                  const ReachFanParms &parms)
+{
+  const FlatGeoPoint offset =
+    (FlatGeoPoint)origin - (FlatGeoPoint)fan.GetOrigin();
+  const GeoPoint geo_origin = parms.projection.Unproject(origin);
+
+  /* the terrain under the moved edges may be different; each of
+     them must still be clear */
+  for (auto i = std::next(fan.vs.begin()), end = fan.vs.end();
+       i != end; ++i)
+    if (!IsGlideClear(origin, geo_origin, *i + offset, parms))
+      return false;
+
+  return true;
+}
+
+bool
+FlatTriangleFanTree::Reuse(const AFlatGeoPoint &origin, const int index_low,
+                           const int index_high, ReachFanParms &parms)
+{
+  if (parms.reusable.empty() || parms.terrain == nullptr)
+    return false;
+
+  FlatTriangleFanTree key(depth);
+  key.scan_low = index_low;
+  key.scan_high = index_high;
+
+  const auto range = std::equal_range(parms.reusable.begin(),
+                                      parms.reusable.end(),
+                                      &key, CompareReusable);
+  for (auto i = range.first; i != range.second; ++i) {
+    const FlatTriangleFanTree &fan = **i;
+    const AFlatGeoPoint old_origin = fan.GetOrigin();
+
+    /* where we'd expect this fan's origin after the aircraft has
+       moved */
+    const FlatGeoPoint expected = (FlatGeoPoint)old_origin + parms.shift;
+    const FlatGeoPoint error = (FlatGeoPoint)origin - expected;
+    if (std::max(abs(error.x), abs(error.y)) > parms.reuse_distance ||
+        abs(old_origin.altitude + parms.climb - origin.altitude) >
+        REUSE_MAX_HEIGHT_ERROR)
+      continue;
+
+    if (!IsStillValid(fan, origin, parms))
+      continue;
+
+    /* copy the fan, moved to the new origin */
+    const FlatGeoPoint offset = (FlatGeoPoint)origin - (FlatGeoPoint)old_origin;
+    AddOrigin(origin, fan.vs.size() - 1);
+    for (auto j = std::next(fan.vs.begin()), end = fan.vs.end();
+         j != end; ++j)
+      vs.push_back(*j + offset);
+
+    scan_low = index_low;
+    scan_high = index_high;
+
+    parms.reusable.erase(i);
+    ++parms.reuse_counter;
+    return true;
+  }
+
+  return false;
+}
+
 void
 FlatTriangleFanTree::FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms)
 {
@@ -237,7 +403,8 @@ FlatTriangleFanTree::CheckGap(const AFlatGeoPoint &n, const RouteLink &e_1,
     const AFlatGeoPoint x(px, h);
 
     FlatTriangleFanTree child(depth + 1);
-    if (child.FillReach(x, index_left, index_right, parms)) {
+    if (child.Reuse(x, index_left, index_right, parms) ||
+        child.FillReach(x, index_left, index_right, parms)) {
       parms.vertex_counter += child.vs.size();
       parms.fan_counter++;
       children.emplace_back(std::move(child));
@@ -28,6 +28,7 @@
 #include "FlatTriangleFan.hpp"
 
 #include <list>
+#include <vector>
 
 class FlatProjection;
 struct GeoPoint;
@@ -56,12 +57,19 @@ private:
   const unsigned char depth;
   bool gaps_filled;
 
+  /**
+   * The range of polar indices scanned by FillReach().  Used to
+   * match fans of a previous solve in Reuse().
+   */
+  short scan_low, scan_high;
+
 public:
   friend class PrintHelper;
 
   FlatTriangleFanTree(const unsigned char _depth = 0)
     :depth(_depth),
-     gaps_filled(false) {}
+     gaps_filled(false),
+     scan_low(0), scan_high(0) {}
 
   bool IsRoot() const {
     return depth == 0;
@@ -72,6 +80,32 @@ public:
     children.clear();
   }
 
+  /**
+   * Exchange the contents of two trees of the same depth.
+   */
+  void Swap(FlatTriangleFanTree &other);
+
+  /**
+   * Fill the list with pointers to all descendants of this tree (but
+   * not this tree itself), sorted for lookups by Reuse().
+   */
+  void CollectReusable(std::vector<const FlatTriangleFanTree *> &dest) const;
+
+  /**
+   * Compare depth and scanned polar index range, for sorting the
+   * list built by CollectReusable().
+   */
+  gcc_pure
+  int CompareIndex(const FlatTriangleFanTree &other) const {
+    if (depth != other.depth)
+      return depth < other.depth ? -1 : 1;
+    if (scan_low != other.scan_low)
+      return scan_low < other.scan_low ? -1 : 1;
+    if (scan_high != other.scan_high)
+      return scan_high < other.scan_high ? -1 : 1;
+    return 0;
+  }
+
   void CalcBB();
 
   gcc_pure
@@ -100,6 +134,19 @@ public:
                  const int index_low, const int index_high,
                  const ReachFanParms &parms);
 
+  /**
+   * Like FillReach(), but attempt to recycle a matching fan of the
+   * previous solve (ReachFanParms::reusable), moved to the new
+   * origin.  A fan is only recycled if none of its moved edges
+   * intersects terrain.
+   *
+   * @return true if a fan was recycled, false if FillReach() needs
+   * to be called
+   */
+  bool Reuse(const AFlatGeoPoint &origin,
+             const int index_low, const int index_high,
+             ReachFanParms &parms);
+
   bool FillDepth(const AFlatGeoPoint &origin, ReachFanParms &parms);
   void FillGaps(const AFlatGeoPoint &origin, ReachFanParms &parms);
 
@@ -115,6 +162,21 @@ public:
 
   void UpdateTerrainBase(FlatGeoPoint origin, ReachFanParms &parms);
 
+private:
+  void CollectDescendants(std::vector<const FlatTriangleFanTree *> &dest) const;
+
+  /**
+   * Check whether the given fan of a previous solve, moved to the
+   * new origin, is still clear of terrain, i.e. it does not overstate
+   * the reach.
+   */
+  gcc_pure
+  static bool IsStillValid(const FlatTriangleFanTree &fan,
+                           const AFlatGeoPoint &origin,
+                           const ReachFanParms &parms);
+
+public:
+
   gcc_pure
   int DirectArrival(FlatGeoPoint dest, const ReachFanParms &parms) const;
 };
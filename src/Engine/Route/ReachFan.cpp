@@ -25,24 +25,124 @@
 #include "ReachFanParms.hpp"
 #include "ReachResult.hpp"
 
+#include <algorithm>
+
+#include <stdlib.h>
+
 static constexpr int MIN_FLOOR_CLEARANCE = 100;
 
+/**
+ * Maximum distance (m) the aircraft may have moved since the
+ * previous solve for an incremental solve.
+ */
+static constexpr double MAX_INCREMENTAL_SHIFT = 500;
+
+/**
+ * Maximum altitude change (m) since the previous solve for an
+ * incremental solve.
+ */
+static constexpr int MAX_INCREMENTAL_CLIMB = 50;
+
+/**
+ * Errors of recycled fans may add up; force a full solve after this
+ * number of incremental solves.
+ */
+static constexpr unsigned MAX_INCREMENTAL_SOLVES = 5;
+
+/**
+ * Maximum distance (m) between a new fan origin and the (moved)
+ * origin of a fan of the previous solve to recycle it.
+ */
+static constexpr double REUSE_DISTANCE = 100;
+
+/** Reference altitude (m) for the #PolarSignature */
+static constexpr int SIGNATURE_ALTITUDE = 2000;
+
+bool
+ReachFan::PolarSignature::operator==(const PolarSignature &other) const
+{
+  return std::equal(range, range + N, other.range) &&
+    floor == other.floor && safety_height == other.safety_height &&
+    turning == other.turning;
+}
+
 void
 ReachFan::Reset()
 {
   root.Clear();
+  previous.Clear();
   terrain_base = 0;
+  last_terrain = nullptr;
+  incremental_count = 0;
+  reused_fans = 0;
+}
+
+ReachFan::PolarSignature
+ReachFan::CalcSignature(const AFlatGeoPoint &origin,
+                        const GeoPoint &geo_origin,
+                        const RoutePolars &rpolars) const
+{
+  const AFlatGeoPoint reference(origin, SIGNATURE_ALTITUDE);
+
+  PolarSignature signature;
+  for (unsigned i = 0; i < PolarSignature::N; ++i)
+    /* without terrain, this is the plain glide range */
+    signature.range[i] =
+      rpolars.ReachIntercept(i * ROUTEPOLAR_Q3 / PolarSignature::N,
+                             reference, geo_origin, nullptr, projection)
+      - (FlatGeoPoint)origin;
+
+  signature.floor = rpolars.GetFloor();
+  signature.safety_height = rpolars.GetSafetyHeight();
+  signature.turning = rpolars.IsTurningReachEnabled();
+  return signature;
 }
 
 bool
-ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-                const RasterMap* terrain, const bool do_solve)
+ReachFan::CanSolveIncremental(const AGeoPoint &origin,
+                              const RoutePolars &rpolars,
+                              const RasterMap *terrain) const
 {
-  Reset();
+  if (root.IsEmpty() || root.IsDummy() || terrain != last_terrain ||
+      incremental_count >= MAX_INCREMENTAL_SOLVES)
+    return false;
+
+  const AFlatGeoPoint ao(projection.ProjectInteger(origin), origin.altitude);
+  const FlatGeoPoint shift = (FlatGeoPoint)ao - (FlatGeoPoint)last_origin;
+  const int max_shift =
+    projection.ProjectRangeInteger(origin, MAX_INCREMENTAL_SHIFT);
+  if (std::max(abs(shift.x), abs(shift.y)) > max_shift ||
+      abs(ao.altitude - last_origin.altitude) > MAX_INCREMENTAL_CLIMB)
+    return false;
+
+  return CalcSignature(ao, origin, rpolars) == last_signature;
+}
 
-  // initialise projection
+bool
+ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
+                const RasterMap* terrain, const bool do_solve,
+                const bool incremental)
+{
+  const bool reuse = incremental && do_solve && terrain != nullptr &&
+    CanSolveIncremental(origin, rpolars, terrain);
+
+  if (reuse) {
+    /* move the old tree aside to recycle its fans */
+    previous.Swap(root);
+    root.Clear();
+    terrain_base = 0;
+    ++incremental_count;
+  } else
+    Reset();
+
+  /* always project around the new origin, just like a full solve;
+     the old tree keeps the coordinates of the previous projection,
+     which differ from the new ones only by the origin movement (see
+     ReachFanParms::shift) */
   projection = FlatProjection(origin);
 
+  reused_fans = 0;
+
   const auto h = terrain
     ? terrain->GetHeight(origin)
     : TerrainHeight::Invalid();
@@ -57,15 +157,33 @@ ReachFan::Solve(const AGeoPoint origin, const RoutePolars &rpolars,
       (origin.altitude <= h2 + rpolars.GetSafetyHeight()))
       || (origin.altitude < MIN_FLOOR_CLEARANCE + rpolars.GetFloor() + rpolars.GetSafetyHeight())) {
     terrain_base = h2;
+    previous.Clear();
     root.DummyReach(ao);
     return false;
   }
 
+  if (reuse) {
+    previous.CollectReusable(parms.reusable);
+    parms.shift = (FlatGeoPoint)ao - (FlatGeoPoint)last_origin;
+    parms.climb = ao.altitude - last_origin.altitude;
+    parms.reuse_distance =
+      projection.ProjectRangeInteger(origin, REUSE_DISTANCE);
+  }
+
   if (do_solve)
     root.FillReach(ao, parms);
   else
     root.DummyReach(ao);
 
+  /* the recycled fans have been copied; free the old tree */
+  parms.reusable.clear();
+  previous.Clear();
+
+  reused_fans = parms.reuse_counter;
+  last_origin = ao;
+  last_terrain = terrain;
+  last_signature = CalcSignature(ao, origin, rpolars);
+
   if (!h.IsInvalid()) {
     parms.terrain_base = h2;
     parms.terrain_counter = 1;
@@ -25,6 +25,7 @@
 
 #include "Geo/Flat/FlatProjection.hpp"
 #include "FlatTriangleFanTree.hpp"
+#include "Compiler.h"
 
 class RoutePolars;
 class RasterMap;
@@ -33,12 +34,54 @@ struct ReachResult;
 
 class ReachFan
 {
+  /**
+   * Attributes of the #RoutePolars which determine the shape of the
+   * fans.  An incremental solve is only possible if they have not
+   * changed since the previous solve.
+   */
+  struct PolarSignature {
+    static constexpr unsigned N = 4;
+
+    /** Glide range in a few directions from a reference altitude */
+    FlatGeoPoint range[N];
+
+    int floor, safety_height;
+    bool turning;
+
+    gcc_pure
+    bool operator==(const PolarSignature &other) const;
+  };
+
   FlatProjection projection;
   FlatTriangleFanTree root;
   int terrain_base;
 
+  /**
+   * The tree of the previous solve; only used while an incremental
+   * solve is in progress.
+   */
+  FlatTriangleFanTree previous;
+
+  /**
+   * The origin of the previous solve in #projection (or, during an
+   * incremental solve, in the previous projection)
+   */
+  AFlatGeoPoint last_origin;
+
+  const RasterMap *last_terrain;
+
+  PolarSignature last_signature;
+
+  /** Number of incremental solves since the last full solve */
+  unsigned incremental_count;
+
+  /** Number of fans recycled by the last solve */
+  unsigned reused_fans;
+
 public:
-  ReachFan():terrain_base(0) {}
+  ReachFan()
+    :terrain_base(0), last_origin(0, 0, 0), last_terrain(nullptr),
+     incremental_count(0), reused_fans(0) {}
 
   friend class PrintHelper;
 
@@ -52,8 +95,17 @@ public:
 
   void Reset();
 
+  /**
+   * @param incremental if true, then the previous solution may be
+   * used to speed up this one: the root fan is always recalculated,
+   * but turning reach fans of the previous solve whose terrain
+   * clearance has not changed are moved instead of being scanned
+   * again.  This is only done if the aircraft has moved only a
+   * little, and a full solve is forced every few calls.
+   */
   bool Solve(const AGeoPoint origin, const RoutePolars &rpolars,
-             const RasterMap *terrain, const bool do_solve = true);
+             const RasterMap *terrain, const bool do_solve = true,
+             const bool incremental = false);
 
   bool FindPositiveArrival(const AGeoPoint dest, const RoutePolars &rpolars,
                            ReachResult &result_r) const;
@@ -64,6 +116,28 @@ public:
   int GetTerrainBase() const {
     return terrain_base;
   }
+
+  /**
+   * Returns the number of fans recycled by the last Solve() call.
+   */
+  unsigned GetReusedFans() const {
+    return reused_fans;
+  }
+
+private:
+  gcc_pure
+  PolarSignature CalcSignature(const AFlatGeoPoint &origin,
+                               const GeoPoint &geo_origin,
+                               const RoutePolars &rpolars) const;
+
+  /**
+   * Can the previous solution be recycled for a solve at the given
+   * origin?
+   */
+  gcc_pure
+  bool CanSolveIncremental(const AGeoPoint &origin,
+                           const RoutePolars &rpolars,
+                           const RasterMap *terrain) const;
 };
 
 #endif
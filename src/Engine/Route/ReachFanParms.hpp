@@ -24,9 +24,13 @@
 #define REACHFAN_PARMS_HPP
 
 #include "Route/RoutePolars.hpp"
+#include "Geo/Flat/FlatGeoPoint.hpp"
+
+#include <vector>
 
 class FlatProjection;
 class RasterMap;
+class FlatTriangleFanTree;
 
 struct ReachFanParms {
   const RoutePolars &rpolars;
@@ -38,6 +42,34 @@ struct ReachFanParms {
   unsigned vertex_counter = 0;
   unsigned char set_depth = 0;
 
+  /**
+   * Fans of the previous solve which may be recycled by an
+   * incremental solve, sorted by depth and polar index.  Recycled
+   * fans are removed from the list.  Empty for a full solve.
+   */
+  std::vector<const FlatTriangleFanTree *> reusable;
+
+  /**
+   * Movement of the origin since the previous solve, i.e. the new
+   * origin minus the old origin in the previous projection.  Each
+   * solve projects around its own origin, so adding this to a point
+   * of the previous tree yields the point which has moved along
+   * with the aircraft.
+   */
+  FlatGeoPoint shift = FlatGeoPoint(0, 0);
+
+  /** Altitude change (m) of the origin since the previous solve */
+  int climb = 0;
+
+  /**
+   * Maximum distance (flat units) between a new fan origin and the
+   * (shifted) origin of a recycled fan
+   */
+  int reuse_distance = 0;
+
+  /** Number of fans recycled by this solve */
+  unsigned reuse_counter = 0;
+
   ReachFanParms(const RoutePolars& _rpolars,
                 const FlatProjection &_projection,
                 const short _terrain_base,
@@ -57,23 +57,27 @@ RoutePlanner::Reset()
 bool
 RoutePlanner::SolveReachTerrain(const AGeoPoint &origin,
                                 const RoutePlannerConfig &config,
-                                const int h_ceiling, const bool do_solve)
+                                const int h_ceiling, const bool do_solve,
+                                const bool incremental)
 {
   rpolars_reach.SetConfig(config, origin.altitude, h_ceiling);
   reach_polar_mode = config.reach_polar_mode;
 
-  return reach_terrain.Solve(origin, rpolars_reach, terrain, do_solve);
+  return reach_terrain.Solve(origin, rpolars_reach, terrain, do_solve,
+                             incremental);
 }
 
 bool
 RoutePlanner::SolveReachWorking(const AGeoPoint &origin,
                                 const RoutePlannerConfig &config,
-                                const int h_ceiling, const bool do_solve)
+                                const int h_ceiling, const bool do_solve,
+                                const bool incremental)
 {
   rpolars_reach_working.SetConfig(config, origin.altitude, h_ceiling);
   // reach_polar_mode previously set by SolveReachTerrain
 
-  return reach_working.Solve(origin, rpolars_reach_working, terrain, do_solve);
+  return reach_working.Solve(origin, rpolars_reach_working, terrain, do_solve,
+                             incremental);
 }
 
 bool
@@ -33,6 +33,7 @@
 
 #include <utility>
 #include <unordered_set>
+#include <queue>
 
 #include <limits.h>
 
@@ -205,22 +206,28 @@ public:
    *
    * @param origin The start of the search (current aircraft location)
    * @param do_solve actually solve or just perform minimal calculations
+   * @param incremental recycle parts of the previous solution if the
+   * aircraft has moved only a little (see ReachFan::Solve())
    *
    * @return True if reach was scanned
    */
   bool SolveReachTerrain(const AGeoPoint &origin, const RoutePlannerConfig &config,
-                         int h_ceiling, bool do_solve=true);
+                         int h_ceiling, bool do_solve=true,
+                         bool incremental=false);
 
   /**
    * Solve reach footprint to working height
    *
    * @param origin The start of the search (current aircraft location)
    * @param do_solve actually solve or just perform minimal calculations
+   * @param incremental recycle parts of the previous solution if the
+   * aircraft has moved only a little (see ReachFan::Solve())
    *
    * @return True if reach was scanned
    */
   bool SolveReachWorking(const AGeoPoint &origin, const RoutePlannerConfig &config,
-                         int h_ceiling, bool do_solve=true);
+                         int h_ceiling, bool do_solve=true,
+                         bool incremental=false);
 
   const FlatProjection &GetTerrainReachProjection() const {
     return reach_terrain.GetProjection();
@@ -291,6 +298,13 @@ public:
     return reach_terrain.GetTerrainBase();
   }
 
+  /**
+   * The number of fans recycled by the last terrain reach solve.
+   */
+  unsigned GetReusedFans() const {
+    return reach_terrain.GetReusedFans();
+  }
+
 protected:
   /**
    * Test whether a solution is required or the solution is trivial
@@ -555,6 +555,12 @@ TaskManager::SetIntersectionTest(AbortIntersectionTest *test)
   abort_task->SetIntersectionTest(test);
 }
 
+void
+TaskManager::SetExecutor(ParallelExecutor *executor)
+{
+  abort_task->SetExecutor(executor);
+}
+
 void
 TaskManager::TakeoffAutotask(const GeoPoint &loc, const double terrain_alt)
 {
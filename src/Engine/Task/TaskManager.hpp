@@ -42,6 +42,7 @@ class AlternateTask;
 class AlternateList;
 class TaskWaypoint;
 class AbortIntersectionTest;
+class ParallelExecutor;
 struct RangeAndRadial;
 
 /**
@@ -441,6 +442,13 @@ public:
    */
   void SetIntersectionTest(AbortIntersectionTest *test);
 
+  /**
+   * Evaluate the landables of the abort/alternate task concurrently
+   * on the given executor (nullptr to evaluate them in the calling
+   * thread).  The #AbortIntersectionTest must allow concurrent calls.
+   */
+  void SetExecutor(ParallelExecutor *executor);
+
   /**
    * When called on takeoff, will create a goto task to the nearest waypoint if
    * no other task is active.
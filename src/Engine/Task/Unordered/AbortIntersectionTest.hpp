@@ -28,6 +28,11 @@ struct AGeoPoint;
 
 class AbortIntersectionTest {
 public:
+  /**
+   * This may be called from several threads at a time if the
+   * #AbortTask has a #ParallelExecutor, and must therefore not modify
+   * shared state.
+   */
   virtual bool Intersects(const AGeoPoint &destination) = 0;
 };
 
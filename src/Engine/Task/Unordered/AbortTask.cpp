@@ -30,14 +30,25 @@
 #include "Waypoint/Waypoints.hpp"
 #include "Waypoint/WaypointVisitor.hpp"
 #include "Util/ReservablePriorityQueue.hpp"
+#include "Util/ParallelExecutor.hpp"
 #include "Util/Clamp.hpp"
 
+#include <algorithm>
+#include <memory>
+
 /** min search range in m */
 static constexpr double min_search_range = 50000;
 
 /** max search range in m */
 static constexpr double max_search_range = 100000;
 
+/**
+ * The number of candidates evaluated by one job of FillReachable().
+ * Each one is cheap, so a job per candidate would be dominated by the
+ * scheduling overhead.
+ */
+static constexpr unsigned reachable_chunk_size = 8;
+
 AbortTask::AbortTask(const TaskBehaviour &_task_behaviour,
                      const Waypoints &wps)
   :UnorderedTask(TaskType::ABORT, _task_behaviour),
@@ -122,8 +133,14 @@ struct AbortRank
 {
   /** Condition, ranks by arrival time */
   bool operator()(const AlternatePoint &x, const AlternatePoint &y) const {
-    return x.solution.time_elapsed + x.solution.time_virtual >
-           y.solution.time_elapsed + y.solution.time_virtual;
+    const auto tx = x.solution.time_elapsed + x.solution.time_virtual;
+    const auto ty = y.solution.time_elapsed + y.solution.time_virtual;
+    if (tx != ty)
+      return tx > ty;
+
+    /* break ties by waypoint id, so the order does not depend on the
+       order of the candidates */
+    return x.waypoint->id > y.waypoint->id;
   }
 };
 
@@ -136,6 +153,28 @@ IsReachable(const GlideResult &result, bool final_glide)
     : result.IsAchievable();
 }
 
+bool
+AbortTask::CheckReachable(const AircraftState &state,
+                          AlternatePoint &candidate,
+                          const GlidePolar &polar, bool final_glide) const
+{
+  auto wp = candidate.waypoint;
+  UnorderedTaskPoint t(std::move(wp), task_behaviour);
+  candidate.solution =
+    TaskSolution::GlideSolutionRemaining(t, state,
+                                         task_behaviour.glide, polar);
+
+  if (!IsReachable(candidate.solution, final_glide))
+    return false;
+
+  if (intersection_test && final_glide &&
+      IsReachable(candidate.solution, true))
+    return !intersection_test->Intersects(AGeoPoint(candidate.waypoint->location,
+                                                    candidate.solution.min_arrival_altitude));
+
+  return true;
+}
+
 bool
 AbortTask::FillReachable(const AircraftState &state,
                          AlternateList &approx_waypoints,
@@ -145,48 +184,47 @@ AbortTask::FillReachable(const AircraftState &state,
   if (IsTaskFull() || approx_waypoints.empty())
     return false;
 
-  const AGeoPoint p_start(state.location, state.altitude);
+  /* evaluate all candidates (concurrently if there is an executor);
+     each job writes only to its own candidates and to its own slots
+     of the "accepted" array */
+  const unsigned n = approx_waypoints.size();
+  std::unique_ptr<bool[]> accepted(new bool[n]);
+
+  const unsigned n_chunks =
+    (n + reachable_chunk_size - 1) / reachable_chunk_size;
+  ParallelForEach(executor, n_chunks, [&](unsigned chunk){
+      const unsigned begin = chunk * reachable_chunk_size;
+      const unsigned end = std::min(begin + reachable_chunk_size, n);
+      for (unsigned i = begin; i < end; ++i) {
+        AlternatePoint &v = approx_waypoints[i];
+        accepted[i] = (!only_airfield || v.waypoint->IsAirport()) &&
+          CheckReachable(state, v, polar, final_glide);
+      }
+    });
 
+  /* merge the results in the original order, and remove the accepted
+     candidates from the list since they are in the task now */
   bool found_final_glide = false;
   reservable_priority_queue<AlternatePoint, AlternateList, AbortRank> q;
   q.reserve(32);
 
-  for (auto v = approx_waypoints.begin(); v != approx_waypoints.end();) {
-    if (only_airfield && !v->waypoint->IsAirport()) {
-      ++v;
-      continue;
+  auto dest = approx_waypoints.begin();
+  for (unsigned i = 0; i < n; ++i) {
+    AlternatePoint &v = approx_waypoints[i];
+    if (accepted[i]) {
+      if (IsReachable(v.solution, true))
+        found_final_glide = true;
+
+      q.push(std::move(v));
+    } else {
+      if (&*dest != &v)
+        *dest = std::move(v);
+      ++dest;
     }
-
-    auto wp = v->waypoint;
-    UnorderedTaskPoint t(std::move(wp), task_behaviour);
-    GlideResult result =
-        TaskSolution::GlideSolutionRemaining(t, state,
-                                             task_behaviour.glide, polar);
-
-    if (IsReachable(result, final_glide)) {
-      bool intersects = false;
-      const bool is_reachable_final = IsReachable(result, true);
-
-      if (intersection_test && final_glide && is_reachable_final)
-        intersects = intersection_test->Intersects(
-            AGeoPoint(v->waypoint->location, result.min_arrival_altitude));
-
-      if (!intersects) {
-        wp = v->waypoint;
-        q.push(AlternatePoint(std::move(wp), result));
-        // remove it since it's already in the list now      
-        v = approx_waypoints.erase(v);
-
-        if (is_reachable_final)
-          found_final_glide = true;
-
-        continue; // skip incrementing v since we just erased it
-      }
-    } 
-
-    ++v;
   }
 
+  approx_waypoints.erase(dest, approx_waypoints.end());
+
   while (!q.empty() && !IsTaskFull()) {
     auto top = q.top();
     task_points.emplace_back(std::move(top.waypoint), task_behaviour,
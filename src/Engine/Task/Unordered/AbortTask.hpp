@@ -33,6 +33,8 @@
 class Waypoints;
 class AbortIntersectionTest;
 class AlternateList;
+struct AlternatePoint;
+class ParallelExecutor;
 
 /**
  * Abort task provides automatic management of a sorted list of task points
@@ -76,6 +78,12 @@ protected:
   /** Hook for external intersection tests */
   AbortIntersectionTest* intersection_test;
 
+  /**
+   * Evaluates the candidate landables concurrently, or nullptr to
+   * evaluate them sequentially.
+   */
+  ParallelExecutor *executor = nullptr;
+
 private:
   unsigned active_waypoint;
   bool reachable_landable;
@@ -173,6 +181,19 @@ protected:
                      const GlidePolar &polar, bool only_airfield,
                      bool final_glide, bool safety);
 
+private:
+  /**
+   * Calculate the glide solution to one candidate of FillReachable()
+   * and store it in the candidate.  This only reads the task's
+   * state, so it may be called for several candidates concurrently.
+   *
+   * @return true if the candidate is reachable and does not
+   * intersect terrain
+   */
+  bool CheckReachable(const AircraftState &state,
+                      AlternatePoint &candidate,
+                      const GlidePolar &polar, bool final_glide) const;
+
 protected:
   /**
    * This is called by update_sample after the turnpoint list has 
@@ -198,6 +219,14 @@ public:
     intersection_test = test;
   }
 
+  /**
+   * Evaluate the candidate landables on the given executor.  Their
+   * order in the resulting list does not depend on it.
+   */
+  void SetExecutor(ParallelExecutor *_executor) {
+    executor = _executor;
+  }
+
   /**
    * Accept a const task point visitor; makes the visitor visit
    * all TaskPoint in the task
@@ -55,11 +55,15 @@ struct AlternateRank:
                               AlternateTask::Divert, bool>
 {
   /**
-   * Condition, ranks by distance diversion 
+   * Condition, ranks by distance diversion; ties are broken by
+   * waypoint id to keep the order deterministic
    */
   bool operator()(const AlternateTask::Divert& x, 
                   const AlternateTask::Divert& y) const {
-    return x.delta < y.delta;
+    if (x.delta != y.delta)
+      return x.delta < y.delta;
+
+    return x.waypoint->id > y.waypoint->id;
   }
 };
 
@@ -23,36 +23,123 @@ Copyright_License {
 
 #include "Trace.hpp"
 #include "Vector.hpp"
-#include "Util/GlobalSliceAllocator.hpp"
 
 #include <algorithm>
 
+#include <stdlib.h>
+
+void
+Trace::EliminationQueue::Init(unsigned n)
+{
+  elim_distance.resize(n);
+  elim_time.resize(n);
+  previous.resize(n);
+  next.resize(n);
+
+  for (unsigned i = 0; i < n; ++i) {
+    previous[i] = i - 1;
+    next[i] = i + 1;
+  }
+
+  heap.clear();
+  heap.reserve(n);
+  position.assign(n, unsigned(NONE));
+}
+
+void
+Trace::EliminationQueue::SiftUp(unsigned heap_index)
+{
+  const unsigned i = heap[heap_index];
+  while (heap_index > 0) {
+    const unsigned parent = (heap_index - 1) / 2;
+    if (!Less(i, heap[parent]))
+      break;
+
+    Place(heap_index, heap[parent]);
+    heap_index = parent;
+  }
+
+  Place(heap_index, i);
+}
+
+void
+Trace::EliminationQueue::SiftDown(unsigned heap_index)
+{
+  const unsigned n = heap.size();
+  const unsigned i = heap[heap_index];
+  while (true) {
+    unsigned child = 2 * heap_index + 1;
+    if (child >= n)
+      break;
+
+    if (child + 1 < n && Less(heap[child + 1], heap[child]))
+      ++child;
+
+    if (!Less(heap[child], i))
+      break;
+
+    Place(heap_index, heap[child]);
+    heap_index = child;
+  }
+
+  Place(heap_index, i);
+}
+
+void
+Trace::EliminationQueue::Heapify()
+{
+  for (unsigned heap_index = heap.size() / 2; heap_index-- > 0;)
+    SiftDown(heap_index);
+}
+
+unsigned
+Trace::EliminationQueue::Pop()
+{
+  assert(!heap.empty());
+
+  const unsigned top = heap.front();
+  position[top] = NONE;
+
+  const unsigned last = heap.back();
+  heap.pop_back();
+  if (!heap.empty() && last != top) {
+    Place(0, last);
+    SiftDown(0);
+  }
+
+  return top;
+}
+
+void
+Trace::EliminationQueue::Update(unsigned i)
+{
+  const unsigned heap_index = position[i];
+  if (heap_index == NONE)
+    return;
+
+  SiftUp(heap_index);
+  SiftDown(position[i]);
+}
+
 Trace::Trace(const unsigned _no_thin_time, const unsigned max_time,
              const unsigned max_size)
-  :cached_size(0),
-   max_time(max_time),
+  :max_time(max_time),
    no_thin_time(_no_thin_time),
    max_size(max_size),
    opt_size((3 * max_size) / 4)
 {
   assert(max_size >= 4);
+
+  points.reserve(max_size);
 }
 
 void
 Trace::clear()
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
   average_delta_distance = 0;
   average_delta_time = 0;
 
-  delta_list.clear();
-  chronological_list.clear_and_dispose(MakeDisposer());
-  cached_size = 0;
-
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
+  points.clear();
 
   ++modify_serial;
   ++append_serial;
@@ -71,102 +158,104 @@ Trace::GetRecentTime(const unsigned t) const
   return 0;
 }
 
-void
-Trace::UpdateDelta(TraceDelta &td)
+unsigned
+Trace::DistanceMetric(const TracePoint &last, const TracePoint &node,
+                      const TracePoint &next)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
-  if (&td == &chronological_list.front() ||
-      &td == &chronological_list.back())
-    return;
-
-  const auto ci = chronological_list.iterator_to(td);
-  const TraceDelta &previous = *std::prev(ci);
-  const TraceDelta &next = *std::next(ci);
+  const int d_this = last.FlatDistanceTo(node) + node.FlatDistanceTo(next);
+  const int d_rem = last.FlatDistanceTo(next);
+  return abs(d_this - d_rem);
+}
 
-  delta_list.erase(delta_list.iterator_to(td));
-  td.Update(previous.point, next.point);
-  delta_list.insert(td);
+unsigned
+Trace::TimeMetric(const TracePoint &last, const TracePoint &node,
+                  const TracePoint &next)
+{
+  return next.DeltaTime(last)
+    - std::min(next.DeltaTime(node), node.DeltaTime(last));
 }
 
 void
-Trace::EraseInside(DeltaList::iterator it)
+Trace::UpdateMetrics(unsigned i)
 {
-  assert(cached_size > 0);
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-  assert(it != delta_list.end());
-
-  const TraceDelta &td = *it;
-  assert(!td.IsEdge());
-
-  const auto ci = chronological_list.iterator_to(td);
-  TraceDelta &previous = const_cast<TraceDelta &>(*std::prev(ci));
-  TraceDelta &next = const_cast<TraceDelta &>(*std::next(ci));
-
-  // now delete the item
-  chronological_list.erase(chronological_list.iterator_to(td));
-  delta_list.erase_and_dispose(it, MakeDisposer());
-  --cached_size;
-
-  // and update the deltas
-  UpdateDelta(previous);
-  UpdateDelta(next);
+  const TracePoint &previous = points[queue.previous[i]];
+  const TracePoint &point = points[i];
+  const TracePoint &next = points[queue.next[i]];
+
+  queue.elim_distance[i] = DistanceMetric(previous, point, next);
+  queue.elim_time[i] = TimeMetric(previous, point, next);
 }
 
 bool
 Trace::EraseDelta(const unsigned target_size, const unsigned recent)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
   if (size() <= 2)
     return false;
 
-  bool modified = false;
-
   const unsigned recent_time = GetRecentTime(recent);
+  const unsigned n = size();
 
-  auto candidate = delta_list.begin();
-  while (size() > target_size) {
-    const TraceDelta &td = *candidate;
-    if (!td.IsEdge() && td.point.GetTime() < recent_time) {
-      EraseInside(candidate);
-      candidate = delta_list.begin(); // find new top
-      modified = true;
-    } else {
-      ++candidate;
-      // suppressed removal, skip it.
+  /* rank all points except for the edges and the recent ones */
+  queue.Init(n);
+  for (unsigned i = 1; i + 1 < n; ++i) {
+    if (points[i].GetTime() >= recent_time)
+      /* all following points are even more recent */
+      break;
+
+    UpdateMetrics(i);
+    queue.Add(i);
+  }
+
+  queue.Heapify();
+
+  unsigned remaining = n;
+  while (remaining > target_size && !queue.empty()) {
+    const unsigned i = queue.Pop();
+    const unsigned previous = queue.previous[i];
+    const unsigned next = queue.next[i];
+
+    /* unlink the point and re-rank its neighbours */
+    queue.next[previous] = next;
+    queue.previous[next] = previous;
+    --remaining;
+
+    if (previous > 0) {
+      UpdateMetrics(previous);
+      queue.Update(previous);
+    }
+
+    if (next + 1 < n) {
+      UpdateMetrics(next);
+      queue.Update(next);
     }
   }
 
-  return modified;
+  if (remaining == n)
+    return false;
+
+  /* compact the surviving points (the first point is never
+     eliminated) */
+  unsigned dest = 0;
+  for (unsigned i = 0; i < n; i = queue.next[i])
+    points[dest++] = points[i];
+
+  assert(dest == remaining);
+  points.resize(remaining);
+  return true;
 }
 
 bool
 Trace::EraseEarlierThan(const unsigned p_time)
 {
-  if (p_time == 0 || empty() || GetFront().point.GetTime() >= p_time)
+  if (p_time == 0 || empty() || front().GetTime() >= p_time)
     // there will be nothing to remove
     return false;
 
-  do {
-    auto ci = chronological_list.begin();
-    TraceDelta &td = *ci;
-    chronological_list.erase(ci);
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase_and_dispose(i, MakeDisposer());
-
-    --cached_size;
-  } while (!empty() && GetFront().point.GetTime() < p_time);
-
-  // need to set deltas for first point, only one of these
-  // will occur (have to search for this point)
-  if (!empty())
-    EraseStart(GetFront());
+  const auto first = std::find_if(points.begin(), points.end(),
+                                  [p_time](const TracePoint &p){
+                                    return p.GetTime() >= p_time;
+                                  });
+  points.erase(points.begin(), first);
 
   ++modify_serial;
   ++append_serial;
@@ -179,44 +268,13 @@ Trace::EraseLaterThan(const unsigned min_time)
   assert(min_time > 0);
   assert(!empty());
 
-  while (!empty() && GetBack().point.GetTime() > min_time) {
-    TraceDelta &td = GetBack();
-
-    chronological_list.erase(chronological_list.iterator_to(td));
-
-    auto i = delta_list.find(td);
-    assert(i != delta_list.end());
-    delta_list.erase_and_dispose(i, MakeDisposer());
-
-    --cached_size;
-  }
-
-  /* need to set deltas for first point, only one of these will occur
-     (have to search for this point) */
-  if (!empty())
-    EraseStart(GetBack());
-}
-
-/**
- * Update start node (and neighbour) after min time pruning
- */
-void
-Trace::EraseStart(TraceDelta &td)
-{
-  delta_list.erase(delta_list.iterator_to(td));
-
-  td.elim_distance = null_delta;
-  td.elim_time = null_time;
-
-  delta_list.insert(td);
+  while (!empty() && back().GetTime() > min_time)
+    points.pop_back();
 }
 
 void
 Trace::push_back(const TracePoint &point)
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
-
   if (empty()) {
     // first point determines origin for flat projection
     task_projection.Reset(point.GetLocation());
@@ -244,17 +302,8 @@ Trace::push_back(const TracePoint &point)
 
   assert(size() < max_size);
 
-  TraceDelta *td = allocator.allocate(1);
-  allocator.construct(td, point);
-  td->point.Project(task_projection);
-
-  delta_list.insert(*td);
-  chronological_list.push_back(*td);
-
-  ++cached_size;
-
-  if (td != &chronological_list.front())
-    UpdateDelta(*std::prev(chronological_list.iterator_to(*td)));
+  points.push_back(point);
+  points.back().Project(task_projection);
 
   ++append_serial;
 }
@@ -266,10 +315,10 @@ Trace::CalcAverageDeltaDistance(const unsigned no_thin) const
   unsigned acc = 0;
   unsigned counter = 0;
 
-  const auto end = chronological_list.end();
-  for (auto it = chronological_list.begin();
-       it != end && it->point.GetTime() < r; ++it, ++counter)
-    acc += it->delta_distance;
+  for (unsigned n = size(); counter < n && points[counter].GetTime() < r;
+       ++counter)
+    if (counter > 0)
+      acc += points[counter].FlatDistanceTo(points[counter - 1]);
 
   if (counter)
     return acc / counter;
@@ -284,19 +333,16 @@ Trace::CalcAverageDeltaTime(const unsigned no_thin) const
   unsigned counter = 0;
 
   /* find the last item before the "r" timestamp */
-  const auto end = chronological_list.end();
-  ChronologicalList::const_iterator it;
-  for (it = chronological_list.begin(); it != end && it->point.GetTime() < r; ++it)
+  for (unsigned n = size(); counter < n && points[counter].GetTime() < r;)
     ++counter;
 
   if (counter < 2)
     return 0;
 
-  --it;
   --counter;
 
   unsigned start_time = front().GetTime();
-  unsigned end_time = it->point.GetTime();
+  unsigned end_time = points[counter].GetTime();
   return (end_time - start_time) / counter;
 }
 
@@ -337,8 +383,6 @@ Trace::Thin2()
 void
 Trace::Thin()
 {
-  assert(cached_size == delta_list.size());
-  assert(cached_size == chronological_list.size());
   assert(size() == max_size);
 
   Thin2();
@@ -355,75 +399,7 @@ Trace::Thin()
 void
 Trace::GetPoints(TracePointVector& iov) const
 {
-  iov.clear();
-  iov.reserve(size());
-  std::copy(begin(), end(), std::back_inserter(iov));
-}
-
-template<typename I>
-class PointerIterator {
-  I i;
-
-public:
-  typedef typename I::iterator_category iterator_category;
-  typedef typename I::pointer value_type;
-  typedef typename I::pointer *pointer;
-  typedef value_type &reference;
-  typedef typename I::difference_type difference_type;
-
-  PointerIterator() = default;
-  explicit PointerIterator(I _i):i(_i) {}
-  PointerIterator<I> &operator=(const PointerIterator<I> &other) = default;
-
-  PointerIterator<I> &operator--() {
-    --i;
-    return *this;
-  }
-
-  PointerIterator<I> &operator++() {
-    ++i;
-    return *this;
-  }
-
-  typename I::pointer operator*() {
-    return &*i;
-  }
-
-  bool operator==(const PointerIterator<I> &other) const {
-    return i == other.i;
-  }
-
-  bool operator!=(const PointerIterator<I> &other) const {
-    return i != other.i;
-  }
-};
-
-void
-Trace::GetPoints(TracePointerVector &v) const
-{
-  v.clear();
-  v.reserve(size());
-  std::copy(PointerIterator<decltype(begin())>(begin()),
-            PointerIterator<decltype(end())>(end()),
-            std::back_inserter(v));
-}
-
-bool
-Trace::SyncPoints(TracePointerVector &v) const
-{
-  assert(v.size() <= size());
-
-  if (v.size() == size())
-    /* no news */
-    return false;
-
-  v.reserve(size());
-
-  PointerIterator<decltype(end())> e(end());
-  std::copy(std::prev(e, size() - v.size()), e,
-            std::back_inserter(v));
-  assert(v.size() == size());
-  return true;
+  iov.assign(points.begin(), points.end());
 }
 
 void
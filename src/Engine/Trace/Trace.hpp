@@ -26,21 +26,16 @@ Copyright_License {
 
 #include "Point.hpp"
 #include "Util/NonCopyable.hpp"
-#include "Util/SliceAllocator.hpp"
+#include "Util/ConstBuffer.hxx"
 #include "Util/Serial.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "Compiler.h"
 
-#include <boost/intrusive/list.hpp>
-#include <boost/intrusive/set.hpp>
-
-#include <algorithm>
+#include <vector>
 
 #include <assert.h>
-#include <stdlib.h>
 
 class TracePointVector;
-class TracePointerVector;
 
 /**
  * This class uses a smart thinning algorithm to limit the number of items
@@ -51,137 +46,111 @@ class TracePointerVector;
  * the candidate point removed.  In this version, time differences is also a
  * secondary factor, such that thinning attempts to remove points such that,
  * for equal distance ranking, smaller time step details are removed first.
+ *
+ * The points are stored in one contiguous chronological array; the
+ * ranking is only built (in a separate set of arrays) while thinning.
  */
 class Trace : private NonCopyable
 {
-  struct TraceDelta
-    : boost::intrusive::set_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>>,
-      boost::intrusive::list_base_hook<boost::intrusive::link_mode<boost::intrusive::normal_link>> {
+  /**
+   * An indexed binary min-heap of point indices used by
+   * EraseDelta().  The ranking metrics and the chronological links
+   * are stored in flat arrays indexed by the point's position in
+   * #points.
+   */
+  class EliminationQueue {
+  public:
+    std::vector<unsigned> elim_distance, elim_time;
 
     /**
-     * Function used to points for sorting by deltas.
-     * Ranking is primarily by distance delta; for equal distances, rank by
-     * time delta.
-     * This is like a modified Douglas-Peuker algorithm
+     * The chronological neighbours of each point, skipping points
+     * which have already been eliminated.
      */
-    gcc_pure
-    static bool DeltaRank(const TraceDelta &x, const TraceDelta &y) {
-      // distance is king
-      if (x.elim_distance < y.elim_distance)
-        return true;
+    std::vector<unsigned> previous, next;
 
-      if (x.elim_distance > y.elim_distance)
-        return false;
+  private:
+    std::vector<unsigned> heap;
 
-      // distance is equal, so go by time error
-      if (x.elim_time < y.elim_time)
-        return true;
-
-      if (x.elim_time > y.elim_time)
-        return false;
-
-      // all else fails, go by age
-      if (x.point.IsOlderThan(y.point))
-        return true;
+    /**
+     * The position of each point in #heap, or #NONE if it is not
+     * (or no longer) a candidate.
+     */
+    std::vector<unsigned> position;
 
-      if (x.point.IsNewerThan(y.point))
-        return false;
+    static constexpr unsigned NONE = 0 - 1;
 
-      return false;
-    }
+  public:
+    /**
+     * Prepare the arrays for a trace with the given number of
+     * points, and link them chronologically.
+     */
+    void Init(unsigned n);
 
-    struct DeltaRankOp {
-      gcc_pure
-      bool operator()(const TraceDelta &s1, const TraceDelta &s2) const {
-        return DeltaRank(s1, s2);
-      }
-    };
-
-    TracePoint point;
-
-    unsigned elim_time;
-    unsigned elim_distance;
-    unsigned delta_distance;
-
-    explicit TraceDelta(const TracePoint &p)
-      :point(p),
-       elim_time(null_time), elim_distance(null_delta),
-       delta_distance(0) {}
-
-    TraceDelta(const TracePoint &p_last, const TracePoint &p,
-               const TracePoint &p_next)
-      :point(p),
-       elim_time(TimeMetric(p_last, p, p_next)),
-       elim_distance(DistanceMetric(p_last, p, p_next)),
-       delta_distance(p.FlatDistanceTo(p_last))
-    {
-      assert(elim_distance != null_delta);
+    bool empty() const {
+      return heap.empty();
     }
 
     /**
-     * Is this the first or the last point?
+     * Add a candidate.  Call Heapify() after all candidates have
+     * been added.
      */
-    bool IsEdge() const {
-      return elim_time == null_time;
+    void Add(unsigned i) {
+      position[i] = heap.size();
+      heap.push_back(i);
     }
 
-    void Update(const TracePoint &p_last, const TracePoint &p_next) {
-      elim_time = TimeMetric(p_last, point, p_next);
-      elim_distance = DistanceMetric(p_last, point, p_next);
-      delta_distance = point.FlatDistanceTo(p_last);
-    }
+    void Heapify();
 
     /**
-     * Calculate error distance, between last through this to next,
-     * if this node is removed.  This metric provides for Douglas-Peuker
-     * thinning.
-     *
-     * @param last Point previous in time to this node
-     * @param node This node
-     * @param next Point succeeding this node
-     *
-     * @return Distance error if this node is thinned
+     * Remove and return the candidate with the lowest rank.
      */
-    static unsigned DistanceMetric(const TracePoint &last,
-                                   const TracePoint &node,
-                                   const TracePoint &next) {
-      const int d_this = last.FlatDistanceTo(node) + node.FlatDistanceTo(next);
-      const int d_rem = last.FlatDistanceTo(next);
-      return abs(d_this - d_rem);
-    }
+    unsigned Pop();
+
+    /**
+     * Restore the heap order after the metrics of the given point
+     * have been changed.  No-op if the point is not a candidate.
+     */
+    void Update(unsigned i);
 
+  private:
     /**
-     * Calculate error time, between last through this to next,
-     * if this node is removed.  This metric provides for fair thinning
-     * (tendency to to result in equal time steps)
-     *
-     * @param last Point previous in time to this node
-     * @param node This node
-     * @param next Point succeeding this node
-     *
-     * @return Time delta if this node is thinned
+     * Ranking is primarily by distance delta; for equal distances,
+     * rank by time delta, and finally by age (the index is
+     * chronological).  This is like a modified Douglas-Peuker
+     * algorithm.
      */
-    static unsigned TimeMetric(const TracePoint &last, const TracePoint &node,
-                               const TracePoint &next) {
-      return next.DeltaTime(last)
-        - std::min(next.DeltaTime(node), node.DeltaTime(last));
+    gcc_pure
+    bool Less(unsigned a, unsigned b) const {
+      if (elim_distance[a] != elim_distance[b])
+        return elim_distance[a] < elim_distance[b];
+
+      if (elim_time[a] != elim_time[b])
+        return elim_time[a] < elim_time[b];
+
+      return a < b;
     }
-  };
 
-  /* using multiset, not because we need multiple values (we don't),
-     but to avoid set's overhead for duplicate elimination */
-  typedef boost::intrusive::multiset<TraceDelta,
-                                     boost::intrusive::compare<TraceDelta::DeltaRankOp>,
-                                     boost::intrusive::constant_time_size<false>> DeltaList;
+    void Place(unsigned heap_index, unsigned i) {
+      heap[heap_index] = i;
+      position[i] = heap_index;
+    }
 
-  typedef boost::intrusive::list<TraceDelta,
-                                 boost::intrusive::constant_time_size<false>> ChronologicalList;
+    void SiftUp(unsigned heap_index);
+    void SiftDown(unsigned heap_index);
+  };
 
-  SliceAllocator<TraceDelta, 128u> allocator;
+  /**
+   * All points, sorted by time.  The capacity is reserved in the
+   * constructor, therefore appending never moves existing points;
+   * only operations which increment #modify_serial do.
+   */
+  std::vector<TracePoint> points;
 
-  DeltaList delta_list;
-  ChronologicalList chronological_list;
-  unsigned cached_size;
+  /**
+   * Scratch space for EraseDelta(); kept here to avoid
+   * reallocation on each thinning pass.
+   */
+  EliminationQueue queue;
 
   TaskProjection task_projection;
 
@@ -195,25 +164,6 @@ class Trace : private NonCopyable
 
   Serial append_serial, modify_serial;
 
-  template<typename Alloc>
-  struct Disposer {
-    Alloc &alloc;
-
-    void operator()(typename Alloc::pointer td) {
-      alloc.destroy(td);
-      alloc.deallocate(td, 1);
-    }
-  };
-
-  template<typename Alloc>
-  static Disposer<Alloc> MakeDisposer(Alloc &alloc) {
-    return {alloc};
-  }
-
-  Disposer<decltype(allocator)> MakeDisposer() {
-    return MakeDisposer(allocator);
-  }
-
 public:
   /**
    * Constructor.  Task projection is updated after first call to append().
@@ -227,10 +177,6 @@ public:
                  const unsigned max_time = null_time,
                  const unsigned max_size = 1000);
 
-  ~Trace() {
-    clear();
-  }
-
 protected:
   /**
    * Find recent time after which points should not be culled
@@ -244,25 +190,10 @@ protected:
   unsigned GetRecentTime(const unsigned t) const;
 
   /**
-   * Update delta values for specified item in the delta list and the
-   * tree.  This repositions the item after into its sorted position.
-   *
-   * @param it Item to update
-   * @param tree Tree containing leaf
-   *
-   * @return Iterator to updated item
-   */
-  void UpdateDelta(TraceDelta &td);
-
-  /**
-   * Erase a non-edge item from delta list and tree, updating
-   * deltas in the process.  This Invalidates the calling iterator.
-   *
-   * @param it Item to erase
-   * @param tree Tree to remove from
-   *
+   * Calculate the ranking metrics of the specified non-edge point
+   * from its current neighbours in #queue.
    */
-  void EraseInside(DeltaList::iterator it);
+  void UpdateMetrics(unsigned i);
 
   /**
    * Erase elements based on delta metric until the size is
@@ -273,7 +204,6 @@ protected:
    * fail to set the target size.
    *
    * @param target_size Size of desired list.
-   * @param tree Tree to remove from
    * @param recent Time window for which to not remove points
    *
    * @return True if items were erased
@@ -282,11 +212,9 @@ protected:
                   const unsigned recent = 0);
 
   /**
-   * Erase elements older than specified time from delta and tree,
-   * and update earliest item to become the new start
+   * Erase elements older than specified time.
    *
    * @param p_time Time to remove
-   * @param tree Tree to remove from
    *
    * @return True if items were erased
    */
@@ -298,11 +226,6 @@ protected:
    */
   void EraseLaterThan(const unsigned min_time);
 
-  /**
-   * Update start node (and neighbour) after min time pruning
-   */
-  void EraseStart(TraceDelta &td_start);
-
 public:
   /**
    * Add trace to internal store.  Call optimise() periodically
@@ -330,13 +253,12 @@ public:
   }
 
   /**
-   * Size of traces (in tree, not in temporary store) ---
-   * must call optimise() before this for it to be accurate.
+   * Size of traces
    *
-   * @return Number of traces in tree
+   * @return Number of traces
    */
   unsigned size() const {
-    return cached_size;
+    return points.size();
   }
 
   /**
@@ -345,7 +267,7 @@ public:
    * @return True if no traces stored
    */
   bool empty() const {
-    return cached_size == 0;
+    return points.empty();
   }
 
   /**
@@ -377,18 +299,14 @@ public:
   void GetPoints(TracePointVector& iov) const;
 
   /**
-   * Retrieve a vector of trace points sorted by time
+   * Returns all trace points sorted by time.  The buffer is
+   * Invalidated when the #Trace gets modified; be sure to check
+   * GetModifySerial() for updates.  Appending new points does not
+   * Invalidate it (but it does not grow either).
    */
-  void GetPoints(TracePointerVector &v) const;
-
-  /**
-   * Update the given #TracePointVector after points were appended to
-   * this object.  This must not be called after thinning has
-   * occurred, see GetModifySerial().
-   *
-   * @return true if new points were added
-   */
-  bool SyncPoints(TracePointerVector &v) const;
+  ConstBuffer<TracePoint> GetPoints() const {
+    return ConstBuffer<TracePoint>(points.data(), points.size());
+  }
 
   /**
    * Fill the vector with trace points, not before #min_time, minimum
@@ -400,13 +318,13 @@ public:
   const TracePoint &front() const {
     assert(!empty());
 
-    return chronological_list.front().point;
+    return points.front();
   }
 
   const TracePoint &back() const {
     assert(!empty());
 
-    return chronological_list.back().point;
+    return points.back();
   }
 
 private:
@@ -433,17 +351,36 @@ private:
    */
   void Thin();
 
-  TraceDelta &GetFront() {
-    assert(!empty());
-
-    return chronological_list.front();
-  }
-
-  TraceDelta &GetBack() {
-    assert(!empty());
+  /**
+   * Calculate error distance, between last through this to next,
+   * if this node is removed.  This metric provides for Douglas-Peuker
+   * thinning.
+   *
+   * @param last Point previous in time to this node
+   * @param node This node
+   * @param next Point succeeding this node
+   *
+   * @return Distance error if this node is thinned
+   */
+  gcc_pure
+  static unsigned DistanceMetric(const TracePoint &last,
+                                 const TracePoint &node,
+                                 const TracePoint &next);
 
-    return chronological_list.back();
-  }
+  /**
+   * Calculate error time, between last through this to next,
+   * if this node is removed.  This metric provides for fair thinning
+   * (tendency to to result in equal time steps)
+   *
+   * @param last Point previous in time to this node
+   * @param node This node
+   * @param next Point succeeding this node
+   *
+   * @return Time delta if this node is thinned
+   */
+  gcc_pure
+  static unsigned TimeMetric(const TracePoint &last, const TracePoint &node,
+                             const TracePoint &next);
 
   gcc_pure
   unsigned CalcAverageDeltaDistance(const unsigned no_thin) const;
@@ -451,8 +388,6 @@ private:
   gcc_pure
   unsigned CalcAverageDeltaTime(const unsigned no_thin) const;
 
-  static constexpr unsigned null_delta = 0 - 1;
-
 public:
   static constexpr unsigned null_time = 0 - 1;
 
@@ -465,29 +400,19 @@ public:
   }
 
 public:
-  class const_iterator : public ChronologicalList::const_iterator {
+  class const_iterator : public std::vector<TracePoint>::const_iterator {
     friend class Trace;
 
-    const_iterator(ChronologicalList::const_iterator &&_iterator)
-      :ChronologicalList::const_iterator(std::move(_iterator)) {}
+    typedef std::vector<TracePoint>::const_iterator Base;
 
-  public:
-    using ChronologicalList::const_iterator::iterator_category;
-    using ChronologicalList::const_iterator::difference_type;
-    typedef const TracePoint value_type;
-    typedef const TracePoint *pointer;
-    typedef const TracePoint &reference;
+    const_iterator(Base _iterator):Base(_iterator) {}
 
+  public:
     const_iterator() = default;
 
-    const TracePoint &operator*() const {
-      const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-      return td.point;
-    }
-
-    const TracePoint *operator->() const {
-      const TraceDelta &td = ChronologicalList::const_iterator::operator*();
-      return &td.point;
+    const_iterator &operator++() {
+      Base::operator++();
+      return *this;
     }
 
     const_iterator &NextSquareRange(unsigned sq_resolution,
@@ -499,19 +424,18 @@ public:
         if (*this == end)
           return *this;
 
-        const TraceDelta &td = (const TraceDelta &)**this;
-        if (td.point.FlatSquareDistanceTo(previous) >= sq_resolution)
+        if ((*this)->FlatSquareDistanceTo(previous) >= sq_resolution)
           return *this;
       }
     }
   };
 
   const_iterator begin() const {
-    return chronological_list.begin();
+    return points.begin();
   }
 
   const_iterator end() const {
-    return chronological_list.end();
+    return points.end();
   }
 
   const TaskProjection &GetProjection() const {
@@ -0,0 +1,349 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "WaypointIndex.hpp"
+#include "Waypoint.hpp"
+
+#include <algorithm>
+
+#include <limits.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Spread the lower 32 bits of the value to the even bits of the
+ * result.
+ */
+gcc_const
+static uint64_t
+SpreadBits(uint64_t x)
+{
+  x &= 0xffffffff;
+  x = (x | (x << 16)) & 0x0000ffff0000ffffull;
+  x = (x | (x << 8)) & 0x00ff00ff00ff00ffull;
+  x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0full;
+  x = (x | (x << 2)) & 0x3333333333333333ull;
+  x = (x | (x << 1)) & 0x5555555555555555ull;
+  return x;
+}
+
+gcc_const
+static uint64_t
+MortonCode(int x, int y)
+{
+  /* flip the sign bits so the unsigned order matches the signed
+     one */
+  return SpreadBits(unsigned(x) ^ 0x80000000u) |
+    (SpreadBits(unsigned(y) ^ 0x80000000u) << 1);
+}
+
+gcc_const
+static int
+ClampToInt(int64_t value)
+{
+  return value < INT_MIN
+    ? INT_MIN
+    : (value > INT_MAX ? INT_MAX : int(value));
+}
+
+WaypointIndex::Query::Query(FlatGeoPoint _location, unsigned range)
+  :location(_location),
+   left(ClampToInt(int64_t(location.x) - range)),
+   bottom(ClampToInt(int64_t(location.y) - range)),
+   right(ClampToInt(int64_t(location.x) + range)),
+   top(ClampToInt(int64_t(location.y) + range)),
+   square_range(uint64_t(range) * range) {}
+
+uint64_t
+WaypointIndex::SquareDistance(unsigned node, FlatGeoPoint p) const
+{
+  const int64_t dx = p.x < box_left[node]
+    ? int64_t(box_left[node]) - p.x
+    : (p.x > box_right[node] ? int64_t(p.x) - box_right[node] : 0);
+  const int64_t dy = p.y < box_bottom[node]
+    ? int64_t(box_bottom[node]) - p.y
+    : (p.y > box_top[node] ? int64_t(p.y) - box_top[node] : 0);
+  return uint64_t(dx * dx) + uint64_t(dy * dy);
+}
+
+void
+WaypointIndex::Clear()
+{
+  items.clear();
+  xs.clear();
+  ys.clear();
+  box_left.clear();
+  box_bottom.clear();
+  box_right.clear();
+  box_top.clear();
+  levels.clear();
+}
+
+void
+WaypointIndex::Build(std::vector<WaypointPtr> &&waypoints)
+{
+  Clear();
+
+  if (waypoints.empty())
+    return;
+
+  /* sort along the Morton curve, so each leaf contains waypoints
+     which are close to each other */
+  struct Key {
+    uint64_t code;
+    unsigned index;
+
+    bool operator<(const Key &other) const {
+      return code < other.code;
+    }
+  };
+
+  const unsigned n = waypoints.size();
+  std::vector<Key> keys;
+  keys.reserve(n);
+  for (unsigned i = 0; i < n; ++i) {
+    const FlatGeoPoint &p = waypoints[i]->flat_location;
+    keys.push_back({MortonCode(p.x, p.y), i});
+  }
+
+  std::sort(keys.begin(), keys.end());
+
+  items.reserve(n);
+  xs.reserve(n);
+  ys.reserve(n);
+  for (const auto &key : keys) {
+    WaypointPtr &wp = waypoints[key.index];
+    xs.push_back(wp->flat_location.x);
+    ys.push_back(wp->flat_location.y);
+    items.emplace_back(std::move(wp));
+  }
+
+  waypoints.clear();
+
+  /* the leaves */
+  const unsigned n_leaves = (n + LEAF_SIZE - 1) / LEAF_SIZE;
+  const unsigned n_nodes = n_leaves + n_leaves / (FANOUT - 1) + 1;
+  box_left.reserve(n_nodes);
+  box_bottom.reserve(n_nodes);
+  box_right.reserve(n_nodes);
+  box_top.reserve(n_nodes);
+  levels.push_back(0);
+
+  for (unsigned leaf = 0; leaf < n_leaves; ++leaf) {
+    const unsigned start = GetLeafStart(leaf), end = GetLeafEnd(leaf);
+    FlatBoundingBox box(FlatGeoPoint(xs[start], ys[start]));
+    for (unsigned i = start + 1; i < end; ++i)
+      box.Expand(FlatGeoPoint(xs[i], ys[i]));
+    PushBox(box);
+  }
+
+  levels.push_back(box_left.size());
+
+  /* the levels above, until there is only the root */
+  while (levels.back() - levels[levels.size() - 2] > 1) {
+    const unsigned begin = levels[levels.size() - 2], end = levels.back();
+
+    for (unsigned i = begin; i < end; i += FANOUT) {
+      FlatBoundingBox box(FlatGeoPoint(box_left[i], box_bottom[i]),
+                          FlatGeoPoint(box_right[i], box_top[i]));
+      const unsigned group_end = std::min(i + FANOUT, end);
+      for (unsigned j = i + 1; j < group_end; ++j)
+        box.Merge(FlatBoundingBox(FlatGeoPoint(box_left[j], box_bottom[j]),
+                                  FlatGeoPoint(box_right[j], box_top[j])));
+      PushBox(box);
+    }
+
+    levels.push_back(box_left.size());
+  }
+}
+
+/**
+ * Portable implementation of WaypointIndex::FilterChildren().
+ */
+struct PortableNodeFilter {
+  static constexpr unsigned N = 1;
+
+  static unsigned Filter(const int *gcc_restrict l, const int *gcc_restrict b,
+                         const int *gcc_restrict r, const int *gcc_restrict t,
+                         unsigned n,
+                         int left, int bottom, int right, int top) {
+    unsigned mask = 0;
+    for (unsigned i = 0; i < n; ++i)
+      if (l[i] <= right && r[i] >= left && b[i] <= top && t[i] >= bottom)
+        mask |= 1u << i;
+    return mask;
+  }
+};
+
+/**
+ * Portable implementation of WaypointIndex::FilterLeaf().
+ */
+struct PortableLeafFilter {
+  static constexpr unsigned N = 1;
+
+  static unsigned Filter(const int *gcc_restrict xs,
+                         const int *gcc_restrict ys, unsigned n,
+                         int left, int bottom, int right, int top) {
+    unsigned mask = 0;
+    for (unsigned i = 0; i < n; ++i)
+      if (xs[i] >= left && xs[i] <= right &&
+          ys[i] >= bottom && ys[i] <= top)
+        mask |= 1u << i;
+    return mask;
+  }
+};
+
+#ifdef __SSE2__
+
+/**
+ * Implementation of WaypointIndex::FilterLeaf() using Intel SSE2
+ * instructions, four waypoints at a time.
+ */
+struct SSE2LeafFilter {
+  static constexpr unsigned N = 4;
+
+  gcc_hot gcc_flatten
+  static unsigned Filter(const int *gcc_restrict xs,
+                         const int *gcc_restrict ys, unsigned n,
+                         int left, int bottom, int right, int top) {
+    const __m128i box_left = _mm_set1_epi32(left);
+    const __m128i box_right = _mm_set1_epi32(right);
+    const __m128i box_bottom = _mm_set1_epi32(bottom);
+    const __m128i box_top = _mm_set1_epi32(top);
+
+    unsigned mask = 0;
+    unsigned i = 0;
+    for (; i + N <= n; i += N) {
+      const __m128i x = _mm_loadu_si128((const __m128i *)(xs + i));
+      const __m128i y = _mm_loadu_si128((const __m128i *)(ys + i));
+
+      const __m128i reject =
+        _mm_or_si128(_mm_or_si128(_mm_cmplt_epi32(x, box_left),
+                                  _mm_cmpgt_epi32(x, box_right)),
+                     _mm_or_si128(_mm_cmplt_epi32(y, box_bottom),
+                                  _mm_cmpgt_epi32(y, box_top)));
+
+      mask |= (~_mm_movemask_ps(_mm_castsi128_ps(reject)) & 0xf) << i;
+    }
+
+    /* the remainder of the last (partial) leaf */
+    return mask | (PortableLeafFilter::Filter(xs + i, ys + i, n - i,
+                                              left, bottom,
+                                              right, top) << i);
+  }
+};
+
+/**
+ * Implementation of WaypointIndex::FilterChildren() using Intel SSE2
+ * instructions, four bounding boxes at a time.
+ */
+struct SSE2NodeFilter {
+  static constexpr unsigned N = 4;
+
+  gcc_hot gcc_flatten
+  static unsigned Filter(const int *gcc_restrict l, const int *gcc_restrict b,
+                         const int *gcc_restrict r, const int *gcc_restrict t,
+                         unsigned n,
+                         int left, int bottom, int right, int top) {
+    const __m128i box_left = _mm_set1_epi32(left);
+    const __m128i box_right = _mm_set1_epi32(right);
+    const __m128i box_bottom = _mm_set1_epi32(bottom);
+    const __m128i box_top = _mm_set1_epi32(top);
+
+    unsigned mask = 0;
+    unsigned i = 0;
+    for (; i + N <= n; i += N) {
+      const __m128i vl = _mm_loadu_si128((const __m128i *)(l + i));
+      const __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+      const __m128i vr = _mm_loadu_si128((const __m128i *)(r + i));
+      const __m128i vt = _mm_loadu_si128((const __m128i *)(t + i));
+
+      const __m128i reject =
+        _mm_or_si128(_mm_or_si128(_mm_cmpgt_epi32(vl, box_right),
+                                  _mm_cmplt_epi32(vr, box_left)),
+                     _mm_or_si128(_mm_cmpgt_epi32(vb, box_top),
+                                  _mm_cmplt_epi32(vt, box_bottom)));
+
+      mask |= (~_mm_movemask_ps(_mm_castsi128_ps(reject)) & 0xf) << i;
+    }
+
+    return mask | (PortableNodeFilter::Filter(l + i, b + i, r + i, t + i,
+                                              n - i,
+                                              left, bottom,
+                                              right, top) << i);
+  }
+};
+
+typedef SSE2LeafFilter OptimisedLeafFilter;
+typedef SSE2NodeFilter OptimisedNodeFilter;
+#else
+typedef PortableLeafFilter OptimisedLeafFilter;
+typedef PortableNodeFilter OptimisedNodeFilter;
+#endif
+
+static_assert(WaypointIndex::LEAF_SIZE % OptimisedLeafFilter::N == 0,
+              "Leaf size does not fit the SIMD width");
+static_assert(WaypointIndex::LEAF_SIZE <= sizeof(unsigned) * 8,
+              "Leaf size does not fit in the bit mask");
+static_assert(WaypointIndex::FANOUT <= sizeof(unsigned) * 8,
+              "Fanout does not fit in the bit mask");
+
+void
+WaypointIndex::PushBox(const FlatBoundingBox &box)
+{
+  box_left.push_back(box.GetLeft());
+  box_bottom.push_back(box.GetBottom());
+  box_right.push_back(box.GetRight());
+  box_top.push_back(box.GetTop());
+}
+
+unsigned
+WaypointIndex::FilterChildren(unsigned level, unsigned i,
+                              const Query &query) const
+{
+  assert(level > 0);
+
+  const unsigned first = i * FANOUT;
+  const unsigned end = std::min(first + FANOUT, GetNodeCount(level - 1));
+  const unsigned offset = levels[level - 1] + first;
+
+  return OptimisedNodeFilter::Filter(box_left.data() + offset,
+                                     box_bottom.data() + offset,
+                                     box_right.data() + offset,
+                                     box_top.data() + offset,
+                                     end - first,
+                                     query.left, query.bottom,
+                                     query.right, query.top);
+}
+
+unsigned
+WaypointIndex::FilterLeaf(unsigned leaf, const Query &query) const
+{
+  const unsigned start = GetLeafStart(leaf), end = GetLeafEnd(leaf);
+  return OptimisedLeafFilter::Filter(xs.data() + start, ys.data() + start,
+                                     end - start,
+                                     query.left, query.bottom,
+                                     query.right, query.top);
+}
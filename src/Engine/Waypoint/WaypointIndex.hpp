@@ -0,0 +1,270 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_WAYPOINT_INDEX_HPP
+#define XCSOAR_WAYPOINT_INDEX_HPP
+
+#include "Ptr.hpp"
+#include "Geo/Flat/FlatGeoPoint.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <assert.h>
+#include <stdint.h>
+
+/**
+ * An immutable spatial index of projected waypoints, which is bulk
+ * loaded in one pass: the waypoints are sorted along a Morton
+ * (Z-order) curve and packed into leaves of #LEAF_SIZE consecutive
+ * elements; each level above combines #FANOUT nodes of the level
+ * below (a packed R-tree).  All bounding boxes and coordinates live
+ * in flat arrays, and the children of a node and the elements of a
+ * leaf are filtered with SIMD instructions.
+ *
+ * The queries return the same waypoints as the #QuadTree used by
+ * #Waypoints, but use 64 bit arithmetic for the squared distances.
+ */
+class WaypointIndex {
+public:
+  static constexpr unsigned LEAF_SIZE = 16;
+  static constexpr unsigned FANOUT = 16;
+
+private:
+  /**
+   * The waypoints in Morton order.
+   */
+  std::vector<WaypointPtr> items;
+
+  /**
+   * The projected coordinates of #items.
+   */
+  std::vector<int> xs, ys;
+
+  /**
+   * The bounding boxes of all nodes (structure of arrays), the
+   * leaves first, followed by each level above; the last one is the
+   * root.
+   */
+  std::vector<int> box_left, box_bottom, box_right, box_top;
+
+  /**
+   * The index of the first node of each level within the box
+   * arrays, plus one element marking the end.
+   */
+  std::vector<unsigned> levels;
+
+public:
+  bool IsEmpty() const {
+    return items.empty();
+  }
+
+  unsigned size() const {
+    return items.size();
+  }
+
+  void Clear();
+
+  /**
+   * Build the index from scratch.  The waypoints must have been
+   * projected already.
+   */
+  void Build(std::vector<WaypointPtr> &&waypoints);
+
+  /**
+   * Invoke the visitor for each waypoint whose distance to the
+   * given location is not larger than the range.
+   */
+  template<typename V>
+  void VisitWithinRange(FlatGeoPoint location, unsigned range,
+                        V &&visitor) const {
+    if (IsEmpty())
+      return;
+
+    const Query query(location, range);
+    VisitNode(GetRootLevel(), 0, query, visitor);
+  }
+
+  /**
+   * Find the nearest waypoint within the given range which matches
+   * the predicate.
+   *
+   * @return the waypoint or nullptr if there is none
+   */
+  template<typename P>
+  gcc_pure
+  WaypointPtr FindNearestIf(FlatGeoPoint location, unsigned range,
+                            P &&predicate) const {
+    if (IsEmpty())
+      return nullptr;
+
+    const Query query(location, range);
+    uint64_t best_distance = query.square_range;
+    const WaypointPtr *best = nullptr;
+    FindNearestNode(GetRootLevel(), 0, query, predicate,
+                    best_distance, best);
+    return best != nullptr ? *best : nullptr;
+  }
+
+private:
+  struct Query {
+    FlatGeoPoint location;
+
+    /**
+     * The range box, clipped to the integer range.
+     */
+    int left, bottom, right, top;
+
+    uint64_t square_range;
+
+    Query(FlatGeoPoint _location, unsigned range);
+  };
+
+  gcc_const
+  static uint64_t SquareDistance(int ax, int ay, int bx, int by) {
+    const int64_t dx = int64_t(ax) - bx, dy = int64_t(ay) - by;
+    return uint64_t(dx * dx) + uint64_t(dy * dy);
+  }
+
+  /**
+   * Calculate the squared distance between the point and the
+   * bounding box of a node.
+   */
+  gcc_pure
+  uint64_t SquareDistance(unsigned node, FlatGeoPoint p) const;
+
+  unsigned GetRootLevel() const {
+    return levels.size() - 2;
+  }
+
+  unsigned GetNodeCount(unsigned level) const {
+    return levels[level + 1] - levels[level];
+  }
+
+  void PushBox(const FlatBoundingBox &box);
+
+  /**
+   * Determine which children of the node (at a level above the
+   * leaves) overlap the query's range box.
+   *
+   * @return a bit mask; bit i stands for child i
+   */
+  gcc_pure
+  unsigned FilterChildren(unsigned level, unsigned i,
+                          const Query &query) const;
+
+  unsigned GetLeafStart(unsigned leaf) const {
+    return leaf * LEAF_SIZE;
+  }
+
+  unsigned GetLeafEnd(unsigned leaf) const {
+    const unsigned end = (leaf + 1) * LEAF_SIZE;
+    return end < items.size() ? end : items.size();
+  }
+
+  /**
+   * Determine which elements of the leaf are within the query's
+   * range box.
+   *
+   * @return a bit mask; bit i stands for element GetLeafStart()+i
+   */
+  gcc_pure
+  unsigned FilterLeaf(unsigned leaf, const Query &query) const;
+
+  template<typename V>
+  void VisitNode(unsigned level, unsigned i, const Query &query,
+                 V &visitor) const {
+    if (level == 0) {
+      const unsigned start = GetLeafStart(i);
+      for (unsigned mask = FilterLeaf(i, query); mask != 0;
+           mask &= mask - 1) {
+        const unsigned j = start + __builtin_ctz(mask);
+        if (SquareDistance(xs[j], ys[j], query.location.x,
+                           query.location.y) <= query.square_range)
+          visitor(items[j]);
+      }
+
+      return;
+    }
+
+    const unsigned first = i * FANOUT;
+    for (unsigned mask = FilterChildren(level, i, query); mask != 0;
+         mask &= mask - 1) {
+      const unsigned c = first + __builtin_ctz(mask);
+      if (SquareDistance(levels[level - 1] + c,
+                         query.location) <= query.square_range)
+        VisitNode(level - 1, c, query, visitor);
+    }
+  }
+
+  template<typename P>
+  void FindNearestNode(unsigned level, unsigned i, const Query &query,
+                       P &predicate, uint64_t &best_distance,
+                       const WaypointPtr *&best) const {
+    if (level == 0) {
+      const unsigned start = GetLeafStart(i);
+      for (unsigned mask = FilterLeaf(i, query); mask != 0;
+           mask &= mask - 1) {
+        const unsigned j = start + __builtin_ctz(mask);
+        const uint64_t d = SquareDistance(xs[j], ys[j], query.location.x,
+                                          query.location.y);
+        if (d <= best_distance && predicate(*items[j])) {
+          best_distance = d;
+          best = &items[j];
+        }
+      }
+
+      return;
+    }
+
+    /* visit the children nearest first, so the range shrinks
+       quickly */
+    struct Child {
+      uint64_t distance;
+      unsigned index;
+    } children[FANOUT];
+    unsigned n = 0;
+
+    const unsigned first = i * FANOUT;
+    for (unsigned mask = FilterChildren(level, i, query); mask != 0;
+         mask &= mask - 1) {
+      const unsigned c = first + __builtin_ctz(mask);
+      const uint64_t d = SquareDistance(levels[level - 1] + c,
+                                        query.location);
+      if (d > best_distance)
+        continue;
+
+      unsigned k = n++;
+      for (; k > 0 && children[k - 1].distance > d; --k)
+        children[k] = children[k - 1];
+      children[k] = {d, c};
+    }
+
+    for (unsigned k = 0; k < n && children[k].distance <= best_distance; ++k)
+      FindNearestNode(level - 1, children[k].index, query, predicate,
+                      best_distance, best);
+  }
+};
+
+#endif
@@ -125,19 +125,25 @@ Waypoints::Waypoints()
 void
 Waypoints::Optimise()
 {
-  if (waypoint_tree.IsEmpty() || waypoint_tree.HaveBounds())
-    /* empty or already optimised */
+  if (waypoint_tree.IsEmpty())
     return;
 
-  task_projection.Update();
+  if (!waypoint_tree.HaveBounds()) {
+    task_projection.Update();
 
-  for (auto &i : waypoint_tree) {
-    // TODO: eliminate this const_cast hack
-    Waypoint &w = const_cast<Waypoint &>(*i);
-    w.Project(task_projection);
-  }
+    for (auto &i : waypoint_tree) {
+      // TODO: eliminate this const_cast hack
+      Waypoint &w = const_cast<Waypoint &>(*i);
+      w.Project(task_projection);
+    }
+
+    waypoint_tree.Optimise();
+  } else if (IsIndexed())
+    /* already optimised */
+    return;
 
-  waypoint_tree.Optimise();
+  index.Build(std::vector<WaypointPtr>(waypoint_tree.begin(),
+                                       waypoint_tree.end()));
 }
 
 void
@@ -160,6 +166,7 @@ Waypoints::Append(WaypointPtr wp)
 
   waypoint_tree.Add(wp);
   name_tree.Add(wp);
+  index.Clear();
 
   ++serial;
 }
@@ -171,8 +178,13 @@ Waypoints::GetNearest(const GeoPoint &loc, double range) const
     return nullptr;
 
   const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
-  const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
+
+  if (IsIndexed())
+    return index.FindNearestIf(flat_location, mrange,
+                               [](const Waypoint &){ return true; });
+
+  const WaypointTree::Point point(flat_location.x, flat_location.y);
   const auto found = waypoint_tree.FindNearest(point, mrange);
 
   if (found.first == waypoint_tree.end())
@@ -201,8 +213,12 @@ Waypoints::GetNearestIf(const GeoPoint &loc, double range,
     return nullptr;
 
   const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
-  const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
+
+  if (IsIndexed())
+    return index.FindNearestIf(flat_location, mrange, predicate);
+
+  const WaypointTree::Point point(flat_location.x, flat_location.y);
   const auto found = waypoint_tree.FindNearestIf(point, mrange,
                                                  [predicate](const WaypointPtr &ptr){
                                                    return predicate(*ptr);
@@ -278,11 +294,16 @@ Waypoints::VisitWithinRange(const GeoPoint &loc, const double range,
     return; // nothing to do
 
   const FlatGeoPoint flat_location = task_projection.ProjectInteger(loc);
-  const WaypointTree::Point point(flat_location.x, flat_location.y);
   const unsigned mrange = task_projection.ProjectRangeInteger(loc, range);
 
   WaypointEnvelopeVisitor wve(&visitor);
 
+  if (IsIndexed()) {
+    index.VisitWithinRange(flat_location, mrange, wve);
+    return;
+  }
+
+  const WaypointTree::Point point(flat_location.x, flat_location.y);
   waypoint_tree.VisitWithinRange(point, mrange, wve);
 }
 
@@ -300,6 +321,7 @@ Waypoints::Clear()
   home = nullptr;
   name_tree.Clear();
   waypoint_tree.clear();
+  index.Clear();
   next_id = 1;
 }
 
@@ -317,6 +339,7 @@ Waypoints::Erase(WaypointPtr &&wp)
 
   name_tree.Remove(std::move(wp));
   waypoint_tree.erase(f.first);
+  index.Clear();
   ++serial;
 }
 
@@ -330,6 +353,7 @@ Waypoints::EraseUserMarkers()
           home = nullptr;
 
         name_tree.Remove(wp);
+        index.Clear();
         ++serial;
         return true;
       } else
@@ -365,6 +389,7 @@ Waypoints::Replace(const WaypointPtr &orig, Waypoint &&replacement)
   assert(f.first != waypoint_tree.end());
 
   waypoint_tree.Replace(f.first, std::move(new_ptr));
+  index.Clear();
 
   ++serial;
 }
@@ -24,6 +24,7 @@
 
 #include "Util/RadixTree.hpp"
 #include "Util/QuadTree.hpp"
+#include "WaypointIndex.hpp"
 #include "Util/Serial.hpp"
 #include "Ptr.hpp"
 #include "Waypoint.hpp"
@@ -75,6 +76,14 @@ class Waypoints {
   unsigned next_id;
 
   WaypointTree waypoint_tree;
+
+  /**
+   * A read-only copy of #waypoint_tree for fast spatial queries.  It
+   * is built by Optimise() and cleared by every modification; while
+   * it is empty, the queries use #waypoint_tree.
+   */
+  WaypointIndex index;
+
   WaypointNameTree name_tree;
   TaskProjection task_projection;
 
@@ -165,10 +174,19 @@ public:
    */
   void Optimise();
 
+  /**
+   * Has Optimise() built the #WaypointIndex, and has the store not
+   * been modified since?
+   */
+  bool IsIndexed() const {
+    return !index.IsEmpty();
+  }
+
   /**
    * Prepare and enable the next Optimise() call.
    */
   void ScheduleOptimise() {
+    index.Clear();
     waypoint_tree.Flatten();
     waypoint_tree.ClearBounds();
   }
@@ -0,0 +1,68 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "FlatDistanceBatch.hpp"
+#include "FlatGeoPoint.hpp"
+#include "Math/FastMath.hpp"
+
+#ifdef __SSE2__
+#include "SSE2.hpp"
+#endif
+
+/**
+ * Implementation of FlatDistanceBatch() without SIMD.
+ */
+struct PortableFlatDistance {
+  static constexpr unsigned N = 1;
+
+  gcc_always_inline
+  static void Calculate(const FlatGeoPoint &origin,
+                        const int *gcc_restrict x, const int *gcc_restrict y,
+                        unsigned n, unsigned *gcc_restrict dest) {
+    for (unsigned i = 0; i < n; ++i)
+      dest[i] = ihypot(x[i] - origin.x, y[i] - origin.y);
+  }
+};
+
+/* NEONFlatDistance (NEON.hpp) is not enabled until it has been
+   tested on ARM; ARM builds use the portable implementation */
+#ifdef __SSE2__
+typedef SSE2FlatDistance OptimisedFlatDistance;
+#else
+typedef PortableFlatDistance OptimisedFlatDistance;
+#endif
+
+void
+FlatDistanceBatch(const FlatGeoPoint &origin,
+                  const int *gcc_restrict x, const int *gcc_restrict y,
+                  unsigned n, unsigned *gcc_restrict dest)
+{
+  /* the optimised implementation does the bulk of the work, and the
+     portable one the odd remainder */
+  constexpr unsigned PORTABLE_MASK = OptimisedFlatDistance::N - 1;
+  const unsigned no = n & ~PORTABLE_MASK;
+  const unsigned np = n & PORTABLE_MASK;
+
+  OptimisedFlatDistance::Calculate(origin, x, y, no, dest);
+  PortableFlatDistance::Calculate(origin, x + no, y + no, np, dest + no);
+}
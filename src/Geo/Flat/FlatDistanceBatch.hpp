@@ -0,0 +1,47 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_FLAT_DISTANCE_BATCH_HPP
+#define XCSOAR_GEO_FLAT_DISTANCE_BATCH_HPP
+
+#include "Compiler.h"
+
+struct FlatGeoPoint;
+
+/**
+ * Calculate the distance from #origin to each of the #n points
+ * (x[i], y[i]) and store it in dest[i].  The results are the same
+ * as those of FlatGeoPoint::Distance(), but SIMD instructions are
+ * used if available.
+ *
+ * The coordinates are passed as separate arrays (instead of an
+ * array of #FlatGeoPoint), because that allows loading them into
+ * vector registers directly.
+ */
+gcc_nonnull_all
+void
+FlatDistanceBatch(const FlatGeoPoint &origin,
+                  const int *gcc_restrict x, const int *gcc_restrict y,
+                  unsigned n, unsigned *gcc_restrict dest);
+
+#endif
@@ -0,0 +1,84 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_FLAT_NEON_HPP
+#define XCSOAR_GEO_FLAT_NEON_HPP
+
+#include "FlatGeoPoint.hpp"
+
+#ifndef __ARM_NEON__
+#error ARM NEON required
+#endif
+
+#include <arm_neon.h>
+
+/**
+ * Implementation of FlatDistanceBatch() using ARM NEON instructions.
+ * The square root is estimated in single precision and then
+ * corrected to the exact integer square root, to match isqrt4().
+ */
+struct NEONFlatDistance {
+  static constexpr unsigned N = 4;
+
+  gcc_always_inline
+  static uint32x4_t ISqrt4(uint32x4_t sq) {
+    /* sqrt(f) = f * rsqrt(f), refined with two Newton-Raphson steps;
+       for f=0, this yields NaN which converts to 0 */
+    const float32x4_t f = vcvtq_f32_u32(sq);
+    float32x4_t e = vrsqrteq_f32(f);
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(f, e), e));
+    e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(f, e), e));
+    /* the integer square root of a 32 bit value is at most 65535;
+       clamping the estimate keeps r*r from wrapping */
+    const uint32x4_t max = vdupq_n_u32(65535);
+    uint32x4_t r = vminq_u32(vcvtq_u32_f32(vmulq_f32(f, e)), max);
+
+    /* the estimate may be off by one in either direction */
+    const uint32x4_t one = vdupq_n_u32(1);
+    r = vsubq_u32(r, vandq_u32(vcgtq_u32(vmulq_u32(r, r), sq), one));
+
+    /* (r+1)^2 would wrap for r=65535, which is the maximum anyway */
+    const uint32x4_t r1 = vaddq_u32(r, one);
+    const uint32x4_t up = vandq_u32(vcleq_u32(vmulq_u32(r1, r1), sq),
+                                    vcltq_u32(r, max));
+    return vaddq_u32(r, vandq_u32(up, one));
+  }
+
+  gcc_hot gcc_flatten
+  static void Calculate(const FlatGeoPoint &origin,
+                        const int *gcc_restrict x, const int *gcc_restrict y,
+                        unsigned n, unsigned *gcc_restrict dest) {
+    const int32x4_t ox = vdupq_n_s32(origin.x);
+    const int32x4_t oy = vdupq_n_s32(origin.y);
+
+    for (unsigned i = 0; i < n; i += N) {
+      const int32x4_t dx = vsubq_s32(vld1q_s32(x + i), ox);
+      const int32x4_t dy = vsubq_s32(vld1q_s32(y + i), oy);
+      const int32x4_t sq = vmlaq_s32(vmulq_s32(dx, dx), dy, dy);
+
+      vst1q_u32(dest + i, ISqrt4(vreinterpretq_u32_s32(sq)));
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,75 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_FLAT_SSE2_HPP
+#define XCSOAR_GEO_FLAT_SSE2_HPP
+
+#include "FlatGeoPoint.hpp"
+
+#ifndef __SSE2__
+#error SSE2 required
+#endif
+
+#include <emmintrin.h>
+
+/**
+ * Implementation of FlatDistanceBatch() using Intel SSE2
+ * instructions.  Like isqrt4() on x86, it calculates the square root
+ * in double precision, which gives the same results as long as the
+ * squared distance fits in 32 bits.
+ */
+struct SSE2FlatDistance {
+  static constexpr unsigned N = 4;
+
+  gcc_always_inline
+  static __m128i Distance2(__m128i dx, __m128i dy) {
+    const __m128d fx = _mm_cvtepi32_pd(dx);
+    const __m128d fy = _mm_cvtepi32_pd(dy);
+    const __m128d sq = _mm_add_pd(_mm_mul_pd(fx, fx), _mm_mul_pd(fy, fy));
+    return _mm_cvttpd_epi32(_mm_sqrt_pd(sq));
+  }
+
+  gcc_hot gcc_flatten
+  static void Calculate(const FlatGeoPoint &origin,
+                        const int *gcc_restrict x, const int *gcc_restrict y,
+                        unsigned n, unsigned *gcc_restrict dest) {
+    const __m128i ox = _mm_set1_epi32(origin.x);
+    const __m128i oy = _mm_set1_epi32(origin.y);
+
+    for (unsigned i = 0; i < n; i += N) {
+      const __m128i dx =
+        _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(x + i)), ox);
+      const __m128i dy =
+        _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(y + i)), oy);
+
+      /* convert lanes 0-1 and 2-3 separately, two doubles each */
+      const __m128i lo = Distance2(dx, dy);
+      const __m128i hi = Distance2(_mm_shuffle_epi32(dx, _MM_SHUFFLE(1, 0, 3, 2)),
+                                   _mm_shuffle_epi32(dy, _MM_SHUFFLE(1, 0, 3, 2)));
+
+      _mm_storeu_si128((__m128i *)(dest + i), _mm_unpacklo_epi64(lo, hi));
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,490 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "PackedPolygon.hpp"
+#include "SearchPointVector.hpp"
+#include "GeoPoint.hpp"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * Implementation of the winding number loop of PolygonInterior()
+ * without SIMD.
+ */
+struct PortableWinding {
+  static constexpr unsigned N = 1;
+
+  gcc_always_inline
+  static int Calculate(const double *gcc_restrict longitude,
+                       const double *gcc_restrict latitude,
+                       unsigned n, double px, double py) {
+    int wn = 0;
+
+    for (unsigned i = 0; i < n; ++i) {
+      const double lon0 = longitude[i], lon1 = longitude[i + 1];
+      const double lat0 = latitude[i], lat1 = latitude[i + 1];
+
+      /* same operand order as Line2D::LocatePoint(), to get the same
+         rounding */
+      const double is_left = (lon1 - lon0) * (py - lat0)
+        - (px - lon0) * (lat1 - lat0);
+
+      if (lat0 <= py) {
+        if (lat1 > py && is_left > 0)
+          ++wn;
+      } else {
+        if (lat1 <= py && is_left < 0)
+          --wn;
+      }
+    }
+
+    return wn;
+  }
+};
+
+/**
+ * Implementation of PackedPolygon::ScanEdges() without SIMD.
+ */
+struct PortableEdgeFilter {
+  static constexpr unsigned N = 1;
+
+  gcc_always_inline
+  static unsigned Filter(const FlatBoundingBox &box,
+                         const int *gcc_restrict left,
+                         const int *gcc_restrict right,
+                         const int *gcc_restrict bottom,
+                         const int *gcc_restrict top,
+                         unsigned n, unsigned *gcc_restrict dest) {
+    unsigned count = 0;
+    for (unsigned i = 0; i < n; ++i)
+      if (left[i] <= box.GetRight() && right[i] >= box.GetLeft() &&
+          bottom[i] <= box.GetTop() && top[i] >= box.GetBottom())
+        dest[count++] = i;
+
+    return count;
+  }
+};
+
+#ifdef __SSE2__
+
+/**
+ * Implementation of the winding number loop using Intel SSE2
+ * instructions, two edges at a time.  The double precision
+ * arithmetic is the same as the portable one's, and so are the
+ * results.
+ */
+struct SSE2Winding {
+  static constexpr unsigned N = 2;
+
+  gcc_always_inline
+  static int CountBits(int mask) {
+    return (mask & 1) + (mask >> 1);
+  }
+
+  gcc_hot gcc_flatten
+  static int Calculate(const double *gcc_restrict longitude,
+                       const double *gcc_restrict latitude,
+                       unsigned n, double px, double py) {
+    const __m128d vx = _mm_set1_pd(px);
+    const __m128d vy = _mm_set1_pd(py);
+    const __m128d zero = _mm_setzero_pd();
+
+    int wn = 0;
+
+    for (unsigned i = 0; i < n; i += N) {
+      const __m128d lon0 = _mm_loadu_pd(longitude + i);
+      const __m128d lon1 = _mm_loadu_pd(longitude + i + 1);
+      const __m128d lat0 = _mm_loadu_pd(latitude + i);
+      const __m128d lat1 = _mm_loadu_pd(latitude + i + 1);
+
+      const __m128d is_left =
+        _mm_sub_pd(_mm_mul_pd(_mm_sub_pd(lon1, lon0), _mm_sub_pd(vy, lat0)),
+                   _mm_mul_pd(_mm_sub_pd(vx, lon0), _mm_sub_pd(lat1, lat0)));
+
+      const __m128d below = _mm_cmple_pd(lat0, vy);
+      const __m128d up =
+        _mm_and_pd(below, _mm_and_pd(_mm_cmpgt_pd(lat1, vy),
+                                     _mm_cmpgt_pd(is_left, zero)));
+      const __m128d down =
+        _mm_andnot_pd(below, _mm_and_pd(_mm_cmple_pd(lat1, vy),
+                                        _mm_cmplt_pd(is_left, zero)));
+
+      wn += CountBits(_mm_movemask_pd(up)) - CountBits(_mm_movemask_pd(down));
+    }
+
+    return wn;
+  }
+};
+
+/**
+ * Implementation of PackedPolygon::ScanEdges() using Intel SSE2
+ * instructions, four edge bounding boxes at a time.
+ */
+struct SSE2EdgeFilter {
+  static constexpr unsigned N = 4;
+
+  gcc_hot gcc_flatten
+  static unsigned Filter(const FlatBoundingBox &box,
+                         const int *gcc_restrict left,
+                         const int *gcc_restrict right,
+                         const int *gcc_restrict bottom,
+                         const int *gcc_restrict top,
+                         unsigned n, unsigned *gcc_restrict dest) {
+    const __m128i box_left = _mm_set1_epi32(box.GetLeft());
+    const __m128i box_right = _mm_set1_epi32(box.GetRight());
+    const __m128i box_bottom = _mm_set1_epi32(box.GetBottom());
+    const __m128i box_top = _mm_set1_epi32(box.GetTop());
+
+    unsigned count = 0;
+
+    for (unsigned i = 0; i < n; i += N) {
+      const __m128i l = _mm_loadu_si128((const __m128i *)(left + i));
+      const __m128i r = _mm_loadu_si128((const __m128i *)(right + i));
+      const __m128i b = _mm_loadu_si128((const __m128i *)(bottom + i));
+      const __m128i t = _mm_loadu_si128((const __m128i *)(top + i));
+
+      const __m128i reject =
+        _mm_or_si128(_mm_or_si128(_mm_cmpgt_epi32(l, box_right),
+                                  _mm_cmplt_epi32(r, box_left)),
+                     _mm_or_si128(_mm_cmpgt_epi32(b, box_top),
+                                  _mm_cmplt_epi32(t, box_bottom)));
+
+      unsigned mask = ~_mm_movemask_ps(_mm_castsi128_ps(reject)) & 0xf;
+      while (mask != 0) {
+        dest[count++] = i + __builtin_ctz(mask);
+        mask &= mask - 1;
+      }
+    }
+
+    return count;
+  }
+};
+
+typedef SSE2Winding OptimisedWinding;
+typedef SSE2EdgeFilter OptimisedEdgeFilter;
+#else
+typedef PortableWinding OptimisedWinding;
+typedef PortableEdgeFilter OptimisedEdgeFilter;
+#endif
+
+/**
+ * The edge bounding box arrays are padded to a multiple of this.
+ */
+static constexpr unsigned EDGE_PADDING = 4;
+
+static_assert(EDGE_PADDING % OptimisedEdgeFilter::N == 0,
+              "Padding does not fit the SIMD width");
+
+void
+PackedPolygon::Clear()
+{
+  n_edges = 0;
+  longitude.clear();
+  latitude.clear();
+  x.clear();
+  y.clear();
+  edge_left.clear();
+  edge_right.clear();
+  edge_bottom.clear();
+  edge_top.clear();
+  columns = rows = 0;
+  cell_start.clear();
+  cell_edges.clear();
+  n_bands = 0;
+  band_start.clear();
+  band_edges.clear();
+}
+
+void
+PackedPolygon::Build(const SearchPointVector &border)
+{
+  Clear();
+
+  if (border.size() < 2)
+    return;
+
+  n_edges = border.size() - 1;
+
+  longitude.reserve(n_edges + 1);
+  latitude.reserve(n_edges + 1);
+  x.reserve(n_edges + 1);
+  y.reserve(n_edges + 1);
+
+  for (const auto &i : border) {
+    longitude.push_back(i.GetLocation().longitude.Native());
+    latitude.push_back(i.GetLocation().latitude.Native());
+    x.push_back(i.GetFlatLocation().x);
+    y.push_back(i.GetFlatLocation().y);
+  }
+
+  const unsigned padded = (n_edges + EDGE_PADDING - 1) & ~(EDGE_PADDING - 1);
+
+  /* the padding boxes are "inverted" and never overlap anything */
+  edge_left.resize(padded, INT_MAX);
+  edge_right.resize(padded, INT_MIN);
+  edge_bottom.resize(padded, INT_MAX);
+  edge_top.resize(padded, INT_MIN);
+
+  bounds = FlatBoundingBox(GetFlatPoint(0));
+
+  for (unsigned i = 0; i < n_edges; ++i) {
+    edge_left[i] = std::min(x[i], x[i + 1]);
+    edge_right[i] = std::max(x[i], x[i + 1]);
+    edge_bottom[i] = std::min(y[i], y[i + 1]);
+    edge_top[i] = std::max(y[i], y[i + 1]);
+
+    bounds.Expand(GetFlatPoint(i + 1));
+  }
+
+  if (n_edges >= GRID_MIN_EDGES) {
+    BuildGrid();
+    BuildBands();
+  }
+}
+
+/**
+ * Build a "compressed sparse row" table: #n_buckets lists of edge
+ * indices, each in ascending order.  The #visit function is called
+ * for each edge, and invokes its callback for each bucket which the
+ * edge belongs to.
+ */
+template<typename V>
+static void
+BuildBuckets(unsigned n_edges, unsigned n_buckets,
+             std::vector<unsigned> &start, std::vector<unsigned> &edges,
+             V &&visit)
+{
+  start.assign(n_buckets + 1, 0);
+
+  for (unsigned i = 0; i < n_edges; ++i)
+    visit(i, [&start](unsigned b){
+        ++start[b + 1];
+      });
+
+  for (unsigned b = 0; b < n_buckets; ++b)
+    start[b + 1] += start[b];
+
+  edges.resize(start[n_buckets]);
+
+  std::vector<unsigned> fill(start.begin(), start.end() - 1);
+  for (unsigned i = 0; i < n_edges; ++i)
+    visit(i, [&edges, &fill, i](unsigned b){
+        edges[fill[b]++] = i;
+      });
+}
+
+void
+PackedPolygon::BuildGrid()
+{
+  columns = rows =
+    std::min(std::max(unsigned(sqrt(n_edges / 4.)), 2u), 64u);
+
+  cell_width = (bounds.GetWidth() + columns) / columns;
+  cell_height = (bounds.GetHeight() + rows) / rows;
+
+  BuildBuckets(n_edges, columns * rows, cell_start, cell_edges,
+               [this](unsigned i, auto &&f){
+                 const unsigned c0 = GetColumn(edge_left[i]);
+                 const unsigned c1 = GetColumn(edge_right[i]);
+                 const unsigned r0 = GetRow(edge_bottom[i]);
+                 const unsigned r1 = GetRow(edge_top[i]);
+
+                 for (unsigned r = r0; r <= r1; ++r)
+                   for (unsigned c = c0; c <= c1; ++c)
+                     f(r * columns + c);
+               });
+}
+
+void
+PackedPolygon::BuildBands()
+{
+  const auto minmax = std::minmax_element(latitude.begin(), latitude.end());
+
+  n_bands = std::min(std::max(n_edges / 4, 2u), 256u);
+  band_bottom = *minmax.first;
+
+  const double height = *minmax.second - band_bottom;
+  band_scale = height > 0 ? n_bands / height : 0;
+
+  BuildBuckets(n_edges, n_bands, band_start, band_edges,
+               [this](unsigned i, auto &&f){
+                 const double lat0 = latitude[i], lat1 = latitude[i + 1];
+                 const unsigned b0 = GetBand(std::min(lat0, lat1));
+                 const unsigned b1 = GetBand(std::max(lat0, lat1));
+
+                 for (unsigned b = b0; b <= b1; ++b)
+                   f(b);
+               });
+}
+
+/*
+ * The following mapping functions are monotonic, which guarantees
+ * that an edge is registered in every cell/band where a query for
+ * an overlapping box/latitude will look for it, even with rounding
+ * and clamping.
+ */
+
+unsigned
+PackedPolygon::GetColumn(int px) const
+{
+  const int64_t c = (int64_t(px) - bounds.GetLeft()) / cell_width;
+  return (unsigned)std::min(std::max(c, int64_t(0)), int64_t(columns - 1));
+}
+
+unsigned
+PackedPolygon::GetRow(int py) const
+{
+  const int64_t r = (int64_t(py) - bounds.GetBottom()) / cell_height;
+  return (unsigned)std::min(std::max(r, int64_t(0)), int64_t(rows - 1));
+}
+
+unsigned
+PackedPolygon::GetBand(double lat) const
+{
+  const double b = (lat - band_bottom) * band_scale;
+  if (!(b > 0))
+    return 0;
+
+  if (b >= n_bands)
+    return n_bands - 1;
+
+  return unsigned(b);
+}
+
+int
+PackedPolygon::GetWinding(unsigned i, double px, double py) const
+{
+  return PortableWinding::Calculate(longitude.data() + i,
+                                    latitude.data() + i, 1, px, py);
+}
+
+bool
+PackedPolygon::IsInside(const GeoPoint &p) const
+{
+  /* see PolygonInterior(): at least 3 points are required */
+  if (n_edges < 2)
+    return false;
+
+  const double px = p.longitude.Native(), py = p.latitude.Native();
+
+  int wn;
+  if (n_bands > 0) {
+    /* only edges which span the latitude of the point can contribute
+       to the winding number */
+    const unsigned b = GetBand(py);
+
+    wn = 0;
+    for (unsigned j = band_start[b], end = band_start[b + 1]; j < end; ++j)
+      wn += GetWinding(band_edges[j], px, py);
+  } else {
+    /* the optimised implementation does the bulk of the work, and
+       the portable one the odd remainder */
+    constexpr unsigned PORTABLE_MASK = OptimisedWinding::N - 1;
+    const unsigned no = n_edges & ~PORTABLE_MASK;
+
+    wn = OptimisedWinding::Calculate(longitude.data(), latitude.data(),
+                                     no, px, py) +
+      PortableWinding::Calculate(longitude.data() + no, latitude.data() + no,
+                                 n_edges - no, px, py);
+  }
+
+  return wn != 0;
+}
+
+void
+PackedPolygon::ScanEdges(const FlatBoundingBox &box,
+                         std::vector<unsigned> &dest) const
+{
+  const unsigned padded = edge_left.size();
+
+  dest.resize(padded);
+  unsigned n = OptimisedEdgeFilter::Filter(box, edge_left.data(),
+                                           edge_right.data(),
+                                           edge_bottom.data(),
+                                           edge_top.data(),
+                                           padded, dest.data());
+
+  /* the padding may match only a degenerate box spanning the whole
+     integer range */
+  while (n > 0 && dest[n - 1] >= n_edges)
+    --n;
+
+  dest.resize(n);
+}
+
+void
+PackedPolygon::FindEdges(const FlatBoundingBox &box,
+                         std::vector<unsigned> &dest) const
+{
+  dest.clear();
+
+  if (!IsDefined() || !bounds.Overlaps(box))
+    return;
+
+  if (columns == 0) {
+    ScanEdges(box, dest);
+    return;
+  }
+
+  const unsigned c0 = GetColumn(box.GetLeft()), c1 = GetColumn(box.GetRight());
+  const unsigned r0 = GetRow(box.GetBottom()), r1 = GetRow(box.GetTop());
+
+  if ((c1 - c0 + 1) * (r1 - r0 + 1) * 2 > columns * rows) {
+    /* the box covers a large part of the polygon; a linear scan is
+       cheaper than merging the cell lists */
+    ScanEdges(box, dest);
+    return;
+  }
+
+  for (unsigned r = r0; r <= r1; ++r) {
+    for (unsigned c = c0; c <= c1; ++c) {
+      const unsigned cell = r * columns + c;
+      dest.insert(dest.end(),
+                  cell_edges.begin() + cell_start[cell],
+                  cell_edges.begin() + cell_start[cell + 1]);
+    }
+  }
+
+  if (r1 > r0 || c1 > c0) {
+    /* edges spanning several cells were collected more than once */
+    std::sort(dest.begin(), dest.end());
+    dest.erase(std::unique(dest.begin(), dest.end()), dest.end());
+  }
+
+  dest.erase(std::remove_if(dest.begin(), dest.end(),
+                            [this, &box](unsigned i){
+                              return edge_left[i] > box.GetRight() ||
+                                edge_right[i] < box.GetLeft() ||
+                                edge_bottom[i] > box.GetTop() ||
+                                edge_top[i] < box.GetBottom();
+                            }),
+             dest.end());
+}
@@ -0,0 +1,172 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_GEO_PACKED_POLYGON_HPP
+#define XCSOAR_GEO_PACKED_POLYGON_HPP
+
+#include "Flat/FlatGeoPoint.hpp"
+#include "Flat/FlatBoundingBox.hpp"
+#include "Compiler.h"
+
+#include <vector>
+
+#include <assert.h>
+
+struct GeoPoint;
+class SearchPointVector;
+
+/**
+ * A read-only copy of a closed, projected polygon, laid out for fast
+ * point-in-polygon and segment intersection queries: the vertex
+ * coordinates and the per-edge bounding boxes are stored in separate
+ * arrays (structure of arrays), which can be scanned with SIMD
+ * instructions.  Polygons with many edges get an additional grid of
+ * cells (for flat queries) and latitude bands (for geographic
+ * queries), so that only the edges near the query need to be
+ * examined.
+ *
+ * The results are exactly the same as those of
+ * SearchPointVector::IsInside() and of examining each edge with
+ * FlatRay; this is only a different way to find the edges which
+ * matter.
+ */
+class PackedPolygon {
+  /**
+   * Polygons with at least this number of edges get a grid and
+   * latitude bands.
+   */
+  static constexpr unsigned GRID_MIN_EDGES = 64;
+
+  unsigned n_edges = 0;
+
+  /**
+   * The geographic vertex coordinates (native angles), n_edges+1
+   * elements each; the last vertex equals the first one.
+   */
+  std::vector<double> longitude, latitude;
+
+  /**
+   * The projected vertex coordinates, n_edges+1 elements each.
+   */
+  std::vector<int> x, y;
+
+  /**
+   * The projected bounding box of each edge.  The arrays are padded
+   * to a multiple of 4 with empty boxes which never match.
+   */
+  std::vector<int> edge_left, edge_right, edge_bottom, edge_top;
+
+  /**
+   * The projected bounding box of the whole polygon.
+   */
+  FlatBoundingBox bounds;
+
+  /**
+   * The grid dimensions; zero if this polygon has no grid.
+   */
+  unsigned columns = 0, rows = 0;
+  int cell_width, cell_height;
+
+  /**
+   * The edges overlapping each cell (row-major), in ascending order:
+   * cell_edges[cell_start[i] .. cell_start[i + 1]].
+   */
+  std::vector<unsigned> cell_start, cell_edges;
+
+  /**
+   * The number of latitude bands; zero if this polygon has none.
+   */
+  unsigned n_bands = 0;
+  double band_bottom, band_scale;
+
+  /**
+   * The edges overlapping each latitude band, in ascending order:
+   * band_edges[band_start[i] .. band_start[i + 1]].
+   */
+  std::vector<unsigned> band_start, band_edges;
+
+public:
+  bool IsDefined() const {
+    return n_edges > 0;
+  }
+
+  void Clear();
+
+  /**
+   * Copy the (already projected) polygon.
+   *
+   * @param border a closed polygon, i.e. the last point equals the
+   * first one
+   */
+  void Build(const SearchPointVector &border);
+
+  unsigned GetEdgeCount() const {
+    return n_edges;
+  }
+
+  /**
+   * Returns the projected start point of the given edge; the edge
+   * ends at the start point of edge i+1.
+   */
+  FlatGeoPoint GetFlatPoint(unsigned i) const {
+    assert(i <= n_edges);
+
+    return FlatGeoPoint(x[i], y[i]);
+  }
+
+  /**
+   * Winding number test, see PolygonInterior().
+   */
+  gcc_pure
+  bool IsInside(const GeoPoint &p) const;
+
+  /**
+   * Find all edges whose bounding box overlaps the given box.
+   *
+   * @param dest the edge indices are stored here, in ascending
+   * order; the previous contents are discarded
+   */
+  void FindEdges(const FlatBoundingBox &box,
+                 std::vector<unsigned> &dest) const;
+
+private:
+  void BuildGrid();
+  void BuildBands();
+
+  gcc_pure
+  unsigned GetColumn(int px) const;
+
+  gcc_pure
+  unsigned GetRow(int py) const;
+
+  gcc_pure
+  unsigned GetBand(double lat) const;
+
+  gcc_pure
+  int GetWinding(unsigned i, double px, double py) const;
+
+  void ScanEdges(const FlatBoundingBox &box,
+                 std::vector<unsigned> &dest) const;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "BinaryCache.hpp"
+#include "FileCache.hpp"
+#include "FileTransaction.hpp"
+#include "OS/FileMapping.hpp"
+#include "OS/FileUtil.hpp"
+#include "OS/Path.hpp"
+#include "Util/FNV1a.hpp"
+
+#include <stdio.h>
+
+static constexpr uint32_t BINARY_CACHE_MAGIC = 0x5843424e;
+
+struct BinaryCacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t key;
+  uint64_t payload_size;
+  uint64_t checksum;
+};
+
+uint64_t
+UpdateBinaryCacheKey(uint64_t key, Path path)
+{
+  if (path.IsNull())
+    return UpdateFNV1a(key, "", 1);
+
+  key = UpdateFNV1a(key, path.c_str(),
+                    (_tcslen(path.c_str()) + 1) * sizeof(TCHAR));
+
+  const uint64_t info[] = {
+    File::Exists(path),
+    File::GetSize(path),
+    File::GetLastModification(path),
+  };
+
+  return UpdateFNV1a(key, info, sizeof(info));
+}
+
+bool
+SaveBinaryCache(FileCache &cache, const TCHAR *name,
+                uint32_t version, uint64_t key,
+                ConstBuffer<void> payload)
+{
+  cache.CreateCacheDirectory();
+
+  FileTransaction transaction(cache.MakeCachePath(name));
+
+  FILE *file = _tfopen(transaction.GetTemporaryPath().c_str(), _T("wb"));
+  if (file == nullptr)
+    return false;
+
+  const BinaryCacheHeader header = {
+    BINARY_CACHE_MAGIC, version, key, payload.size,
+    UpdateFNV1a(FNV1A_INIT, payload.data, payload.size),
+  };
+
+  bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+    (payload.empty() || fwrite(payload.data, payload.size, 1, file) == 1);
+  success = fclose(file) == 0 && success;
+
+  return success && transaction.Commit();
+}
+
+std::unique_ptr<FileMapping>
+LoadBinaryCache(FileCache &cache, const TCHAR *name,
+                uint32_t version, uint64_t key,
+                ConstBuffer<void> &payload_r)
+{
+  const auto path = cache.MakeCachePath(name);
+
+  std::unique_ptr<FileMapping> mapping(new FileMapping(path));
+  if (mapping->error())
+    return nullptr;
+
+  if (mapping->size() < sizeof(BinaryCacheHeader)) {
+    mapping.reset();
+    File::Delete(path);
+    return nullptr;
+  }
+
+  const BinaryCacheHeader &header =
+    *(const BinaryCacheHeader *)mapping->data();
+  if (header.magic != BINARY_CACHE_MAGIC ||
+      header.version != version || header.key != key ||
+      header.payload_size != mapping->size() - sizeof(header)) {
+    /* obsolete or corrupt */
+    mapping.reset();
+    File::Delete(path);
+    return nullptr;
+  }
+
+  const ConstBuffer<void> payload(mapping->at(sizeof(header)),
+                                  header.payload_size);
+  if (UpdateFNV1a(FNV1A_INIT, payload.data, payload.size) !=
+      header.checksum) {
+    mapping.reset();
+    File::Delete(path);
+    return nullptr;
+  }
+
+  payload_r = payload;
+  return mapping;
+}
@@ -0,0 +1,142 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_BINARY_CACHE_HPP
+#define XCSOAR_BINARY_CACHE_HPP
+
+#include "Util/ConstBuffer.hxx"
+#include "Util/tstring.hpp"
+#include "Compiler.h"
+
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include <stdint.h>
+#include <string.h>
+#include <tchar.h>
+
+class Path;
+class FileCache;
+class FileMapping;
+
+/**
+ * Mix the name, size and modification time of a source file into a
+ * cache key.  A missing file yields a different key than an empty
+ * one, and a null path (an unconfigured slot) yet another one.
+ */
+gcc_pure
+uint64_t
+UpdateBinaryCacheKey(uint64_t key, Path path);
+
+/**
+ * Write a cache file to the #FileCache directory.  It contains a
+ * header with the format version, the key (see
+ * UpdateBinaryCacheKey()) and a checksum of the payload.  The file
+ * is replaced atomically.
+ *
+ * The payload is in host byte order; the cache is not meant to be
+ * portable.
+ */
+bool
+SaveBinaryCache(FileCache &cache, const TCHAR *name,
+                uint32_t version, uint64_t key,
+                ConstBuffer<void> payload);
+
+/**
+ * Map a cache file written by SaveBinaryCache() into memory.  The
+ * file is deleted if the version, key or checksum does not match.
+ *
+ * @param payload_r on success, the payload; it is valid as long as
+ * the returned object exists
+ * @return nullptr if there is no valid cache file
+ */
+std::unique_ptr<FileMapping>
+LoadBinaryCache(FileCache &cache, const TCHAR *name,
+                uint32_t version, uint64_t key,
+                ConstBuffer<void> &payload_r);
+
+/**
+ * Builds the payload of a binary cache file.
+ */
+class BinaryCacheWriter {
+  std::string data;
+
+public:
+  template<typename T>
+  void WriteT(const T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Type must be trivially copyable");
+    data.append((const char *)&value, sizeof(value));
+  }
+
+  void WriteString(const tstring &s) {
+    WriteT(uint32_t(s.length()));
+    data.append((const char *)s.data(), s.length() * sizeof(TCHAR));
+  }
+
+  ConstBuffer<void> GetData() const {
+    return {data.data(), data.size()};
+  }
+};
+
+/**
+ * Reads the payload of a binary cache file.  All methods fail
+ * (return false) if the payload is too short.
+ */
+class BinaryCacheReader {
+  const uint8_t *p, *const end;
+
+public:
+  explicit BinaryCacheReader(ConstBuffer<void> payload)
+    :p((const uint8_t *)payload.data),
+     end((const uint8_t *)payload.data + payload.size) {}
+
+  bool IsEnd() const {
+    return p == end;
+  }
+
+  template<typename T>
+  bool ReadT(T &value) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Type must be trivially copyable");
+    if (size_t(end - p) < sizeof(value))
+      return false;
+
+    memcpy(&value, p, sizeof(value));
+    p += sizeof(value);
+    return true;
+  }
+
+  bool ReadString(tstring &s) {
+    uint32_t length;
+    if (!ReadT(length) || (end - p) / sizeof(TCHAR) < length)
+      return false;
+
+    s.assign((const TCHAR *)(const void *)p, length);
+    p += length * sizeof(TCHAR);
+    return true;
+  }
+};
+
+#endif
@@ -38,6 +38,9 @@ protected:
 public:
   CSVLine(const char *line);
 
+  CSVLine(const char *line, const char *_end)
+    :data(line), end(_end) {}
+
   Range<const char *> Rest() const {
     return Range<const char *>(data, end);
   }
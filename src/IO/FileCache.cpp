@@ -97,6 +97,12 @@ GetRegularFileInfo(Path path, FileInfo &info)
 FileCache::FileCache(AllocatedPath &&_cache_path)
   :cache_path(std::move(_cache_path)) {}
 
+void
+FileCache::CreateCacheDirectory()
+{
+  Directory::Create(cache_path);
+}
+
 void
 FileCache::Flush(const TCHAR *name)
 {
@@ -149,7 +155,7 @@ FileCache::Save(const TCHAR *name, Path original_path)
   if (!GetRegularFileInfo(original_path, original_info))
     return nullptr;
 
-  Directory::Create(cache_path);
+  CreateCacheDirectory();
 
   const auto path = MakeCachePath(name);
 
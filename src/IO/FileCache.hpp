@@ -35,13 +35,20 @@ class FileCache {
 public:
   FileCache(AllocatedPath &&_cache_path);
 
-protected:
+  /**
+   * Returns the path of a cache file which is managed by the caller
+   * (i.e. not with Load() and Save()).
+   */
   gcc_pure
   AllocatedPath MakeCachePath(const TCHAR *name) const {
     return AllocatedPath::Build(cache_path, name);
   }
 
-public:
+  /**
+   * Create the cache directory if it does not exist yet.
+   */
+  void CreateCacheDirectory();
+
   void Flush(const TCHAR *name);
   FILE *Load(const TCHAR *name, Path original_path);
 
@@ -132,11 +132,8 @@ GlueMapWindow::ExchangeBlackboard()
 {
   /* copy device_blackboard to MapWindow */
 
-  {
-    const ScopeLock lock(device_blackboard->mutex);
-    ReadBlackboard(device_blackboard->Basic(),
-                   device_blackboard->Calculated());
-  }
+  ReadBlackboard(*device_blackboard->ReadBasic(),
+                 *device_blackboard->ReadCalculated());
 
 #ifndef ENABLE_OPENGL
   {
@@ -123,7 +123,7 @@ GlueMapWindow::UpdateScreenBounds()
      display is enabled */
   if (terrain_thread != nullptr &&
       visible_projection.IsValid())
-    terrain_thread->Trigger(visible_projection);
+    terrain_thread->Trigger(visible_projection, CommonInterface::Basic());
 }
 
 void
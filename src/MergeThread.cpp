@@ -28,6 +28,7 @@ Copyright_License {
 #include "NMEA/MoreData.hpp"
 #include "Audio/VarioGlue.hpp"
 #include "Device/MultipleDevices.hpp"
+#include "OS/Clock.hpp"
 
 MergeThread::MergeThread(DeviceBlackboard &_device_blackboard)
   :WorkerThread("MergeThread", 50, 20, 10),
@@ -50,10 +51,12 @@ MergeThread::Process()
 
   computer.Fill(device_blackboard.SetMoreData(), settings_computer);
   computer.Compute(device_blackboard.SetMoreData(), last_any, last_fix,
-                   device_blackboard.Calculated());
+                   *device_blackboard.ReadCalculated());
 
   flarm_computer.Process(device_blackboard.SetBasic().flarm,
                          last_fix.flarm, basic);
+
+  device_blackboard.PublishBasic();
 }
 
 void
@@ -68,6 +71,7 @@ MergeThread::Tick()
 
   {
     ScopeLock protect(device_blackboard.mutex);
+    const uint64_t lock_start = MonotonicClockUS();
 
     Process();
 
@@ -99,6 +103,8 @@ MergeThread::Tick()
          (!last_fix.time_available || basic.time != last_fix.time)) ||
         basic.location_available != last_fix.location_available)
       last_fix = basic;
+
+    stats.Add(sizeof(basic), MonotonicClockUS() - lock_start);
   }
 
 #ifdef HAVE_PCM_PLAYER
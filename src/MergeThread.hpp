@@ -28,6 +28,7 @@ Copyright_License {
 #include "Computer/BasicComputer.hpp"
 #include "FLARM/FlarmComputer.hpp"
 #include "NMEA/MoreData.hpp"
+#include "Blackboard/TransferStats.hpp"
 
 class DeviceBlackboard;
 
@@ -53,6 +54,8 @@ class MergeThread final : public WorkerThread {
   BasicComputer computer;
   FlarmComputer flarm_computer;
 
+  TransferStats stats;
+
 public:
   MergeThread(DeviceBlackboard &_device_blackboard);
 
@@ -66,6 +69,14 @@ public:
     Process();
   }
 
+  /**
+   * Statistics about the blackboard transfers.  May be read only
+   * after the thread has been joined.
+   */
+  const TransferStats &GetTransferStats() const {
+    return stats;
+  }
+
   bool Start(bool suspended=false) {
     if (!WorkerThread::Start(suspended))
       return false;
@@ -23,20 +23,99 @@ Copyright_License {
 
 #include "NMEA/Checksum.hpp"
 
+#ifdef __ARM_NEON__
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <cassert>
 #include <cstring>
 #include <cstdlib>
 #include <cstdio>
 #include <stdint.h>
 
+/**
+ * Fold the 8 bytes of a 64 bit word into one with XOR.
+ */
+gcc_const
+static inline uint8_t
+FoldXor(uint64_t x)
+{
+  x ^= x >> 32;
+  x ^= x >> 16;
+  x ^= x >> 8;
+  return uint8_t(x);
+}
+
+uint8_t
+XorBytes(const void *_p, size_t size)
+{
+  const uint8_t *p = (const uint8_t *)_p;
+  uint64_t x = 0;
+
+#ifdef __ARM_NEON__
+  if (size >= 16) {
+    uint8x16_t acc = vdupq_n_u8(0);
+    for (; size >= 16; p += 16, size -= 16)
+      acc = veorq_u8(acc, vld1q_u8(p));
+
+    const uint8x8_t half = veor_u8(vget_low_u8(acc), vget_high_u8(acc));
+    x = vget_lane_u64(vreinterpret_u64_u8(half), 0);
+  }
+#elif defined(__SSE2__)
+  if (size >= 16) {
+    __m128i acc = _mm_setzero_si128();
+    for (; size >= 16; p += 16, size -= 16)
+      acc = _mm_xor_si128(acc, _mm_loadu_si128((const __m128i *)p));
+
+    /* fold the upper 8 bytes into the lower 8 bytes */
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    x = lanes[0];
+  }
+#endif
+
+  for (; size >= 8; p += 8, size -= 8) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    x ^= word;
+  }
+
+  uint8_t checksum = FoldXor(x);
+  while (size-- > 0)
+    checksum ^= *p++;
+
+  return checksum;
+}
+
 bool
 VerifyNMEAChecksum(const char *p)
 {
   assert(p != NULL);
 
-  const char *asterisk = strrchr(p, '*');
-  if (asterisk == NULL)
-    return false;
+  const size_t length = strlen(p);
+
+  /* skip the dollar sign at the beginning (the exclamation mark is
+     used by CAI302 */
+  const char *const start = *p == '$' || *p == '!' ? p + 1 : p;
+
+  /* calculate the checksum of the whole line in one pass, and then
+     XOR out the asterisk and the checksum string while searching
+     backwards for the asterisk; that is cheaper than locating the
+     asterisk first, because it is near the end of the line */
+  uint8_t CalcCheckSum = XorBytes(start, p + length - start);
+
+  const char *asterisk = p + length;
+  do {
+    if (asterisk == start)
+      return false;
+
+    --asterisk;
+    CalcCheckSum ^= *asterisk;
+  } while (*asterisk != '*');
 
   const char *checksum_string = asterisk + 1;
   char *endptr;
@@ -45,8 +124,6 @@ VerifyNMEAChecksum(const char *p)
     return false;
 
   uint8_t ReadCheckSum = (unsigned char)ReadCheckSum2;
-  uint8_t CalcCheckSum = NMEAChecksum(p, asterisk - p);
-
   return CalcCheckSum == ReadCheckSum;
 }
 
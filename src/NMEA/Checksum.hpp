@@ -26,30 +26,18 @@ Copyright_License {
 
 #include "Compiler.h"
 
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 /**
- * Calculates the checksum for the specified line (without the
- * asterisk and the newline character).
- *
- * @param p a NULL terminated string
+ * XOR all bytes of the buffer.  This is the inner loop of the NMEA
+ * checksum; it processes 16 bytes per step with SSE2 or NEON, or 8
+ * bytes per step in a 64 bit register otherwise.
  */
 gcc_pure
-static inline uint8_t
-NMEAChecksum(const char *p)
-{
-  uint8_t checksum = 0;
-
-  /* skip the dollar sign at the beginning (the exclamation mark is
-     used by CAI302 */
-  if (*p == '$' || *p == '!')
-    ++p;
-
-  while (*p != 0)
-    checksum ^= *p++;
-
-  return checksum;
-}
+uint8_t
+XorBytes(const void *p, size_t size);
 
 /**
  * Calculates the checksum for the specified line (without the
@@ -62,21 +50,27 @@ gcc_pure
 static inline uint8_t
 NMEAChecksum(const char *p, unsigned length)
 {
-  uint8_t checksum = 0;
-
-  unsigned i = 0;
-
   /* skip the dollar sign at the beginning (the exclamation mark is
      used by CAI302 */
   if (length > 0 && (*p == '$' || *p == '!')) {
-    ++i;
     ++p;
+    --length;
   }
 
-  for (; i < length; ++i)
-    checksum ^= *p++;
+  return XorBytes(p, length);
+}
 
-  return checksum;
+/**
+ * Calculates the checksum for the specified line (without the
+ * asterisk and the newline character).
+ *
+ * @param p a NULL terminated string
+ */
+gcc_pure
+static inline uint8_t
+NMEAChecksum(const char *p)
+{
+  return NMEAChecksum(p, strlen(p));
 }
 
 /**
@@ -22,13 +22,25 @@ Copyright_License {
 */
 
 #include "NMEA/InputLine.hpp"
+#include "Compiler.h"
 
 #include <string.h>
 
+/**
+ * Find the asterisk which separates the checksum, or the end of the
+ * string if there is none.
+ */
+gcc_pure
+static const char *
+FindNMEAEnd(const char *line)
+{
+  const char *asterisk = strchr(line, '*');
+  return asterisk != nullptr
+    ? asterisk
+    : line + strlen(line);
+}
+
 NMEAInputLine::NMEAInputLine(const char* line):
-  CSVLine(line)
+  CSVLine(line, FindNMEAEnd(line))
 {
-  const char* asterisk = strchr(line, '*');
-  if (asterisk != NULL)
-    end = asterisk;
 }
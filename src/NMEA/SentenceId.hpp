@@ -0,0 +1,56 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_NMEA_SENTENCE_ID_HPP
+#define XCSOAR_NMEA_SENTENCE_ID_HPP
+
+#include <stdint.h>
+
+/**
+ * Pack a NMEA sentence identifier of up to 8 characters (e.g. "RMC"
+ * or "$PFLAU") into an integer.  This is a collision-free ("perfect")
+ * hash, which allows dispatching with a "switch" statement on the
+ * identifier; the compiler turns that into a jump table or a binary
+ * search instead of a chain of string comparisons.
+ *
+ * This is constexpr, therefore the "case" labels can be written as
+ * NMEASentenceId("RMC").
+ *
+ * @return the packed identifier, or 0 if the string is empty or
+ * longer than 8 characters
+ */
+constexpr uint64_t
+NMEASentenceId(const char *p)
+{
+  uint64_t id = 0;
+  for (unsigned i = 0; i < 8; ++i) {
+    if (p[i] == 0)
+      return id;
+
+    id = (id << 8) | uint8_t(p[i]);
+  }
+
+  return p[8] == 0 ? id : 0;
+}
+
+#endif
@@ -63,14 +63,8 @@ FileMapping::FileMapping(Path path)
     return;
   }
 
-  m_size = (size_t)st.st_size;
-
-  m_data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+  Map(fd, 0, (size_t)st.st_size);
   close(fd);
-  if (m_data == nullptr)
-    return;
-
-  madvise(m_data, m_size, MADV_WILLNEED);
 #else /* !HAVE_POSIX */
   hFile = ::CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
                        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
@@ -95,11 +89,45 @@ FileMapping::FileMapping(Path path)
 #endif /* !HAVE_POSIX */
 }
 
+#ifdef HAVE_POSIX
+
+FileMapping::FileMapping(int fd, uint64_t offset, size_t size)
+  :m_data(nullptr)
+{
+  struct stat st;
+  if (size == 0 || fstat(fd, &st) < 0 ||
+      offset + size > (uint64_t)st.st_size ||
+      size > 1024 * 1024 * 1024)
+    return;
+
+  Map(fd, offset, size);
+}
+
+void
+FileMapping::Map(int fd, uint64_t offset, size_t size)
+{
+  /* mmap() wants a page-aligned offset */
+  static const uint64_t page_size = sysconf(_SC_PAGESIZE);
+  m_skew = offset % page_size;
+
+  void *p = mmap(nullptr, m_skew + size, PROT_READ, MAP_SHARED, fd,
+                 offset - m_skew);
+  if (p == MAP_FAILED)
+    return;
+
+  m_data = (char *)p + m_skew;
+  m_size = size;
+
+  madvise(p, m_skew + size, MADV_WILLNEED);
+}
+
+#endif
+
 FileMapping::~FileMapping()
 {
 #ifdef HAVE_POSIX
   if (m_data != nullptr)
-    munmap(m_data, m_size);
+    munmap((char *)m_data - m_skew, m_skew + m_size);
 #else /* !HAVE_POSIX */
   if (m_data != nullptr)
     ::UnmapViewOfFile(m_data);
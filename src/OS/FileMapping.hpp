@@ -25,6 +25,7 @@ Copyright_License {
 #define XCSOAR_OS_FILE_MAPPING_HPP
 
 #include <stddef.h>
+#include <stdint.h>
 
 #ifndef HAVE_POSIX
 #include <windef.h>
@@ -43,8 +44,31 @@ class FileMapping {
   HANDLE hFile, hMapping;
 #endif
 
+#ifdef HAVE_POSIX
+  void Map(int fd, uint64_t offset, size_t size);
+#endif
+
+#ifdef HAVE_POSIX
+  /**
+   * The distance between the page-aligned start of the mapping and
+   * #m_data.
+   */
+  size_t m_skew;
+#endif
+
 public:
   FileMapping(Path path);
+
+#ifdef HAVE_POSIX
+  /**
+   * Map a portion of the file referred to by the given file
+   * descriptor, e.g. one entry of a ZIP archive which is stored
+   * without compression.  The descriptor is not owned by this
+   * object; the caller may close it right after construction.
+   */
+  FileMapping(int fd, uint64_t offset, size_t size);
+#endif
+
   ~FileMapping();
 
   /**
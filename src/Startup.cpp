@@ -168,6 +168,16 @@ AfterStartup()
   ForceCalculation();
 }
 
+static void
+LogTransferStats(const char *name, const TransferStats &stats)
+{
+  if (stats.ticks > 0)
+    LogFormat("%s: %u ticks, %u bytes/tick, blackboard held %u us/tick, max %u us",
+              name, stats.ticks,
+              stats.GetBytesPerTick(), stats.GetHoldPerTick(),
+              unsigned(stats.max_hold_us));
+}
+
 /**
  * "Boots" up XCSoar
  * @param hInstance Instance handle
@@ -327,7 +337,7 @@ Startup()
   LoadConfiguredTopography(*topography, operation);
 
   // Read the waypoint files
-  WaypointGlue::LoadWaypoints(way_points, terrain, operation);
+  WaypointGlue::LoadWaypoints(way_points, terrain, file_cache, operation);
 
   // Read and parse the airfield info file
   WaypointDetails::ReadFileFromProfile(way_points, operation);
@@ -349,12 +359,12 @@ Startup()
 
   // Reads the airspace files
   ReadAirspace(airspace_database, terrain, computer_settings.pressure,
-               operation);
+               file_cache, operation);
 
   {
     const AircraftState aircraft_state =
       ToAircraftState(device_blackboard->Basic(),
-                      device_blackboard->Calculated());
+                      *device_blackboard->ReadCalculated());
     ProtectedAirspaceWarningManager::ExclusiveLease lease(glide_computer->GetAirspaceWarnings());
     lease->Reset(aircraft_state);
   }
@@ -544,16 +554,31 @@ Shutdown()
 
   if (merge_thread != nullptr) {
     merge_thread->Join();
+    LogTransferStats("MergeThread", merge_thread->GetTransferStats());
     delete merge_thread;
     merge_thread = nullptr;
   }
 
   if (calculation_thread != nullptr) {
     calculation_thread->Join();
+    LogTransferStats("CalculationThread",
+                     calculation_thread->GetTransferStats());
     delete calculation_thread;
     calculation_thread = nullptr;
   }
 
+  if (glide_computer != nullptr) {
+    /* the calculation thread is gone; now the profiler may be read */
+    const ComputerProfiler &profiler = glide_computer->GetProfiler();
+    profiler.LogSummary();
+
+    try {
+      profiler.WriteChromeTrace(LocalPath(_T("glide_computer_trace.json")));
+    } catch (const std::runtime_error &e) {
+      LogError(e);
+    }
+  }
+
   //  Wait for the drawing thread to finish
 #ifndef ENABLE_OPENGL
   LogFormat("Waiting for draw thread");
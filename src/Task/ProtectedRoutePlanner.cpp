@@ -66,10 +66,11 @@ void
 ProtectedRoutePlanner::SolveReach(const AGeoPoint &origin,
                                   const RoutePlannerConfig &config,
                                   const int h_ceiling,
-                                  const bool do_solve)
+                                  const bool do_solve,
+                                  const bool incremental)
 {
   ExclusiveLease lease(*this);
-  lease->SolveReach(origin, config, h_ceiling, do_solve);
+  lease->SolveReach(origin, config, h_ceiling, do_solve, incremental);
 }
 
 const FlatProjection
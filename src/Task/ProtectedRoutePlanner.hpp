@@ -82,7 +82,7 @@ public:
                         const AGeoPoint &destination) const;
 
   void SolveReach(const AGeoPoint &origin, const RoutePlannerConfig &config,
-                  int h_ceiling, bool do_solve);
+                  int h_ceiling, bool do_solve, bool incremental=false);
 
   gcc_pure
   const FlatProjection GetTerrainReachProjection() const;
@@ -38,6 +38,7 @@ ProtectedTaskManager::ProtectedTaskManager(TaskManager &_task_manager,
 ProtectedTaskManager::~ProtectedTaskManager() {
   UnprotectedLease lease(*this);
   lease->SetIntersectionTest(nullptr); // de-register
+  lease->SetExecutor(nullptr);
 }
 
 void 
@@ -145,6 +146,13 @@ ProtectedTaskManager::SetRoutePlanner(const RoutePlannerGlue *_route) {
   lease->SetIntersectionTest(&intersection_test);
 }
 
+void
+ProtectedTaskManager::SetExecutor(ParallelExecutor *executor)
+{
+  ExclusiveLease lease(*this);
+  lease->SetExecutor(executor);
+}
+
 bool
 ReachIntersectionTest::Intersects(const AGeoPoint& destination)
 {
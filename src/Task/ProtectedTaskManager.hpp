@@ -36,6 +36,7 @@ class GlidePolar;
 class RoutePlannerGlue;
 class OrderedTask;
 class TaskManager;
+class ParallelExecutor;
 
 class ReachIntersectionTest: public AbortIntersectionTest {
   const RoutePlannerGlue *route;
@@ -117,6 +118,11 @@ public:
 
   void SetRoutePlanner(const RoutePlannerGlue *_route);
 
+  /**
+   * @see TaskManager::SetExecutor()
+   */
+  void SetExecutor(ParallelExecutor *executor);
+
   short GetTerrainBase() const;
 
   void ResetTask();
@@ -65,15 +65,20 @@ RoutePlannerGlue::Solve(const AGeoPoint &origin,
 void
 RoutePlannerGlue::SolveReach(const AGeoPoint &origin,
                               const RoutePlannerConfig &config,
-                              const int h_ceiling, const bool do_solve)
+                              const int h_ceiling, const bool do_solve,
+                              const bool incremental)
 {
   if (terrain) {
     RasterTerrain::Lease lease(*terrain);
-    planner.SolveReachTerrain(origin, config, h_ceiling, do_solve);
-    planner.SolveReachWorking(origin, config, h_ceiling, do_solve);
+    planner.SolveReachTerrain(origin, config, h_ceiling, do_solve,
+                              incremental);
+    planner.SolveReachWorking(origin, config, h_ceiling, do_solve,
+                              incremental);
   } else {
-    planner.SolveReachTerrain(origin, config, h_ceiling, do_solve);
-    planner.SolveReachWorking(origin, config, h_ceiling, do_solve);
+    planner.SolveReachTerrain(origin, config, h_ceiling, do_solve,
+                              incremental);
+    planner.SolveReachWorking(origin, config, h_ceiling, do_solve,
+                              incremental);
   }
 }
 
@@ -74,7 +74,7 @@ public:
   }
 
   void SolveReach(const AGeoPoint &origin, const RoutePlannerConfig &config,
-                  int h_ceiling, bool do_solve);
+                  int h_ceiling, bool do_solve, bool incremental=false);
 
   bool FindPositiveArrival(const AGeoPoint &dest, ReachResult &result_r) const;
 
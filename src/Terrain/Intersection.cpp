@@ -22,6 +22,7 @@ Copyright_License {
 */
 
 #include "RasterTileCache.hpp"
+#include "RasterLineStepper.hpp"
 #include "Terrain/RasterLocation.hpp"
 
 #include <stdlib.h>
@@ -60,14 +61,10 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
   h_dest = std::max(h_dest, h_origin);
 
   // line algorithm parameters
-  const int dx = abs(destination.x - origin.x);
-  const int dy = abs(destination.y - origin.y);
-  int err = dx-dy;
-  const int sx = origin.x < destination.x ? 1 : -1;
-  const int sy = origin.y < destination.y ? 1 : -1;
+  RasterLineStepper line(origin, destination);
 
   // max number of steps to walk
-  const int max_steps = (dx+dy);
+  const int max_steps = line.GetMaxSteps();
   // calculate number of fine steps to produce a step on the overview field
   const int step_fine = std::max(1, max_steps >> INTERSECT_BITS);
   // number of steps for update to the overview map
@@ -76,10 +73,8 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
   // number of steps to be cleared after climbing over obstruction
   const int intersect_steps = 32;
 
-  // counter for steps to reach next position to be checked on the field.
-  unsigned step_counter = 0;
-  // total counter of fine steps
-  int total_steps = 0;
+  // the iteration which reaches the destination (total_steps == max_steps)
+  const unsigned end_iteration = line.GetEndIteration();
 
   // number of steps since intersection
   int intersect_counter = 0;
@@ -108,108 +103,95 @@ RasterTileCache::FirstIntersection(const SignedRasterLocation origin,
   RasterLocation last_clear_location = location;
   int last_clear_h = h_origin;
 
-  while (true) {
-
-    if (!step_counter) {
+  FieldWindow window;
 
-      if (!IsInside(location))
-        break; // outside bounds
+  while (true) {
+    location = line.GetLocation();
+    if (!IsInside(location))
+      break; // outside bounds
 
-      const auto field_direct = GetFieldDirect(location.x, location.y);
-      if (field_direct.first.IsInvalid())
-        break;
+    const auto field_direct = GetFieldCached(location.x, location.y, window);
+    if (field_direct.first.IsInvalid())
+      break;
 
-      const int h_terrain = field_direct.first.GetValueOr0() + h_safety;
-      step_counter = field_direct.second ? step_fine : step_coarse;
+    const int h_terrain = field_direct.first.GetValueOr0() + h_safety;
+    const int step_counter = field_direct.second ? step_fine : step_coarse;
 
-      // calculate height of glide so far
-      const int dh = (total_steps * slope_fact) >> RASTER_SLOPE_FACT;
+    // calculate height of glide so far
+    const int total_steps = line.GetTotalSteps();
+    const int dh = (total_steps * slope_fact) >> RASTER_SLOPE_FACT;
 
-      // current aircraft height
-      int h_int = dh + h_origin;
-      if (can_climb) {
-        h_int = std::min(h_int, h_dest);
-      }
+    // current aircraft height
+    int h_int = dh + h_origin;
+    if (can_climb) {
+      h_int = std::min(h_int, h_dest);
+    }
 
 #ifdef DEBUG_TILE
-      printf("%d %d %d %d %d # fint\n", location.x, location.y, h_int, h_terrain, h_ceiling);
+    printf("%d %d %d %d %d # fint\n", location.x, location.y, h_int, h_terrain, h_ceiling);
 #endif
 
-      // this point has intersected if aircraft is below terrain height
-      const bool this_intersecting = (h_int< h_terrain);
+    // this point has intersected if aircraft is below terrain height
+    const bool this_intersecting = (h_int< h_terrain);
 
-      if (this_intersecting) {
-        intersect_counter = 1;
+    if (this_intersecting) {
+      intersect_counter = 1;
 
-        // when intersecting, consider origin to have started higher
-        const int h_jump = h_terrain - h_int;
-        h_origin += h_jump;
-
-        if (can_climb) {
-          // if intersecting beyond desired destination height, allow dest height
-          // to be increased
-          if (h_terrain> h_dest)
-            h_dest = h_terrain;
-        } else {
-          // if can't climb, must jump so path is pure glide
-          h_dest += h_jump;
-        }
-        h_int = h_terrain;
+      // when intersecting, consider origin to have started higher
+      const int h_jump = h_terrain - h_int;
+      h_origin += h_jump;
 
+      if (can_climb) {
+        // if intersecting beyond desired destination height, allow dest height
+        // to be increased
+        if (h_terrain> h_dest)
+          h_dest = h_terrain;
+      } else {
+        // if can't climb, must jump so path is pure glide
+        h_dest += h_jump;
       }
+      h_int = h_terrain;
 
-      if (h_int > h_ceiling) {
-        _location = last_clear_location;
-        _h = last_clear_h;
+    }
+
+    if (h_int > h_ceiling) {
+      _location = last_clear_location;
+      _h = last_clear_h;
 #ifdef DEBUG_TILE
-        printf("# fint reach ceiling\n");
+      printf("# fint reach ceiling\n");
 #endif
-        return true; // reached ceiling
-      }
+      return true; // reached ceiling
+    }
 
-      if (!this_intersecting) {
-        if (intersect_counter) {
-          intersect_counter+= step_counter;
+    if (!this_intersecting) {
+      if (intersect_counter) {
+        intersect_counter+= step_counter;
 
-          // was intersecting, now cleared.
-          // exit with small height above terrain
+        // was intersecting, now cleared.
+        // exit with small height above terrain
 #ifdef DEBUG_TILE
-          printf("# fint int->clear\n");
+        printf("# fint int->clear\n");
 #endif
-          if (intersect_counter >= intersect_steps) {
-            _location = location;
-            _h = h_int;
-            return true;
-          }
-        } else {
-          last_clear_location = location;
-          last_clear_h = h_int;
+        if (intersect_counter >= intersect_steps) {
+          _location = location;
+          _h = h_int;
+          return true;
         }
+      } else {
+        last_clear_location = location;
+        last_clear_h = h_int;
       }
     }
 
-    if (!intersect_counter && (total_steps == max_steps)) {
-#ifdef DEBUG_TILE
-      printf("# fint cleared\n");
-#endif
-      return false;
-    }
+    /* jump to the next sample; the destination may be reached at
+       this sample or between the two */
+    if (!intersect_counter && line.GetIteration() >= end_iteration)
+      break; // cleared
 
-    const int e2 = 2*err;
-    if (e2 > -dy) {
-      err -= dy;
-      location.x += sx;
-      if (step_counter)
-        step_counter--;
-      total_steps++;
-    }
-    if (e2 < dx) {
-      err += dx;
-      location.y += sy;
-      if (step_counter)
-        step_counter--;
-      total_steps++;
-    }
+    line.AdvanceTo(total_steps + step_counter);
+
+    if (!intersect_counter && line.GetIteration() > end_iteration)
+      break; // cleared
   }
 
   // early exit due to inability to find clearance after intersecting
@@ -251,6 +233,43 @@ RasterTileCache::GetFieldDirect(const unsigned px, const unsigned py) const
   return std::make_pair(overview.Get(x_overview, y_overview), false);
 }
 
+inline std::pair<TerrainHeight, bool>
+RasterTileCache::GetFieldCached(const unsigned px, const unsigned py,
+                                FieldWindow &window) const
+{
+  assert(px < width);
+  assert(py < height);
+
+  if (!window.IsInside(px, py)) {
+    const unsigned tile_x = px / tile_width, tile_y = py / tile_height;
+    const RasterTile &tile = tiles.Get(tile_x, tile_y);
+
+    window.x_start = tile_x * tile_width;
+    window.y_start = tile_y * tile_height;
+    window.width = tile_width;
+    window.height = tile_height;
+    window.tile = tile.IsEnabled() ? &tile : nullptr;
+  }
+
+  if (window.tile != nullptr) {
+    const RasterTile &tile = *window.tile;
+    assert(px - tile.xstart < tile.width);
+    assert(py - tile.ystart < tile.height);
+
+    return std::make_pair(tile.buffer.Get(px - tile.xstart, py - tile.ystart),
+                          true);
+  }
+
+  unsigned x_overview = px >> OVERVIEW_BITS;
+  unsigned y_overview = py >> OVERVIEW_BITS;
+  if (x_overview == overview.GetWidth())
+    x_overview--;
+  if (y_overview == overview.GetHeight())
+    y_overview--;
+
+  return std::make_pair(overview.Get(x_overview, y_overview), false);
+}
+
 SignedRasterLocation
 RasterTileCache::Intersection(const SignedRasterLocation origin,
                               const SignedRasterLocation destination,
@@ -258,21 +277,15 @@ RasterTileCache::Intersection(const SignedRasterLocation origin,
                               const int slope_fact,
                               const int height_floor) const
 {
-  SignedRasterLocation location = origin;
-
-  if (!IsInside(location))
+  if (!IsInside(origin))
     // origin is outside overall bounds
     return {-1, -1};
 
   // line algorithm parameters
-  const int dx = abs(destination.x - origin.x);
-  const int dy = abs(destination.y - origin.y);
-  int err = dx-dy;
-  const int sx = origin.x < destination.x ? 1 : -1;
-  const int sy = origin.y < destination.y ? 1 : -1;
+  RasterLineStepper line(origin, destination);
 
   // max number of steps to walk
-  const int max_steps = (dx+dy);
+  const int max_steps = line.GetMaxSteps();
   // calculate number of fine steps to produce a step on the overview field
 
   // step size at selected refinement level
@@ -283,10 +296,8 @@ RasterTileCache::Intersection(const SignedRasterLocation origin,
   // number of steps for update to the overview map
   const int step_coarse = std::max(1<< OVERVIEW_BITS, step_fine);
 
-  // counter for steps to reach next position to be checked on the field.
-  unsigned step_counter = 0;
-  // total counter of fine steps
-  int total_steps = 0;
+  // the first iteration with total_steps > max_steps
+  const unsigned last_iteration = line.GetEndIteration() + 1;
 
 #ifdef DEBUG_TILE
   printf("# max steps %d\n", max_steps);
@@ -294,63 +305,54 @@ RasterTileCache::Intersection(const SignedRasterLocation origin,
   printf("# step fine %d\n", step_fine);
 #endif
 
-  RasterLocation last_clear_location = location;
+  RasterLocation last_clear_location = origin;
   int last_clear_h = h_origin;
 
+  FieldWindow window;
+
   while (true) {
+    const RasterLocation location = line.GetLocation();
+    if (!IsInside(location))
+      break;
 
-    if (!step_counter) {
+    const auto field_direct = GetFieldCached(location.x, location.y, window);
+    if (field_direct.first.IsInvalid())
+      break;
 
-      if (!IsInside(location))
-        break;
+    const int h_terrain = field_direct.first.GetValueOr0();
+    const int step_counter = field_direct.second ? step_fine : step_coarse;
 
-      const auto field_direct = GetFieldDirect(location.x, location.y);
-      if (field_direct.first.IsInvalid())
-        break;
+    // calculate height of glide so far
+    const int total_steps = line.GetTotalSteps();
+    const int dh = (total_steps * slope_fact) >> RASTER_SLOPE_FACT;
 
-      const int h_terrain = field_direct.first.GetValueOr0();
-      step_counter = field_direct.second ? step_fine : step_coarse;
+    // current aircraft height
+    const int h_int = h_origin - dh;
 
-      // calculate height of glide so far
-      const int dh = (total_steps * slope_fact) >> RASTER_SLOPE_FACT;
+    if (h_int < std::max(h_terrain, height_floor)) {
+      if (refine_step<3) // can't refine any further
+        return RasterLocation(last_clear_location.x, last_clear_location.y);
 
-      // current aircraft height
-      const int h_int = h_origin - dh;
+      // refine solution
+      return Intersection(last_clear_location, location,
+                          last_clear_h, slope_fact, height_floor);
+    }
 
-      if (h_int < std::max(h_terrain, height_floor)) {
-        if (refine_step<3) // can't refine any further
-          return RasterLocation(last_clear_location.x, last_clear_location.y);
+    if (h_int <= 0)
+      break; // reached max range
 
-        // refine solution
-        return Intersection(last_clear_location, location,
-                            last_clear_h, slope_fact, height_floor);
-      }
+    last_clear_location = location;
+    last_clear_h = h_int;
 
-      if (h_int <= 0)
-        break; // reached max range
+    /* jump to the next sample, unless the end was reached at this
+       sample or between the two */
+    if (line.GetIteration() >= last_iteration)
+      break;
 
-      last_clear_location = location;
-      last_clear_h = h_int;
-    }
+    line.AdvanceTo(total_steps + step_counter);
 
-    if (total_steps > max_steps)
+    if (line.GetIteration() > last_iteration)
       break;
-
-    const int e2 = 2*err;
-    if (e2 > -dy) {
-      err -= dy;
-      location.x += sx;
-      if (step_counter>0)
-        step_counter--;
-      total_steps++;
-    }
-    if (e2 < dx) {
-      err += dx;
-      location.y += sy;
-      if (step_counter>0)
-        step_counter--;
-      total_steps++;
-    }
   }
 
   // if we reached invalid terrain, assume we can hit MSL
@@ -23,11 +23,17 @@ Copyright_License {
 
 #include "Loader.hpp"
 #include "RasterTileCache.hpp"
+#include "RasterTileStore.hpp"
 #include "RasterProjection.hpp"
 #include "ZzipStream.hpp"
 #include "WorldFile.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/ConvertPathName.hpp"
+#include "Util/ParallelExecutor.hpp"
+#include "Util/AllocatedArray.hxx"
+
+#include <algorithm>
+#include <vector>
 
 extern "C" {
 #include "jasper/jp2/jp2_cod.h"
@@ -35,6 +41,14 @@ extern "C" {
 #include "jasper/jpc/jpc_t1cod.h"
 }
 
+inline bool
+TerrainLoader::IsTileWanted(unsigned index) const
+{
+  return raster_tile_cache.IsTileRequested(index) &&
+    (tiles.IsNull() ||
+     std::binary_search(tiles.begin(), tiles.end(), index));
+}
+
 long
 TerrainLoader::SkipMarkerSegment(long file_offset) const
 {
@@ -54,8 +68,7 @@ TerrainLoader::SkipMarkerSegment(long file_offset) const
     return 0;
 
   long skip_to = segment->file_offset;
-  while (segment->IsTileSegment() &&
-         !raster_tile_cache.tiles.GetLinear(segment->tile).IsRequested()) {
+  while (segment->IsTileSegment() && !IsTileWanted(segment->tile)) {
     ++segment;
     if (segment >= raster_tile_cache.segments.end())
       /* last segment is hidden; shouldn't happen either, because we
@@ -176,9 +189,13 @@ TerrainLoader::PutTileData(unsigned index,
     raster_tile_cache.PutOverviewTile(index, start_x, start_y,
                                       end_x, end_y, m);
 
-  if (scan_tiles) {
+  if (scan_tiles && IsTileWanted(index)) {
+    /* convert the data while other threads may still read the map;
+       lock only for installing the new buffer */
+    auto buffer = raster_tile_cache.ConvertTileData(index, m);
+
     const ScopeExclusiveLock lock(mutex);
-    raster_tile_cache.PutTileData(index, m);
+    raster_tile_cache.PutTileData(index, std::move(buffer));
   }
 }
 
@@ -227,8 +244,6 @@ LoadJPG2000(jas_stream_t *in, void *loader)
   /* allow really large maps, but specify a reasonable limit */
   opts.max_samples = size_t(1) << 31;
 
-  jpc_initluts();
-
   const auto dec = jpc_dec_create(&opts, in);
   if (dec == nullptr)
     return false;
@@ -277,6 +292,8 @@ TerrainLoader::LoadOverview(struct zzip_dir *dir,
 
   raster_tile_cache.Reset();
 
+  jpc_initluts();
+
   bool success = LoadJPG2000(dir, path);
 
   /* if we loaded the JPG2000 file successfully, but no bounds were
@@ -307,32 +324,85 @@ LoadTerrainOverview(struct zzip_dir *dir,
   return loader.LoadOverview(dir, path, world_file);
 }
 
-inline bool
-TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
-                           int x, int y, unsigned radius)
+bool
+TerrainLoader::LoadTiles(struct zzip_dir *dir, const char *path)
 {
   assert(!scan_overview);
 
-  if (!raster_tile_cache.PollTiles(x, y, radius))
-    /* nothing to do */
-    return true;
-
-  bool success = LoadJPG2000(dir, path);
-  raster_tile_cache.FinishTileUpdate();
-  return success;
+  return LoadJPG2000(dir, path);
 }
 
 bool
-UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+UpdateTerrainTiles(ParallelExecutor *executor,
+                   struct zzip_dir *const*dirs, unsigned n_dirs,
+                   const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
-                   int x, int y, unsigned radius)
+                   int x, int y, int ahead_x, int ahead_y, unsigned radius,
+                   RasterTileStore *store)
 {
+  assert(n_dirs > 0);
+
   if (!raster_tile_cache.IsValid())
     return false;
 
-  NullOperationEnvironment env;
-  TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
-  return loader.UpdateTiles(dir, path, x, y, radius);
+  {
+    const ScopeExclusiveLock lock(mutex);
+    if (!raster_tile_cache.PollTiles(x, y, ahead_x, ahead_y, radius))
+      /* nothing to do */
+      return true;
+  }
+
+  /* load the tiles which were decoded previously from the store, and
+     distribute the others over the jobs round-robin, so each one
+     gets some of the nearest tiles */
+  std::vector<std::vector<uint16_t>> parts(n_dirs);
+  unsigned n_requested = 0;
+  for (const auto i : raster_tile_cache.GetPolledTiles()) {
+    if (!raster_tile_cache.IsTileRequested(i))
+      continue;
+
+    if (store != nullptr && store->Contains(i)) {
+      const auto &tile = raster_tile_cache.GetTile(i);
+      RasterBuffer buffer;
+      if (store->Load(i, tile.width, tile.height, buffer)) {
+        const ScopeExclusiveLock lock(mutex);
+        raster_tile_cache.PutTileData(i, std::move(buffer));
+        continue;
+      }
+    }
+
+    parts[n_requested++ % n_dirs].push_back(i);
+  }
+
+  const unsigned n_jobs = std::min(n_requested, n_dirs);
+  for (unsigned i = 0; i < n_jobs; ++i)
+    std::sort(parts[i].begin(), parts[i].end());
+
+  if (n_jobs > 0)
+    /* the lookup tables are global; initialise them before the jobs
+       start */
+    jpc_initluts();
+
+  AllocatedArray<bool> results(n_jobs);
+  ParallelForEach(executor, n_jobs, [&](unsigned i){
+      NullOperationEnvironment env;
+      TerrainLoader loader(mutex, raster_tile_cache, false, true, env,
+                           ConstBuffer<uint16_t>(parts[i].data(),
+                                                 parts[i].size()));
+      results[i] = loader.LoadTiles(dirs[i], path);
+    });
+
+  if (store != nullptr)
+    /* this is the only thread which modifies the tiles, so they can
+       be read without the lock */
+    for (unsigned i = 0; i < n_jobs; ++i)
+      for (const auto index : parts[i])
+        if (raster_tile_cache.GetTile(index).IsEnabled())
+          store->Store(index, raster_tile_cache.GetTile(index).buffer);
+
+  const ScopeExclusiveLock lock(mutex);
+  raster_tile_cache.FinishTileUpdate();
+  return std::find(results.begin(), results.end(), false) == results.end();
 }
 
 bool
@@ -25,12 +25,18 @@ Copyright_License {
 #define XCSOAR_TERRAIN_LOADER_HPP
 
 #include "Thread/SharedMutex.hpp"
+#include "Util/ConstBuffer.hxx"
+#include "Compiler.h"
+
+#include <stdint.h>
 
 struct zzip_dir;
 struct GeoPoint;
 class RasterTileCache;
 class RasterProjection;
 class OperationEnvironment;
+class RasterTileStore;
+class ParallelExecutor;
 
 class TerrainLoader {
   SharedMutex &mutex;
@@ -41,6 +47,13 @@ class TerrainLoader {
 
   OperationEnvironment &env;
 
+  /**
+   * If not nullptr, then this object decodes only these tiles
+   * (sorted by index); the other requested tiles are left to other
+   * #TerrainLoader instances which run concurrently.
+   */
+  const ConstBuffer<uint16_t> tiles;
+
   /**
    * The number of remaining segments after the current one.
    */
@@ -49,16 +62,22 @@ class TerrainLoader {
 public:
   TerrainLoader(SharedMutex &_mutex, RasterTileCache &_rtc,
                 bool _scan_overview, bool _scan_all,
-                OperationEnvironment &_env)
+                OperationEnvironment &_env,
+                ConstBuffer<uint16_t> _tiles=nullptr)
     :mutex(_mutex), raster_tile_cache(_rtc),
      scan_overview(_scan_overview),
      scan_tiles(!_scan_overview || _scan_all),
-     env(_env) {}
+     env(_env), tiles(_tiles) {}
 
   bool LoadOverview(struct zzip_dir *dir,
                     const char *path, const char *world_file);
-  bool UpdateTiles(struct zzip_dir *dir, const char *path,
-                   int x, int y, unsigned radius);
+
+  /**
+   * Decode the tiles which were requested by
+   * RasterTileCache::PollTiles().  The mutex is locked only while a
+   * decoded tile is being published.
+   */
+  bool LoadTiles(struct zzip_dir *dir, const char *path);
 
   /* callback methods for libjasper (via jas_rtc.cpp) */
 
@@ -79,6 +98,9 @@ public:
                    const struct jas_matrix &m);
 
 private:
+  gcc_pure
+  bool IsTileWanted(unsigned index) const;
+
   bool LoadJPG2000(struct zzip_dir *dir, const char *path);
   void ParseBounds(const char *data);
 };
@@ -104,10 +126,35 @@ LoadTerrainOverview(struct zzip_dir *dir,
                              tile_cache, false, env);
 }
 
+/**
+ * Load the tiles around (x, y) and along the line to (ahead_x,
+ * ahead_y).  The requested tiles are distributed over up to #n_dirs
+ * jobs which decode in parallel on the given #ParallelExecutor
+ * (sequentially if it is nullptr).  Each job needs its own handle to
+ * the archive, because libzzip handles must not be shared between
+ * threads.
+ *
+ * @param dirs an array of #n_dirs handles to the same archive
+ * @param store if not nullptr, then tiles are loaded from there if
+ * possible, and newly decoded tiles are added to it
+ */
 bool
+UpdateTerrainTiles(ParallelExecutor *executor,
+                   struct zzip_dir *const*dirs, unsigned n_dirs,
+                   const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   int x, int y, int ahead_x, int ahead_y, unsigned radius,
+                   RasterTileStore *store=nullptr);
+
+static inline bool
 UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
-                   int x, int y, unsigned radius);
+                   int x, int y, unsigned radius)
+{
+  return UpdateTerrainTiles(nullptr, &dir, 1, path,
+                            raster_tile_cache, mutex,
+                            x, y, x, y, radius);
+}
 
 static inline bool
 UpdateTerrainTiles(struct zzip_dir *dir,
@@ -117,6 +117,40 @@ public:
   }
 };
 
+/**
+ * Generates the sequence a + (i * d) / n for i = 0, 1, 2, ..., with
+ * the same rounding (towards zero) as the integer division, but
+ * with only additions in each step.
+ */
+class LinearIterator
+{
+  unsigned value;
+  int sign;
+  unsigned quotient, remainder;
+  unsigned n, counter;
+
+public:
+  LinearIterator(unsigned a, int d, unsigned _n)
+    :value(a), sign(d < 0 ? -1 : 1),
+     quotient(unsigned(abs(d)) / _n), remainder(unsigned(abs(d)) % _n),
+     n(_n), counter(0) {
+    assert(_n > 0);
+  }
+
+  unsigned GetValue() const {
+    return value;
+  }
+
+  void Next() {
+    value += sign * quotient;
+    counter += remainder;
+    if (counter >= n) {
+      counter -= n;
+      value += sign;
+    }
+  }
+};
+
 void
 RasterBuffer::ScanHorizontalLine(unsigned ax, unsigned bx, unsigned y,
                                  TerrainHeight *gcc_restrict buffer, unsigned size,
@@ -147,8 +181,9 @@ RasterBuffer::ScanHorizontalLine(unsigned ax, unsigned bx, unsigned y,
     const unsigned int iy = CombinedDivAndMod(cy);
 
     --size;
-    for (int i = 0; (unsigned)i <= size; ++i) {
-      unsigned cx = ax + (i * dx) / (int)size;
+    LinearIterator x(ax, dx, size);
+    for (unsigned i = 0; i <= size; ++i, x.Next()) {
+      unsigned cx = x.GetValue();
       const unsigned int ix = CombinedDivAndMod(cx);
 
       *buffer++ = GetInterpolated(cx, cy, ix, iy);
@@ -175,11 +210,9 @@ RasterBuffer::ScanHorizontalLine(unsigned ax, unsigned bx, unsigned y,
       GetDataAt(0, y >> RasterTraits::SUBPIXEL_BITS);
 
     --size;
-    for (int i = 0; (unsigned)i <= size; ++i) {
-      unsigned cx = ax + (i * dx) / (int)size;
-
-      *buffer++ = src[cx >> RasterTraits::SUBPIXEL_BITS];
-    }
+    LinearIterator x(ax, dx, size);
+    for (unsigned i = 0; i <= size; ++i, x.Next())
+      *buffer++ = src[x.GetValue() >> RasterTraits::SUBPIXEL_BITS];
   }
 }
 
@@ -216,9 +249,10 @@ RasterBuffer::ScanLine(unsigned ax, unsigned ay, unsigned bx, unsigned by,
       (unsigned)(abs(dx) + abs(dy)) < (2 * size << RasterTraits::SUBPIXEL_BITS)) {
     /* interpolate */
 
-    for (int i = 0; (unsigned)i <= size; ++i) {
-      unsigned cx = ax + (i * dx) / (int)size;
-      unsigned cy = ay + (i * dy) / (int)size;
+    LinearIterator x(ax, dx, size), y(ay, dy, size);
+    for (unsigned i = 0; i <= size; ++i, x.Next(), y.Next()) {
+      unsigned cx = x.GetValue();
+      unsigned cy = y.GetValue();
 
       const unsigned int ix = CombinedDivAndMod(cx);
       const unsigned int iy = CombinedDivAndMod(cy);
@@ -228,13 +262,10 @@ RasterBuffer::ScanLine(unsigned ax, unsigned ay, unsigned bx, unsigned by,
   } else {
     /* no interpolation needed */
 
-    for (int i = 0; (unsigned)i <= size; ++i) {
-      unsigned cx = ax + (i * dx) / (int)size;
-      unsigned cy = ay + (i * dy) / (int)size;
-
-      *buffer++ = Get(cx >> RasterTraits::SUBPIXEL_BITS,
-                      cy >> RasterTraits::SUBPIXEL_BITS);
-    }
+    LinearIterator x(ax, dx, size), y(ay, dy, size);
+    for (unsigned i = 0; i <= size; ++i, x.Next(), y.Next())
+      *buffer++ = Get(x.GetValue() >> RasterTraits::SUBPIXEL_BITS,
+                      y.GetValue() >> RasterTraits::SUBPIXEL_BITS);
   }
 }
 
@@ -39,6 +39,9 @@ public:
   RasterBuffer(unsigned _width, unsigned _height)
     :data(_width, _height) {}
 
+  RasterBuffer(RasterBuffer &&) = default;
+  RasterBuffer &operator=(RasterBuffer &&) = default;
+
   RasterBuffer(const RasterBuffer &) = delete;
   RasterBuffer &operator=(const RasterBuffer &) = delete;
 
@@ -0,0 +1,255 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TERRAIN_RASTER_LINE_STEPPER_HPP
+#define XCSOAR_TERRAIN_RASTER_LINE_STEPPER_HPP
+
+#include "RasterLocation.hpp"
+#include "Compiler.h"
+
+#include <algorithm>
+
+#include <assert.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * Walks the pixels of a Bresenham line from #origin towards
+ * #destination, exactly like the classic incremental loop:
+ *
+ *   e2 = 2 * err;
+ *   if (e2 > -dy) { err -= dy; x += sx; }
+ *   if (e2 < dx) { err += dx; y += sy; }
+ *
+ * Each iteration of that loop moves one pixel along the major axis,
+ * and sometimes one along the minor axis: after n iterations, it has
+ * made (2 * minor * n + major - 1) / (2 * major) minor steps.  This
+ * allows jumping over many iterations at a time, instead of visiting
+ * all pixels in between.  Like the loop, the walk may continue
+ * beyond the destination.
+ */
+class RasterLineStepper {
+  SignedRasterLocation origin;
+  int sx, sy;
+
+  /**
+   * The length of the line along the major and the minor axis.
+   */
+  unsigned major, minor;
+
+  /**
+   * The divisor of the minor step formula (2 * major), or UINT_MAX
+   * if the line has no length.
+   */
+  unsigned modulus;
+
+  bool x_major;
+
+  /**
+   * The number of loop iterations so far, and the number of minor
+   * steps made by them.
+   */
+  unsigned iteration, minor_steps;
+
+  /**
+   * The remainder of the minor step formula.
+   */
+  unsigned error;
+
+  /**
+   * The most recent jump made by AdvanceTo(): the requested number
+   * of total steps, the estimated number of iterations and the
+   * resulting quotient and remainder of the minor step formula.  A
+   * ray is usually sampled at a constant stride, and this saves the
+   * divisions for all but the first jump.
+   */
+  unsigned jump_delta = 0, jump_iterations = 0, jump_minor = 0, jump_error = 0;
+
+  /**
+   * AdvanceTo() walks strides up to this number of steps one
+   * iteration at a time.
+   */
+  static constexpr unsigned MAX_WALK = 32;
+
+public:
+  RasterLineStepper(SignedRasterLocation _origin,
+                    SignedRasterLocation destination)
+    :origin(_origin),
+     sx(origin.x < destination.x ? 1 : -1),
+     sy(origin.y < destination.y ? 1 : -1) {
+    const unsigned dx = abs(destination.x - origin.x);
+    const unsigned dy = abs(destination.y - origin.y);
+    x_major = dx >= dy;
+    major = std::max(dx, dy);
+    minor = std::min(dx, dy);
+    modulus = major > 0 ? 2 * major : UINT_MAX;
+
+    iteration = minor_steps = 0;
+    error = major > 0 ? major - 1 : 0;
+  }
+
+  /**
+   * The total number of steps (along both axes) from origin to
+   * destination.
+   */
+  unsigned GetMaxSteps() const {
+    return major + minor;
+  }
+
+  /**
+   * The iteration which arrives at the destination.
+   */
+  unsigned GetEndIteration() const {
+    return major;
+  }
+
+  unsigned GetIteration() const {
+    return iteration;
+  }
+
+  /**
+   * The number of minor axis steps after the specified number of
+   * iterations.
+   */
+  gcc_pure
+  unsigned MinorAt(unsigned n) const {
+    return major > 0
+      ? unsigned((2 * uint64_t(minor) * n + major - 1) / modulus)
+      : 0;
+  }
+
+  /**
+   * The total number of steps (along both axes) after the specified
+   * number of iterations.
+   */
+  gcc_pure
+  unsigned TotalStepsAt(unsigned n) const {
+    return n + MinorAt(n);
+  }
+
+  unsigned GetTotalSteps() const {
+    return iteration + minor_steps;
+  }
+
+  SignedRasterLocation GetLocation() const {
+    const int a = iteration, b = minor_steps;
+    return x_major
+      ? SignedRasterLocation(origin.x + sx * a, origin.y + sy * b)
+      : SignedRasterLocation(origin.x + sx * b, origin.y + sy * a);
+  }
+
+  void Seek(unsigned n) {
+    iteration = n;
+
+    if (major > 0) {
+      const uint64_t numerator = 2 * uint64_t(minor) * n + major - 1;
+      minor_steps = unsigned(numerator / modulus);
+      error = unsigned(numerator % modulus);
+    } else {
+      minor_steps = error = 0;
+    }
+  }
+
+  /**
+   * Advance by one iteration.
+   */
+  void Step() {
+    ++iteration;
+    error += 2 * minor;
+    if (error >= modulus) {
+      error -= modulus;
+      ++minor_steps;
+    }
+  }
+
+  /**
+   * Undo one Step().
+   */
+  void StepBack() {
+    assert(iteration > 0);
+
+    --iteration;
+    if (error < 2 * minor) {
+      error += modulus;
+      --minor_steps;
+    }
+    error -= 2 * minor;
+  }
+
+  /**
+   * Advance to the first iteration (not before the current one)
+   * whose total step count is at least #total_steps.
+   */
+  void AdvanceTo(unsigned total_steps) {
+    const unsigned current = GetTotalSteps();
+    if (current >= total_steps)
+      return;
+
+    const unsigned delta = total_steps - current;
+    if (delta <= MAX_WALK) {
+      /* short stride: walking is cheaper than the divisions below */
+      do {
+        Step();
+      } while (GetTotalSteps() < total_steps);
+      return;
+    }
+
+    if (delta != jump_delta) {
+      /* estimate from the slope; each iteration makes one or two
+         steps */
+      const unsigned sum = major + minor;
+      jump_delta = delta;
+      jump_iterations = sum > 0
+        ? std::max(1u, unsigned(uint64_t(delta) * major / sum))
+        : delta;
+      const uint64_t numerator = 2 * uint64_t(minor) * jump_iterations;
+      jump_minor = major > 0 ? unsigned(numerator / modulus) : 0;
+      jump_error = major > 0 ? unsigned(numerator % modulus) : 0;
+    }
+
+    const unsigned start = iteration;
+
+    iteration += jump_iterations;
+    minor_steps += jump_minor;
+    error += jump_error;
+    if (error >= modulus) {
+      error -= modulus;
+      ++minor_steps;
+    }
+
+    /* correct the rounding error of the estimate */
+    while (GetTotalSteps() < total_steps)
+      Step();
+
+    while (iteration > start + 1) {
+      StepBack();
+      if (GetTotalSteps() < total_steps) {
+        Step();
+        break;
+      }
+    }
+  }
+};
+
+#endif
@@ -118,7 +118,6 @@ public:
   void ScanLine(const GeoPoint &start, const GeoPoint &end,
                 TerrainHeight *buffer, unsigned size, bool interpolate) const;
 
-  gcc_pure
   bool FirstIntersection(const GeoPoint &origin, int h_origin,
                          const GeoPoint &destination, int h_destination,
                          int h_virt, int h_ceiling, int h_safety,
@@ -23,14 +23,26 @@ Copyright_License {
 
 #include "RasterTerrain.hpp"
 #include "Loader.hpp"
+#include "RasterTileStore.hpp"
 #include "Profile/Profile.hpp"
 #include "IO/ZipArchive.hpp"
 #include "IO/FileCache.hpp"
+#include "OS/FileUtil.hpp"
 #include "OS/ConvertPathName.hpp"
 #include "Operation/Operation.hpp"
 #include "Util/ConvertString.hpp"
+#include "Util/Clamp.hpp"
+
+#include <algorithm>
+#include <stdexcept>
 
 static const TCHAR *const terrain_cache_name = _T("terrain");
+static const TCHAR *const terrain_tiles_name = _T("terrain-tiles");
+
+RasterTerrain::RasterTerrain(Path _path, ZipArchive &&_archive)
+  :Guard<RasterMap>(map), path(_path), archive(std::move(_archive)) {}
+
+RasterTerrain::~RasterTerrain() {}
 
 inline bool
 RasterTerrain::LoadCache(FileCache &cache, Path path)
@@ -63,20 +75,40 @@ RasterTerrain::SaveCache(FileCache &cache, Path path) const
   return success;
 }
 
+inline void
+RasterTerrain::OpenTileStore(FileCache &cache, Path path)
+{
+  const auto &tile_cache = map.GetTileCache();
+
+  /* the key identifies the map file and the terrain inside it */
+  const uint64_t key = tile_cache.CalculateChecksum() ^
+    (File::GetSize(path) * 0x9e3779b97f4a7c15ull) ^
+    (File::GetLastModification(path) * 0xc2b2ae3d27d4eb4full);
+
+  cache.CreateCacheDirectory();
+  const auto store_path = cache.MakeCachePath(terrain_tiles_name);
+  tile_store.reset(new RasterTileStore(store_path, key,
+                                       tile_cache.GetTileCount()));
+  if (!tile_store->IsDefined())
+    tile_store.reset();
+}
+
 inline bool
 RasterTerrain::Load(Path path, FileCache *cache,
                     OperationEnvironment &operation)
 {
-  if (LoadCache(cache, path))
-    return true;
+  if (!LoadCache(cache, path)) {
+    if (!LoadTerrainOverview(archive.get(), map.GetTileCache(), operation))
+      return false;
 
-  if (!LoadTerrainOverview(archive.get(), map.GetTileCache(), operation))
-    return false;
+    map.UpdateProjection();
 
-  map.UpdateProjection();
+    if (cache != nullptr)
+      SaveCache(*cache, path);
+  }
 
   if (cache != nullptr)
-    SaveCache(*cache, path);
+    OpenTileStore(*cache, path);
 
   return true;
 }
@@ -88,7 +120,7 @@ try {
   if (path.IsNull())
     return nullptr;
 
-  RasterTerrain *rt = new RasterTerrain(ZipArchive(path));
+  RasterTerrain *rt = new RasterTerrain(path, ZipArchive(path));
   if (!rt->Load(path, cache, operation)) {
     delete rt;
     return nullptr;
@@ -101,13 +133,43 @@ try {
 }
 
 bool
-RasterTerrain::UpdateTiles(const GeoPoint &location, double radius)
+RasterTerrain::UpdateTiles(const GeoPoint &location, const GeoPoint &ahead,
+                           double radius,
+                           ParallelExecutor *executor, unsigned n_jobs)
 {
   auto &tile_cache = map.GetTileCache();
   if (!tile_cache.IsValid())
     return false;
 
-  UpdateTerrainTiles(archive.get(), tile_cache, mutex,
-                     map.GetProjection(), location, radius);
+  n_jobs = Clamp(n_jobs, 1u, unsigned(MAX_UPDATE_JOBS));
+
+  /* libzzip handles must not be shared between threads; open one
+     more for each additional job */
+  while (job_archives.size() + 1 < n_jobs) {
+    try {
+      job_archives.emplace_back(path);
+    } catch (const std::runtime_error &) {
+      /* continue with fewer jobs */
+      break;
+    }
+  }
+
+  n_jobs = std::min<unsigned>(n_jobs, job_archives.size() + 1);
+
+  struct zzip_dir *dirs[MAX_UPDATE_JOBS];
+  dirs[0] = archive.get();
+  for (unsigned i = 1; i < n_jobs; ++i)
+    dirs[i] = job_archives[i - 1].get();
+
+  const auto &projection = map.GetProjection();
+  const auto raster_location = projection.ProjectCoarse(location);
+  const auto raster_ahead = projection.ProjectCoarse(ahead);
+
+  UpdateTerrainTiles(executor, dirs, n_jobs, "terrain.jp2",
+                     tile_cache, mutex,
+                     raster_location.x, raster_location.y,
+                     raster_ahead.x, raster_ahead.y,
+                     projection.DistancePixelsCoarse(radius),
+                     tile_store.get());
   return map.IsDirty();
 }
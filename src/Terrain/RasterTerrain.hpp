@@ -31,8 +31,13 @@ Copyright_License {
 #include "IO/ZipArchive.hpp"
 #include "Compiler.h"
 
+#include <memory>
+#include <vector>
+
 class FileCache;
+class RasterTileStore;
 class OperationEnvironment;
+class ParallelExecutor;
 
 /**
  * Class to manage raster terrain database, potentially with caching
@@ -44,19 +49,40 @@ public:
   friend class ProtectedTaskManager; // for intersection
   friend class WaypointVisitorMap; // for intersection rendering
 
+  /**
+   * The maximum number of jobs decoding tiles in parallel.
+   */
+  static constexpr unsigned MAX_UPDATE_JOBS = 4;
+
 private:
+  const AllocatedPath path;
+
   ZipArchive archive;
 
+  /**
+   * Additional handles to the archive, one for each tile decoder job
+   * except the first one (which uses #archive).  They are opened on
+   * demand.
+   */
+  std::vector<ZipArchive> job_archives;
+
+  /**
+   * Decoded tiles from previous runs.  nullptr if there is no
+   * #FileCache.
+   */
+  std::unique_ptr<RasterTileStore> tile_store;
+
   RasterMap map;
 
 private:
   /**
    * Constructor.  Returns uninitialised object.
    */
-  explicit RasterTerrain(ZipArchive &&_archive)
-    :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+  RasterTerrain(Path _path, ZipArchive &&_archive);
 
 public:
+  ~RasterTerrain();
+
   const Serial &GetSerial() const {
     return map.GetSerial();
   }
@@ -80,7 +106,20 @@ public:
   /**
    * @return true if the method shall be called again
    */
-  bool UpdateTiles(const GeoPoint &location, double radius);
+  bool UpdateTiles(const GeoPoint &location, double radius) {
+    return UpdateTiles(location, location, radius, nullptr, 1);
+  }
+
+  /**
+   * Load the tiles around the given location and along the line to
+   * #ahead (the projected track), decoding up to #n_jobs parts in
+   * parallel on the given #ParallelExecutor.
+   *
+   * @return true if the method shall be called again
+   */
+  bool UpdateTiles(const GeoPoint &location, const GeoPoint &ahead,
+                   double radius,
+                   ParallelExecutor *executor, unsigned n_jobs);
 
 private:
   bool LoadCache(FileCache &cache, Path path);
@@ -91,6 +130,8 @@ private:
 
   bool SaveCache(FileCache &cache, Path path) const;
 
+  void OpenTileStore(FileCache &cache, Path path);
+
   bool Load(Path path, FileCache *cache,
             OperationEnvironment &operation);
 };
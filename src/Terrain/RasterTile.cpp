@@ -52,15 +52,15 @@ RasterTile::LoadCache(FILE *file)
   return true;
 }
 
-void
-RasterTile::CopyFrom(const struct jas_matrix &m)
+RasterBuffer
+RasterTile::Convert(const struct jas_matrix &m) const
 {
   if (!IsDefined())
-    return;
+    return RasterBuffer();
 
-  buffer.Resize(width, height);
+  RasterBuffer result(width, height);
 
-  auto *gcc_restrict dest = buffer.GetData();
+  auto *gcc_restrict dest = result.GetData();
   assert(dest != nullptr);
 
   const unsigned width = m.numcols_, height = m.numrows_;
@@ -71,6 +71,8 @@ RasterTile::CopyFrom(const struct jas_matrix &m)
     for (unsigned i = 0; i < width; ++i)
       *dest++ = TerrainHeight(src[i]);
   }
+
+  return result;
 }
 
 TerrainHeight
@@ -136,3 +138,30 @@ RasterTile::VisibilityChanged(int view_x, int view_y, unsigned view_radius)
   request = false;
   return CheckTileVisibility(view_x, view_y, view_radius);
 }
+
+bool
+RasterTile::VisibilityChanged(int view_x, int view_y,
+                              int ahead_x, int ahead_y,
+                              unsigned view_radius)
+{
+  if (VisibilityChanged(view_x, view_y, view_radius))
+    return true;
+
+  if (!IsDefined())
+    return false;
+
+  /* sample the line at intervals not larger than the radius, so the
+     corridor has no gaps (unless it is extremely long) */
+  constexpr unsigned MAX_SAMPLES = 64;
+  const int dx = ahead_x - view_x, dy = ahead_y - view_y;
+  const unsigned length = std::max(abs(dx), abs(dy));
+  const int n = std::min(length / std::max(view_radius, 1u) + 1,
+                         MAX_SAMPLES);
+
+  for (int i = 1; i <= n; ++i)
+    if (CalcDistanceTo(view_x + dx * i / n,
+                       view_y + dy * i / n) <= view_radius)
+      return true;
+
+  return false;
+}
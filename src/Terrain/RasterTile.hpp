@@ -27,6 +27,8 @@ Copyright_License {
 #include "RasterTraits.hpp"
 #include "RasterBuffer.hpp"
 
+#include <utility>
+
 #include <stdio.h>
 
 struct jas_matrix;
@@ -113,7 +115,19 @@ public:
     return !buffer.IsDefined();
   }
 
-  void CopyFrom(const struct jas_matrix &m);
+  /**
+   * Convert a decoded JPEG2000 tile to a new buffer with the
+   * dimensions of this tile.  This method does not modify the
+   * object, therefore it may be called without holding the lock.
+   */
+  RasterBuffer Convert(const struct jas_matrix &m) const;
+
+  /**
+   * Install a buffer which was returned by Convert().
+   */
+  void Publish(RasterBuffer &&_buffer) {
+    buffer = std::move(_buffer);
+  }
 
   /**
    * Determine the non-interpolated height at the specified pixel
@@ -140,6 +154,15 @@ public:
 
   bool VisibilityChanged(int view_x, int view_y, unsigned view_radius);
 
+  /**
+   * Like VisibilityChanged(), but the tile is also considered
+   * visible if it is within range of the line from the view center
+   * to (ahead_x, ahead_y), i.e. the projected track.  The #distance
+   * is still measured from the view center.
+   */
+  bool VisibilityChanged(int view_x, int view_y,
+                         int ahead_x, int ahead_y, unsigned view_radius);
+
   void ScanLine(unsigned ax, unsigned ay, unsigned bx, unsigned by,
                 TerrainHeight *dest, unsigned size, bool interpolate) const {
     buffer.ScanLine(ax - (xstart << RasterTraits::SUBPIXEL_BITS),
@@ -24,6 +24,7 @@ Copyright_License {
 #include "RasterTileCache.hpp"
 #include "Math/Angle.hpp"
 #include "Math/FastMath.hpp"
+#include "Util/FNV1a.hpp"
 
 extern "C" {
 #include "jasper/jas_seq.h"
@@ -75,14 +76,13 @@ RasterTileCache::PutOverviewTile(unsigned index,
 }
 
 void
-RasterTileCache::PutTileData(unsigned index,
-                             const struct jas_matrix &m)
+RasterTileCache::PutTileData(unsigned index, RasterBuffer &&buffer)
 {
   auto &tile = tiles.GetLinear(index);
   if (!tile.IsRequested())
     return;
 
-  tile.CopyFrom(m);
+  tile.Publish(std::move(buffer));
 }
 
 struct RTDistanceSort {
@@ -99,7 +99,8 @@ struct RTDistanceSort {
 };
 
 bool
-RasterTileCache::PollTiles(int x, int y, unsigned radius)
+RasterTileCache::PollTiles(int x, int y, int ahead_x, int ahead_y,
+                           unsigned radius)
 {
   /* tiles are usually 256 pixels wide; with a radius smaller than
      that, the (optimized) tile distance calculations may fail;
@@ -120,16 +121,17 @@ RasterTileCache::PollTiles(int x, int y, unsigned radius)
 
   request_tiles.clear();
   for (int i = tiles.GetSize() - 1; i >= 0 && !request_tiles.full(); --i)
-    if (tiles.GetLinear(i).VisibilityChanged(x, y, radius))
+    if (tiles.GetLinear(i).VisibilityChanged(x, y, ahead_x, ahead_y,
+                                             radius))
       request_tiles.append(i);
 
+  /* sort by distance, to load the nearest tiles first */
+  const RTDistanceSort sort(*this);
+  std::sort(request_tiles.begin(), request_tiles.end(), sort);
+
   /* reduce if there are too many */
 
   if (request_tiles.size() > MAX_ACTIVE_TILES) {
-    /* sort by distance */
-    const RTDistanceSort sort(*this);
-    std::sort(request_tiles.begin(), request_tiles.end(), sort);
-
     /* dispose all tiles which are out of range */
     for (unsigned i = MAX_ACTIVE_TILES; i < request_tiles.size(); ++i) {
       RasterTile &tile = tiles.GetLinear(request_tiles[i]);
@@ -271,6 +273,26 @@ RasterTileCache::FinishTileUpdate()
   ++serial;
 }
 
+uint64_t
+RasterTileCache::CalculateChecksum() const
+{
+  const unsigned layout[] = {
+    width, height, tile_width, tile_height,
+    tiles.GetWidth(), tiles.GetHeight(),
+  };
+
+  uint64_t hash = UpdateFNV1a(FNV1A_INIT, layout, sizeof(layout));
+
+  for (const auto &segment : segments) {
+    const uint32_t values[] = {
+      segment.file_offset, segment.tile, segment.count,
+    };
+    hash = UpdateFNV1a(hash, values, sizeof(values));
+  }
+
+  return hash;
+}
+
 bool
 RasterTileCache::SaveCache(FILE *file) const
 {
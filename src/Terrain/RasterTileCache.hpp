@@ -30,6 +30,7 @@ Copyright_License {
 #include "Geo/GeoBounds.hpp"
 #include "Util/StaticArray.hxx"
 #include "Util/Serial.hpp"
+#include "Util/ConstBuffer.hxx"
 
 #include <assert.h>
 #include <stdio.h>
@@ -217,6 +218,36 @@ private:
   gcc_pure
   std::pair<TerrainHeight, bool> GetFieldDirect(unsigned px, unsigned py) const;
 
+  /**
+   * The tile which contains the most recent GetFieldCached() sample.
+   * Consecutive samples along a ray are usually within the same
+   * tile, and this saves the tile lookup for them.
+   */
+  struct FieldWindow {
+    unsigned x_start = 0, y_start = 0;
+
+    /**
+     * The size of the window; zero means there is no tile yet.
+     */
+    unsigned width = 0, height = 0;
+
+    /**
+     * The tile, or nullptr if it is not loaded and the overview
+     * shall be used.
+     */
+    const RasterTile *tile = nullptr;
+
+    bool IsInside(unsigned px, unsigned py) const {
+      return px - x_start < width && py - y_start < height;
+    }
+  };
+
+  /**
+   * Like GetFieldDirect(), but use (and update) the #FieldWindow.
+   */
+  std::pair<TerrainHeight, bool> GetFieldCached(unsigned px, unsigned py,
+                                                FieldWindow &window) const;
+
 public:
   bool SaveCache(FILE *file) const;
   bool LoadCache(FILE *file);
@@ -274,9 +305,61 @@ public:
                        unsigned end_x, unsigned end_y,
                        const struct jas_matrix &m);
 
-  bool PollTiles(int x, int y, unsigned radius);
+  bool PollTiles(int x, int y, unsigned radius) {
+    return PollTiles(x, y, x, y, radius);
+  }
+
+  /**
+   * Determine which tiles shall be loaded: those within the radius
+   * around (x, y) and around the line from there to (ahead_x,
+   * ahead_y), which is usually the projected track.  Tiles nearer to
+   * (x, y) get higher priority.
+   *
+   * @return true if at least one tile was requested
+   */
+  bool PollTiles(int x, int y, int ahead_x, int ahead_y, unsigned radius);
+
+  /**
+   * Returns the indices of the tiles examined by the last
+   * PollTiles() call, nearest first.  Only those which are
+   * requested need to be loaded.
+   */
+  ConstBuffer<uint16_t> GetPolledTiles() const {
+    return ConstBuffer<uint16_t>(request_tiles.begin(),
+                                 request_tiles.size());
+  }
+
+  gcc_pure
+  bool IsTileRequested(unsigned index) const {
+    return tiles.GetLinear(index).IsRequested();
+  }
+
+  const RasterTile &GetTile(unsigned index) const {
+    return tiles.GetLinear(index);
+  }
+
+  unsigned GetTileCount() const {
+    return tiles.GetSize();
+  }
+
+  /**
+   * Calculate a checksum of the tile layout and the marker segment
+   * table, which identifies the JPEG2000 file.
+   */
+  gcc_pure
+  uint64_t CalculateChecksum() const;
+
+  /**
+   * Convert decoded tile data to a buffer which can be passed to
+   * PutTileData().  This does not modify the object, and may be
+   * called without holding the lock.
+   */
+  RasterBuffer ConvertTileData(unsigned index,
+                               const struct jas_matrix &m) const {
+    return tiles.GetLinear(index).Convert(m);
+  }
 
-  void PutTileData(unsigned index, const struct jas_matrix &m);
+  void PutTileData(unsigned index, RasterBuffer &&buffer);
 
   void FinishTileUpdate();
 
@@ -0,0 +1,206 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "RasterTileStore.hpp"
+#include "RasterBuffer.hpp"
+#include "OS/FileMapping.hpp"
+#include "OS/FileUtil.hpp"
+
+#include <algorithm>
+
+#include <string.h>
+#include <tchar.h>
+
+/**
+ * Don't let the file grow beyond this size [bytes].
+ */
+static constexpr uint32_t MAX_FILE_SIZE = 256 * 1024 * 1024;
+
+/**
+ * Blocks are padded to a multiple of this size, to keep the block
+ * headers aligned.
+ */
+static constexpr size_t BLOCK_ALIGN = 4;
+
+static constexpr size_t
+AlignBlock(size_t size)
+{
+  return (size + BLOCK_ALIGN - 1) & ~(BLOCK_ALIGN - 1);
+}
+
+RasterTileStore::RasterTileStore(Path _path, uint64_t key, unsigned n_tiles)
+  :path(_path)
+{
+  if (!Open(key, n_tiles))
+    Create(key, n_tiles);
+}
+
+RasterTileStore::~RasterTileStore()
+{
+  if (file != nullptr)
+    fclose(file);
+}
+
+bool
+RasterTileStore::Open(uint64_t key, unsigned n_tiles)
+{
+  file = _tfopen(path.c_str(), _T("r+b"));
+  if (file == nullptr)
+    return false;
+
+  offsets.resize(n_tiles);
+
+  Header header;
+  long size;
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      header.magic != Header::MAGIC ||
+      header.version != Header::VERSION ||
+      header.key != key ||
+      header.n_tiles != n_tiles ||
+      fread(offsets.data(), sizeof(offsets.front()), n_tiles,
+            file) != n_tiles ||
+      fseek(file, 0, SEEK_END) != 0 ||
+      (size = ftell(file)) < 0 || size > long(MAX_FILE_SIZE)) {
+    fclose(file);
+    file = nullptr;
+    offsets.clear();
+    return false;
+  }
+
+  end = size;
+
+  /* ignore blocks which were not completely written */
+  for (auto &offset : offsets)
+    if (offset >= end)
+      offset = 0;
+
+  return true;
+}
+
+bool
+RasterTileStore::Create(uint64_t key, unsigned n_tiles)
+{
+  file = _tfopen(path.c_str(), _T("w+b"));
+  if (file == nullptr)
+    return false;
+
+  Header header;
+  /* zero-fill all implicit padding bytes (to make valgrind happy) */
+  memset(&header, 0, sizeof(header));
+  header.magic = Header::MAGIC;
+  header.version = Header::VERSION;
+  header.key = key;
+  header.n_tiles = n_tiles;
+
+  offsets.assign(n_tiles, 0);
+
+  if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+      fwrite(offsets.data(), sizeof(offsets.front()), n_tiles,
+             file) != n_tiles ||
+      fflush(file) != 0) {
+    fclose(file);
+    file = nullptr;
+    offsets.clear();
+    File::Delete(path);
+    return false;
+  }
+
+  end = sizeof(header) + n_tiles * sizeof(offsets.front());
+  return true;
+}
+
+const void *
+RasterTileStore::Map(uint32_t offset, size_t size)
+{
+  if (mapping == nullptr || offset + size > mapping->size()) {
+    /* the file has grown since it was mapped */
+    mapping.reset(new FileMapping(path));
+    if (mapping->error() || offset + size > mapping->size()) {
+      mapping.reset();
+      return nullptr;
+    }
+  }
+
+  return mapping->at(offset);
+}
+
+bool
+RasterTileStore::Load(unsigned index, unsigned width, unsigned height,
+                      RasterBuffer &buffer)
+{
+  if (!Contains(index))
+    return false;
+
+  const size_t data_size = size_t(width) * height * sizeof(TerrainHeight);
+  const auto *block = (const BlockHeader *)
+    Map(offsets[index], sizeof(BlockHeader) + data_size);
+  if (block == nullptr || block->width != width || block->height != height)
+    return false;
+
+  buffer = RasterBuffer(width, height);
+  std::copy_n((const TerrainHeight *)(block + 1), size_t(width) * height,
+              buffer.GetData());
+  return true;
+}
+
+void
+RasterTileStore::Store(unsigned index, const RasterBuffer &buffer)
+{
+  if (file == nullptr || index >= offsets.size() || offsets[index] != 0 ||
+      !buffer.IsDefined())
+    return;
+
+  BlockHeader block;
+  block.width = buffer.GetWidth();
+  block.height = buffer.GetHeight();
+
+  const size_t n = size_t(block.width) * block.height;
+  const size_t block_size = AlignBlock(sizeof(block) +
+                                       n * sizeof(TerrainHeight));
+  if (end + block_size > MAX_FILE_SIZE)
+    /* full */
+    return;
+
+  static constexpr uint8_t padding[BLOCK_ALIGN] = {0};
+  const size_t padding_size =
+    block_size - sizeof(block) - n * sizeof(TerrainHeight);
+
+  /* write the block first and then its offset, so an interrupted
+     write does not leave a dangling table entry */
+  const uint32_t offset = end;
+  if (fseek(file, offset, SEEK_SET) != 0 ||
+      fwrite(&block, sizeof(block), 1, file) != 1 ||
+      fwrite(buffer.GetData(), sizeof(TerrainHeight), n, file) != n ||
+      fwrite(padding, 1, padding_size, file) != padding_size ||
+      fseek(file, sizeof(Header) + index * sizeof(offset), SEEK_SET) != 0 ||
+      fwrite(&offset, sizeof(offset), 1, file) != 1 ||
+      fflush(file) != 0) {
+    /* give up writing; the blocks stored so far remain usable */
+    fclose(file);
+    file = nullptr;
+    return;
+  }
+
+  offsets[index] = offset;
+  end += block_size;
+}
@@ -0,0 +1,137 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_RASTER_TILE_STORE_HPP
+#define XCSOAR_RASTER_TILE_STORE_HPP
+
+#include "OS/Path.hpp"
+#include "Compiler.h"
+
+#include <memory>
+#include <vector>
+
+#include <stdint.h>
+#include <stdio.h>
+
+class FileMapping;
+class RasterBuffer;
+
+/**
+ * A persistent store of decoded terrain tiles, which avoids decoding
+ * the same JPEG2000 tiles again after a restart, or after they were
+ * discarded because there were too many.
+ *
+ * The file begins with a header, followed by a table of block
+ * offsets (one per tile, 0 if the tile is not stored), followed by
+ * the blocks of raw #TerrainHeight values in native byte order.  It
+ * is memory-mapped for reading; new blocks are appended.
+ *
+ * This class is not thread-safe.
+ */
+class RasterTileStore {
+  struct Header {
+    static constexpr uint32_t MAGIC = 0x5452534c;
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic, version;
+
+    /**
+     * Identifies the terrain file and its tile layout; the file is
+     * discarded if it does not match.
+     */
+    uint64_t key;
+
+    uint32_t n_tiles;
+
+    uint32_t reserved;
+  };
+
+  struct BlockHeader {
+    uint32_t width, height;
+  };
+
+  const AllocatedPath path;
+
+  FILE *file = nullptr;
+
+  std::unique_ptr<FileMapping> mapping;
+
+  /**
+   * The block offsets of all tiles, including the ones which were
+   * appended after #mapping was created.
+   */
+  std::vector<uint32_t> offsets;
+
+  /**
+   * The file size; new blocks are appended here.
+   */
+  uint32_t end;
+
+public:
+  /**
+   * Open (or create) the store.  Check IsDefined() afterwards.
+   *
+   * @param key a checksum of the terrain file
+   * @param n_tiles the number of tiles of the terrain file
+   */
+  RasterTileStore(Path _path, uint64_t key, unsigned n_tiles);
+  ~RasterTileStore();
+
+  RasterTileStore(const RasterTileStore &) = delete;
+  RasterTileStore &operator=(const RasterTileStore &) = delete;
+
+  bool IsDefined() const {
+    return file != nullptr;
+  }
+
+  gcc_pure
+  bool Contains(unsigned index) const {
+    return index < offsets.size() && offsets[index] != 0;
+  }
+
+  /**
+   * Copy a stored tile to the given buffer.
+   *
+   * @return false if the tile is not stored (or on error)
+   */
+  bool Load(unsigned index, unsigned width, unsigned height,
+            RasterBuffer &buffer);
+
+  /**
+   * Append a decoded tile.  Errors are ignored; the tile will just
+   * be decoded again next time.
+   */
+  void Store(unsigned index, const RasterBuffer &buffer);
+
+private:
+  bool Open(uint64_t key, unsigned n_tiles);
+  bool Create(uint64_t key, unsigned n_tiles);
+
+  /**
+   * Make sure the #mapping covers the specified range, re-mapping
+   * the file if it has grown.
+   */
+  const void *Map(uint32_t offset, size_t size);
+};
+
+#endif
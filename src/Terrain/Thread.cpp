@@ -24,15 +24,56 @@ Copyright_License {
 #include "Thread.hpp"
 #include "RasterTerrain.hpp"
 #include "Projection/WindowProjection.hpp"
+#include "NMEA/Info.hpp"
+#include "Geo/Math.hpp"
 #include "Thread/Util.hpp"
 
+#include <algorithm>
+
+/**
+ * How many seconds of flight along the current track shall be
+ * prefetched?
+ */
+static constexpr double LOOKAHEAD_TIME = 300;
+
+/**
+ * Upper limit for the prefetch distance [m], to avoid loading lots
+ * of tiles with bogus ground speeds.
+ */
+static constexpr double MAX_LOOKAHEAD_DISTANCE = 50000;
+
+/**
+ * The number of tile decoder threads in addition to this one.
+ */
+static constexpr unsigned MAX_DECODER_THREADS =
+  RasterTerrain::MAX_UPDATE_JOBS - 1;
+
+/**
+ * Calculate the location where the aircraft will be after
+ * #LOOKAHEAD_TIME, or return the fallback if it is not moving.
+ */
+gcc_pure
+static GeoPoint
+GetLookahead(const NMEAInfo &basic, const GeoPoint &fallback)
+{
+  if (!basic.location_available || !basic.track_available ||
+      !basic.MovementDetected())
+    return fallback;
+
+  const double distance = std::min(basic.ground_speed * LOOKAHEAD_TIME,
+                                   MAX_LOOKAHEAD_DISTANCE);
+  return FindLatitudeLongitude(basic.location, basic.track, distance);
+}
+
 TerrainThread::TerrainThread(RasterTerrain &_terrain,
                              std::function<void()> &&_callback)
   :StandbyThread("Terrain"), terrain(_terrain),
-   callback(std::move(_callback)) {}
+   callback(std::move(_callback)),
+   worker_pool(WorkerPool::GetDefaultThreads(MAX_DECODER_THREADS)) {}
 
 void
-TerrainThread::Trigger(const WindowProjection &projection)
+TerrainThread::Trigger(const WindowProjection &projection,
+                       const NMEAInfo &basic)
 {
   assert(projection.IsValid());
 
@@ -40,11 +81,14 @@ TerrainThread::Trigger(const WindowProjection &projection)
 
   GeoPoint center = projection.GetGeoScreenCenter();
   auto radius = projection.GetScreenWidthMeters() / 2;
+  const GeoPoint ahead = GetLookahead(basic, center);
   if (last_center.IsValid() && last_radius >= radius &&
-      last_center.DistanceS(center) < 1000)
+      last_center.DistanceS(center) < 1000 &&
+      last_ahead.DistanceS(ahead) < 1000)
     return;
 
   next_center = center;
+  next_ahead = ahead;
   next_radius = radius;
   StandbyThread::Trigger();
 }
@@ -57,14 +101,18 @@ TerrainThread::Tick()
   bool again = true;
   while (next_center.IsValid() && again && !IsStopped()) {
     const GeoPoint center = next_center;
+    const GeoPoint ahead = next_ahead;
     const auto radius = next_radius;
 
     {
       const ScopeUnlock unlock(mutex);
-      again = terrain.UpdateTiles(center, radius);
+      again = terrain.UpdateTiles(center, ahead, radius,
+                                  &worker_pool,
+                                  worker_pool.GetThreadCount() + 1);
     }
 
     last_center = center;
+    last_ahead = ahead;
     last_radius = radius;
   }
 
@@ -25,25 +25,32 @@ Copyright_License {
 #define XCSOAR_TERRAIN_THREAD_HPP
 
 #include "Thread/StandbyThread.hpp"
+#include "Thread/WorkerPool.hpp"
 #include "Geo/GeoPoint.hpp"
 
 #include <functional>
 
+struct NMEAInfo;
 class RasterTerrain;
 class WindowProjection;
 
 /**
- * A thread that loads topography files asynchronously.
+ * A thread that loads terrain tiles asynchronously.  The tiles are
+ * decoded in parallel by a #WorkerPool.
  */
 class TerrainThread final : private StandbyThread {
   RasterTerrain &terrain;
 
   const std::function<void()> callback;
 
+  WorkerPool worker_pool;
+
   GeoPoint last_center = GeoPoint::Invalid();
+  GeoPoint last_ahead;
   double last_radius;
 
   GeoPoint next_center;
+  GeoPoint next_ahead;
   double next_radius;
 
 public:
@@ -51,7 +58,11 @@ public:
 
   using StandbyThread::LockStop;
 
-  void Trigger(const WindowProjection &projection);
+  /**
+   * Load the tiles visible in the given projection, and prefetch the
+   * tiles along the aircraft's projected track.
+   */
+  void Trigger(const WindowProjection &projection, const NMEAInfo &basic);
 
 private:
   /* virtual methods from class StandbyThread*/
@@ -0,0 +1,163 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_SNAPSHOT_BUFFER_HPP
+#define XCSOAR_THREAD_SNAPSHOT_BUFFER_HPP
+
+#include <atomic>
+
+#include <assert.h>
+
+/**
+ * Publishes copies of a (large) object from one writer thread to any
+ * number of reader threads without a mutex.  The writer fills a slot
+ * which is not visible to readers and then makes it the current one;
+ * a reader pins the current slot while it looks at it, and the
+ * writer skips pinned slots.  Readers therefore always see a
+ * complete, consistent value which does not change while they hold
+ * the #Reader.
+ *
+ * There must be only one writer at a time (e.g. serialised by an
+ * external mutex).  With N slots, up to N-2 readers may hold a
+ * #Reader at the same time without ever blocking the writer; readers
+ * are supposed to release it quickly (usually after copying the
+ * value).
+ */
+template<typename T, unsigned N=4>
+class SnapshotBuffer {
+  static_assert(N >= 3, "Too few slots");
+
+  struct Slot {
+    T value;
+
+    /**
+     * The number of #Reader instances referring to this slot.
+     */
+    mutable std::atomic<unsigned> readers;
+
+    Slot():readers(0) {}
+  };
+
+  Slot slots[N];
+
+  /**
+   * The index of the most recently published slot.
+   */
+  std::atomic<unsigned> current;
+
+  /**
+   * The index of the slot being written, or N if there is none.
+   * Only accessed by the writer.
+   */
+  unsigned writing;
+
+public:
+  /**
+   * A reference to the current value; the slot will not be
+   * overwritten until this object is destructed.
+   */
+  class Reader {
+    const Slot *slot;
+
+    explicit Reader(const Slot &_slot):slot(&_slot) {}
+
+    friend class SnapshotBuffer;
+
+  public:
+    Reader(Reader &&src):slot(src.slot) {
+      src.slot = nullptr;
+    }
+
+    ~Reader() {
+      if (slot != nullptr)
+        --slot->readers;
+    }
+
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+
+    const T &operator*() const {
+      return slot->value;
+    }
+
+    const T *operator->() const {
+      return &slot->value;
+    }
+  };
+
+  SnapshotBuffer():current(0), writing(N) {}
+
+  SnapshotBuffer(const SnapshotBuffer &) = delete;
+  SnapshotBuffer &operator=(const SnapshotBuffer &) = delete;
+
+  /**
+   * Obtain the current value.  This method is lock-free, but it may
+   * need to retry if the writer publishes concurrently.
+   */
+  Reader Read() const {
+    while (true) {
+      const unsigned i = current;
+      const Slot &slot = slots[i];
+      ++slot.readers;
+
+      /* the writer may have picked this slot before we pinned it;
+         that is impossible if it is (still) the current one */
+      if (current == i)
+        return Reader(slot);
+
+      --slot.readers;
+    }
+  }
+
+  /**
+   * Obtain a slot for writing the next value.  Its contents are
+   * undefined (an older value).  Call EndWrite() to publish it.
+   */
+  T &BeginWrite() {
+    assert(writing == N);
+
+    const unsigned c = current;
+    for (unsigned i = (c + 1) % N;; i = (i + 1) % N) {
+      /* with at most N-2 readers, this will find a free slot in the
+         first round */
+      if (i != c && slots[i].readers == 0) {
+        writing = i;
+        return slots[i].value;
+      }
+    }
+  }
+
+  void EndWrite() {
+    assert(writing < N);
+
+    current = writing;
+    writing = N;
+  }
+
+  void Write(const T &value) {
+    BeginWrite() = value;
+    EndWrite();
+  }
+};
+
+#endif
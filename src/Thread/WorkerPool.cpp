@@ -0,0 +1,154 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "WorkerPool.hpp"
+#include "Thread/Thread.hpp"
+#include "Util/Clamp.hpp"
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+class WorkerPool::Worker final : public Thread {
+  WorkerPool &pool;
+
+public:
+  explicit Worker(WorkerPool &_pool):Thread("WorkerPool"), pool(_pool) {}
+
+protected:
+  void Run() override {
+    pool.WorkerRun();
+  }
+};
+
+WorkerPool::WorkerPool(unsigned n_threads)
+{
+  workers.reserve(n_threads);
+  for (unsigned i = 0; i < n_threads; ++i) {
+    Worker *worker = new Worker(*this);
+    if (!worker->Start()) {
+      delete worker;
+      break;
+    }
+
+    workers.push_back(worker);
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    const ScopeLock lock(mutex);
+    stop = true;
+    work_cond.broadcast();
+  }
+
+  for (Worker *worker : workers) {
+    worker->Join();
+    delete worker;
+  }
+}
+
+unsigned
+WorkerPool::GetDefaultThreads(unsigned limit)
+{
+#ifdef HAVE_POSIX
+  const long n_processors = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  const long n_processors = info.dwNumberOfProcessors;
+#endif
+
+  if (n_processors <= 1)
+    return 0;
+
+  return Clamp<unsigned>(n_processors - 1, 0, limit);
+}
+
+void
+WorkerPool::RunJobs()
+{
+  assert(mutex.IsLockedByCurrent());
+
+  while (function != nullptr && next_job < n_jobs) {
+    const Function &f = *function;
+    const unsigned i = next_job++;
+
+    {
+      const ScopeUnlock unlock(mutex);
+
+      try {
+        f(i);
+      } catch (...) {
+        const ScopeLock lock(mutex);
+        if (!error)
+          error = std::current_exception();
+      }
+    }
+
+    assert(n_pending > 0);
+    if (--n_pending == 0)
+      done_cond.broadcast();
+  }
+}
+
+void
+WorkerPool::WorkerRun()
+{
+  const ScopeLock lock(mutex);
+
+  while (!stop) {
+    RunJobs();
+    work_cond.wait(mutex);
+  }
+}
+
+void
+WorkerPool::ForEach(unsigned n, const Function &f)
+{
+  const ScopeLock lock(mutex);
+  assert(function == nullptr);
+
+  function = &f;
+  n_jobs = n;
+  next_job = 0;
+  n_pending = n;
+  error = nullptr;
+  work_cond.broadcast();
+
+  RunJobs();
+
+  while (n_pending > 0)
+    done_cond.wait(mutex);
+
+  function = nullptr;
+
+  if (error) {
+    std::exception_ptr e = error;
+    error = nullptr;
+    std::rethrow_exception(e);
+  }
+}
@@ -0,0 +1,111 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_THREAD_WORKER_POOL_HPP
+#define XCSOAR_THREAD_WORKER_POOL_HPP
+
+#include "Util/ParallelExecutor.hpp"
+#include "Thread/Mutex.hpp"
+#include "Cond.hxx"
+
+#include <exception>
+#include <vector>
+
+/**
+ * A small pool of threads which run the jobs passed to ForEach().
+ * The calling thread participates, so a pool without worker threads
+ * simply runs everything sequentially.
+ *
+ * ForEach() must not be called by more than one thread at a time.
+ */
+class WorkerPool final : public ParallelExecutor {
+  class Worker;
+
+  Mutex mutex;
+
+  /**
+   * Signalled when a new batch of jobs is available or when the
+   * pool shall be stopped.
+   */
+  Cond work_cond;
+
+  /**
+   * Signalled when the last job of the current batch has finished.
+   */
+  Cond done_cond;
+
+  std::vector<Worker *> workers;
+
+  const Function *function = nullptr;
+
+  /**
+   * The number of jobs in the current batch, the index of the next
+   * job to be started and the number of jobs which have not yet
+   * finished.
+   */
+  unsigned n_jobs = 0, next_job = 0, n_pending = 0;
+
+  /**
+   * The first exception thrown by a job of the current batch.
+   */
+  std::exception_ptr error;
+
+  bool stop = false;
+
+public:
+  /**
+   * @param n_threads the number of worker threads to be launched
+   * in addition to the calling thread
+   */
+  explicit WorkerPool(unsigned n_threads);
+
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  /**
+   * Returns a reasonable number of worker threads for this machine:
+   * one less than the number of processors, but not more than the
+   * given limit.
+   */
+  static unsigned GetDefaultThreads(unsigned limit);
+
+  unsigned GetThreadCount() const {
+    return workers.size();
+  }
+
+  /* virtual methods from class ParallelExecutor */
+  void ForEach(unsigned n, const Function &f) override;
+
+private:
+  /**
+   * Run jobs of the current batch until none is left to be started.
+   * Caller must lock the mutex.
+   */
+  void RunJobs();
+
+  void WorkerRun();
+};
+
+#endif
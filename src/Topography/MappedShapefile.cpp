@@ -0,0 +1,525 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "MappedShapefile.hpp"
+#include "shapelib/mapshape.h"
+#include "OS/ByteOrder.hpp"
+#include "OS/FileMapping.hpp"
+#include "Util/StringAPI.hxx"
+
+#ifdef HAVE_POSIX
+#include "OS/Path.hpp"
+
+#include <zzip/lib.h>
+
+#include <unistd.h>
+#endif
+
+#include <string>
+#include <cmath>
+
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+
+static inline uint32_t
+ReadLE32(const uint8_t *p)
+{
+  return ReadUnalignedLE32((const uint32_t *)p);
+}
+
+static inline uint32_t
+ReadBE32(const uint8_t *p)
+{
+  return ReadUnalignedBE32((const uint32_t *)p);
+}
+
+static inline unsigned
+ReadLE16(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+static inline double
+ReadLEDouble(const uint8_t *p)
+{
+  uint64_t i;
+  memcpy(&i, p, sizeof(i));
+  i = FromLE64(i);
+
+  double d;
+  memcpy(&d, &i, sizeof(d));
+  return d;
+}
+
+static rectObj
+ReadRect(const uint8_t *p)
+{
+  rectObj r;
+  r.minx = ReadLEDouble(p);
+  r.miny = ReadLEDouble(p + 8);
+  r.maxx = ReadLEDouble(p + 16);
+  r.maxy = ReadLEDouble(p + 24);
+  return r;
+}
+
+static constexpr bool
+IsPointType(int type)
+{
+  return type == SHP_POINT || type == SHP_POINTZ || type == SHP_POINTM;
+}
+
+static constexpr bool
+IsMultiPointType(int type)
+{
+  return type == SHP_MULTIPOINT || type == SHP_MULTIPOINTZ ||
+    type == SHP_MULTIPOINTM;
+}
+
+static constexpr bool
+IsPolygonType(int type)
+{
+  return type == SHP_POLYGON || type == SHP_POLYGONZ ||
+    type == SHP_POLYGONM;
+}
+
+static constexpr bool
+IsArcType(int type)
+{
+  return type == SHP_ARC || type == SHP_ARCZ || type == SHP_ARCM;
+}
+
+unsigned
+ShapeRecord::GetPartStart(unsigned i) const
+{
+  assert(i < n_parts);
+
+  return parts != nullptr ? ReadLE32(parts + 4 * i) : 0;
+}
+
+double
+ShapeRecord::GetX(unsigned i) const
+{
+  assert(i < n_points);
+
+  return ReadLEDouble(points + 16 * i);
+}
+
+double
+ShapeRecord::GetY(unsigned i) const
+{
+  assert(i < n_points);
+
+  return ReadLEDouble(points + 16 * i + 8);
+}
+
+bool
+ShapefileView::Open(ConstBuffer<void> _shp, ConstBuffer<void> _shx,
+                    ConstBuffer<void> _dbf)
+{
+  shp = ConstBuffer<uint8_t>::FromVoid(_shp);
+  shx = ConstBuffer<uint8_t>::FromVoid(_shx);
+  dbf = ConstBuffer<uint8_t>::FromVoid(_dbf);
+
+  if (shp.size < 100 || shx.size < 100)
+    return false;
+
+  shape_type = (int32_t)ReadLE32(shp.data + 32);
+  n_shapes = (shx.size - 100) / 8;
+
+  if (!dbf.IsNull()) {
+    if (dbf.size < 32)
+      return false;
+
+    dbf_records = ReadLE32(dbf.data + 4);
+    dbf_header_length = ReadLE16(dbf.data + 8);
+    dbf_record_length = ReadLE16(dbf.data + 10);
+    if (dbf_header_length < 32 || dbf_header_length > dbf.size)
+      return false;
+
+    dbf_fields = (dbf_header_length - 32) / 32;
+  }
+
+  return true;
+}
+
+rectObj
+ShapefileView::GetBounds() const
+{
+  return ReadRect(shp.data + 36);
+}
+
+ConstBuffer<uint8_t>
+ShapefileView::GetRecord(unsigned i) const
+{
+  assert(i < n_shapes);
+
+  const uint8_t *p = shx.data + 100 + 8 * i;
+  const size_t offset = size_t(ReadBE32(p)) * 2;
+  /* the record header (number and content length) is included, just
+     like msSHPReadShape() does */
+  const size_t size = size_t(ReadBE32(p + 4)) * 2 + 8;
+
+  if (offset > shp.size || size > shp.size - offset)
+    return nullptr;
+
+  return {shp.data + offset, size};
+}
+
+bool
+ShapefileView::ReadBounds(unsigned i, rectObj &bounds) const
+{
+  const auto record = GetRecord(i);
+  if (record.IsNull() || record.size == 12)
+    /* malformed or NULL shape */
+    return false;
+
+  if (IsPointType(shape_type)) {
+    if (record.size < 28)
+      return false;
+
+    bounds.minx = bounds.maxx = ReadLEDouble(record.data + 12);
+    bounds.miny = bounds.maxy = ReadLEDouble(record.data + 20);
+    return true;
+  }
+
+  if (record.size < 44)
+    return false;
+
+  bounds = ReadRect(record.data + 12);
+  /* empty shape? */
+  return !std::isnan(bounds.minx);
+}
+
+bool
+ShapefileView::ReadShape(unsigned i, ShapeRecord &shape) const
+{
+  /* this is what msInitShape() leaves behind */
+  shape.type = MS_SHAPE_NULL;
+  shape.bounds.minx = shape.bounds.miny = -1;
+  shape.bounds.maxx = shape.bounds.maxy = -1;
+  shape.n_parts = shape.n_points = 0;
+  shape.parts = shape.points = nullptr;
+
+  const auto record = GetRecord(i);
+  if (record.IsNull() || record.size == 12)
+    /* malformed or NULL shape */
+    return false;
+
+  const uint8_t *const p = record.data;
+
+  if (IsPolygonType(shape_type) || IsArcType(shape_type)) {
+    if (record.size < 52)
+      return false;
+
+    const int32_t n_points = ReadLE32(p + 48);
+    const int32_t n_parts = ReadLE32(p + 44);
+    if (n_points < 0 || n_parts < 0 ||
+        n_points > 50 * 1000 * 1000 || n_parts > 10 * 1000 * 1000 ||
+        52 + 4 * size_t(n_parts) + 16 * size_t(n_points) > record.size)
+      return false;
+
+    shape.parts = p + 52;
+    shape.n_parts = n_parts;
+    shape.n_points = n_points;
+
+    /* every part must have at least one point */
+    for (unsigned j = 0; j < shape.n_parts; ++j) {
+      const unsigned start = shape.GetPartStart(j);
+      if ((j == 0 && start != 0) ||
+          shape.GetPartEnd(j) <= start ||
+          shape.GetPartEnd(j) > shape.n_points) {
+        shape.n_parts = shape.n_points = 0;
+        return false;
+      }
+    }
+
+    shape.points = shape.parts + 4 * n_parts;
+    shape.bounds = ReadRect(p + 12);
+    shape.type = IsPolygonType(shape_type)
+      ? MS_SHAPE_POLYGON
+      : MS_SHAPE_LINE;
+    return true;
+  } else if (IsMultiPointType(shape_type)) {
+    if (record.size < 48)
+      return false;
+
+    const int32_t n_points = ReadLE32(p + 44);
+    size_t required = 48 + 16 * size_t(n_points);
+    if (shape_type != SHP_MULTIPOINT)
+      required += 16 + 8 * size_t(n_points);
+
+    if (n_points < 0 || n_points > 50 * 1000 * 1000 ||
+        required > record.size)
+      return false;
+
+    shape.n_parts = 1;
+    shape.n_points = n_points;
+    shape.points = p + 48;
+    shape.bounds = ReadRect(p + 12);
+    shape.type = MS_SHAPE_POINT;
+    return true;
+  } else if (IsPointType(shape_type)) {
+    if (record.size < 28)
+      return false;
+
+    shape.n_parts = shape.n_points = 1;
+    shape.points = p + 12;
+    shape.bounds.minx = shape.bounds.maxx = shape.GetX(0);
+    shape.bounds.miny = shape.bounds.maxy = shape.GetY(0);
+    shape.type = MS_SHAPE_POINT;
+    return true;
+  } else
+    return false;
+}
+
+StringView
+ShapefileView::ReadAttribute(unsigned i, unsigned field) const
+{
+  assert(HasAttributes());
+
+  if (i >= dbf_records || field >= dbf_fields)
+    return nullptr;
+
+  /* find the field's position within the record */
+  const uint8_t *info = dbf.data + 32;
+  unsigned offset = 1, size = 0;
+  char type = 0;
+  for (unsigned j = 0;; ++j, info += 32) {
+    type = (char)info[11];
+    size = type == 'N' || type == 'F'
+      ? info[16]
+      : ReadLE16(info + 16);
+
+    if (j == field)
+      break;
+
+    offset += size;
+  }
+
+  const size_t record_offset = dbf_header_length
+    + size_t(i) * dbf_record_length;
+  if (offset + size > dbf_record_length ||
+      record_offset + dbf_record_length > dbf.size)
+    return nullptr;
+
+  const char *begin = (const char *)dbf.data + record_offset + offset;
+  const char *end = begin + size;
+
+  /* like strncpy(), stop at the first null byte */
+  const char *nul = StringFind(begin, '\0', size);
+  if (nul != nullptr)
+    end = nul;
+
+  /* trim trailing blanks */
+  while (end > begin && end[-1] == ' ')
+    --end;
+
+  const bool numeric = type == 'N' || type == 'F' || type == 'D';
+  if (numeric) {
+    /* trim leading blanks from numeric values */
+    while (begin < end && *begin == ' ')
+      ++begin;
+
+    /* null values, see DBFIsValueNULL() */
+    if ((type != 'D' && begin < end && *begin == '*') ||
+        (type == 'D' && size_t(end - begin) >= 8 &&
+         memcmp(begin, "00000000", 8) == 0))
+      return "0";
+  }
+
+  return {begin, end};
+}
+
+MappedShapefile::MappedShapefile() = default;
+MappedShapefile::~MappedShapefile() = default;
+
+#ifdef HAVE_POSIX
+
+/**
+ * Find an entry in the central directory of a ZIP archive.
+ */
+gcc_pure
+static const zzip_dir_hdr *
+FindZipEntry(const zzip_dir &dir, const char *name)
+{
+  const zzip_dir_hdr *hdr = dir.hdr0;
+  if (hdr == nullptr)
+    return nullptr;
+
+  while (!StringIsEqual(hdr->d_name, name)) {
+    if (hdr->d_reclen == 0)
+      return nullptr;
+
+    hdr = (const zzip_dir_hdr *)((const char *)hdr + hdr->d_reclen);
+  }
+
+  return hdr;
+}
+
+/**
+ * Map an entry of a ZIP archive, if it is stored without
+ * compression.
+ */
+static std::unique_ptr<FileMapping>
+MapZipEntry(const zzip_dir &dir, const char *name)
+{
+  const zzip_dir_hdr *hdr = FindZipEntry(dir, name);
+  if (hdr == nullptr || hdr->d_compr != 0 ||
+      hdr->d_csize != hdr->d_usize)
+    /* missing or compressed */
+    return nullptr;
+
+  /* the central directory doesn't know the size of the local
+     header's variable-length fields; read them */
+  uint8_t local[30];
+  if (pread(dir.fd, local, sizeof(local), hdr->d_off) != sizeof(local) ||
+      ReadLE32(local) != 0x04034b50)
+    return nullptr;
+
+  const uint64_t offset = uint64_t(hdr->d_off) + sizeof(local)
+    + ReadLE16(local + 26) + ReadLE16(local + 28);
+
+  std::unique_ptr<FileMapping> mapping(new FileMapping(dir.fd, offset,
+                                                       hdr->d_csize));
+  if (mapping->error())
+    return nullptr;
+
+  return mapping;
+}
+
+std::unique_ptr<FileMapping>
+MapTopographyFile(zzip_dir *dir, const char *path)
+{
+  if (dir != nullptr)
+    return MapZipEntry(*dir, path);
+
+  std::unique_ptr<FileMapping> mapping(new FileMapping(Path(path)));
+  if (mapping->error())
+    return nullptr;
+
+  return mapping;
+}
+
+static bool
+FileExists(zzip_dir *dir, const char *path)
+{
+  return dir != nullptr
+    ? FindZipEntry(*dir, path) != nullptr
+    : access(path, R_OK) == 0;
+}
+
+/**
+ * Map the file with the given suffix, trying the lower case and
+ * the upper case variant like shapelib does.
+ */
+static std::unique_ptr<FileMapping>
+MapFile(zzip_dir *dir, const std::string &base,
+        const char *suffix, const char *upper_suffix)
+{
+  auto mapping = MapTopographyFile(dir, (base + suffix).c_str());
+  if (!mapping)
+    mapping = MapTopographyFile(dir, (base + upper_suffix).c_str());
+  return mapping;
+}
+
+static ConstBuffer<void>
+ToBuffer(const std::unique_ptr<FileMapping> &mapping)
+{
+  return mapping
+    ? ConstBuffer<void>(mapping->data(), mapping->size())
+    : nullptr;
+}
+
+bool
+MappedShapefile::Open(zzip_dir *dir, const char *filename)
+{
+  std::string base(filename);
+  const auto dot = base.rfind('.');
+  if (dot != base.npos &&
+      base.find_first_of("/\\", dot) == base.npos)
+    base.erase(dot);
+
+  shp_mapping = MapFile(dir, base, ".shp", ".SHP");
+  shx_mapping = MapFile(dir, base, ".shx", ".SHX");
+  if (!shp_mapping || !shx_mapping)
+    return false;
+
+  /* the .dbf file is optional; if it can't be mapped, labels are
+     read with shapelib */
+  dbf_mapping = MapFile(dir, base, ".dbf", ".DBF");
+
+  if (!view.Open(ToBuffer(shp_mapping), ToBuffer(shx_mapping),
+                 ToBuffer(dbf_mapping)))
+    return false;
+
+  has_index = FileExists(dir, (base + MS_INDEX_EXTENSION).c_str());
+  return true;
+}
+
+#else
+
+std::unique_ptr<FileMapping>
+MapTopographyFile(zzip_dir *, const char *)
+{
+  /* not implemented */
+  return nullptr;
+}
+
+bool
+MappedShapefile::Open(zzip_dir *, const char *)
+{
+  /* not implemented */
+  return false;
+}
+
+#endif
+
+int
+MappedShapefile::WhichShapes(shapefileObj &file, rectObj rect) const
+{
+  free(file.status);
+  file.status = nullptr;
+
+  file.statusbounds = rect;
+
+  if (msRectOverlap(&file.bounds, &rect) != MS_TRUE)
+    return MS_DONE;
+
+  file.status = msAllocBitArray(file.numshapes);
+  if (file.status == nullptr)
+    return MS_FAILURE;
+
+  if (msRectContained(&file.bounds, &rect) == MS_TRUE) {
+    msSetAllBits(file.status, file.numshapes, 1);
+  } else {
+    rectObj bounds;
+    for (int i = 0; i < file.numshapes; ++i)
+      if (view.ReadBounds(i, bounds) &&
+          msRectOverlap(&bounds, &rect) == MS_TRUE)
+        msSetBit(file.status, i, 1);
+  }
+
+  file.lastshape = -1;
+  return MS_SUCCESS;
+}
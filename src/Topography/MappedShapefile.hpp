@@ -0,0 +1,209 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef TOPOGRAPHY_MAPPED_SHAPEFILE_HPP
+#define TOPOGRAPHY_MAPPED_SHAPEFILE_HPP
+
+#include "shapelib/mapserver.h"
+#include "Util/ConstBuffer.hxx"
+#include "Util/StringView.hxx"
+#include "Compiler.h"
+
+#include <memory>
+
+#include <stdint.h>
+
+class FileMapping;
+struct zzip_dir;
+
+/**
+ * A shape record which was decoded by #ShapefileView.  The
+ * coordinates are not copied; they point into the .shp file.
+ */
+struct ShapeRecord {
+  MS_SHAPE_TYPE type;
+
+  rectObj bounds;
+
+  unsigned n_parts, n_points;
+
+  /**
+   * The little-endian 32 bit start index of each part; nullptr if
+   * there is only one part starting at index 0.
+   */
+  const uint8_t *parts;
+
+  /**
+   * The little-endian (x, y) coordinate pairs of all points; not
+   * necessarily aligned.
+   */
+  const uint8_t *points;
+
+  gcc_pure
+  unsigned GetPartStart(unsigned i) const;
+
+  gcc_pure
+  unsigned GetPartEnd(unsigned i) const {
+    return i + 1 < n_parts ? GetPartStart(i + 1) : n_points;
+  }
+
+  gcc_pure
+  double GetX(unsigned i) const;
+
+  gcc_pure
+  double GetY(unsigned i) const;
+};
+
+/**
+ * Decodes the records of a shapefile (.shp, .shx and optionally
+ * .dbf) straight from memory, without copying and without system
+ * calls.  This is a subset of what shapelib's msSHPReadShape(),
+ * msSHPReadBounds() and msDBFReadStringAttribute() do, and it
+ * applies the same plausibility checks.
+ */
+class ShapefileView {
+  ConstBuffer<uint8_t> shp, shx, dbf;
+
+  /**
+   * The shape type from the .shp header (SHP_*).
+   */
+  int shape_type;
+
+  unsigned n_shapes;
+
+  unsigned dbf_records, dbf_fields;
+  unsigned dbf_header_length, dbf_record_length;
+
+public:
+  /**
+   * Check the headers and initialise this object.  The buffers must
+   * remain valid as long as this object is used.
+   *
+   * @param dbf the .dbf file; may be nullptr, and then ReadAttribute()
+   * must not be used
+   * @return false if the files are malformed
+   */
+  bool Open(ConstBuffer<void> shp, ConstBuffer<void> shx,
+            ConstBuffer<void> dbf);
+
+  unsigned GetShapeCount() const {
+    return n_shapes;
+  }
+
+  bool HasAttributes() const {
+    return !dbf.IsNull();
+  }
+
+  /**
+   * Read the bounds of the whole file.
+   */
+  gcc_pure
+  rectObj GetBounds() const;
+
+  /**
+   * Read the bounds of the specified shape.
+   *
+   * @return false if the shape is empty or malformed
+   */
+  bool ReadBounds(unsigned i, rectObj &bounds) const;
+
+  /**
+   * Decode the specified shape.
+   *
+   * @return false if the shape is empty, malformed or of a type
+   * which is not supported
+   */
+  bool ReadShape(unsigned i, ShapeRecord &record) const;
+
+  /**
+   * Read an attribute from the .dbf file, with blanks trimmed like
+   * msDBFReadStringAttribute() does.
+   *
+   * @return the value (not null-terminated), or nullptr on error
+   */
+  gcc_pure
+  StringView ReadAttribute(unsigned i, unsigned field) const;
+
+private:
+  gcc_pure
+  ConstBuffer<uint8_t> GetRecord(unsigned i) const;
+};
+
+/**
+ * Map a file which belongs to a map into memory.
+ *
+ * @param dir the ZIP archive; nullptr if the file is in the real
+ * file system
+ * @return nullptr if the file does not exist or can't be mapped
+ * (e.g. because it is a deflated ZIP entry)
+ */
+std::unique_ptr<FileMapping>
+MapTopographyFile(zzip_dir *dir, const char *path);
+
+/**
+ * Maps the files of a shapefile into memory, if they are plain
+ * files or entries of a ZIP archive which are stored without
+ * compression.  Deflated entries can't be mapped; those are left
+ * to shapelib.
+ */
+class MappedShapefile {
+  std::unique_ptr<FileMapping> shp_mapping, shx_mapping, dbf_mapping;
+
+  ShapefileView view;
+
+  /**
+   * Does a ".qix" spatial index exist?  Then shapelib's
+   * msShapefileWhichShapes() is faster than a linear scan.
+   */
+  bool has_index;
+
+public:
+  MappedShapefile();
+  ~MappedShapefile();
+
+  /**
+   * @param dir the ZIP archive; nullptr if the file is in the real
+   * file system
+   * @param filename the path of the .shp file
+   * @return false if the .shp and .shx files could not be mapped;
+   * the .dbf file is optional
+   */
+  bool Open(zzip_dir *dir, const char *filename);
+
+  const ShapefileView &GetView() const {
+    return view;
+  }
+
+  bool HasIndex() const {
+    return has_index;
+  }
+
+  /**
+   * A replacement for msShapefileWhichShapes() which scans the
+   * mapped shape bounds instead of reading each of them with a
+   * system call.  Only use it if there is no spatial index.
+   */
+  int WhichShapes(shapefileObj &file, rectObj rect) const;
+};
+
+#endif
@@ -0,0 +1,85 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "ShapeGeneration.hpp"
+
+#include <new>
+
+#include <stdint.h>
+
+ShapeGeneration::~ShapeGeneration()
+{
+  while (head != nullptr) {
+    Chunk *next = head->next;
+    ::operator delete(head);
+    head = next;
+  }
+}
+
+ShapeGeneration::Chunk *
+ShapeGeneration::NewChunk(size_t size)
+{
+  Chunk *chunk = (Chunk *)::operator new(sizeof(Chunk) + size);
+  chunk->size = size;
+  return chunk;
+}
+
+void *
+ShapeGeneration::Allocate(size_t size, size_t alignment)
+{
+  assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+  assert(alignment <= alignof(Chunk));
+
+  char *p = (char *)(((uintptr_t)position + alignment - 1)
+                     & ~(uintptr_t)(alignment - 1));
+  if (head != nullptr && p <= end && size <= size_t(end - p)) {
+    position = p + size;
+    return p;
+  }
+
+  constexpr size_t CHUNK_DATA_SIZE = CHUNK_SIZE - sizeof(Chunk);
+  if (size > CHUNK_DATA_SIZE / 4) {
+    /* big allocations get a chunk of their own, linked behind
+       #head, so the free space in #head is not wasted */
+    Chunk *chunk = NewChunk(size);
+    if (head != nullptr) {
+      chunk->next = head->next;
+      head->next = chunk;
+    } else {
+      chunk->next = nullptr;
+      head = chunk;
+      position = end = chunk->Data() + size;
+    }
+
+    return chunk->Data();
+  }
+
+  Chunk *chunk = NewChunk(CHUNK_DATA_SIZE);
+  chunk->next = head;
+  head = chunk;
+
+  p = chunk->Data();
+  position = p + size;
+  end = p + CHUNK_DATA_SIZE;
+  return p;
+}
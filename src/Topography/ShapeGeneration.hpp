@@ -0,0 +1,114 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef TOPOGRAPHY_SHAPE_GENERATION_HPP
+#define TOPOGRAPHY_SHAPE_GENERATION_HPP
+
+#include "Compiler.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+/**
+ * A bump allocator which owns the memory of all #XShape objects
+ * loaded by one TopographyFile::Update() call.  Shapes are carved
+ * out of a few large chunks instead of one heap allocation per
+ * shape, point array and label, and the whole generation is freed
+ * at once when its last shape has been evicted from the cache.
+ *
+ * Only trivially destructible data may be allocated here; objects
+ * with a destructor (i.e. #XShape) must be destructed explicitly
+ * before Unref() is called.
+ */
+class ShapeGeneration {
+  static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+  struct alignas(8) Chunk {
+    Chunk *next;
+
+    /**
+     * The number of bytes available after this header.
+     */
+    size_t size;
+
+    char *Data() {
+      return (char *)(this + 1);
+    }
+  };
+
+  Chunk *head = nullptr;
+
+  /**
+   * The free range of the #head chunk.
+   */
+  char *position = nullptr, *end = nullptr;
+
+  /**
+   * The number of shapes which still live in this generation.
+   */
+  unsigned n_shapes = 0;
+
+public:
+  ShapeGeneration() = default;
+  ShapeGeneration(const ShapeGeneration &) = delete;
+  ShapeGeneration &operator=(const ShapeGeneration &) = delete;
+
+  ~ShapeGeneration();
+
+  gcc_malloc gcc_returns_nonnull
+  void *Allocate(size_t size, size_t alignment);
+
+  template<typename T>
+  gcc_malloc gcc_returns_nonnull
+  T *AllocateArray(size_t n) {
+    return (T *)Allocate(sizeof(T) * n, alignof(T));
+  }
+
+  /**
+   * Account for a new shape living in this generation.
+   */
+  void Ref() {
+    ++n_shapes;
+  }
+
+  /**
+   * A shape of this generation has been destructed.
+   *
+   * @return true if that was the last one, and the generation may
+   * now be deleted
+   */
+  bool Unref() {
+    assert(n_shapes > 0);
+
+    return --n_shapes == 0;
+  }
+
+  bool IsEmpty() const {
+    return n_shapes == 0;
+  }
+
+private:
+  static Chunk *NewChunk(size_t size);
+};
+
+#endif
@@ -23,12 +23,17 @@ Copyright_License {
 
 #include "Topography/TopographyFile.hpp"
 #include "Topography/XShape.hpp"
+#include "Topography/ShapeGeneration.hpp"
+#include "Topography/MappedShapefile.hpp"
+#include "Topography/TopographyPyramid.hpp"
 #include "Convert.hpp"
 #include "Projection/WindowProjection.hpp"
 
 #include <zzip/lib.h>
 
 #include <algorithm>
+#include <new>
+#include <string>
 
 TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
                                double _threshold,
@@ -46,6 +51,16 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
    important_label_threshold(_important_label_threshold),
    cache_bounds(GeoBounds::Invalid())
 {
+  if (OpenPyramid(filename)) {
+    center = pyramid->GetBounds().GetCenter();
+
+    if (dir != nullptr)
+      ++dir->refcount;
+
+    ++serial;
+    return;
+  }
+
   if (msShapefileOpen(&file, "rb", dir, filename, 0) == -1)
     return;
 
@@ -63,6 +78,12 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
 
   center = file_bounds.GetCenter();
 
+  mapped.reset(new MappedShapefile());
+  if (!mapped->Open(dir, filename) ||
+      mapped->GetView().GetShapeCount() != (unsigned)file.numshapes)
+    /* fall back to shapelib */
+    mapped.reset();
+
   shapes.ResizeDiscard(file.numshapes);
   std::fill(shapes.begin(), shapes.end(), ShapeList(nullptr));
 
@@ -78,7 +99,13 @@ TopographyFile::~TopographyFile()
     return;
 
   ClearCache();
-  msShapefileClose(&file);
+
+  if (pyramid) {
+    pyramid.reset();
+  } else {
+    mapped.reset();
+    msShapefileClose(&file);
+  }
 
   if (dir != nullptr) {
     --dir->refcount;
@@ -89,19 +116,187 @@ TopographyFile::~TopographyFile()
 void
 TopographyFile::ClearCache()
 {
-  for (auto i = shapes.begin(), end = shapes.end(); i != end; ++i) {
-    delete i->shape;
-    i->shape = nullptr;
-  }
+  for (auto &i : shapes)
+    if (i.shape != nullptr)
+      DeleteShape(i);
+
+  for (auto &i : pyramid_tiles)
+    DeletePyramidTile(i);
+  pyramid_tiles.clear();
 
   first = nullptr;
 }
 
-static XShape *
-LoadShape(shapefileObj *file, const GeoPoint &center, int i,
-          int label_field)
+XShape *
+TopographyFile::LoadShape(unsigned i, ShapeGeneration &generation)
+{
+  void *p = generation.Allocate(sizeof(XShape), alignof(XShape));
+  XShape *shape;
+
+  if (mapped) {
+    const ShapefileView &view = mapped->GetView();
+
+    ShapeRecord record;
+    view.ReadShape(i, record);
+
+    StringView label = nullptr;
+    if (label_field >= 0)
+      label = view.HasAttributes()
+        ? view.ReadAttribute(i, label_field)
+        : StringView(msDBFReadStringAttribute(file.hDBF, i, label_field));
+
+    shape = new(p) XShape(record, label, center, generation);
+  } else
+    shape = new(p) XShape(&file, center, i, label_field, generation);
+
+  generation.Ref();
+  return shape;
+}
+
+void
+TopographyFile::DeleteShape(ShapeList &item)
+{
+  assert(item.shape != nullptr);
+  assert(item.generation != nullptr);
+
+  /* the item itself may live in the generation (pyramid tiles), so
+     don't touch it after the generation has been deleted */
+  ShapeGeneration *generation = item.generation;
+  item.shape->~XShape();
+  item.shape = nullptr;
+  item.generation = nullptr;
+
+  if (generation->Unref())
+    delete generation;
+}
+
+bool
+TopographyFile::OpenPyramid(const char *filename)
+{
+  /* "foo.shp" -> "foo.lod" */
+  std::string path(filename);
+  const auto dot = path.rfind('.');
+  if (dot == path.npos)
+    return false;
+
+  path.replace(dot, path.npos, ".lod");
+
+  pyramid.reset(new TopographyPyramid());
+  if (!pyramid->Open(dir, path.c_str())) {
+    pyramid.reset();
+    return false;
+  }
+
+  pyramid_level = pyramid->GetLevelCount();
+  return true;
+}
+
+TopographyFile::PyramidTile
+TopographyFile::LoadPyramidTile(unsigned index)
+{
+  PyramidTile tile;
+  tile.index = index;
+  tile.n_items = 0;
+
+  const unsigned n = pyramid->GetShapeCount(index);
+  if (n == 0) {
+    tile.generation = nullptr;
+    tile.items = nullptr;
+    return tile;
+  }
+
+  /* the shapes and the list items share one generation which lives
+     as long as the tile is cached */
+  ShapeGeneration &generation = *new ShapeGeneration();
+  tile.generation = &generation;
+  tile.items = generation.AllocateArray<ShapeList>(n);
+
+  pyramid->ForEachShape(index, [this, &tile, &generation](const PyramidShape &src){
+      void *p = generation.Allocate(sizeof(XShape), alignof(XShape));
+      ShapeList &item = tile.items[tile.n_items++];
+      item.shape = new(p) XShape(src, center, generation);
+      item.generation = &generation;
+      generation.Ref();
+    });
+
+  if (tile.n_items == 0) {
+    /* malformed tile */
+    delete tile.generation;
+    tile.generation = nullptr;
+  }
+
+  return tile;
+}
+
+void
+TopographyFile::DeletePyramidTile(PyramidTile &tile)
 {
-  return new XShape(file, center, i, label_field);
+  /* the last DeleteShape() call frees the generation, including the
+     items array */
+  for (unsigned i = 0, n = tile.n_items; i < n; ++i)
+    DeleteShape(tile.items[i]);
+
+  tile.generation = nullptr;
+  tile.items = nullptr;
+  tile.n_items = 0;
+}
+
+void
+TopographyFile::LinkPyramidTiles()
+{
+  const ShapeList **current = &first;
+  for (auto &tile : pyramid_tiles) {
+    for (unsigned i = 0; i < tile.n_items; ++i) {
+      *current = &tile.items[i];
+      current = &tile.items[i].next;
+    }
+  }
+
+  *current = nullptr;
+}
+
+bool
+TopographyFile::UpdatePyramid(const WindowProjection &map_projection)
+{
+  const GeoBounds screen = map_projection.GetScreenBounds();
+  const unsigned level = pyramid->ChooseLevel(screen);
+  if (level == pyramid_level &&
+      cache_bounds.IsValid() && cache_bounds.IsInside(screen))
+    /* the cache is still fresh */
+    return false;
+
+  cache_bounds = screen.Scale(2);
+  pyramid_level = level;
+
+  /* merge the tiles which are needed now with the cached ones (both
+     are ordered by index) */
+  std::vector<PyramidTile> tiles, evicted;
+  auto old = pyramid_tiles.begin();
+  const auto old_end = pyramid_tiles.end();
+  pyramid->VisitTiles(level, cache_bounds, [&](unsigned index){
+      while (old != old_end && old->index < index)
+        evicted.push_back(*old++);
+
+      if (old != old_end && old->index == index)
+        tiles.push_back(*old++);
+      else
+        tiles.push_back(LoadPyramidTile(index));
+    });
+  evicted.insert(evicted.end(), old, old_end);
+
+  {
+    const ScopeLock lock(mutex);
+    pyramid_tiles.swap(tiles);
+    LinkPyramidTiles();
+    ++serial;
+  }
+
+  /* now they're unreachable, and we can delete them without holding
+     a lock */
+  for (auto &i : evicted)
+    DeletePyramidTile(i);
+
+  return true;
 }
 
 bool
@@ -114,6 +309,9 @@ TopographyFile::Update(const WindowProjection &map_projection)
     /* not visible, don't update cache now */
     return false;
 
+  if (pyramid)
+    return UpdatePyramid(map_projection);
+
   const GeoBounds screenRect =
     map_projection.GetScreenBounds();
   if (cache_bounds.IsValid() && cache_bounds.IsInside(screenRect))
@@ -125,8 +323,13 @@ TopographyFile::Update(const WindowProjection &map_projection)
   rectObj deg_bounds = ConvertRect(cache_bounds);
 
   // Test which shapes are inside the given bounds and save the
-  // status to file.status
-  switch (msShapefileWhichShapes(&file, dir, deg_bounds, 0)) {
+  // status to file.status; without a spatial index, scanning the
+  // mapped file is much cheaper than letting shapelib read each
+  // shape's bounds
+  const int which = mapped && !mapped->HasIndex()
+    ? mapped->WhichShapes(file, deg_bounds)
+    : msShapefileWhichShapes(&file, dir, deg_bounds, 0);
+  switch (which) {
   case MS_FAILURE:
     ClearCache();
     return false;
@@ -141,6 +344,9 @@ TopographyFile::Update(const WindowProjection &map_projection)
 
   assert(file.status != nullptr);
 
+  /* all shapes loaded by this call share one generation */
+  ShapeGeneration *generation = nullptr;
+
   // Iterate through the shapefile entries
   const ShapeList **current = &first;
   auto it = shapes.begin();
@@ -160,8 +366,7 @@ TopographyFile::Update(const WindowProjection &map_projection)
 
         /* now it's unreachable, and we can delete the XShape without
            holding a lock */
-        delete it->shape;
-        it->shape = nullptr;
+        DeleteShape(*it);
       }
     } else {
       // is inside the bounds
@@ -169,7 +374,11 @@ TopographyFile::Update(const WindowProjection &map_projection)
         assert(*current != it);
 
         // shape isn't cached yet -> cache the shape
-        it->shape = LoadShape(&file, center, i, label_field);
+        if (generation == nullptr)
+          generation = new ShapeGeneration();
+
+        it->shape = LoadShape(i, *generation);
+        it->generation = generation;
         it->next = *current;
 
         /* insert into linked list (protected) */
@@ -192,13 +401,35 @@ TopographyFile::Update(const WindowProjection &map_projection)
 void
 TopographyFile::LoadAll()
 {
+  if (pyramid) {
+    /* load all tiles of the deepest level, which has all vertices */
+    ClearCache();
+
+    pyramid_level = pyramid->GetLevelCount() - 1;
+    pyramid->VisitTiles(pyramid_level, pyramid->GetBounds(),
+                        [this](unsigned index){
+                          pyramid_tiles.push_back(LoadPyramidTile(index));
+                        });
+
+    LinkPyramidTiles();
+    ++serial;
+    return;
+  }
+
+  ShapeGeneration *generation = nullptr;
+
   // Iterate through the shapefile entries
   const ShapeList **current = &first;
   auto it = shapes.begin();
   for (int i = 0; i < file.numshapes; ++i, ++it) {
-    if (it->shape == nullptr)
+    if (it->shape == nullptr) {
       // shape isn't cached yet -> cache the shape
-      it->shape = LoadShape(&file, center, i, label_field);
+      if (generation == nullptr)
+        generation = new ShapeGeneration();
+
+      it->shape = LoadShape(i, *generation);
+      it->generation = generation;
+    }
     // update list pointer
     *current = it;
     current = &it->next;
@@ -37,10 +37,16 @@ Copyright_License {
 #include "XShapePoint.hpp"
 #endif
 
+#include <memory>
+#include <vector>
+
 #include <assert.h>
 
 class WindowProjection;
 class XShape;
+class ShapeGeneration;
+class MappedShapefile;
+class TopographyPyramid;
 struct zzip_dir;
 
 class TopographyFile {
@@ -49,8 +55,13 @@ class TopographyFile {
 
     const XShape *shape;
 
+    /**
+     * The #ShapeGeneration which owns the memory of #shape.
+     */
+    ShapeGeneration *generation;
+
     ShapeList() {}
-    ShapeList(const XShape *_shape):shape(_shape) {}
+    ShapeList(const XShape *_shape):shape(_shape), generation(nullptr) {}
   };
 
   /**
@@ -62,6 +73,41 @@ class TopographyFile {
 
   shapefileObj file;
 
+  /**
+   * If the shapefile could be mapped into memory, shapes are decoded
+   * from there instead of being read with shapelib.  nullptr if that
+   * was not possible (e.g. deflated ZIP entries).
+   */
+  std::unique_ptr<MappedShapefile> mapped;
+
+  /**
+   * If the map contains a precomputed ".lod" pyramid for this layer,
+   * shapes are loaded tile by tile from there, already thinned for
+   * the current zoom level.  #file, #mapped and #shapes are unused
+   * then.
+   */
+  std::unique_ptr<TopographyPyramid> pyramid;
+
+  struct PyramidTile {
+    unsigned index;
+
+    /**
+     * Owns the shapes and the #items array; nullptr if the tile has
+     * no shapes.
+     */
+    ShapeGeneration *generation;
+
+    ShapeList *items;
+    unsigned n_items;
+  };
+
+  /**
+   * The pyramid tiles currently in the cache, ordered by index.
+   */
+  std::vector<PyramidTile> pyramid_tiles;
+
+  unsigned pyramid_level;
+
   /**
    * The center of shapefileObj::bounds.
    */
@@ -189,7 +235,7 @@ public:
   }
 
   bool IsEmpty() const {
-    return shapes.empty();
+    return shapes.empty() && pyramid == nullptr;
   }
 
   bool IsVisible(double map_scale) const {
@@ -287,8 +333,42 @@ public:
    */
   void LoadAll();
 
+  /**
+   * Are the shapes decoded from a memory-mapped file?
+   */
+  bool IsMapped() const {
+    return mapped != nullptr || pyramid != nullptr;
+  }
+
+  /**
+   * Are the shapes loaded from a precomputed ".lod" pyramid?
+   */
+  bool HasPyramid() const {
+    return pyramid != nullptr;
+  }
+
 protected:
   void ClearCache();
+
+private:
+  XShape *LoadShape(unsigned i, ShapeGeneration &generation);
+
+  /**
+   * Destruct the shape and release its generation if it was the last
+   * one there.
+   */
+  static void DeleteShape(ShapeList &item);
+
+  bool OpenPyramid(const char *filename);
+  bool UpdatePyramid(const WindowProjection &map_projection);
+  PyramidTile LoadPyramidTile(unsigned index);
+  static void DeletePyramidTile(PyramidTile &tile);
+
+  /**
+   * Rebuild the linked list from #pyramid_tiles.  Caller must hold
+   * the lock.
+   */
+  void LinkPyramidTiles();
 };
 
 #endif
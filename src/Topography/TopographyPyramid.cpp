@@ -0,0 +1,271 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TopographyPyramid.hpp"
+#include "MappedShapefile.hpp"
+#include "OS/FileMapping.hpp"
+#include "OS/ByteOrder.hpp"
+
+#include <algorithm>
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+using namespace TopographyPyramidFormat;
+
+static inline unsigned
+ReadLE16(const uint8_t *p)
+{
+  return ReadUnalignedLE16((const uint16_t *)p);
+}
+
+static inline uint32_t
+ReadLE32(const uint8_t *p)
+{
+  return ReadUnalignedLE32((const uint32_t *)p);
+}
+
+static inline double
+ReadLEDouble(const uint8_t *p)
+{
+  uint64_t i;
+  memcpy(&i, p, sizeof(i));
+  i = FromLE64(i);
+
+  double d;
+  memcpy(&d, &i, sizeof(d));
+  return d;
+}
+
+unsigned
+PyramidShape::GetLineSize(unsigned l) const
+{
+  assert(l < n_lines);
+
+  return ReadLE16(line_sizes + 2 * l);
+}
+
+double
+PyramidShape::GetX(unsigned i) const
+{
+  assert(i < n_points);
+
+  return origin_x + int16_t(ReadLE16(points + 4 * i)) * unit_x;
+}
+
+double
+PyramidShape::GetY(unsigned i) const
+{
+  assert(i < n_points);
+
+  return origin_y + int16_t(ReadLE16(points + 4 * i + 2)) * unit_y;
+}
+
+TopographyPyramid::TopographyPyramid() = default;
+TopographyPyramid::~TopographyPyramid() = default;
+
+bool
+TopographyPyramid::Open(zzip_dir *dir, const char *filename)
+{
+  mapping = MapTopographyFile(dir, filename);
+  if (!mapping)
+    return false;
+
+  data = ConstBuffer<uint8_t>::FromVoid({mapping->data(), mapping->size()});
+  if (data.size < sizeof(Header) ||
+      memcmp(data.data, "XCSLOD\0\0", 8) != 0 ||
+      ReadLE32(data.data + offsetof(Header, version)) != VERSION)
+    return false;
+
+  n_levels = ReadLE32(data.data + offsetof(Header, n_levels));
+  n_tiles = ReadLE32(data.data + offsetof(Header, n_tiles));
+  west = ReadLEDouble(data.data + offsetof(Header, west));
+  south = ReadLEDouble(data.data + offsetof(Header, south));
+  east = ReadLEDouble(data.data + offsetof(Header, east));
+  north = ReadLEDouble(data.data + offsetof(Header, north));
+
+  if (n_levels == 0 || n_levels > MAX_LEVELS ||
+      n_tiles > (data.size - sizeof(Header)) / sizeof(TileEntry) ||
+      !(west < east) || !(south < north))
+    return false;
+
+  /* check all tile offsets once, so GetTileEntry() users don't need
+     to */
+  for (unsigned i = 0; i < n_tiles; ++i) {
+    const uint8_t *entry = GetTileEntry(i);
+    const uint32_t offset = ReadLE32(entry + offsetof(TileEntry, offset));
+    const uint32_t size = ReadLE32(entry + offsetof(TileEntry, size));
+    const uint32_t n_shapes = ReadLE32(entry + offsetof(TileEntry, n_shapes));
+    if (offset > data.size || size > data.size - offset ||
+        /* each record has at least a 4 byte header */
+        n_shapes > size / 4 ||
+        (i > 0 && GetKey(i) <= GetKey(i - 1)))
+      return false;
+  }
+
+  return true;
+}
+
+GeoBounds
+TopographyPyramid::GetBounds() const
+{
+  return GeoBounds(GeoPoint(Angle::Degrees(west), Angle::Degrees(north)),
+                   GeoPoint(Angle::Degrees(east), Angle::Degrees(south)));
+}
+
+unsigned
+TopographyPyramid::ChooseLevel(const GeoBounds &screen) const
+{
+  const double screen_width = std::max(screen.GetWidth().Degrees(),
+                                       screen.GetHeight().Degrees());
+  if (!(screen_width > 0))
+    return n_levels - 1;
+
+  /* the first level whose tiles are not wider than the screen */
+  const double ratio = std::max(east - west, north - south) / screen_width;
+  if (ratio <= 1)
+    return 0;
+
+  const unsigned level = unsigned(ceil(log2(ratio)));
+  return std::min(level, n_levels - 1);
+}
+
+bool
+TopographyPyramid::GetTileRange(unsigned level, const GeoBounds &bounds,
+                                unsigned &x0, unsigned &y0,
+                                unsigned &x1, unsigned &y1) const
+{
+  const unsigned n = 1u << level;
+  const double scale_x = n / (east - west), scale_y = n / (north - south);
+
+  const double left = (bounds.GetWest().Degrees() - west) * scale_x;
+  const double right = (bounds.GetEast().Degrees() - west) * scale_x;
+  const double bottom = (bounds.GetSouth().Degrees() - south) * scale_y;
+  const double top = (bounds.GetNorth().Degrees() - south) * scale_y;
+
+  if (right < 0 || left >= n || top < 0 || bottom >= n)
+    return false;
+
+  x0 = unsigned(std::max(left, 0.));
+  y0 = unsigned(std::max(bottom, 0.));
+  x1 = unsigned(std::min(right, n - 1.));
+  y1 = unsigned(std::min(top, n - 1.));
+  return true;
+}
+
+const uint8_t *
+TopographyPyramid::GetTileEntry(unsigned i) const
+{
+  assert(i < n_tiles);
+
+  return data.data + sizeof(Header) + i * sizeof(TileEntry);
+}
+
+uint32_t
+TopographyPyramid::GetKey(unsigned i) const
+{
+  return ReadLE32(GetTileEntry(i) + offsetof(TileEntry, key));
+}
+
+unsigned
+TopographyPyramid::FindTile(uint32_t key) const
+{
+  unsigned first = 0, count = n_tiles;
+  while (count > 0) {
+    const unsigned step = count / 2;
+    const unsigned i = first + step;
+    if (GetKey(i) < key) {
+      first = i + 1;
+      count -= step + 1;
+    } else
+      count = step;
+  }
+
+  return first;
+}
+
+unsigned
+TopographyPyramid::GetShapeCount(unsigned tile) const
+{
+  return ReadLE32(GetTileEntry(tile) + offsetof(TileEntry, n_shapes));
+}
+
+TopographyPyramid::TileReader::TileReader(const TopographyPyramid &pyramid,
+                                          unsigned tile)
+{
+  const uint8_t *entry = pyramid.GetTileEntry(tile);
+  const uint32_t key = ReadLE32(entry + offsetof(TileEntry, key));
+  p = pyramid.data.data + ReadLE32(entry + offsetof(TileEntry, offset));
+  end = p + ReadLE32(entry + offsetof(TileEntry, size));
+
+  const unsigned level = key >> 24;
+  const unsigned x = key & 0xfff, y = (key >> 12) & 0xfff;
+  const unsigned n = 1u << level;
+
+  const double tile_width = (pyramid.east - pyramid.west) / n;
+  const double tile_height = (pyramid.north - pyramid.south) / n;
+  origin_x = pyramid.west + x * tile_width;
+  origin_y = pyramid.south + y * tile_height;
+  unit_x = tile_width / QUANTUM;
+  unit_y = tile_height / QUANTUM;
+}
+
+bool
+TopographyPyramid::TileReader::Read(PyramidShape &shape)
+{
+  if (end - p < 4)
+    return false;
+
+  shape.type = MS_SHAPE_TYPE(p[0]);
+  shape.n_lines = p[1];
+  const unsigned label_length = ReadLE16(p + 2);
+  p += 4;
+
+  if (size_t(end - p) < 2 * shape.n_lines)
+    return false;
+
+  shape.line_sizes = p;
+  p += 2 * shape.n_lines;
+
+  shape.n_points = 0;
+  for (unsigned l = 0; l < shape.n_lines; ++l)
+    shape.n_points += shape.GetLineSize(l);
+
+  if (size_t(end - p) < 4 * size_t(shape.n_points) + label_length)
+    return false;
+
+  shape.points = p;
+  p += 4 * shape.n_points;
+
+  shape.label = label_length > 0
+    ? StringView((const char *)p, label_length)
+    : StringView(nullptr);
+  p += label_length;
+
+  shape.origin_x = origin_x;
+  shape.origin_y = origin_y;
+  shape.unit_x = unit_x;
+  shape.unit_y = unit_y;
+  return true;
+}
@@ -0,0 +1,251 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef TOPOGRAPHY_PYRAMID_HPP
+#define TOPOGRAPHY_PYRAMID_HPP
+
+#include "shapelib/mapserver.h"
+#include "Geo/GeoBounds.hpp"
+#include "Util/ConstBuffer.hxx"
+#include "Util/StringView.hxx"
+#include "Compiler.h"
+
+#include <memory>
+
+#include <stdint.h>
+
+class FileMapping;
+struct zzip_dir;
+
+/**
+ * The layout of a ".lod" file: a precomputed multi-resolution copy
+ * of one topography layer, generated by the BuildTopographyPyramid
+ * tool.
+ *
+ * Level L divides the layer's bounds into 2^L x 2^L tiles.  Each
+ * tile contains the shapes (clipped at the tile border) with their
+ * vertices already thinned for the zoom band of that level; the
+ * deepest level contains the original vertices.  All integers are
+ * little-endian, and nothing is aligned.
+ *
+ *   Header
+ *   TileEntry[n_tiles], sorted by key
+ *   tile data
+ *
+ * Each tile is a sequence of n_shapes records:
+ *
+ *   uint8_t type (MS_SHAPE_TYPE)
+ *   uint8_t n_lines
+ *   uint16_t label_length
+ *   uint16_t line_size[n_lines]
+ *   int16_t x, y for each point, in 1/QUANTUM tile units relative to
+ *     the tile's south-west corner
+ *   char label[label_length] (UTF-8, not null-terminated)
+ */
+namespace TopographyPyramidFormat {
+  static constexpr uint32_t VERSION = 1;
+
+  static constexpr unsigned MAX_LEVELS = 13;
+
+  /**
+   * The number of quantisation steps per tile width/height.  Lines
+   * may leave their tile by up to three tile sizes in each
+   * direction, which still fits into 16 bit.
+   */
+  static constexpr int QUANTUM = 8192;
+
+  struct Header {
+    /**
+     * "XCSLOD" followed by two null bytes.
+     */
+    char magic[8];
+
+    uint32_t version;
+    uint32_t n_levels;
+    uint32_t n_tiles;
+    uint32_t reserved;
+
+    /**
+     * The bounds of level 0 in degrees.
+     */
+    double west, south, east, north;
+  };
+
+  static_assert(sizeof(Header) == 56, "Wrong Header size");
+
+  struct TileEntry {
+    uint32_t key;
+    uint32_t n_shapes;
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  static_assert(sizeof(TileEntry) == 16, "Wrong TileEntry size");
+
+  constexpr uint32_t
+  MakeKey(unsigned level, unsigned x, unsigned y)
+  {
+    return (level << 24) | (y << 12) | x;
+  }
+}
+
+/**
+ * One shape record of a #TopographyPyramid tile.  The coordinates
+ * point into the mapped file.
+ */
+struct PyramidShape {
+  MS_SHAPE_TYPE type;
+
+  unsigned n_lines, n_points;
+
+  const uint8_t *line_sizes, *points;
+
+  StringView label;
+
+  /**
+   * The south-west corner of the tile and the size of one
+   * quantisation step, in degrees.
+   */
+  double origin_x, origin_y, unit_x, unit_y;
+
+  gcc_pure
+  unsigned GetLineSize(unsigned l) const;
+
+  gcc_pure
+  double GetX(unsigned i) const;
+
+  gcc_pure
+  double GetY(unsigned i) const;
+};
+
+/**
+ * Reads a memory-mapped ".lod" file (see #TopographyPyramidFormat).
+ */
+class TopographyPyramid {
+  std::unique_ptr<FileMapping> mapping;
+
+  ConstBuffer<uint8_t> data;
+
+  unsigned n_levels, n_tiles;
+
+  double west, south, east, north;
+
+public:
+  TopographyPyramid();
+  ~TopographyPyramid();
+
+  /**
+   * @param dir the ZIP archive; nullptr if the file is in the real
+   * file system
+   * @return false if the file does not exist, can't be mapped or is
+   * malformed
+   */
+  bool Open(zzip_dir *dir, const char *filename);
+
+  gcc_pure
+  GeoBounds GetBounds() const;
+
+  unsigned GetLevelCount() const {
+    return n_levels;
+  }
+
+  /**
+   * Choose the level whose tiles are about as big as the screen,
+   * i.e. whose vertex thinning is just below pixel resolution.
+   */
+  gcc_pure
+  unsigned ChooseLevel(const GeoBounds &screen) const;
+
+  /**
+   * Invoke f(tile) for each non-empty tile of the given level
+   * which overlaps the bounds, in ascending order.
+   */
+  template<typename F>
+  void VisitTiles(unsigned level, const GeoBounds &bounds, F &&f) const {
+    unsigned x0, y0, x1, y1;
+    if (!GetTileRange(level, bounds, x0, y0, x1, y1))
+      return;
+
+    for (unsigned y = y0; y <= y1; ++y) {
+      using namespace TopographyPyramidFormat;
+      const uint32_t last = MakeKey(level, x1, y);
+      for (unsigned i = FindTile(MakeKey(level, x0, y));
+           i < n_tiles && GetKey(i) <= last; ++i)
+        f(i);
+    }
+  }
+
+  gcc_pure
+  unsigned GetShapeCount(unsigned tile) const;
+
+  /**
+   * Decode all shapes of a tile, and invoke f(const PyramidShape &)
+   * for each of them.
+   *
+   * @return false if the tile is malformed (shapes decoded so far
+   * have been passed to f)
+   */
+  template<typename F>
+  bool ForEachShape(unsigned tile, F &&f) const {
+    TileReader reader(*this, tile);
+    PyramidShape shape;
+    for (unsigned n = GetShapeCount(tile); n > 0; --n) {
+      if (!reader.Read(shape))
+        return false;
+
+      f(shape);
+    }
+
+    return true;
+  }
+
+private:
+  bool GetTileRange(unsigned level, const GeoBounds &bounds,
+                    unsigned &x0, unsigned &y0,
+                    unsigned &x1, unsigned &y1) const;
+
+  const uint8_t *GetTileEntry(unsigned i) const;
+
+  gcc_pure
+  uint32_t GetKey(unsigned i) const;
+
+  /**
+   * Returns the index of the first tile whose key is not less than
+   * the given one.
+   */
+  gcc_pure
+  unsigned FindTile(uint32_t key) const;
+
+  class TileReader {
+    const uint8_t *p, *end;
+
+    double origin_x, origin_y, unit_x, unit_y;
+
+  public:
+    TileReader(const TopographyPyramid &pyramid, unsigned tile);
+
+    bool Read(PyramidShape &shape);
+  };
+};
+
+#endif
@@ -22,10 +22,12 @@ Copyright_License {
 */
 
 #include "Topography/XShape.hpp"
+#include "Topography/MappedShapefile.hpp"
+#include "Topography/TopographyPyramid.hpp"
+#include "Topography/ShapeGeneration.hpp"
 #include "Convert.hpp"
 #include "Util/StringAPI.hxx"
 #include "Util/UTF8.hpp"
-#include "Util/StringUtil.hpp"
 #include "Util/ScopeExit.hxx"
 
 #ifdef ENABLE_OPENGL
@@ -39,27 +41,39 @@ Copyright_License {
 
 #include <algorithm>
 
+#include <math.h>
 #include <tchar.h>
 
-static AllocatedString<TCHAR>
-ImportLabel(const char *src)
+static const TCHAR *
+ImportLabel(StringView src, ShapeGeneration &generation)
 {
-  if (src == nullptr)
+  if (src.IsNull())
     return nullptr;
 
-  src = StripLeft(src);
-  if (StringIsEqual(src, "RAILWAY STATION") ||
-      StringIsEqual(src, "RAILROAD STATION") ||
-      StringIsEqual(src, "UNK"))
+  src.StripLeft();
+  if (src.Equals("RAILWAY STATION") ||
+      src.Equals("RAILROAD STATION") ||
+      src.Equals("UNK"))
     return nullptr;
 
+  char *copy = generation.AllocateArray<char>(src.size + 1);
+  *std::copy_n(src.data, src.size, copy) = 0;
+
 #ifdef _UNICODE
-  return AllocatedString<TCHAR>::Donate(ConvertUTF8ToWide(src));
+  const UTF8ToWideConverter converted(copy);
+  if (!converted.IsValid())
+    return nullptr;
+
+  const TCHAR *wide = converted;
+  const size_t length = StringLength(wide);
+  TCHAR *label = generation.AllocateArray<TCHAR>(length + 1);
+  std::copy_n(wide, length + 1, label);
+  return label;
 #else
-  if (!ValidateUTF8(src))
+  if (!ValidateUTF8(copy))
     return nullptr;
 
-  return AllocatedString<TCHAR>::Duplicate(src);
+  return copy;
 #endif
 }
 
@@ -87,47 +101,165 @@ GetMinPointsForShapeType(int shapelib_type)
   }
 }
 
-XShape::XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
-               int label_field)
-  :label(nullptr)
+/**
+ * Adapts a shapelib #shapeObj for XShape::Import().
+ */
+class ShapeObjSource {
+  const shapeObj &shape;
+
+public:
+  explicit ShapeObjSource(const shapeObj &_shape):shape(_shape) {}
+
+  int GetType() const {
+    return shape.type;
+  }
+
+  const rectObj &GetBounds() const {
+    return shape.bounds;
+  }
+
+  unsigned GetLineCount() const {
+    return shape.numlines;
+  }
+
+  int GetLineSize(unsigned l) const {
+    return shape.line[l].numpoints;
+  }
+
+  GeoPoint GetPoint(unsigned l, unsigned j) const {
+    const pointObj &p = shape.line[l].point[j];
+    return GeoPoint(Angle::Degrees(p.x), Angle::Degrees(p.y));
+  }
+};
+
+/**
+ * Adapts a #ShapeRecord decoded from a mapped shapefile for
+ * XShape::Import().
+ */
+class ShapeRecordSource {
+  const ShapeRecord &record;
+
+public:
+  explicit ShapeRecordSource(const ShapeRecord &_record):record(_record) {}
+
+  int GetType() const {
+    return record.type;
+  }
+
+  const rectObj &GetBounds() const {
+    return record.bounds;
+  }
+
+  unsigned GetLineCount() const {
+    return record.n_parts;
+  }
+
+  int GetLineSize(unsigned l) const {
+    return record.GetPartEnd(l) - record.GetPartStart(l);
+  }
+
+  GeoPoint GetPoint(unsigned l, unsigned j) const {
+    const unsigned i = record.GetPartStart(l) + j;
+    return GeoPoint(Angle::Degrees(record.GetX(i)),
+                    Angle::Degrees(record.GetY(i)));
+  }
+};
+
+/**
+ * Adapts a #PyramidShape for XShape::Import().
+ */
+class PyramidShapeSource {
+  const PyramidShape &shape;
+
+  rectObj bounds;
+
+  /**
+   * The index of the first point of each line (n_lines is an 8 bit
+   * field).
+   */
+  unsigned line_starts[256];
+
+public:
+  explicit PyramidShapeSource(const PyramidShape &_shape):shape(_shape) {
+    bounds.minx = bounds.miny = HUGE_VAL;
+    bounds.maxx = bounds.maxy = -HUGE_VAL;
+    for (unsigned i = 0; i < shape.n_points; ++i) {
+      const double x = shape.GetX(i), y = shape.GetY(i);
+      bounds.minx = std::min(bounds.minx, x);
+      bounds.maxx = std::max(bounds.maxx, x);
+      bounds.miny = std::min(bounds.miny, y);
+      bounds.maxy = std::max(bounds.maxy, y);
+    }
+
+    unsigned start = 0;
+    for (unsigned l = 0; l < shape.n_lines; ++l) {
+      line_starts[l] = start;
+      start += shape.GetLineSize(l);
+    }
+  }
+
+  int GetType() const {
+    return shape.type;
+  }
+
+  const rectObj &GetBounds() const {
+    return bounds;
+  }
+
+  unsigned GetLineCount() const {
+    return shape.n_lines;
+  }
+
+  int GetLineSize(unsigned l) const {
+    return shape.GetLineSize(l);
+  }
+
+  GeoPoint GetPoint(unsigned l, unsigned j) const {
+    const unsigned i = line_starts[l] + j;
+    return GeoPoint(Angle::Degrees(shape.GetX(i)),
+                    Angle::Degrees(shape.GetY(i)));
+  }
+};
+
+template<typename S>
+void
+XShape::Import(const S &source, const GeoPoint &file_center,
+               ShapeGeneration &generation)
 {
 #ifdef ENABLE_OPENGL
   std::fill_n(index_count, THINNING_LEVELS, nullptr);
   std::fill_n(indices, THINNING_LEVELS, nullptr);
 #endif
 
-  shapeObj shape;
-  msInitShape(&shape);
-  AtScopeExit(&shape) { msFreeShape(&shape); };
-  msSHPReadShape(shpfile->hSHP, i, &shape);
+  points = nullptr;
+  num_lines = 0;
 
-  bounds = ImportRect(shape.bounds);
-  if (!bounds.Check()) {
+  bounds = ImportRect(source.GetBounds());
+  if (!bounds.Check())
     /* malformed bounds */
-    points = nullptr;
     return;
-  }
-
-  type = shape.type;
 
-  num_lines = 0;
+  type = source.GetType();
 
-  const int min_points = GetMinPointsForShapeType(shape.type);
-  if (min_points < 0) {
+  const int min_points = GetMinPointsForShapeType(type);
+  if (min_points < 0)
     /* not supported, leave an empty XShape object */
-    points = nullptr;
     return;
-  }
 
-  const unsigned input_lines = std::min((unsigned)shape.numlines,
-                                        (unsigned)MAX_LINES);
+  /* remember which input line each of our lines comes from; malformed
+     lines are skipped */
+  unsigned sources[MAX_LINES];
+
+  const unsigned input_lines = source.GetLineCount();
   unsigned num_points = 0;
-  for (unsigned l = 0; l < input_lines; ++l) {
-    if (shape.line[l].numpoints < min_points)
+  for (unsigned l = 0; l < input_lines && num_lines < MAX_LINES; ++l) {
+    const int line_size = source.GetLineSize(l);
+    if (line_size < min_points)
       /* malformed shape */
       continue;
 
-    lines[num_lines] = std::min(shape.line[l].numpoints, 16384);
+    sources[num_lines] = l;
+    lines[num_lines] = std::min(line_size, 16384);
     num_points += lines[num_lines];
     ++num_lines;
   }
@@ -136,40 +268,69 @@ XShape::XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
   /* OpenGL: convert GeoPoints to ShapePoints, make them relative to
      the map's boundary center */
 
-  points = new ShapePoint[num_points];
+  points = generation.AllocateArray<ShapePoint>(num_points);
   ShapePoint *p = points;
 #else // !ENABLE_OPENGL
   /* convert all points of all lines to GeoPoints */
 
-  points = new GeoPoint[num_points];
+  points = generation.AllocateArray<GeoPoint>(num_points);
   GeoPoint *p = points;
 #endif
   for (unsigned l = 0; l < num_lines; ++l) {
-    const pointObj *src = shape.line[l].point;
+    const unsigned src = sources[l];
     num_points = lines[l];
-    for (unsigned j = 0; j < num_points; ++j, ++src) {
+    for (unsigned j = 0; j < num_points; ++j) {
 #ifdef ENABLE_OPENGL
-      const GeoPoint vertex(Angle::Degrees(src->x), Angle::Degrees(src->y));
-      const GeoPoint relative = vertex - file_center;
+      const GeoPoint relative = source.GetPoint(src, j) - file_center;
 
       *p++ = ShapePoint(ShapeScalar(relative.longitude.Native()),
                         ShapeScalar(relative.latitude.Native()));
 #else
-      *p++ = GeoPoint(Angle::Degrees(src->x),
-                      Angle::Degrees(src->y));
+      *p++ = source.GetPoint(src, j);
 #endif
     }
   }
+}
+
+XShape::XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
+               int label_field, ShapeGeneration &generation)
+  :label(nullptr)
+{
+  shapeObj shape;
+  msInitShape(&shape);
+  AtScopeExit(&shape) { msFreeShape(&shape); };
+  msSHPReadShape(shpfile->hSHP, i, &shape);
+
+  Import(ShapeObjSource(shape), file_center, generation);
 
-  if (label_field >= 0) {
+  if (points != nullptr && label_field >= 0) {
     const char *src = msDBFReadStringAttribute(shpfile->hDBF, i, label_field);
-    label = ImportLabel(src);
+    label = ImportLabel(src, generation);
   }
 }
 
+XShape::XShape(const ShapeRecord &record, StringView _label,
+               const GeoPoint &file_center, ShapeGeneration &generation)
+  :label(nullptr)
+{
+  Import(ShapeRecordSource(record), file_center, generation);
+
+  if (points != nullptr)
+    label = ImportLabel(_label, generation);
+}
+
+XShape::XShape(const PyramidShape &shape, const GeoPoint &file_center,
+               ShapeGeneration &generation)
+  :label(nullptr)
+{
+  Import(PyramidShapeSource(shape), file_center, generation);
+
+  if (points != nullptr)
+    label = ImportLabel(shape.label, generation);
+}
+
 XShape::~XShape()
 {
-  delete[] points;
 #ifdef ENABLE_OPENGL
   // Note: index_count and indices share one buffer
   for (unsigned i = 0; i < THINNING_LEVELS; i++)
@@ -26,7 +26,7 @@ Copyright_License {
 #define TOPOGRAPHY_XSHAPE_HPP
 
 #include "Util/ConstBuffer.hxx"
-#include "Util/AllocatedString.hxx"
+#include "Util/StringView.hxx"
 #include "Geo/GeoBounds.hpp"
 #include "shapelib/mapserver.h"
 #include "shapelib/mapshape.h"
@@ -38,6 +38,9 @@ Copyright_License {
 #include <stdint.h>
 
 struct GeoPoint;
+struct ShapeRecord;
+struct PyramidShape;
+class ShapeGeneration;
 
 class XShape {
   static constexpr unsigned MAX_LINES = 32;
@@ -62,7 +65,8 @@ class XShape {
   uint16_t lines[MAX_LINES];
 
   /**
-   * All points of all lines.
+   * All points of all lines.  They are allocated from the
+   * #ShapeGeneration which owns this object.
    */
 #ifdef ENABLE_OPENGL
   ShapePoint *points;
@@ -89,16 +93,45 @@ class XShape {
   GeoPoint *points;
 #endif
 
-  AllocatedString<TCHAR> label;
+  /**
+   * The label, allocated from the #ShapeGeneration; nullptr if there
+   * is none.
+   */
+  const TCHAR *label;
 
 public:
+  /**
+   * Load a shape with shapelib.  The object itself and all of its
+   * data must be allocated from the given #ShapeGeneration.
+   */
   XShape(shapefileObj *shpfile, const GeoPoint &file_center, int i,
-         int label_field=-1);
+         int label_field, ShapeGeneration &generation);
+
+  /**
+   * Import a shape which was decoded from a mapped shapefile.
+   *
+   * @param label the raw label from the .dbf file; nullptr if there
+   * is none
+   */
+  XShape(const ShapeRecord &record, StringView label,
+         const GeoPoint &file_center, ShapeGeneration &generation);
+
+  /**
+   * Import a pre-thinned shape from a #TopographyPyramid tile.
+   */
+  XShape(const PyramidShape &shape, const GeoPoint &file_center,
+         ShapeGeneration &generation);
 
   XShape(const XShape &) = delete;
 
   ~XShape();
 
+private:
+  template<typename S>
+  void Import(const S &source, const GeoPoint &file_center,
+              ShapeGeneration &generation);
+
+public:
 #ifdef ENABLE_OPENGL
   void SetOffset(unsigned _offset) const {
     offset = _offset;
@@ -138,7 +171,7 @@ public:
   }
 
   const TCHAR *GetLabel() const {
-    return label.c_str();
+    return label;
   }
 };
 
@@ -28,12 +28,37 @@ Copyright_License {
 #include "OS/ByteOrder.hpp"
 #include "Util/CRC.hpp"
 
+#ifdef __linux__
+#include "OS/Error.hxx"
+#endif
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <errno.h>
+#endif
+
 namespace SkyLinesTracking {
 
 Server::Server(boost::asio::io_service &io_service,
-               boost::asio::ip::udp::endpoint endpoint)
-  :socket(io_service, endpoint)
+               boost::asio::ip::udp::endpoint endpoint,
+               bool reuse_port)
+  :socket(io_service, endpoint.protocol())
 {
+  if (reuse_port) {
+#ifdef SO_REUSEPORT
+    using ReusePort =
+      boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+    socket.set_option(ReusePort(true));
+#else
+    throw std::runtime_error("SO_REUSEPORT not supported");
+#endif
+  }
+
+  socket.bind(endpoint);
+
   AsyncReceive();
 }
 
@@ -58,6 +83,59 @@ Server::SendBuffer(const boost::asio::ip::udp::endpoint &endpoint,
   }
 }
 
+void
+Server::SendBuffers(ConstBuffer<Datagram> datagrams)
+{
+#ifdef __linux__
+  static constexpr size_t CHUNK = 64;
+
+  while (!datagrams.empty()) {
+    const size_t n = std::min(datagrams.size, CHUNK);
+
+    struct mmsghdr msgs[CHUNK];
+    struct iovec iov[CHUNK];
+
+    for (size_t i = 0; i < n; ++i) {
+      const auto &d = datagrams[i];
+
+      iov[i].iov_base =
+        const_cast<void *>(boost::asio::buffer_cast<const void *>(d.data));
+      iov[i].iov_len = boost::asio::buffer_size(d.data);
+
+      auto &h = msgs[i].msg_hdr;
+      h = {};
+      h.msg_name = const_cast<void *>((const void *)d.endpoint->data());
+      h.msg_namelen = d.endpoint->size();
+      h.msg_iov = &iov[i];
+      h.msg_iovlen = 1;
+    }
+
+    int result = sendmmsg(socket.native_handle(), msgs, n, 0);
+    if (result < 0) {
+      const int e = errno;
+      if (e == EINTR)
+        continue;
+
+      if (e == EAGAIN || e == EWOULDBLOCK)
+        /* the socket buffer is full; let boost::asio wait until the
+           first datagram can be sent, and then try again with the
+           rest */
+        SendBuffer(*datagrams.front().endpoint, datagrams.front().data);
+      else
+        OnSendError(*datagrams.front().endpoint,
+                    std::make_exception_ptr(MakeErrno(e, "sendmmsg() failed")));
+
+      result = 1;
+    }
+
+    datagrams.skip_front(result);
+  }
+#else
+  for (const auto &d : datagrams)
+    SendBuffer(*d.endpoint, d.data);
+#endif
+}
+
 void
 Server::OnPing(const Client &client, unsigned id)
 {
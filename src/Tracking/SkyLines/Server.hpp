@@ -24,6 +24,8 @@ Copyright_License {
 #ifndef XCSOAR_TRACKING_SKYLINES_SERVER_HPP
 #define XCSOAR_TRACKING_SKYLINES_SERVER_HPP
 
+#include "Util/ConstBuffer.hxx"
+
 #include <boost/asio/ip/udp.hpp>
 
 #include <chrono>
@@ -52,12 +54,27 @@ public:
     uint64_t key;
   };
 
+  /**
+   * A datagram queued for SendBuffers().
+   */
+  struct Datagram {
+    const boost::asio::ip::udp::endpoint *endpoint;
+    boost::asio::const_buffer data;
+  };
+
 private:
   Client client_buffer;
 
 public:
+  /**
+   * @param reuse_port set SO_REUSEPORT on the socket, which allows
+   * several #Server instances (usually in different threads) to bind
+   * to the same port; the kernel distributes incoming datagrams among
+   * them
+   */
   Server(boost::asio::io_service &io_service,
-         boost::asio::ip::udp::endpoint endpoint);
+         boost::asio::ip::udp::endpoint endpoint,
+         bool reuse_port=false);
 
   ~Server();
 
@@ -78,6 +95,13 @@ public:
   void SendBuffer(const boost::asio::ip::udp::endpoint &endpoint,
                   boost::asio::const_buffer data);
 
+  /**
+   * Send many datagrams at once.  On Linux, this uses sendmmsg() to
+   * reduce the number of system calls.  Errors are reported to
+   * OnSendError().
+   */
+  void SendBuffers(ConstBuffer<Datagram> datagrams);
+
   template<typename P>
   void SendPacket(const boost::asio::ip::udp::endpoint &endpoint,
                   const P &packet) {
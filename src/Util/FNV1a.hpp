@@ -0,0 +1,50 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_FNV1A_HPP
+#define XCSOAR_FNV1A_HPP
+
+#include "Compiler.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+static constexpr uint64_t FNV1A_INIT = 0xcbf29ce484222325ull;
+
+/**
+ * Update a 64 bit FNV-1a hash.
+ */
+gcc_pure
+static inline uint64_t
+UpdateFNV1a(uint64_t hash, const void *_data, size_t size)
+{
+  const uint8_t *data = (const uint8_t *)_data;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 0x100000001b3ull;
+  }
+
+  return hash;
+}
+
+#endif
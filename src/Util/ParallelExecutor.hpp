@@ -0,0 +1,63 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_PARALLEL_EXECUTOR_HPP
+#define XCSOAR_PARALLEL_EXECUTOR_HPP
+
+#include <functional>
+
+/**
+ * An interface for running a number of independent jobs
+ * concurrently.  Libraries which shall not depend on the threading
+ * library (e.g. the task engine) accept a pointer to it, and run the
+ * jobs sequentially if there is none.
+ */
+class ParallelExecutor {
+public:
+  typedef std::function<void(unsigned)> Function;
+
+  /**
+   * Invoke f(0) .. f(n-1), possibly concurrently, and return after
+   * all of them have finished.  The calling thread may run some of
+   * the jobs itself.  If a job throws, the exception is rethrown
+   * after all jobs have finished.
+   */
+  virtual void ForEach(unsigned n, const Function &f) = 0;
+};
+
+/**
+ * Run the jobs on the given #ParallelExecutor, or sequentially in the
+ * calling thread if it is nullptr.
+ */
+static inline void
+ParallelForEach(ParallelExecutor *executor, unsigned n,
+                const ParallelExecutor::Function &f)
+{
+  if (executor != nullptr && n > 1)
+    executor->ForEach(n, f);
+  else
+    for (unsigned i = 0; i < n; ++i)
+      f(i);
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "WaypointCache.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "IO/BinaryCache.hpp"
+#include "OS/FileMapping.hpp"
+
+#include <algorithm>
+#include <vector>
+
+static constexpr const TCHAR *waypoint_cache_name = _T("waypoints");
+
+/**
+ * Increment this when the record layout changes.
+ */
+static constexpr uint32_t WAYPOINT_CACHE_VERSION = 1;
+
+static void
+WriteStringList(BinaryCacheWriter &writer,
+                const std::forward_list<tstring> &list)
+{
+  writer.WriteT(uint32_t(std::distance(list.begin(), list.end())));
+  for (const auto &i : list)
+    writer.WriteString(i);
+}
+
+static bool
+ReadStringList(BinaryCacheReader &reader, std::forward_list<tstring> &list)
+{
+  uint32_t n;
+  if (!reader.ReadT(n))
+    return false;
+
+  auto i = list.before_begin();
+  for (uint32_t j = 0; j < n; ++j) {
+    tstring s;
+    if (!reader.ReadString(s))
+      return false;
+
+    i = list.emplace_after(i, std::move(s));
+  }
+
+  return true;
+}
+
+static void
+WriteCachedWaypoint(BinaryCacheWriter &writer, const Waypoint &wp)
+{
+  writer.WriteT(wp.location);
+  writer.WriteT(wp.elevation);
+  writer.WriteT(wp.original_id);
+  writer.WriteT(wp.runway);
+  writer.WriteT(wp.radio_frequency);
+  writer.WriteT(wp.type);
+  writer.WriteT(wp.flags);
+  writer.WriteT(wp.origin);
+  writer.WriteString(wp.name);
+  writer.WriteString(wp.comment);
+  writer.WriteString(wp.details);
+  WriteStringList(writer, wp.files_embed);
+#ifdef HAVE_RUN_FILE
+  WriteStringList(writer, wp.files_external);
+#else
+  writer.WriteT(uint32_t(0));
+#endif
+}
+
+static bool
+ReadCachedWaypoint(BinaryCacheReader &reader, Waypoint &wp)
+{
+  if (!reader.ReadT(wp.location) || !reader.ReadT(wp.elevation) ||
+      !reader.ReadT(wp.original_id) || !reader.ReadT(wp.runway) ||
+      !reader.ReadT(wp.radio_frequency) || !reader.ReadT(wp.type) ||
+      !reader.ReadT(wp.flags) || !reader.ReadT(wp.origin) ||
+      !reader.ReadString(wp.name) || !reader.ReadString(wp.comment) ||
+      !reader.ReadString(wp.details) ||
+      !ReadStringList(reader, wp.files_embed))
+    return false;
+
+#ifdef HAVE_RUN_FILE
+  return ReadStringList(reader, wp.files_external);
+#else
+  std::forward_list<tstring> files_external;
+  return ReadStringList(reader, files_external);
+#endif
+}
+
+bool
+SaveWaypointCache(FileCache &cache, uint64_t key,
+                  const Waypoints &waypoints, bool found)
+{
+  /* the ids are assigned by Waypoints::Append(), therefore the
+     waypoints must be saved in id order to be restored with the same
+     ids */
+  std::vector<const Waypoint *> list;
+  list.reserve(waypoints.size());
+  for (const auto &i : waypoints)
+    list.push_back(i.get());
+
+  std::sort(list.begin(), list.end(),
+            [](const Waypoint *a, const Waypoint *b){
+              return a->id < b->id;
+            });
+
+  BinaryCacheWriter writer;
+  writer.WriteT(uint8_t(found));
+  writer.WriteT(uint32_t(list.size()));
+
+  for (const auto *i : list)
+    WriteCachedWaypoint(writer, *i);
+
+  return SaveBinaryCache(cache, waypoint_cache_name,
+                         WAYPOINT_CACHE_VERSION, key, writer.GetData());
+}
+
+bool
+LoadWaypointCache(FileCache &cache, uint64_t key,
+                  Waypoints &waypoints, bool &found_r)
+{
+  ConstBuffer<void> payload;
+  const auto mapping = LoadBinaryCache(cache, waypoint_cache_name,
+                                       WAYPOINT_CACHE_VERSION, key,
+                                       payload);
+  if (!mapping)
+    return false;
+
+  BinaryCacheReader reader(payload);
+
+  uint8_t found;
+  uint32_t n;
+  if (!reader.ReadT(found) || !reader.ReadT(n))
+    return false;
+
+  /* decode everything before appending anything, so a corrupt file
+     leaves the database untouched */
+  std::vector<Waypoint> list;
+  list.reserve(std::min<size_t>(n, payload.size));
+
+  for (uint32_t i = 0; i < n; ++i) {
+    list.emplace_back();
+    if (!ReadCachedWaypoint(reader, list.back()))
+      return false;
+  }
+
+  for (auto &i : list)
+    waypoints.Append(std::move(i));
+
+  found_r = found != 0;
+  return true;
+}
@@ -0,0 +1,58 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_WAYPOINT_CACHE_HPP
+#define XCSOAR_WAYPOINT_CACHE_HPP
+
+#include <stdint.h>
+
+class Waypoints;
+class FileCache;
+
+/**
+ * Save all waypoints in a binary cache file, in the order of their
+ * ids.
+ *
+ * @param key identifies the waypoint files (see
+ * UpdateBinaryCacheKey())
+ * @param found the return value of WaypointGlue::LoadWaypoints(),
+ * to be restored by LoadWaypointCache()
+ */
+bool
+SaveWaypointCache(FileCache &cache, uint64_t key,
+                  const Waypoints &waypoints, bool found);
+
+/**
+ * Load the waypoints from the binary cache file, if its key matches.
+ * On success, the waypoints have been appended (with the same ids as
+ * when they were saved), but Waypoints::Optimise() has not been
+ * called yet.
+ *
+ * @return false if there is no valid cache (nothing has been
+ * appended then)
+ */
+bool
+LoadWaypointCache(FileCache &cache, uint64_t key,
+                  Waypoints &waypoints, bool &found_r);
+
+#endif
@@ -28,12 +28,16 @@ Copyright_License {
 #include "LogFile.hpp"
 #include "Waypoint/Waypoints.hpp"
 #include "WaypointReader.hpp"
+#include "WaypointCache.hpp"
 #include "Language/Language.hpp"
 #include "LocalPath.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/Path.hpp"
+#include "OS/FileUtil.hpp"
 #include "IO/MapFile.hpp"
 #include "IO/ZipArchive.hpp"
+#include "IO/BinaryCache.hpp"
+#include "Util/FNV1a.hpp"
 
 static bool
 LoadWaypointFile(Waypoints &waypoints, Path path,
@@ -82,40 +86,77 @@ LoadWaypointFile(Waypoints &waypoints, struct zzip_dir *dir, const char *path,
   return true;
 }
 
-bool
-WaypointGlue::LoadWaypoints(Waypoints &way_points,
-                            const RasterTerrain *terrain,
-                            OperationEnvironment &operation)
+/**
+ * Calculate the binary cache key for the configured waypoint files.
+ */
+gcc_pure
+static uint64_t
+CalculateWaypointCacheKey(const RasterTerrain *terrain)
 {
-  LogFormat("ReadWaypoints");
-  operation.SetText(_("Loading Waypoints..."));
+  uint64_t key = FNV1A_INIT;
+  key = UpdateBinaryCacheKey(key, LocalPath(_T("user.cup")));
+  key = UpdateBinaryCacheKey(key,
+                             Profile::GetPath(ProfileKeys::WaypointFile));
+  key = UpdateBinaryCacheKey(key,
+                             Profile::GetPath(ProfileKeys::AdditionalWaypointFile));
+  key = UpdateBinaryCacheKey(key,
+                             Profile::GetPath(ProfileKeys::WatchedWaypointFile));
+  key = UpdateBinaryCacheKey(key, Profile::GetPath(ProfileKeys::MapFile));
+
+  /* the terrain (from the map file) fills in missing elevations */
+  const uint8_t have_terrain = terrain != nullptr;
+  return UpdateFNV1a(key, &have_terrain, sizeof(have_terrain));
+}
 
+/**
+ * Load all configured waypoint files.
+ *
+ * @param complete set to false if a configured file failed to load
+ * @return true if at least one waypoint file was loaded
+ */
+static bool
+ParseWaypoints(Waypoints &way_points, const RasterTerrain *terrain,
+               bool &complete, OperationEnvironment &operation)
+{
   bool found = false;
+  complete = true;
 
-  // Delete old waypoints
-  way_points.Clear();
-
-  LoadWaypointFile(way_points, LocalPath(_T("user.cup")),
-                   WaypointFileType::SEEYOU,
-                   WaypointOrigin::USER, terrain, operation);
+  const auto user_path = LocalPath(_T("user.cup"));
+  if (File::Exists(user_path) &&
+      !LoadWaypointFile(way_points, user_path,
+                        WaypointFileType::SEEYOU,
+                        WaypointOrigin::USER, terrain, operation))
+    complete = false;
 
   // ### FIRST FILE ###
   auto path = Profile::GetPath(ProfileKeys::WaypointFile);
-  if (!path.IsNull())
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::PRIMARY,
-                              terrain, operation);
+  if (!path.IsNull()) {
+    if (LoadWaypointFile(way_points, path, WaypointOrigin::PRIMARY,
+                         terrain, operation))
+      found = true;
+    else
+      complete = false;
+  }
 
   // ### SECOND FILE ###
   path = Profile::GetPath(ProfileKeys::AdditionalWaypointFile);
-  if (!path.IsNull())
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::ADDITIONAL,
-                              terrain, operation);
+  if (!path.IsNull()) {
+    if (LoadWaypointFile(way_points, path, WaypointOrigin::ADDITIONAL,
+                         terrain, operation))
+      found = true;
+    else
+      complete = false;
+  }
 
   // ### WATCHED WAYPOINT/THIRD FILE ###
   path = Profile::GetPath(ProfileKeys::WatchedWaypointFile);
-  if (!path.IsNull())
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::WATCHED,
-                              terrain, operation);
+  if (!path.IsNull()) {
+    if (LoadWaypointFile(way_points, path, WaypointOrigin::WATCHED,
+                         terrain, operation))
+      found = true;
+    else
+      complete = false;
+  }
 
   // ### MAP/FOURTH FILE ###
 
@@ -123,16 +164,62 @@ WaypointGlue::LoadWaypoints(Waypoints &way_points,
   if (!found) {
     auto archive = OpenMapFile();
     if (archive) {
-      found |= LoadWaypointFile(way_points, archive->get(), "waypoints.xcw",
-                                WaypointFileType::WINPILOT,
-                                WaypointOrigin::MAP,
-                                terrain, operation);
-
-      found |= LoadWaypointFile(way_points, archive->get(), "waypoints.cup",
-                                WaypointFileType::SEEYOU,
-                                WaypointOrigin::MAP,
-                                terrain, operation);
-    }
+      if (archive->Exists("waypoints.xcw")) {
+        if (LoadWaypointFile(way_points, archive->get(), "waypoints.xcw",
+                             WaypointFileType::WINPILOT,
+                             WaypointOrigin::MAP,
+                             terrain, operation))
+          found = true;
+        else
+          complete = false;
+      }
+
+      if (archive->Exists("waypoints.cup")) {
+        if (LoadWaypointFile(way_points, archive->get(), "waypoints.cup",
+                             WaypointFileType::SEEYOU,
+                             WaypointOrigin::MAP,
+                             terrain, operation))
+          found = true;
+        else
+          complete = false;
+      }
+    } else if (!Profile::GetPath(ProfileKeys::MapFile).IsNull())
+      /* the map file is configured, but could not be opened */
+      complete = false;
+  }
+
+  return found;
+}
+
+bool
+WaypointGlue::LoadWaypoints(Waypoints &way_points,
+                            const RasterTerrain *terrain,
+                            FileCache *cache,
+                            OperationEnvironment &operation)
+{
+  LogFormat("ReadWaypoints");
+  operation.SetText(_("Loading Waypoints..."));
+
+  // Delete old waypoints
+  way_points.Clear();
+
+  const uint64_t cache_key = cache != nullptr
+    ? CalculateWaypointCacheKey(terrain)
+    : 0;
+
+  bool found;
+  if (cache != nullptr &&
+      LoadWaypointCache(*cache, cache_key, way_points, found)) {
+    LogFormat("Loaded %u waypoints from cache", way_points.size());
+  } else {
+    bool complete;
+    found = ParseWaypoints(way_points, terrain, complete, operation);
+
+    /* don't cache the result if a source failed, or the next start
+       would not retry it */
+    if (complete && cache != nullptr &&
+        !SaveWaypointCache(*cache, cache_key, way_points, found))
+      LogFormat("Failed to save the waypoint cache");
   }
 
   // Optimise the waypoint list after attaching new waypoints
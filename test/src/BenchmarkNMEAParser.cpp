@@ -0,0 +1,229 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Measure the throughput of the NMEA input path: checksum
+ * verification, tokenizing with #NMEAInputLine, and the complete
+ * parser (the driver's ParseNMEA() with #NMEAParser as fallback, as
+ * in RunDeviceDriver).  The NMEA files are loaded into memory and
+ * replayed until at least #MIN_LINES lines have been parsed.
+ */
+
+#include "NMEA/Info.hpp"
+#include "NMEA/Checksum.hpp"
+#include "NMEA/InputLine.hpp"
+#include "Device/Port/NullPort.hpp"
+#include "Device/Driver.hpp"
+#include "Device/Register.hpp"
+#include "Device/Parser.hpp"
+#include "Device/Config.hpp"
+#include "OS/Args.hpp"
+#include "Util/StringUtil.hpp"
+#include "Util/PrintException.hxx"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static constexpr unsigned MIN_LINES = 200000;
+
+/**
+ * The number of rounds; the fastest one is reported, which filters
+ * out interference from other processes.
+ */
+static constexpr unsigned ROUNDS = 10;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Invoke the function #ROUNDS times and return the duration of the
+ * fastest call in microseconds.
+ */
+template<typename F>
+static double
+MeasureRound(F &&f)
+{
+  double best = -1;
+  for (unsigned r = 0; r < ROUNDS; ++r) {
+    const auto start = Clock::now();
+    f();
+    const std::chrono::duration<double, std::micro> d = Clock::now() - start;
+    if (best < 0 || d.count() < best)
+      best = d.count();
+  }
+
+  return best;
+}
+
+/**
+ * The byte-by-byte checksum verification which was used before
+ * XorBytes(); for comparison.
+ */
+gcc_pure
+static bool
+ScalarVerifyNMEAChecksum(const char *p)
+{
+  const char *asterisk = strrchr(p, '*');
+  if (asterisk == nullptr)
+    return false;
+
+  const char *checksum_string = asterisk + 1;
+  char *endptr;
+  unsigned long read_checksum = strtoul(checksum_string, &endptr, 16);
+  if (endptr == checksum_string || *endptr != 0 || read_checksum >= 0x100)
+    return false;
+
+  if (*p == '$' || *p == '!')
+    ++p;
+
+  uint8_t checksum = 0;
+  while (p < asterisk)
+    checksum ^= *p++;
+
+  return checksum == read_checksum;
+}
+
+static void
+LoadFile(const char *path, std::vector<std::string> &lines)
+{
+  FILE *file = fopen(path, "r");
+  if (file == nullptr)
+    throw std::runtime_error(std::string("Failed to open ") + path);
+
+  char buffer[1024];
+  while (fgets(buffer, sizeof(buffer), file) != nullptr) {
+    StripRight(buffer);
+    if (*buffer != 0)
+      lines.emplace_back(buffer);
+  }
+
+  fclose(file);
+}
+
+static void
+Report(const char *name, double us, unsigned n_lines, size_t n_bytes)
+{
+  printf("%-24s %8.1f ns/line %8.1f MB/s\n", name,
+         us * 1000. / n_lines, n_bytes / us);
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "DRIVER FILE.nmea ...");
+  tstring driver_name = args.ExpectNextT();
+
+  const DeviceRegister *driver = FindDriverByName(driver_name.c_str());
+  if (driver == nullptr) {
+    _ftprintf(stderr, _T("No such driver: %s\n"), driver_name.c_str());
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::string> file_lines;
+  do {
+    LoadFile(args.ExpectNext(), file_lines);
+  } while (!args.IsEmpty());
+
+  if (file_lines.empty()) {
+    fprintf(stderr, "No NMEA lines\n");
+    return EXIT_FAILURE;
+  }
+
+  /* replay the files until there is enough input to measure */
+  std::vector<const char *> lines;
+  size_t n_bytes = 0;
+  while (lines.size() < MIN_LINES) {
+    for (const auto &i : file_lines) {
+      lines.push_back(i.c_str());
+      n_bytes += i.length();
+    }
+  }
+
+  const unsigned n_lines = lines.size();
+  printf("%u lines, %zu bytes\n", n_lines, n_bytes);
+
+  unsigned valid = 0;
+  Report("checksum (scalar)", MeasureRound([&](){
+        valid = 0;
+        for (const char *line : lines)
+          valid += ScalarVerifyNMEAChecksum(line);
+      }), n_lines, n_bytes);
+
+  unsigned valid2 = 0;
+  Report("checksum", MeasureRound([&](){
+        valid2 = 0;
+        for (const char *line : lines)
+          valid2 += VerifyNMEAChecksum(line);
+      }), n_lines, n_bytes);
+
+  if (valid != valid2) {
+    fprintf(stderr, "Checksum mismatch: %u != %u\n", valid, valid2);
+    return EXIT_FAILURE;
+  }
+
+  size_t n_columns = 0;
+  Report("tokenize", MeasureRound([&](){
+        n_columns = 0;
+        for (const char *line : lines) {
+          NMEAInputLine input(line);
+          while (!input.IsEmpty()) {
+            input.Skip();
+            ++n_columns;
+          }
+        }
+      }), n_lines, n_bytes);
+
+  DeviceConfig config;
+  config.Clear();
+
+  NullPort port;
+  Device *device = driver->CreateOnPort != nullptr
+    ? driver->CreateOnPort(config, port)
+    : nullptr;
+
+  NMEAParser parser;
+
+  unsigned parsed = 0;
+  Report("parse", MeasureRound([&](){
+        NMEAInfo data;
+        data.Reset();
+        data.clock = 1;
+
+        parsed = 0;
+        for (const char *line : lines)
+          parsed += (device != nullptr && device->ParseNMEA(line, data)) ||
+            parser.ParseLine(line, data);
+      }), n_lines, n_bytes);
+
+  printf("%u valid checksums, %zu columns, %u lines parsed\n",
+         valid, n_columns, parsed);
+
+  delete device;
+  return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
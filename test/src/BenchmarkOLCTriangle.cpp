@@ -0,0 +1,128 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Replays IGC files into an OLC FAI triangle solver the way
+ * ContestComputer does it in flight: one non-exhaustive Solve() call
+ * per appended fix.  The incremental solver is compared with one
+ * which rebuilds its branch and bound tree after each update.
+ */
+
+#include "Engine/Trace/Trace.hpp"
+#include "Contest/Solvers/OLCFAI.hpp"
+#include "OS/Args.hpp"
+#include "DebugReplay.hpp"
+
+#include <chrono>
+
+#include <stdio.h>
+
+struct SolverStats {
+  const char *const name;
+
+  OLCFAI solver;
+
+  std::chrono::steady_clock::duration total{}, max{};
+
+  SolverStats(const char *_name, const Trace &trace, bool incremental)
+    :name(_name), solver(trace, true) {
+    solver.SetIncremental(incremental);
+    solver.Reset();
+  }
+
+  void Solve() {
+    const auto start = std::chrono::steady_clock::now();
+    solver.Solve(false);
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    total += duration;
+    if (duration > max)
+      max = duration;
+  }
+
+  void Print(unsigned n_fixes) const {
+    using std::chrono::duration;
+
+    printf("  %-12s %8.3f s  %8.1f us/fix  max %7.2f ms  %7.2f km\n",
+           name,
+           duration<double>(total).count(),
+           duration<double, std::micro>(total).count() / n_fixes,
+           duration<double, std::milli>(max).count(),
+           solver.GetBestResult().distance / 1000.);
+  }
+};
+
+static void
+BenchmarkFile(const char *name, DebugReplay &replay)
+{
+  Trace trace(0, Trace::null_time, 1024);
+
+  SolverStats incremental("incremental", trace, true);
+  SolverStats rebuild("rebuild", trace, false);
+
+  bool released = false;
+  unsigned n_fixes = 0;
+
+  while (replay.Next()) {
+    const MoreData &basic = replay.Basic();
+    if (!basic.time_available || !basic.location_available ||
+        !basic.NavAltitudeAvailable())
+      continue;
+
+    if (!released && replay.Calculated().flight.release_time >= 0) {
+      released = true;
+      trace.EraseEarlierThan(replay.Calculated().flight.release_time);
+    }
+
+    trace.push_back(TracePoint(basic));
+    ++n_fixes;
+
+    incremental.Solve();
+    rebuild.Solve();
+  }
+
+  printf("%s: %u fixes\n", name, n_fixes);
+  if (n_fixes == 0)
+    return;
+
+  incremental.Print(n_fixes);
+  rebuild.Print(n_fixes);
+}
+
+int
+main(int argc, char **argv)
+{
+  Args args(argc, argv, "FILE.igc ...");
+
+  do {
+    const char *name = args.PeekNext();
+    DebugReplay *replay = CreateDebugReplay(args);
+    if (replay == nullptr)
+      return EXIT_FAILURE;
+
+    BenchmarkFile(name, *replay);
+    delete replay;
+  } while (!args.IsEmpty());
+
+  return EXIT_SUCCESS;
+}
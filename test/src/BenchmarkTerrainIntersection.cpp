@@ -0,0 +1,220 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Measure the speed of RasterMap::Intersection(),
+ * RasterMap::FirstIntersection() and RasterMap::ScanLine() on rays
+ * in all directions from the centre of a terrain file.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/Loader.hpp"
+#include "Geo/GeoVector.hpp"
+#include "OS/Args.hpp"
+#include "IO/ZipArchive.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+
+#include <chrono>
+
+#include <stdio.h>
+#include <limits.h>
+
+static constexpr unsigned N_DIRECTIONS = 64;
+
+/**
+ * The number of rounds over all directions.  The fastest round is
+ * reported, which filters out interference from other processes.
+ */
+static constexpr unsigned ROUNDS = 100;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Invoke the function #ROUNDS times and return the duration of the
+ * fastest call in nanoseconds per ray.
+ */
+template<typename F>
+static double
+MeasureRound(F &&f)
+{
+  double best = -1;
+  for (unsigned r = 0; r < ROUNDS; ++r) {
+    const auto start = Clock::now();
+    f();
+    const std::chrono::duration<double, std::nano> d = Clock::now() - start;
+    if (best < 0 || d.count() < best)
+      best = d.count();
+  }
+
+  return best / N_DIRECTIONS;
+}
+
+static void
+MakeDestinations(const GeoPoint origin, double distance,
+                 GeoPoint *destinations)
+{
+  for (unsigned i = 0; i < N_DIRECTIONS; ++i)
+    destinations[i] =
+      GeoVector(distance, Angle::FullCircle() * i / N_DIRECTIONS)
+      .EndPoint(origin);
+}
+
+static void
+BenchmarkIntersection(const RasterMap &map, double distance)
+{
+  const GeoPoint origin = map.GetMapCenter();
+  const int altitude = map.GetHeight(origin).GetValueOr0() + 300;
+
+  GeoPoint destinations[N_DIRECTIONS];
+  MakeDestinations(origin, distance, destinations);
+
+  /* the glide from "altitude" reaches MSL at the destination */
+  unsigned found;
+  double checksum;
+  const double ns = MeasureRound([&](){
+      found = 0;
+      checksum = 0;
+      for (const auto &destination : destinations) {
+        const GeoPoint p = map.Intersection(origin, altitude, altitude,
+                                            destination, 0);
+        if (p.IsValid()) {
+          ++found;
+          checksum += p.longitude.Degrees() + p.latitude.Degrees();
+        }
+      }
+    });
+
+  printf("Intersection %5.0f km: %8.0f ns/ray, %u hits, checksum %.6f\n",
+         distance / 1000, ns, found, checksum);
+}
+
+/**
+ * @param margin the height of origin and destinations above the
+ * terrain; below the safety height of 150 m, the glide path
+ * intersects right at the origin
+ */
+static void
+BenchmarkFirstIntersection(const RasterMap &map, double distance,
+                           int margin)
+{
+  const GeoPoint origin = map.GetMapCenter();
+  const int h_origin = map.GetHeight(origin).GetValueOr0() + margin;
+
+  GeoPoint destinations[N_DIRECTIONS];
+  MakeDestinations(origin, distance, destinations);
+
+  int h_destinations[N_DIRECTIONS];
+  for (unsigned i = 0; i < N_DIRECTIONS; ++i)
+    h_destinations[i] = map.GetHeight(destinations[i]).GetValueOr0() + margin;
+
+  /* glide ratio 40 */
+  const int h_virt = distance / 40;
+
+  unsigned found;
+  double checksum;
+  const double ns = MeasureRound([&](){
+      found = 0;
+      checksum = 0;
+      for (unsigned i = 0; i < N_DIRECTIONS; ++i) {
+        GeoPoint p = GeoPoint::Invalid();
+        int h = 0;
+        if (map.FirstIntersection(origin, h_origin,
+                                  destinations[i], h_destinations[i],
+                                  h_virt, INT_MAX, 150, p, h)) {
+          ++found;
+          checksum += p.longitude.Degrees() + p.latitude.Degrees() + h;
+        }
+      }
+    });
+
+  printf("FirstIntersection %5.0f km %3d m: %8.0f ns/ray, %u hits, checksum %.6f\n",
+         distance / 1000, margin, ns, found, checksum);
+}
+
+static void
+BenchmarkScanLine(const RasterMap &map, double distance, bool interpolate)
+{
+  const GeoPoint origin = map.GetMapCenter();
+
+  GeoPoint destinations[N_DIRECTIONS];
+  MakeDestinations(origin, distance, destinations);
+
+  /* like the cross section renderer */
+  constexpr unsigned SIZE = 512;
+  TerrainHeight buffer[SIZE];
+
+  long checksum;
+  const double ns = MeasureRound([&](){
+      checksum = 0;
+      for (const auto &destination : destinations) {
+        map.ScanLine(origin, destination, buffer, SIZE, interpolate);
+        for (const auto &h : buffer)
+          checksum += h.GetValueOr0();
+      }
+    });
+
+  printf("ScanLine%s %5.0f km: %8.0f ns/ray, checksum %ld\n",
+         interpolate ? " (interpolated)" : "",
+         distance / 1000, ns, checksum);
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH");
+  const auto map_path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  RasterMap map;
+
+  NullOperationEnvironment operation;
+  if (!LoadTerrainOverview(archive.get(), map.GetTileCache(),
+                           operation)) {
+    fprintf(stderr, "failed to load map\n");
+    return EXIT_FAILURE;
+  }
+
+  map.UpdateProjection();
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), 100000);
+  } while (map.IsDirty());
+
+  for (double distance : {5000., 20000., 50000.}) {
+    BenchmarkIntersection(map, distance);
+    BenchmarkFirstIntersection(map, distance, 100);
+    BenchmarkFirstIntersection(map, distance, 400);
+    BenchmarkScanLine(map, distance, false);
+    BenchmarkScanLine(map, distance, true);
+  }
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,318 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Measure how long it takes to build the spatial indexes of
+ * #Waypoints, and the speed of range and nearest-landable queries on
+ * them: the #QuadTree which is modified incrementally, and the
+ * bulk-loaded #WaypointIndex.  Without a waypoint file, a synthetic
+ * set of clustered waypoints is generated.
+ */
+
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "Engine/Waypoint/WaypointIndex.hpp"
+#include "Engine/Waypoint/WaypointVisitor.hpp"
+#include "Util/QuadTree.hpp"
+#include "Geo/Flat/TaskProjection.hpp"
+#include "OS/Args.hpp"
+#include "OS/Path.hpp"
+#include "Operation/Operation.hpp"
+#include "Util/PrintException.hxx"
+
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * The number of synthetic waypoints; about the size of a worldwide
+ * waypoint file.
+ */
+static constexpr unsigned N_SYNTHETIC = 60000;
+
+static constexpr unsigned N_QUERIES = 1000;
+
+/**
+ * The number of rounds; the fastest one is reported, which filters
+ * out interference from other processes.
+ */
+static constexpr unsigned ROUNDS = 10;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * Invoke the function #ROUNDS times and return the duration of the
+ * fastest call in microseconds.
+ */
+template<typename F>
+static double
+MeasureRound(F &&f)
+{
+  double best = -1;
+  for (unsigned r = 0; r < ROUNDS; ++r) {
+    const auto start = Clock::now();
+    f();
+    const std::chrono::duration<double, std::micro> d = Clock::now() - start;
+    if (best < 0 || d.count() < best)
+      best = d.count();
+  }
+
+  return best;
+}
+
+static double
+RandomDouble(double min, double max)
+{
+  return min + (max - min) * rand() / RAND_MAX;
+}
+
+static void
+GenerateWaypoints(Waypoints &waypoints, unsigned n)
+{
+  /* most waypoints are clustered around a few hundred "regions"
+     within an area of the size of Europe */
+  std::vector<GeoPoint> centers;
+  for (unsigned i = 0; i < 300; ++i)
+    centers.emplace_back(Angle::Degrees(RandomDouble(-5, 25)),
+                         Angle::Degrees(RandomDouble(40, 55)));
+
+  for (unsigned i = 0; i < n; ++i) {
+    const GeoPoint &center = centers[rand() % centers.size()];
+    const double spread = i % 10 == 0 ? 10 : 1;
+    Waypoint wp(GeoPoint(center.longitude +
+                         Angle::Degrees(RandomDouble(-spread, spread)),
+                         center.latitude +
+                         Angle::Degrees(RandomDouble(-spread, spread) / 2)));
+    wp.name = _T("X");
+    wp.type = i % 5 == 0
+      ? Waypoint::Type::AIRFIELD
+      : (i % 5 == 1 ? Waypoint::Type::OUTLANDING : Waypoint::Type::NORMAL);
+    waypoints.Append(std::move(wp));
+  }
+}
+
+static void
+LoadWaypoints(Path path, Waypoints &waypoints)
+{
+  NullOperationEnvironment operation;
+  if (!ReadWaypointFile(path, waypoints,
+                        WaypointFactory(WaypointOrigin::NONE),
+                        operation))
+    throw std::runtime_error("ReadWaypointFile() failed");
+}
+
+struct WaypointAccessor {
+  int GetX(const WaypointPtr &wp) const {
+    return wp->flat_location.x;
+  }
+
+  int GetY(const WaypointPtr &wp) const {
+    return wp->flat_location.y;
+  }
+};
+
+typedef QuadTree<WaypointPtr, WaypointAccessor> WaypointTree;
+
+struct Query {
+  GeoPoint location;
+  FlatGeoPoint flat_location;
+  unsigned flat_range;
+};
+
+static std::vector<Query>
+MakeQueries(const std::vector<WaypointPtr> &list,
+            const TaskProjection &projection, double range)
+{
+  std::vector<Query> queries;
+  for (unsigned i = 0; i < N_QUERIES; ++i) {
+    /* near a random waypoint, like an aircraft flying over an area
+       with waypoints */
+    const GeoPoint &p = list[rand() % list.size()]->location;
+    Query q;
+    q.location = GeoPoint(p.longitude + Angle::Degrees(RandomDouble(-0.2, 0.2)),
+                          p.latitude + Angle::Degrees(RandomDouble(-0.1, 0.1)));
+    q.flat_location = projection.ProjectInteger(q.location);
+    q.flat_range = projection.ProjectRangeInteger(q.location, range);
+    queries.push_back(q);
+  }
+
+  return queries;
+}
+
+static void
+BenchmarkBuild(const std::vector<WaypointPtr> &list)
+{
+  const double tree_us = MeasureRound([&list](){
+      WaypointTree tree;
+      for (const auto &wp : list)
+        tree.insert(wp);
+      tree.Optimise();
+    });
+
+  const double index_us = MeasureRound([&list](){
+      WaypointIndex index;
+      index.Build(std::vector<WaypointPtr>(list));
+    });
+
+  printf("Build: QuadTree %8.0f us, WaypointIndex %8.0f us\n",
+         tree_us, index_us);
+}
+
+static void
+BenchmarkRange(const WaypointTree &tree, const WaypointIndex &index,
+               const std::vector<Query> &queries, double range)
+{
+  unsigned tree_count, index_count;
+
+  const double tree_us = MeasureRound([&](){
+      tree_count = 0;
+      auto visitor = [&tree_count](const WaypointPtr &){ ++tree_count; };
+      for (const auto &q : queries)
+        tree.VisitWithinRange(WaypointTree::Point(q.flat_location.x,
+                                                  q.flat_location.y),
+                              q.flat_range, visitor);
+    });
+
+  const double index_us = MeasureRound([&](){
+      index_count = 0;
+      for (const auto &q : queries)
+        index.VisitWithinRange(q.flat_location, q.flat_range,
+                               [&index_count](const WaypointPtr &){
+                                 ++index_count;
+                               });
+    });
+
+  printf("VisitWithinRange %5.0f km: QuadTree %8.2f us/query, "
+         "WaypointIndex %8.2f us/query, %u/%u hits\n",
+         range / 1000,
+         tree_us / queries.size(), index_us / queries.size(),
+         tree_count, index_count);
+}
+
+static bool
+IsLandable(const Waypoint &wp)
+{
+  return wp.IsLandable();
+}
+
+static void
+BenchmarkNearest(const WaypointTree &tree, const WaypointIndex &index,
+                 const std::vector<Query> &queries, double range)
+{
+  unsigned tree_count, index_count;
+
+  const double tree_us = MeasureRound([&](){
+      tree_count = 0;
+      for (const auto &q : queries) {
+        const auto found =
+          tree.FindNearestIf(WaypointTree::Point(q.flat_location.x,
+                                                 q.flat_location.y),
+                             q.flat_range,
+                             [](const WaypointPtr &wp){
+                               return IsLandable(*wp);
+                             });
+        if (found.first != tree.end())
+          ++tree_count;
+      }
+    });
+
+  const double index_us = MeasureRound([&](){
+      index_count = 0;
+      for (const auto &q : queries)
+        if (index.FindNearestIf(q.flat_location, q.flat_range, IsLandable))
+          ++index_count;
+    });
+
+  printf("GetNearestLandable %5.0f km: QuadTree %8.2f us/query, "
+         "WaypointIndex %8.2f us/query, %u/%u found\n",
+         range / 1000,
+         tree_us / queries.size(), index_us / queries.size(),
+         tree_count, index_count);
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[PATH]");
+  AllocatedPath path = nullptr;
+  if (!args.IsEmpty())
+    path = args.ExpectNextPath();
+  args.ExpectEnd();
+
+  Waypoints waypoints;
+
+  const auto load_start = Clock::now();
+  if (!path.IsNull())
+    LoadWaypoints(path, waypoints);
+  else
+    GenerateWaypoints(waypoints, N_SYNTHETIC);
+
+  const auto optimise_start = Clock::now();
+  waypoints.Optimise();
+  const auto end = Clock::now();
+
+  if (waypoints.IsEmpty()) {
+    fprintf(stderr, "No waypoints\n");
+    return EXIT_FAILURE;
+  }
+
+  printf("%u waypoints: load %.0f ms, Optimise() %.0f ms\n",
+         waypoints.size(),
+         std::chrono::duration<double, std::milli>(optimise_start - load_start).count(),
+         std::chrono::duration<double, std::milli>(end - optimise_start).count());
+
+  /* the same projection as the one used by class Waypoints */
+  const std::vector<WaypointPtr> list(waypoints.begin(), waypoints.end());
+  TaskProjection projection;
+  projection.Reset(list.front()->location);
+  for (const auto &wp : list)
+    projection.Scan(wp->location);
+  projection.Update();
+
+  BenchmarkBuild(list);
+
+  WaypointTree tree;
+  for (const auto &wp : list)
+    tree.insert(wp);
+  tree.Optimise();
+
+  WaypointIndex index;
+  index.Build(std::vector<WaypointPtr>(list));
+
+  for (double range : {5000., 20000., 100000.}) {
+    const auto queries = MakeQueries(list, projection, range);
+    BenchmarkRange(tree, index, queries, range);
+  }
+
+  for (double range : {20000., 100000.}) {
+    const auto queries = MakeQueries(list, projection, range);
+    BenchmarkNearest(tree, index, queries, range);
+  }
+
+  return EXIT_SUCCESS;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
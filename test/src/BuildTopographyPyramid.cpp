@@ -0,0 +1,108 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * This program converts the topography layers of a map file into
+ * ".lod" pyramids (see #TopographyPyramidFormat), which
+ * #TopographyFile prefers over the shapefiles.  The generated files
+ * must be added to the map without compression ("zip -0"), because
+ * only stored entries can be memory-mapped.
+ */
+
+#include "TopographyPyramidBuilder.hpp"
+#include "Topography/TopographyPyramid.hpp"
+#include "OS/Args.hpp"
+#include "IO/ZipArchive.hpp"
+#include "IO/ZipLineReader.hpp"
+#include "Util/PrintException.hxx"
+
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace TopographyPyramidFormat;
+
+/**
+ * The default number of levels; the deepest one has 128x128 tiles.
+ */
+static constexpr unsigned DEFAULT_LEVELS = 8;
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "MAP.xcm OUTDIR [LEVELS]");
+  const auto path = args.ExpectNextPath();
+  const char *output_dir = args.ExpectNext();
+  const unsigned n_levels = args.IsEmpty()
+    ? DEFAULT_LEVELS
+    : args.ExpectNextInt();
+  args.ExpectEnd();
+
+  if (n_levels == 0 || n_levels > MAX_LEVELS) {
+    fprintf(stderr, "LEVELS must be between 1 and %u\n", MAX_LEVELS);
+    return EXIT_FAILURE;
+  }
+
+  ZipArchive archive(path);
+  ZipLineReaderA reader(archive.get(), "topology.tpl");
+
+  bool success = true;
+  char *line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    // .tpl Line format: filename,range,icon,field,...
+    if (*line == '*' || *line == '\0')
+      continue;
+
+    char *p = strchr(line, ',');
+    if (p == nullptr || p == line)
+      continue;
+
+    const std::string name(line, p);
+
+    /* skip range and icon */
+    p = strchr(p + 1, ',');
+    if (p != nullptr)
+      p = strchr(p + 1, ',');
+
+    const int label_field = p != nullptr
+      ? int(strtol(p + 1, nullptr, 10)) - 1
+      : -1;
+
+    const std::string output_path =
+      std::string(output_dir) + "/" + name + ".lod";
+    if (BuildTopographyPyramid(archive.get(), name.c_str(), label_field,
+                               n_levels, output_path.c_str()))
+      printf("%s\n", output_path.c_str());
+    else
+      success = false;
+  }
+
+  if (success)
+    printf("Add the files to the map with \"zip -0\".\n");
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+} catch (const std::runtime_error &e) {
+  PrintException(e);
+  return EXIT_FAILURE;
+}
@@ -24,6 +24,7 @@
 #include "OS/FileUtil.hpp"
 #include "Contest/ContestManager.hpp"
 #include "Trace/Trace.hpp"
+#include "Trace/Vector.hpp"
 
 #include <fstream>
 
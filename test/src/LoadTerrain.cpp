@@ -23,7 +23,8 @@ Copyright_License {
 
 /*
  * This program loads the terrain from a map file and exits.  Useful
- * for valgrind and profiling.
+ * for valgrind and profiling.  The optional second argument is the
+ * number of tile decoder jobs.
  */
 
 #include "Terrain/RasterTileCache.hpp"
@@ -32,18 +33,26 @@ Copyright_License {
 #include "OS/ConvertPathName.hpp"
 #include "IO/ZipArchive.hpp"
 #include "Operation/Operation.hpp"
+#include "Thread/WorkerPool.hpp"
 #include "Util/PrintException.hxx"
 
+#include <chrono>
+#include <vector>
+
 #include <stdio.h>
 #include <string.h>
 #include <tchar.h>
 
 int main(int argc, char **argv)
 try {
-  Args args(argc, argv, "PATH");
+  Args args(argc, argv, "PATH [JOBS]");
   const auto map_path = args.ExpectNextPath();
+  const unsigned n_jobs = args.IsEmpty() ? 1 : args.ExpectNextInt();
   args.ExpectEnd();
 
+  if (n_jobs < 1)
+    args.UsageError();
+
   ZipArchive archive(map_path);
 
   NullOperationEnvironment operation;
@@ -60,12 +69,30 @@ try {
          (double)bounds.GetEast().Degrees(),
          (double)bounds.GetSouth().Degrees());
 
+  /* each job needs its own archive handle */
+  std::vector<ZipArchive> job_archives;
+  std::vector<struct zzip_dir *> dirs{archive.get()};
+  for (unsigned i = 1; i < n_jobs; ++i) {
+    job_archives.emplace_back(map_path);
+    dirs.push_back(job_archives.back().get());
+  }
+
+  WorkerPool worker_pool(n_jobs - 1);
+
+  const auto start = std::chrono::steady_clock::now();
+
   SharedMutex mutex;
+  const int x = rtc.GetWidth() / 2, y = rtc.GetHeight() / 2;
   do {
-    UpdateTerrainTiles(archive.get(), rtc, mutex,
-                       rtc.GetWidth() / 2, rtc.GetHeight() / 2, 1000);
+    UpdateTerrainTiles(&worker_pool, dirs.data(), dirs.size(),
+                       "terrain.jp2", rtc, mutex, x, y, x, y, 1000);
   } while (rtc.IsDirty());
 
+  const std::chrono::duration<double> duration =
+    std::chrono::steady_clock::now() - start;
+  printf("tiles loaded in %.3f s with %u jobs\n",
+         duration.count(), n_jobs);
+
   return EXIT_SUCCESS;
 } catch (const std::runtime_error &e) {
   PrintException(e);
@@ -26,21 +26,34 @@ Copyright_License {
 #include "OS/Args.hpp"
 #include "IO/FileLineReader.hpp"
 #include "Operation/Operation.hpp"
+#include "Thread/WorkerPool.hpp"
 #include "Util/PrintException.hxx"
 
+#include <chrono>
+
 #include <stdio.h>
 #include <tchar.h>
 
+typedef std::chrono::steady_clock Clock;
+
 int main(int argc, char **argv)
 try {
-  Args args(argc, argv, "PATH");
+  Args args(argc, argv, "PATH [THREADS]");
   const auto path = args.ExpectNextPath();
+  const unsigned n_threads = args.IsEmpty()
+    ? WorkerPool::GetDefaultThreads(8)
+    : args.ExpectNextInt();
   args.ExpectEnd();
 
   FileLineReader reader(path, Charset::AUTO);
+  const long file_size = reader.GetSize();
+
+  WorkerPool pool(n_threads);
 
   Airspaces airspaces;
-  AirspaceParser parser(airspaces);
+  AirspaceParser parser(airspaces, &pool);
+
+  const auto start = Clock::now();
 
   NullOperationEnvironment operation;
   if (!parser.Parse(reader, operation)) {
@@ -48,7 +61,21 @@ try {
     return 1;
   }
 
-  airspaces.Optimise();
+  const auto optimise_start = Clock::now();
+
+  airspaces.Optimise(&pool);
+
+  const auto end = Clock::now();
+
+  const std::chrono::duration<double> parse = optimise_start - start;
+  const std::chrono::duration<double> optimise = end - optimise_start;
+  const std::chrono::duration<double> total = end - start;
+
+  printf("%u airspaces, %u threads: parse %.1f ms, Optimise() %.1f ms, "
+         "%.1f MB/s\n",
+         airspaces.GetSize(), n_threads + 1,
+         parse.count() * 1000, optimise.count() * 1000,
+         file_size / total.count() / (1024 * 1024));
 
   printf("OK\n");
 
@@ -25,7 +25,7 @@ Copyright_License {
 #define ENABLE_DIALOG
 #define ENABLE_CMDLINE
 #define ENABLE_PROFILE
-#define USAGE "DRIVER FILE"
+#define USAGE "DRIVER FILE [TRACE.json]"
 
 #include "Main.hpp"
 #include "Screen/SingleWindow.hpp"
@@ -110,7 +110,7 @@ LoadFiles(Airspaces &airspace_database)
   terrain = RasterTerrain::OpenTerrain(NULL, operation);
 
   const AtmosphericPressure pressure = AtmosphericPressure::Standard();
-  ReadAirspace(airspace_database, terrain, pressure, operation);
+  ReadAirspace(airspace_database, terrain, pressure, nullptr, operation);
 }
 
 static void
@@ -138,12 +138,21 @@ LoadReplay(DebugReplay *replay, GlideComputer &glide_computer,
 
 static DebugReplay *replay;
 
+/**
+ * If set, the GlideComputer timings are written to this file in the
+ * Chrome trace format.
+ */
+static AllocatedPath trace_path = nullptr;
+
 static void
 ParseCommandLine(Args &args)
 {
   replay = CreateDebugReplay(args);
   if (replay == nullptr)
     exit(EXIT_FAILURE);
+
+  if (!args.IsEmpty())
+    trace_path = args.ExpectNextPath();
 }
 
 static void
@@ -190,6 +199,10 @@ Main()
   LoadReplay(replay, glide_computer, blackboard);
   delete replay;
 
+  glide_computer.GetProfiler().LogSummary();
+  if (!trace_path.IsNull())
+    glide_computer.GetProfiler().WriteChromeTrace(trace_path);
+
   SingleWindow main_window;
   main_window.Create(_T("RunAnalysis"),
                      {640, 480});
@@ -0,0 +1,223 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * A load generator for xcsoar-cloud-server.  It simulates many
+ * SkyLines tracking clients flying straight lines through a common
+ * area, each submitting fixes at a fixed rate and requesting traffic
+ * periodically.  Datagrams are sent from many source sockets, so a
+ * server using SO_REUSEPORT spreads them over all receiver threads.
+ *
+ * At the end, it reports the number of fixes per second that were
+ * submitted and the number of traffic records per second that came
+ * back; compare these while varying the server's thread count.
+ */
+
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Tracking/SkyLines/Assemble.hpp"
+#include "Tracking/SkyLines/Server.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "Geo/Math.hpp"
+#include "OS/Args.hpp"
+#include "OS/ByteOrder.hpp"
+#include "Util/NumberParser.hpp"
+
+#include <boost/asio/ip/udp.hpp>
+
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <memory>
+
+#include <stdio.h>
+
+static constexpr unsigned N_SOCKETS = 64;
+
+/**
+ * Send a traffic request every this many ticks.
+ */
+static constexpr unsigned TRAFFIC_REQUEST_INTERVAL = 60;
+
+struct SyntheticClient {
+  uint64_t key;
+  GeoPoint location;
+  Angle track;
+  double speed;
+  int altitude;
+
+  void Move(double dt) {
+    location = FindLatitudeLongitude(location, track, speed * dt);
+  }
+};
+
+struct Counters {
+  unsigned long fixes = 0, requests = 0;
+  unsigned long responses = 0, records = 0;
+};
+
+static void
+Receive(boost::asio::ip::udp::socket &socket, Counters &c)
+{
+  uint8_t buffer[4096];
+  boost::asio::ip::udp::endpoint sender;
+  boost::system::error_code ec;
+
+  while (true) {
+    const size_t length = socket.receive_from(boost::asio::buffer(buffer),
+                                              sender, 0, ec);
+    if (ec)
+      /* would block */
+      break;
+
+    const auto &header = *(const SkyLinesTracking::Header *)buffer;
+    const auto &traffic =
+      *(const SkyLinesTracking::TrafficResponsePacket *)buffer;
+    if (length >= sizeof(traffic) &&
+        FromBE16(header.type) == SkyLinesTracking::Type::TRAFFIC_RESPONSE) {
+      ++c.responses;
+      c.records += traffic.traffic_count;
+    }
+  }
+}
+
+int
+main(int argc, char **argv)
+try {
+  Args args(argc, argv, "HOST [CLIENTS] [SECONDS] [RATE_HZ]");
+  const char *host = args.ExpectNext();
+  const unsigned n_clients = args.IsEmpty()
+    ? 1000 : ParseUnsigned(args.ExpectNext());
+  const unsigned duration = args.IsEmpty()
+    ? 10 : ParseUnsigned(args.ExpectNext());
+  const unsigned rate = args.IsEmpty()
+    ? 1 : ParseUnsigned(args.ExpectNext());
+  args.ExpectEnd();
+
+  if (n_clients == 0 || duration == 0 || rate == 0)
+    args.UsageError();
+
+  boost::asio::io_service io_service;
+
+  boost::asio::ip::udp::resolver resolver(io_service);
+  const boost::asio::ip::udp::resolver::query query(boost::asio::ip::udp::v4(),
+                                                    host,
+                                                    SkyLinesTracking::Server::GetDefaultPortString());
+  const auto endpoint = *resolver.resolve(query);
+
+  std::vector<std::unique_ptr<boost::asio::ip::udp::socket>> sockets;
+  for (unsigned i = 0; i < N_SOCKETS; ++i) {
+    sockets.emplace_back(new boost::asio::ip::udp::socket(io_service,
+                                                          boost::asio::ip::udp::v4()));
+    sockets.back()->non_blocking(true);
+  }
+
+  /* deterministic pseudo-random clients spread over the Alps */
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<double> longitude(5, 16);
+  std::uniform_real_distribution<double> latitude(44, 48);
+  std::uniform_real_distribution<double> track(0, 360);
+  std::uniform_real_distribution<double> speed(20, 60);
+  std::uniform_int_distribution<int> altitude(500, 4000);
+
+  std::vector<SyntheticClient> clients;
+  clients.reserve(n_clients);
+  for (unsigned i = 0; i < n_clients; ++i)
+    clients.push_back({rng() | 1,
+          GeoPoint(Angle::Degrees(longitude(rng)),
+                   Angle::Degrees(latitude(rng))),
+          Angle::Degrees(track(rng)),
+          speed(rng),
+          altitude(rng)});
+
+  const auto tick = std::chrono::microseconds(1000000 / rate);
+  const double dt = 1. / rate;
+  const unsigned n_ticks = duration * rate;
+
+  Counters c;
+
+  const auto start = std::chrono::steady_clock::now();
+  auto next = start;
+
+  for (unsigned t = 0; t < n_ticks; ++t) {
+    const uint32_t time = t * 1000 / rate;
+
+    for (unsigned i = 0; i < n_clients; ++i) {
+      auto &client = clients[i];
+      auto &socket = *sockets[i % N_SOCKETS];
+
+      client.Move(dt);
+
+      const auto packet =
+        SkyLinesTracking::MakeFix(client.key,
+                                  SkyLinesTracking::FixPacket::FLAG_LOCATION |
+                                  SkyLinesTracking::FixPacket::FLAG_ALTITUDE,
+                                  time, client.location, client.track,
+                                  client.speed, client.speed,
+                                  client.altitude, 0, 0);
+      socket.send_to(boost::asio::buffer(&packet, sizeof(packet)),
+                     endpoint);
+      ++c.fixes;
+
+      /* the server ignores requests from clients it has not seen a
+         fix from, so this is sent after the fix */
+      if (t % TRAFFIC_REQUEST_INTERVAL == 0) {
+        const auto request =
+          SkyLinesTracking::MakeTrafficRequest(client.key, false, false, true);
+        socket.send_to(boost::asio::buffer(&request, sizeof(request)),
+                       endpoint);
+        ++c.requests;
+      }
+    }
+
+    for (auto &socket : sockets)
+      Receive(*socket, c);
+
+    next += tick;
+    const auto now = std::chrono::steady_clock::now();
+    if (now < next)
+      std::this_thread::sleep_until(next);
+    else if (t % rate == 0)
+      fprintf(stderr, "Warning: falling behind schedule\n");
+  }
+
+  /* collect late responses */
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  for (auto &socket : sockets)
+    Receive(*socket, c);
+
+  const double elapsed =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  printf("clients=%u seconds=%.1f\n", n_clients, elapsed);
+  printf("fixes=%lu (%.0f/s) traffic_requests=%lu\n",
+         c.fixes, c.fixes / elapsed, c.requests);
+  printf("traffic_responses=%lu (%.0f/s) traffic_records=%lu (%.0f/s)\n",
+         c.responses, c.responses / elapsed,
+         c.records, c.records / elapsed);
+
+  return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+  fprintf(stderr, "%s\n", e.what());
+  return EXIT_FAILURE;
+}
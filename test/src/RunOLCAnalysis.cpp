@@ -25,6 +25,7 @@
 #include "Printing.hpp"
 #include "OS/Args.hpp"
 #include "DebugReplay.hpp"
+#include "Thread/WorkerPool.hpp"
 
 #include <assert.h>
 #include <stdio.h>
@@ -42,28 +43,23 @@ static Trace triangle_trace(0, Trace::null_time, 1024);
 static Trace sprint_trace(0, 9000, 128);
 #endif
 
-static ContestManager olc_classic(Contest::OLC_CLASSIC,
-                                  full_trace, triangle_trace, sprint_trace);
-static ContestManager olc_fai(Contest::OLC_FAI,
-                              full_trace, triangle_trace, sprint_trace);
 static ContestManager olc_sprint(Contest::OLC_SPRINT,
                                  full_trace, triangle_trace, sprint_trace);
 static ContestManager olc_league(Contest::OLC_LEAGUE,
                                  full_trace, triangle_trace, sprint_trace);
-static ContestManager olc_plus(Contest::OLC_PLUS,
-                               full_trace, triangle_trace, sprint_trace);
-static ContestManager dmst(Contest::DMST,
-                           full_trace, triangle_trace, sprint_trace);
-static ContestManager xcontest(Contest::XCONTEST,
+
+/* all other contests are solved only after the flight, and they can
+   share one ContestManager in "score all" mode */
+static ContestManager contests(Contest::OLC_CLASSIC,
                                full_trace, triangle_trace, sprint_trace);
-static ContestManager sis_at(Contest::SIS_AT,
-                             full_trace, triangle_trace, sprint_trace);
-static ContestManager olc_netcoupe(Contest::NET_COUPE,
-                                   full_trace, triangle_trace, sprint_trace);
 
 static int
 TestOLC(DebugReplay &replay)
 {
+  WorkerPool worker_pool(WorkerPool::GetDefaultThreads(8));
+  contests.SetExecutor(&worker_pool);
+  contests.SetScoreAll(true);
+
   bool released = false;
 
   for (int i = 1; replay.Next(); i++) {
@@ -94,58 +90,55 @@ TestOLC(DebugReplay &replay)
     olc_league.UpdateIdle();
   }
 
-  olc_classic.SolveExhaustive();
-  olc_fai.SolveExhaustive();
   olc_league.SolveExhaustive();
-  olc_plus.SolveExhaustive();
-  dmst.SolveExhaustive();
-  xcontest.SolveExhaustive();
-  sis_at.SolveExhaustive();
-  olc_netcoupe.SolveExhaustive();
+  contests.SolveExhaustive();
 
   putchar('\n');
 
   std::cout << "classic\n";
-  PrintHelper::print(olc_classic.GetStats().GetResult());
+  PrintHelper::print(contests.GetStats(Contest::OLC_CLASSIC).GetResult());
   std::cout << "league\n";
   std::cout << "# league\n";
   PrintHelper::print(olc_league.GetStats().GetResult(0));
   std::cout << "# classic\n";
   PrintHelper::print(olc_league.GetStats().GetResult(1));
   std::cout << "fai\n";
-  PrintHelper::print(olc_fai.GetStats().GetResult());
+  PrintHelper::print(contests.GetStats(Contest::OLC_FAI).GetResult());
   std::cout << "sprint\n";
   PrintHelper::print(olc_sprint.GetStats().GetResult());
   std::cout << "plus\n";
   std::cout << "# classic\n";
-  PrintHelper::print(olc_plus.GetStats().GetResult(0));
+  PrintHelper::print(contests.GetStats(Contest::OLC_PLUS).GetResult(0));
   std::cout << "# triangle\n";
-  PrintHelper::print(olc_plus.GetStats().GetResult(1));
+  PrintHelper::print(contests.GetStats(Contest::OLC_PLUS).GetResult(1));
   std::cout << "# plus\n";
-  PrintHelper::print(olc_plus.GetStats().GetResult(2));
+  PrintHelper::print(contests.GetStats(Contest::OLC_PLUS).GetResult(2));
 
   std::cout << "dmst\n";
-  PrintHelper::print(dmst.GetStats().GetResult());
+  PrintHelper::print(contests.GetStats(Contest::DMST).GetResult());
 
   std::cout << "xcontest\n";
   std::cout << "# free\n";
-  PrintHelper::print(xcontest.GetStats().GetResult(0));
+  PrintHelper::print(contests.GetStats(Contest::XCONTEST).GetResult(0));
+  std::cout << "# triangle\n";
+  PrintHelper::print(contests.GetStats(Contest::XCONTEST).GetResult(1));
+
+  std::cout << "dhv-xc\n";
+  std::cout << "# free\n";
+  PrintHelper::print(contests.GetStats(Contest::DHV_XC).GetResult(0));
   std::cout << "# triangle\n";
-  PrintHelper::print(xcontest.GetStats().GetResult(1));
+  PrintHelper::print(contests.GetStats(Contest::DHV_XC).GetResult(1));
 
   std::cout << "sis_at\n";
-  PrintHelper::print(sis_at.GetStats().GetResult(0));
+  PrintHelper::print(contests.GetStats(Contest::SIS_AT).GetResult(0));
 
   std::cout << "netcoupe\n";
-  PrintHelper::print(olc_netcoupe.GetStats().GetResult());
+  PrintHelper::print(contests.GetStats(Contest::NET_COUPE).GetResult());
 
-  olc_classic.Reset();
-  olc_fai.Reset();
   olc_sprint.Reset();
   olc_league.Reset();
-  olc_plus.Reset();
-  dmst.Reset();
-  olc_netcoupe.Reset();
+  contests.Reset();
+  contests.SetExecutor(nullptr);
   full_trace.clear();
   sprint_trace.clear();
 
@@ -32,8 +32,14 @@ Copyright_License {
 #include "Util/PrintException.hxx"
 #include "IO/FileLineReader.hpp"
 #include "Operation/Operation.hpp"
+#include "Thread/WorkerPool.hpp"
 #include "TestUtil.hpp"
 
+#include <algorithm>
+#include <vector>
+
+#include <limits.h>
+#include <stdio.h>
 #include <tchar.h>
 
 struct AirspaceClassTestCouple
@@ -273,12 +279,170 @@ TestTNP()
   }
 }
 
+/**
+ * The properties of an airspace which must not depend on how the
+ * file was split into chunks.
+ */
+struct ParsedAirspace {
+  tstring name;
+  AirspaceClass type;
+  AltitudeReference base_reference, top_reference;
+  double base, top;
+  AbstractAirspace::Shape shape;
+  unsigned n_points;
+
+  explicit ParsedAirspace(const AbstractAirspace &airspace)
+    :name(airspace.GetName()), type(airspace.GetType()),
+     base_reference(airspace.GetBase().reference),
+     top_reference(airspace.GetTop().reference),
+     base(airspace.GetBase().altitude + airspace.GetBase().flight_level +
+          airspace.GetBase().altitude_above_terrain),
+     top(airspace.GetTop().altitude + airspace.GetTop().flight_level +
+         airspace.GetTop().altitude_above_terrain),
+     shape(airspace.GetShape()),
+     n_points(airspace.GetPoints().size()) {}
+
+  bool operator<(const ParsedAirspace &other) const {
+    return name < other.name;
+  }
+
+  bool operator==(const ParsedAirspace &other) const {
+    return name == other.name && type == other.type &&
+      base_reference == other.base_reference &&
+      top_reference == other.top_reference &&
+      base == other.base && top == other.top &&
+      shape == other.shape && n_points == other.n_points;
+  }
+};
+
+/**
+ * Parse a file into a list sorted by name.
+ *
+ * @return the return value of AirspaceParser::Parse()
+ */
+static bool
+ParseFile(Path path, std::vector<ParsedAirspace> &list,
+          ParallelExecutor *executor, unsigned chunk_size)
+{
+  Airspaces airspaces;
+  bool success;
+
+  {
+    FileLineReader reader(path, Charset::AUTO);
+    AirspaceParser parser(airspaces, executor, chunk_size);
+    NullOperationEnvironment operation;
+    success = parser.Parse(reader, operation);
+  }
+
+  airspaces.Optimise();
+
+  list.clear();
+  for (const auto &i : airspaces.QueryAll())
+    list.emplace_back(i.GetAirspace());
+
+  std::sort(list.begin(), list.end());
+  return success;
+}
+
+static const TCHAR *const generated_path =
+  _T("output/TestAirspaceParser.txt");
+
+/**
+ * Generate an OpenAir file with alternating polygons and circles.
+ *
+ * @param error_index if smaller than n, then the airspace with this
+ * index gets a malformed "DP" line
+ */
+static bool
+GenerateOpenAir(unsigned n, unsigned error_index)
+{
+  static const char *const classes[] = { "R", "Q", "P", "CTR", "C", "D" };
+
+  FILE *file = _tfopen(generated_path, _T("w"));
+  if (file == nullptr)
+    return false;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const unsigned lat = 10 + i % 40, lon = 5 + i % 50;
+
+    fprintf(file, "AC %s\n", classes[i % ARRAY_SIZE(classes)]);
+    fprintf(file, "AN Generated-%04u\n", i);
+    fprintf(file, "AL %u ft\n", 1000 + 10 * i);
+    fprintf(file, "AH FL%u\n", 100 + i % 100);
+
+    if (i % 2 == 0) {
+      fprintf(file, "V X=51:%02u:00 N 007:%02u:00 E\n", lat, lon);
+      fprintf(file, "DC %u\n", 1 + i % 5);
+    } else {
+      /* a different number of vertices for each airspace */
+      const unsigned n_points = 3 + i % 7;
+      for (unsigned j = 0; j < n_points; ++j) {
+        if (i == error_index && j == 1)
+          fprintf(file, "DP 51:%02u:00 X 007:%02u:00 E\n", lat, lon);
+
+        fprintf(file, "DP 51:%02u:%02u N 007:%02u:%02u E\n",
+                lat, j * 5, lon, (j * j) % 60);
+      }
+    }
+  }
+
+  return fclose(file) == 0;
+}
+
+/**
+ * Parse with each airspace in a chunk of its own, with the default chunk
+ * size and without splitting, and compare the results.
+ */
+static void
+TestChunks()
+{
+  WorkerPool pool(4);
+
+  std::vector<ParsedAirspace> unsplit, split, parallel;
+  const Path openair(_T("test/data/airspace/openair.txt"));
+  ok1(ParseFile(openair, unsplit, nullptr, UINT_MAX) &&
+      ParseFile(openair, split, nullptr, 1) &&
+      ParseFile(openair, parallel, &pool, 1));
+  ok1(unsplit.size() == 24);
+  ok(split == unsplit, "split openair.txt", 0);
+  ok(parallel == unsplit, "parallel openair.txt", 0);
+
+  /* more lines than the default chunk size */
+  static constexpr unsigned N = 1000;
+  const Path generated(generated_path);
+  ok1(GenerateOpenAir(N, N) &&
+      ParseFile(generated, unsplit, nullptr, UINT_MAX) &&
+      ParseFile(generated, parallel, &pool, 2048));
+  ok1(unsplit.size() == N);
+  ok(parallel == unsplit, "parallel generated", 0);
+
+  /* an error in a later chunk: the airspaces before the failing line
+     are kept, and nothing after it */
+  static constexpr unsigned ERROR_INDEX = 777;
+  ok1(GenerateOpenAir(N, ERROR_INDEX) &&
+      !ParseFile(generated, unsplit, nullptr, UINT_MAX) &&
+      !ParseFile(generated, split, nullptr, 16) &&
+      !ParseFile(generated, parallel, &pool, 16));
+
+  bool before_error = unsplit.size() == ERROR_INDEX;
+  for (unsigned i = 0; before_error && i < ERROR_INDEX; ++i) {
+    TCHAR name[32];
+    _stprintf(name, _T("Generated-%04u"), i);
+    if (unsplit[i].name != name)
+      before_error = false;
+  }
+
+  ok(before_error, "airspaces before the error", 0);
+  ok(split == unsplit && parallel == unsplit, "error in later chunk", 0);
+}
+
 int main(int argc, char **argv)
 try {
-  plan_tests(102);
+  plan_tests(112);
 
   TestOpenAir();
   TestTNP();
+  TestChunks();
 
   return exit_status();
 } catch (const std::runtime_error &e) {
@@ -0,0 +1,130 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Task/TaskManager.hpp"
+#include "Engine/Task/Unordered/AlternateList.hpp"
+#include "Engine/Task/Stats/CommonStats.hpp"
+#include "Engine/Waypoint/Waypoints.hpp"
+#include "Engine/GlideSolvers/GlidePolar.hpp"
+#include "Engine/Navigation/Aircraft.hpp"
+#include "Thread/WorkerPool.hpp"
+#include "TestUtil.hpp"
+
+/**
+ * Fill the database with a deterministic pseudo-random scatter of
+ * airfields and outlanding fields.
+ */
+static void
+SetupLandables(Waypoints &waypoints, unsigned n)
+{
+  unsigned seed = 42;
+  auto next = [&seed](unsigned range){
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) % range;
+  };
+
+  for (unsigned i = 0; i < n; ++i) {
+    Waypoint wp =
+      waypoints.Create(GeoPoint(Angle::Degrees(next(1600) / 1000.),
+                                Angle::Degrees(45 + next(1600) / 1000.)));
+    wp.type = next(3) == 0
+      ? Waypoint::Type::AIRFIELD
+      : Waypoint::Type::OUTLANDING;
+    wp.elevation = next(800);
+    waypoints.Append(std::move(wp));
+  }
+
+  waypoints.Optimise();
+}
+
+static bool
+Equals(const AlternateList &a, const AlternateList &b)
+{
+  if (a.size() != b.size())
+    return false;
+
+  for (unsigned i = 0; i < a.size(); ++i)
+    if (a[i].waypoint->id != b[i].waypoint->id ||
+        a[i].solution.altitude_difference != b[i].solution.altitude_difference)
+      return false;
+
+  return true;
+}
+
+/**
+ * Update a sequential and a concurrent #TaskManager with the same
+ * aircraft state, and verify that both choose the same alternates in
+ * the same order.
+ */
+static void
+TestAlternates(TaskManager &sequential, TaskManager &concurrent,
+               const GeoPoint &location, double altitude)
+{
+  AircraftState aircraft;
+  aircraft.Reset();
+  aircraft.location = location;
+  aircraft.altitude = altitude;
+  aircraft.flying = true;
+
+  sequential.Update(aircraft, aircraft);
+  concurrent.Update(aircraft, aircraft);
+
+  const AlternateList &expected = sequential.GetAlternates();
+  ok1(!expected.empty());
+  ok1(Equals(expected, concurrent.GetAlternates()));
+  ok1(sequential.GetCommonStats().landable_reachable ==
+      concurrent.GetCommonStats().landable_reachable);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(4 * 3);
+
+  TaskBehaviour task_behaviour;
+  task_behaviour.SetDefaults();
+
+  GlidePolar glide_polar(1);
+
+  Waypoints waypoints;
+  SetupLandables(waypoints, 400);
+
+  WorkerPool pool(3);
+
+  TaskManager sequential(task_behaviour, waypoints);
+  sequential.SetGlidePolar(glide_polar);
+
+  TaskManager concurrent(task_behaviour, waypoints);
+  concurrent.SetGlidePolar(glide_polar);
+  concurrent.SetExecutor(&pool);
+
+  TestAlternates(sequential, concurrent,
+                 GeoPoint(Angle::Degrees(0.8), Angle::Degrees(45.8)), 1500);
+  TestAlternates(sequential, concurrent,
+                 GeoPoint(Angle::Degrees(0.2), Angle::Degrees(45.3)), 900);
+  TestAlternates(sequential, concurrent,
+                 GeoPoint(Angle::Degrees(1.5), Angle::Degrees(46.5)), 3000);
+  TestAlternates(sequential, concurrent,
+                 GeoPoint(Angle::Degrees(-0.3), Angle::Degrees(44.8)), 600);
+
+  return exit_status();
+}
@@ -0,0 +1,352 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "IO/BinaryCache.hpp"
+#include "IO/FileCache.hpp"
+#include "Airspace/AirspaceCache.hpp"
+#include "Waypoint/WaypointCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "OS/FileMapping.hpp"
+#include "OS/FileUtil.hpp"
+#include "OS/Path.hpp"
+#include "Util/StringAPI.hxx"
+#include "TestUtil.hpp"
+
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <string.h>
+#include <tchar.h>
+
+static const TCHAR *const cache_name = _T("test");
+
+static std::string
+LoadFile(Path path)
+{
+  std::string result;
+
+  FILE *file = _tfopen(path.c_str(), _T("rb"));
+  if (file == nullptr)
+    return result;
+
+  char buffer[4096];
+  size_t nbytes;
+  while ((nbytes = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    result.append(buffer, nbytes);
+
+  fclose(file);
+  return result;
+}
+
+static bool
+SaveFile(Path path, const std::string &data)
+{
+  FILE *file = _tfopen(path.c_str(), _T("wb"));
+  if (file == nullptr)
+    return false;
+
+  bool success = fwrite(data.data(), 1, data.size(), file) == data.size();
+  return fclose(file) == 0 && success;
+}
+
+static bool
+SaveTestCache(FileCache &cache, const std::string &payload)
+{
+  return SaveBinaryCache(cache, cache_name, 1, 42,
+                         {payload.data(), payload.size()});
+}
+
+static bool
+LoadTestCache(FileCache &cache, uint32_t version, uint64_t key,
+              const std::string &expected)
+{
+  ConstBuffer<void> payload;
+  const auto mapping = LoadBinaryCache(cache, cache_name, version, key,
+                                       payload);
+  return mapping && payload.size == expected.size() &&
+    memcmp(payload.data, expected.data(), payload.size) == 0;
+}
+
+static void
+TestBinaryCache(FileCache &cache)
+{
+  const auto path = cache.MakeCachePath(cache_name);
+  const std::string payload = "The quick brown fox jumps over the lazy dog";
+
+  ok1(SaveTestCache(cache, payload));
+  ok(LoadTestCache(cache, 1, 42, payload), "round trip", 0);
+
+  ok(!LoadTestCache(cache, 1, 43, payload), "changed key", 0);
+  ok(!File::Exists(path), "obsolete file deleted", 0);
+
+  SaveTestCache(cache, payload);
+  ok(!LoadTestCache(cache, 2, 42, payload), "changed version", 0);
+
+  SaveTestCache(cache, payload);
+  std::string data = LoadFile(path);
+  data.pop_back();
+  ok(SaveFile(path, data) && !LoadTestCache(cache, 1, 42, payload),
+     "truncated", 0);
+
+  SaveTestCache(cache, payload);
+  data = LoadFile(path);
+  data[data.size() - payload.size() + 4] ^= 0x01;
+  ok(SaveFile(path, data) && !LoadTestCache(cache, 1, 42, payload),
+     "flipped payload byte", 0);
+
+  /* an empty payload is valid */
+  ok(SaveTestCache(cache, std::string()) &&
+     LoadTestCache(cache, 1, 42, std::string()), "empty payload", 0);
+
+  /* an unconfigured slot, a missing file and an existing file all
+     have different keys */
+  const uint64_t null_key = UpdateBinaryCacheKey(0, nullptr);
+  const uint64_t missing_key =
+    UpdateBinaryCacheKey(0, cache.MakeCachePath(_T("missing")));
+  const uint64_t existing_key = UpdateBinaryCacheKey(0, path);
+  ok(null_key != missing_key && null_key != existing_key &&
+     missing_key != existing_key, "key", 0);
+}
+
+static bool
+Equals(const AirspaceAltitude &a, const AirspaceAltitude &b)
+{
+  return a.altitude == b.altitude && a.flight_level == b.flight_level &&
+    a.altitude_above_terrain == b.altitude_above_terrain &&
+    a.reference == b.reference;
+}
+
+static bool
+Equals(const AbstractAirspace &a, const AbstractAirspace &b)
+{
+  if (a.GetShape() != b.GetShape() || a.GetType() != b.GetType() ||
+      !Equals(a.GetBase(), b.GetBase()) || !Equals(a.GetTop(), b.GetTop()) ||
+      !a.GetDays().equals(b.GetDays()) ||
+      !StringIsEqual(a.GetName(), b.GetName()) ||
+      a.GetRadioText() != b.GetRadioText())
+    return false;
+
+  switch (a.GetShape()) {
+  case AbstractAirspace::Shape::CIRCLE:
+    return a.GetReferenceLocation() == b.GetReferenceLocation() &&
+      ((const AirspaceCircle &)a).GetRadius() ==
+      ((const AirspaceCircle &)b).GetRadius();
+
+  case AbstractAirspace::Shape::POLYGON:
+    if (a.GetPoints().size() != b.GetPoints().size())
+      return false;
+
+    for (unsigned i = 0; i < a.GetPoints().size(); ++i)
+      if (a.GetPoints()[i].GetLocation() != b.GetPoints()[i].GetLocation())
+        return false;
+
+    return true;
+  }
+
+  return false;
+}
+
+gcc_pure
+static const AbstractAirspace *
+FindAirspace(const Airspaces &airspaces, const TCHAR *name)
+{
+  for (const auto &i : airspaces.QueryAll())
+    if (StringIsEqual(i.GetAirspace().GetName(), name))
+      return &i.GetAirspace();
+
+  return nullptr;
+}
+
+static void
+TestAirspaceCache(FileCache &cache)
+{
+  Airspaces airspaces;
+
+  AirspaceAltitude base, top;
+  base.reference = AltitudeReference::AGL;
+  base.altitude_above_terrain = 300;
+  top.reference = AltitudeReference::STD;
+  top.flight_level = 95;
+
+  AbstractAirspace *circle =
+    new AirspaceCircle(GeoPoint(Angle::Degrees(7.5), Angle::Degrees(51.2)),
+                       5000);
+  circle->SetProperties(_T("Circle"), CTR, base, top);
+  circle->SetRadio(_T("123.450"));
+  AirspaceActivity weekend;
+  weekend.SetWeekend();
+  circle->SetDays(weekend);
+  airspaces.Add(circle);
+
+  base = AirspaceAltitude();
+  base.reference = AltitudeReference::MSL;
+  base.altitude = 1500;
+  top = AirspaceAltitude();
+  top.reference = AltitudeReference::MSL;
+  top.altitude = 3000;
+
+  const std::vector<GeoPoint> points = {
+    GeoPoint(Angle::Degrees(7), Angle::Degrees(51)),
+    GeoPoint(Angle::Degrees(7.2), Angle::Degrees(51)),
+    GeoPoint(Angle::Degrees(7.2), Angle::Degrees(51.3)),
+    GeoPoint(Angle::Degrees(7), Angle::Degrees(51.1)),
+  };
+
+  AbstractAirspace *polygon = new AirspacePolygon(points);
+  polygon->SetProperties(_T("Polygon"), RESTRICT, base, top);
+  polygon->SetRadio(_T("Langen Radar"));
+  airspaces.Add(polygon);
+
+  airspaces.Optimise();
+
+  ok(SaveAirspaceCache(cache, 17, airspaces), "save airspaces", 0);
+
+  Airspaces loaded;
+  ok(!LoadAirspaceCache(cache, 18, loaded) && loaded.GetSize() == 0,
+     "airspaces with changed key", 0);
+
+  ok(SaveAirspaceCache(cache, 17, airspaces) &&
+     LoadAirspaceCache(cache, 17, loaded), "load airspaces", 0);
+  loaded.Optimise();
+  ok1(loaded.GetSize() == 2);
+
+  const AbstractAirspace *a = FindAirspace(loaded, _T("Circle"));
+  ok(a != nullptr && Equals(*a, *circle), "circle", 0);
+
+  a = FindAirspace(loaded, _T("Polygon"));
+  ok(a != nullptr && Equals(*a, *polygon), "polygon", 0);
+}
+
+static bool
+Equals(const std::forward_list<tstring> &a,
+       const std::forward_list<tstring> &b)
+{
+  auto i = a.begin(), j = b.begin();
+  for (; i != a.end() && j != b.end(); ++i, ++j)
+    if (*i != *j)
+      return false;
+
+  return i == a.end() && j == b.end();
+}
+
+static bool
+Equals(const Waypoint &a, const Waypoint &b)
+{
+  return a.id == b.id && a.original_id == b.original_id &&
+    a.location == b.location && a.elevation == b.elevation &&
+    a.runway.IsDirectionDefined() == b.runway.IsDirectionDefined() &&
+    (!a.runway.IsDirectionDefined() ||
+     a.runway.GetDirectionDegrees() == b.runway.GetDirectionDegrees()) &&
+    a.runway.IsLengthDefined() == b.runway.IsLengthDefined() &&
+    (!a.runway.IsLengthDefined() ||
+     a.runway.GetLength() == b.runway.GetLength()) &&
+    a.radio_frequency.IsDefined() == b.radio_frequency.IsDefined() &&
+    (!a.radio_frequency.IsDefined() ||
+     a.radio_frequency.GetKiloHertz() == b.radio_frequency.GetKiloHertz()) &&
+    a.type == b.type &&
+    a.flags.turn_point == b.flags.turn_point &&
+    a.flags.home == b.flags.home &&
+    a.flags.start_point == b.flags.start_point &&
+    a.flags.finish_point == b.flags.finish_point &&
+    a.flags.watched == b.flags.watched &&
+    a.origin == b.origin &&
+    a.name == b.name && a.comment == b.comment && a.details == b.details &&
+    Equals(a.files_embed, b.files_embed);
+}
+
+static void
+TestWaypointCache(FileCache &cache)
+{
+  Waypoints waypoints;
+
+  for (unsigned i = 0; i < 5; ++i) {
+    Waypoint wp(GeoPoint(Angle::Degrees(7 + 0.1 * i),
+                         Angle::Degrees(51 - 0.1 * i)));
+    wp.original_id = 100 + i;
+    wp.elevation = 100 + 10 * i;
+    wp.name = _T("WP") + tstring(1, _T('A' + i));
+    wp.comment = _T("comment");
+    wp.origin = i < 3 ? WaypointOrigin::PRIMARY : WaypointOrigin::USER;
+    wp.flags.home = i == 2;
+    wp.flags.turn_point = true;
+
+    if (i == 1) {
+      wp.type = Waypoint::Type::AIRFIELD;
+      wp.runway.SetDirectionDegrees(270);
+      wp.runway.SetLength(800);
+      wp.radio_frequency.SetKiloHertz(122500);
+      wp.details = _T("details");
+
+      /* the order of these must be kept */
+      wp.files_embed.push_front(_T("b.jpg"));
+      wp.files_embed.push_front(_T("c.jpg"));
+      wp.files_embed.push_front(_T("a.jpg"));
+    }
+
+    waypoints.Append(std::move(wp));
+  }
+
+  waypoints.Optimise();
+
+  ok(SaveWaypointCache(cache, 23, waypoints, true), "save waypoints", 0);
+
+  Waypoints loaded;
+  bool found = false;
+  ok(LoadWaypointCache(cache, 23, loaded, found) && found,
+     "load waypoints", 0);
+  loaded.Optimise();
+  ok1(loaded.size() == waypoints.size());
+
+  bool equal = true;
+  for (unsigned id = 1; id <= waypoints.size(); ++id) {
+    const auto a = waypoints.LookupId(id), b = loaded.LookupId(id);
+    if (a == nullptr || b == nullptr || !Equals(*a, *b))
+      equal = false;
+  }
+
+  ok(equal, "waypoints", 0);
+
+  const auto wp = loaded.LookupId(2);
+  auto i = wp != nullptr
+    ? wp->files_embed.begin()
+    : std::forward_list<tstring>::const_iterator();
+  ok(wp != nullptr && *i++ == _T("a.jpg") && *i++ == _T("c.jpg") &&
+     *i++ == _T("b.jpg") && i == wp->files_embed.end(), "files_embed", 0);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(20);
+
+  FileCache cache(AllocatedPath(_T("output/TestBinaryCache")));
+
+  TestBinaryCache(cache);
+  TestAirspaceCache(cache);
+  TestWaypointCache(cache);
+
+  return exit_status();
+}
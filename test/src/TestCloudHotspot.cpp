@@ -0,0 +1,144 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Cloud/Hotspot.hpp"
+#include "Cloud/Thermal.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Tracking/SkyLines/Import.hpp"
+#include "OS/ByteOrder.hpp"
+#include "TestUtil.hpp"
+
+static const GeoPoint base(Angle::Degrees(7.7), Angle::Degrees(51.05));
+
+static CloudThermal
+MakeThermal(uint64_t client_key, GeoPoint location, double lift,
+            std::chrono::steady_clock::time_point time)
+{
+  CloudThermal thermal(client_key, AGeoPoint(location, 1000),
+                       AGeoPoint(location, 2000), lift);
+  thermal.time = time;
+  return thermal;
+}
+
+static void
+TestMerge()
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  CloudHotspotContainer hotspots;
+
+  /* many reports of the same house thermal are merged */
+  for (unsigned i = 0; i < 100; ++i)
+    hotspots.Add(MakeThermal(1 + i % 3, base, 2 + (i % 2), now));
+
+  ok1(hotspots.size() == 1);
+
+  auto top = hotspots.QueryTop(base, 10000, now, now, 0, 16);
+  ok1(top.size() == 1);
+  ok1(equals(top.front()->GetWeight(now), 100));
+  ok1(equals(top.front()->GetLift(), 2.5));
+  ok1(top.front()->client_key == 0);
+
+  const auto packed = top.front()->Pack();
+  ok1(FromBE16(packed.bottom_altitude) == 1000);
+  ok1(FromBE16(packed.top_altitude) == 2000);
+  ok1(FromBE16(packed.lift) == 2.5 * 256);
+  ok1(SkyLinesTracking::ImportGeoPoint(packed.top_location)
+      .Distance(base) < 10);
+}
+
+static void
+TestDecay()
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  CloudHotspotContainer hotspots;
+  hotspots.Add(MakeThermal(1, base, 3, now - std::chrono::minutes(10)));
+  hotspots.Add(MakeThermal(1, base, 1, now));
+
+  auto top = hotspots.QueryTop(base, 10000, now, now, 0, 16);
+  ok1(top.size() == 1);
+
+  /* the older report has decayed to one half */
+  ok1(equals(top.front()->GetWeight(now), 1.5));
+  ok1(equals(top.front()->GetLift(), 5. / 3));
+  ok1(equals(top.front()->GetWeight(now + std::chrono::minutes(10)), 0.75));
+
+  /* the order of insertion does not matter */
+  CloudHotspotContainer reversed;
+  reversed.Add(MakeThermal(1, base, 1, now));
+  reversed.Add(MakeThermal(1, base, 3, now - std::chrono::minutes(10)));
+  top = reversed.QueryTop(base, 10000, now, now, 0, 16);
+  ok1(top.size() == 1);
+  ok1(equals(top.front()->GetWeight(now), 1.5));
+  ok1(equals(top.front()->GetLift(), 5. / 3));
+
+  /* own submissions are excluded */
+  ok1(reversed.QueryTop(base, 10000, now, now, 1, 16).empty());
+
+  /* old hotspots are excluded and expired */
+  ok1(reversed.QueryTop(base, 10000, now + std::chrono::seconds(1),
+                        now + std::chrono::seconds(1), 0, 16).empty());
+  reversed.Expire(now + std::chrono::seconds(1));
+  ok1(reversed.empty());
+}
+
+static void
+TestTop()
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  CloudHotspotContainer hotspots;
+
+  /* a row of hotspots, 2 km apart, the eastern ones are stronger */
+  for (unsigned i = 0; i < 20; ++i) {
+    const GeoPoint location(base.longitude + Angle::Degrees(i * 0.03),
+                            base.latitude);
+    for (unsigned j = 0; j <= i; ++j)
+      hotspots.Add(MakeThermal(1, location, 2, now));
+  }
+
+  ok1(hotspots.size() == 20);
+
+  /* the query is limited by range and number */
+  const auto top = hotspots.QueryTop(base, 20000, now, now, 0, 4);
+  ok1(top.size() == 4);
+  ok1(top[0]->GetScore(now) > top[1]->GetScore(now));
+  ok1(top[1]->GetScore(now) > top[2]->GetScore(now));
+  ok1(top[2]->GetScore(now) > top[3]->GetScore(now));
+  ok1(top[0]->center.Distance(base) < 20000);
+  ok1(top[0]->center.Distance(base) > 15000);
+
+  ok1(hotspots.QueryTop(base, 20000, now, now, 0, 100).size() < 20);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(27);
+
+  TestMerge();
+  TestDecay();
+  TestTop();
+
+  return exit_status();
+}
@@ -0,0 +1,99 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Computer/Profiler.hpp"
+#include "IO/OutputStream.hxx"
+#include "IO/BufferedOutputStream.hxx"
+#include "TestUtil.hpp"
+
+#include <string>
+
+#include <string.h>
+
+class StringOutputStream final : public OutputStream {
+public:
+  std::string value;
+
+  void Write(const void *data, size_t size) override {
+    value.append((const char *)data, size);
+  }
+};
+
+typedef ComputerProfiler::Stage Stage;
+
+static unsigned
+CountSubstring(const std::string &s, const char *needle)
+{
+  unsigned n = 0;
+  for (auto i = s.find(needle); i != s.npos; i = s.find(needle, i + 1))
+    ++n;
+  return n;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(12);
+
+  ComputerProfiler profiler;
+  ok1(profiler.GetStats(Stage::ROUTE).count == 0);
+
+  /* 1..200 us, in a ring buffer of 128 */
+  for (unsigned i = 1; i <= 200; ++i)
+    profiler.Add(Stage::ROUTE, 1000, 1000 + i);
+
+  const auto &route = profiler.GetStats(Stage::ROUTE);
+  ok1(route.count == 200);
+  ok1(route.total_us == 200 * 201 / 2);
+  ok1(route.max_us == 200);
+
+  /* only the 128 most recent samples (73..200) count */
+  ok1(route.GetRecentPercentile(0) == 73);
+  ok1(route.GetRecentPercentile(50) == 137);
+  ok1(route.GetRecentPercentile(100) == 200);
+
+  /* bucket 0 is 0..1 us, bucket 7 is 128..255 us */
+  ok1(route.buckets[0] == 1);
+  ok1(route.buckets[7] == 73);
+
+  /* one huge sample lands in the last bucket */
+  profiler.Add(Stage::WAVE, 0, 1ull << 40);
+  ok1(profiler.GetStats(Stage::WAVE).buckets[ComputerProfiler::N_BUCKETS - 1] == 1);
+
+  /* only the most recent events are exported */
+  for (unsigned i = 0; i < ComputerProfiler::MAX_EVENTS; ++i)
+    profiler.Add(Stage::CONTEST, 0, 5);
+
+  StringOutputStream sos;
+  {
+    BufferedOutputStream bos(sos);
+    profiler.WriteChromeTrace(bos);
+    bos.Flush();
+  }
+
+  ok1(CountSubstring(sos.value, "\"ph\":\"X\"") ==
+      ComputerProfiler::MAX_EVENTS);
+  ok1(CountSubstring(sos.value, "\"name\":\"contest\"") ==
+      ComputerProfiler::MAX_EVENTS);
+
+  return exit_status();
+}
@@ -60,6 +60,8 @@
 #include "Logger/Settings.hpp"
 #include "Plane/Plane.hpp"
 #include "NMEA/Info.hpp"
+#include "NMEA/Checksum.hpp"
+#include "NMEA/SentenceId.hpp"
 #include "Protection.hpp"
 #include "Input/InputEvents.hpp"
 #include "Engine/Waypoint/Waypoint.hpp"
@@ -77,6 +79,50 @@ static const DeviceConfig dummy_config = DeviceConfig();
  * Unit tests
  */
 
+static void
+TestChecksum()
+{
+  /* compare the vectorised XorBytes() with a trivial loop, for all
+     lengths and alignments which cover the SIMD tail handling */
+  char buffer[128];
+  for (unsigned i = 0; i < sizeof(buffer); ++i)
+    buffer[i] = char(i * 37 + 11);
+
+  bool xor_ok = true;
+  for (unsigned offset = 0; offset < 16; ++offset) {
+    for (unsigned length = 0; offset + length <= sizeof(buffer); ++length) {
+      uint8_t expected = 0;
+      for (unsigned i = 0; i < length; ++i)
+        expected ^= uint8_t(buffer[offset + i]);
+
+      if (XorBytes(buffer + offset, length) != expected)
+        xor_ok = false;
+    }
+  }
+
+  ok1(xor_ok);
+
+  ok1(VerifyNMEAChecksum("$GPRMC,082310.141,V,,,,,230610*25"));
+  ok1(!VerifyNMEAChecksum("$GPRMC,082310.141,V,,,,,230610*26"));
+  ok1(!VerifyNMEAChecksum("$GPRMC,082310.141,V,,,,,230610"));
+  ok1(!VerifyNMEAChecksum("$GPRMC,082310.141,V,,,,,230610*"));
+  ok1(!VerifyNMEAChecksum("$GPRMC,082310.141,V,,,,,230610*25x"));
+  ok1(!VerifyNMEAChecksum(""));
+
+  /* lower case hex digits */
+  ok1(VerifyNMEAChecksum("$GPRMC,082311,A,5103.5403,N,00741.5742,E,055.3,022.4,230610,000.3,W*6c"));
+
+  /* the last asterisk separates the checksum; earlier ones are part
+     of the payload */
+  char line[64] = "$PFOO,*,BAR";
+  AppendNMEAChecksum(line);
+  ok1(VerifyNMEAChecksum(line));
+
+  ok1(NMEASentenceId("RMC") != NMEASentenceId("GGA"));
+  ok1(NMEASentenceId("$PFLAU") != NMEASentenceId("PFLAU"));
+  ok1(NMEASentenceId("123456789") == 0);
+}
+
 static void
 TestGeneric()
 {
@@ -1623,8 +1669,9 @@ TestFlightList(const struct DeviceRegister &driver)
 
 int main(int argc, char **argv)
 {
-  plan_tests(834);
+  plan_tests(847);
 
+  TestChecksum();
   TestGeneric();
   TestTasman();
   TestFLARM();
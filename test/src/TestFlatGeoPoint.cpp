@@ -21,11 +21,36 @@
 */
 
 #include "Geo/Flat/FlatGeoPoint.hpp"
+#include "Geo/Flat/FlatDistanceBatch.hpp"
 #include "TestUtil.hpp"
 
+#include <stdlib.h>
+#include <assert.h>
+
+static bool
+TestDistanceBatch(const FlatGeoPoint &origin, unsigned n)
+{
+  int x[64], y[64];
+  unsigned d[64];
+  assert(n <= 64);
+
+  for (unsigned i = 0; i < n; ++i) {
+    x[i] = rand() % 20000 - 10000;
+    y[i] = rand() % 20000 - 10000;
+  }
+
+  FlatDistanceBatch(origin, x, y, n, d);
+
+  for (unsigned i = 0; i < n; ++i)
+    if (d[i] != origin.Distance(FlatGeoPoint(x[i], y[i])))
+      return false;
+
+  return true;
+}
+
 int main(int argc, char **argv)
 {
-  plan_tests(37);
+  plan_tests(40);
 
   FlatGeoPoint p1(1, 1);
   FlatGeoPoint p2(1, 2);
@@ -88,5 +113,10 @@ int main(int argc, char **argv)
   ok1(p2.Distance(p3) == 8);
   ok1(p3.Distance(p2) == 8);
 
+  // test FlatDistanceBatch() against Distance()
+  ok1(TestDistanceBatch(p1, 3));
+  ok1(TestDistanceBatch(p3, 4));
+  ok1(TestDistanceBatch(FlatGeoPoint(-5000, 12345), 63));
+
   return exit_status();
 }
@@ -0,0 +1,115 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Computer/JobGraph.hpp"
+#include "TestUtil.hpp"
+
+#include <vector>
+
+static std::vector<unsigned>
+GetGroup(const JobGraph &graph, unsigned group)
+{
+  std::vector<unsigned> result;
+  graph.VisitGroup(group, [&result](unsigned job){
+      result.push_back(job);
+    });
+  return result;
+}
+
+static void
+TestConflicts()
+{
+  const JobAccess a{0x1, 0x2}, b{0x1, 0x4}, c{0x2, 0x8}, d{0x1, 0x1};
+
+  /* reading the same data is fine */
+  ok1(!a.ConflictsWith(b));
+
+  /* read/write and write/write conflicts, in both directions */
+  ok1(a.ConflictsWith(c));
+  ok1(c.ConflictsWith(a));
+  ok1(a.ConflictsWith(d));
+  ok1(d.ConflictsWith(b));
+}
+
+static void
+TestIndependent()
+{
+  const JobAccess jobs[] = {
+    {0x1, 0x2},
+    {0x1, 0x4},
+    {0x1, 0x8},
+  };
+
+  const JobGraph graph(jobs, 3);
+  ok1(graph.GetGroupCount() == 3);
+  ok1(graph.GetGroup(0) == 0);
+  ok1(graph.GetGroup(1) == 1);
+  ok1(graph.GetGroup(2) == 2);
+}
+
+static void
+TestTransitive()
+{
+  /* 0 and 3 do not conflict directly, but both conflict with 2 */
+  const JobAccess jobs[] = {
+    {0, 0x1},
+    {0, 0x2},
+    {0x1, 0x4},
+    {0x4, 0x8},
+    {0x2, 0x10},
+  };
+
+  const JobGraph graph(jobs, 5);
+  ok1(graph.GetGroupCount() == 2);
+  ok1(GetGroup(graph, 0) == std::vector<unsigned>({0, 2, 3}));
+  ok1(GetGroup(graph, 1) == std::vector<unsigned>({1, 4}));
+}
+
+static void
+TestMerge()
+{
+  /* job 2 joins two groups which were separate before */
+  const JobAccess jobs[] = {
+    {0, 0x1},
+    {0, 0x2},
+    {0x3, 0},
+    {0, 0x4},
+  };
+
+  const JobGraph graph(jobs, 4);
+  ok1(graph.GetGroupCount() == 2);
+  ok1(GetGroup(graph, 0) == std::vector<unsigned>({0, 1, 2}));
+  ok1(GetGroup(graph, 1) == std::vector<unsigned>({3}));
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(15);
+
+  TestConflicts();
+  TestIndependent();
+  TestTransitive();
+  TestMerge();
+
+  return exit_status();
+}
@@ -0,0 +1,148 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Geo/PackedPolygon.hpp"
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "Geo/Flat/FlatRay.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+
+#include <stdlib.h>
+#include <math.h>
+
+static const GeoPoint center(Angle::Degrees(7.5), Angle::Degrees(51));
+
+/**
+ * Generate a closed, concave, star-shaped polygon with #n points
+ * around #center.
+ */
+static SearchPointVector
+MakeStar(unsigned n)
+{
+  SearchPointVector v;
+
+  for (unsigned i = 0; i < n; ++i) {
+    const double angle = 2 * M_PI * i / n;
+    const double radius = 0.1 + (rand() % 1000) / 5000.;
+    v.emplace_back(GeoPoint(center.longitude
+                            + Angle::Degrees(radius * cos(angle)),
+                            center.latitude
+                            + Angle::Degrees(radius * sin(angle))));
+  }
+
+  v.push_back(v.front());
+  return v;
+}
+
+static GeoPoint
+RandomPoint()
+{
+  return GeoPoint(center.longitude
+                  + Angle::Degrees((rand() % 20001 - 10000) / 30000.),
+                  center.latitude
+                  + Angle::Degrees((rand() % 20001 - 10000) / 30000.));
+}
+
+/**
+ * Check that all edges that PackedPolygon::FindEdges() omits do not
+ * intersect the given segment, and that the result is ordered.
+ */
+static bool
+CheckEdges(const PackedPolygon &packed, const SearchPointVector &v,
+           FlatGeoPoint a, FlatGeoPoint b)
+{
+  const FlatBoundingBox box(FlatGeoPoint(std::min(a.x, b.x),
+                                         std::min(a.y, b.y)),
+                            FlatGeoPoint(std::max(a.x, b.x),
+                                         std::max(a.y, b.y)));
+
+  std::vector<unsigned> edges;
+  packed.FindEdges(box, edges);
+
+  if (!std::is_sorted(edges.begin(), edges.end()))
+    return false;
+
+  const FlatRay ray(a, b);
+  for (unsigned i = 0; i + 1 < v.size(); ++i) {
+    const FlatRay edge(v[i].GetFlatLocation(), v[i + 1].GetFlatLocation());
+    const bool found = std::binary_search(edges.begin(), edges.end(), i);
+    if (!found && ray.DistinctIntersection(edge) >= 0)
+      return false;
+  }
+
+  return true;
+}
+
+static void
+TestPolygon(unsigned n)
+{
+  const FlatProjection projection(center);
+
+  SearchPointVector v = MakeStar(n);
+  v.Project(projection);
+
+  PackedPolygon packed;
+  packed.Build(v);
+  ok1(packed.GetEdgeCount() == n);
+
+  bool inside_equal = true, edges_ok = true;
+  unsigned n_inside = 0;
+
+  for (unsigned i = 0; i < 2000; ++i) {
+    GeoPoint p = RandomPoint();
+    if (i % 10 == 0)
+      /* points on the latitude of a vertex exercise the boundary
+         conditions of the winding number test */
+      p.latitude = v[rand() % n].GetLocation().latitude;
+
+    const bool inside = v.IsInside(p);
+    n_inside += inside;
+    if (packed.IsInside(p) != inside)
+      inside_equal = false;
+
+    const FlatGeoPoint a = projection.ProjectInteger(p);
+    const FlatGeoPoint b = i % 2 == 0
+      /* short segments use the grid, long ones the linear scan */
+      ? a + FlatGeoPoint(rand() % 2001 - 1000, rand() % 2001 - 1000)
+      : projection.ProjectInteger(RandomPoint());
+    if (!CheckEdges(packed, v, a, b))
+      edges_ok = false;
+  }
+
+  ok1(n_inside > 0);
+  ok1(inside_equal);
+  ok1(edges_ok);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(12);
+
+  TestPolygon(5);
+  TestPolygon(13);
+  TestPolygon(400);
+
+  return exit_status();
+}
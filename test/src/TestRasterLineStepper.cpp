@@ -0,0 +1,134 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterLineStepper.hpp"
+#include "TestUtil.hpp"
+
+/**
+ * Walk the line with the classic Bresenham loop and compare each
+ * position with RasterLineStepper, including some distance beyond
+ * the destination.
+ */
+static bool
+CheckWalk(SignedRasterLocation origin, SignedRasterLocation destination)
+{
+  const int dx = abs(destination.x - origin.x);
+  const int dy = abs(destination.y - origin.y);
+  const int sx = origin.x < destination.x ? 1 : -1;
+  const int sy = origin.y < destination.y ? 1 : -1;
+  int err = dx - dy;
+
+  SignedRasterLocation location = origin;
+  unsigned total_steps = 0;
+
+  RasterLineStepper line(origin, destination), seek(origin, destination);
+  if (line.GetMaxSteps() != unsigned(dx + dy))
+    return false;
+
+  const unsigned n_end = 2 * line.GetEndIteration() + 3;
+  for (unsigned n = 0; n <= n_end; ++n, line.Step()) {
+    seek.Seek(n);
+    if (line.GetLocation() != location ||
+        line.GetTotalSteps() != total_steps ||
+        seek.GetLocation() != location ||
+        seek.GetTotalSteps() != total_steps ||
+        line.TotalStepsAt(n) != total_steps)
+      return false;
+
+    if (n == line.GetEndIteration() && location != destination)
+      return false;
+
+    const int e2 = 2 * err;
+    if (e2 > -dy) {
+      err -= dy;
+      location.x += sx;
+      ++total_steps;
+    }
+    if (e2 < dx) {
+      err += dx;
+      location.y += sy;
+      ++total_steps;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * Check that AdvanceTo() finds the first iteration which reaches the
+ * given total step count.
+ */
+static bool
+CheckAdvance(SignedRasterLocation origin, SignedRasterLocation destination,
+             unsigned stride)
+{
+  RasterLineStepper line(origin, destination);
+  const unsigned max_steps = line.GetMaxSteps();
+
+  /* alternate between two strides, like a ray crossing fine and
+     coarse tiles */
+  unsigned expected = 0;
+  for (unsigned target = 0, i = 0; target <= max_steps;
+       target = line.GetTotalSteps() + (i++ % 3 == 0 ? 2 * stride : stride)) {
+    line.AdvanceTo(target);
+
+    while (line.TotalStepsAt(expected) < target)
+      ++expected;
+
+    if (line.GetIteration() != expected ||
+        line.GetTotalSteps() != line.TotalStepsAt(expected))
+      return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(6);
+
+  bool walk = true, advance = true;
+  for (int dx = -40; dx <= 40; ++dx) {
+    for (int dy = -40; dy <= 40; ++dy) {
+      const SignedRasterLocation origin(1000, 2000);
+      const SignedRasterLocation destination(origin.x + dx, origin.y + dy);
+      if (dx == 0 && dy == 0)
+        continue;
+
+      walk = walk && CheckWalk(origin, destination);
+      for (unsigned stride : {1u, 4u, 7u, 40u})
+        advance = advance && CheckAdvance(origin, destination, stride);
+    }
+  }
+
+  ok1(walk);
+  ok1(advance);
+
+  /* long lines, as used for terrain intersections */
+  ok1(CheckWalk({12, 34}, {12345, 6789}));
+  ok1(CheckWalk({9000, 100}, {17, 23456}));
+  ok1(CheckAdvance({12, 34}, {12345, 6789}, 96));
+  ok1(CheckAdvance({9000, 100}, {17, 23456}, 16));
+
+  return exit_status();
+}
@@ -0,0 +1,106 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Terrain/RasterTileStore.hpp"
+#include "Terrain/RasterBuffer.hpp"
+#include "OS/Path.hpp"
+#include "OS/FileUtil.hpp"
+#include "TestUtil.hpp"
+
+#include <tchar.h>
+
+static const Path path(_T("output/TestRasterTileStore.bin"));
+
+static RasterBuffer
+MakeBuffer(unsigned width, unsigned height, int seed)
+{
+  RasterBuffer buffer(width, height);
+  TerrainHeight *p = buffer.GetData();
+  for (unsigned i = 0; i < width * height; ++i)
+    p[i] = TerrainHeight(short(seed + i));
+  return buffer;
+}
+
+static bool
+Equals(const RasterBuffer &buffer, unsigned width, unsigned height,
+       int seed)
+{
+  if (buffer.GetWidth() != width || buffer.GetHeight() != height)
+    return false;
+
+  const TerrainHeight *p = buffer.GetData();
+  for (unsigned i = 0; i < width * height; ++i)
+    if (p[i].GetValue() != short(seed + i))
+      return false;
+
+  return true;
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(14);
+
+  File::Delete(path);
+
+  {
+    RasterTileStore store(path, 42, 16);
+    ok1(store.IsDefined());
+    ok1(!store.Contains(3));
+
+    store.Store(3, MakeBuffer(5, 7, 100));
+    store.Store(9, MakeBuffer(8, 8, -50));
+    ok1(store.Contains(3));
+    ok1(store.Contains(9));
+
+    /* read back from the same instance; this re-maps the file */
+    RasterBuffer buffer;
+    ok1(store.Load(3, 5, 7, buffer));
+    ok1(Equals(buffer, 5, 7, 100));
+
+    /* dimension mismatch */
+    ok1(!store.Load(9, 8, 7, buffer));
+  }
+
+  {
+    /* reopen with the same key */
+    RasterTileStore store(path, 42, 16);
+    ok1(store.IsDefined());
+    ok1(store.Contains(3));
+    ok1(!store.Contains(4));
+
+    RasterBuffer buffer;
+    ok1(store.Load(9, 8, 8, buffer));
+    ok1(Equals(buffer, 8, 8, -50));
+  }
+
+  {
+    /* a different key discards the file */
+    RasterTileStore store(path, 43, 16);
+    ok1(store.IsDefined());
+    ok1(!store.Contains(3));
+  }
+
+  File::Delete(path);
+
+  return exit_status();
+}
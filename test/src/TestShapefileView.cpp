@@ -0,0 +1,258 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Compares the shapes decoded by #ShapefileView and #MappedShapefile
+ * with those read by shapelib.
+ */
+
+#include "Topography/MappedShapefile.hpp"
+#include "Topography/shapelib/mapshape.h"
+#include "Util/Macros.hpp"
+#include "TestUtil.hpp"
+
+#include <zzip/lib.h>
+
+#include <string>
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *const map_path = "test/data/benalla9.xcm";
+
+static const char *const layers[] = {
+  "mispopppop_point",
+  "builtupapop_area",
+  "watrcrslhydro_line",
+  "inwaterahydro_area",
+  "railrdltrans_line",
+  "roadltrans_line",
+};
+
+/**
+ * The .shp files in the test map are deflated, so #MappedShapefile
+ * can't map them from the ZIP archive.  Extract them.
+ */
+static bool
+Extract(zzip_dir *dir, const char *name, const char *path)
+{
+  ZZIP_FILE *src = zzip_file_open(dir, name, 0);
+  if (src == nullptr)
+    return false;
+
+  FILE *dest = fopen(path, "wb");
+  if (dest == nullptr) {
+    zzip_file_close(src);
+    return false;
+  }
+
+  char buffer[4096];
+  zzip_ssize_t nbytes;
+  bool success = true;
+  while ((nbytes = zzip_file_read(src, buffer, sizeof(buffer))) > 0)
+    if (fwrite(buffer, 1, nbytes, dest) != size_t(nbytes))
+      success = false;
+
+  success = success && nbytes == 0;
+  zzip_file_close(src);
+  return fclose(dest) == 0 && success;
+}
+
+static bool
+Extract(zzip_dir *dir, const char *layer)
+{
+  for (const char *suffix : {".shp", ".shx", ".dbf"}) {
+    const std::string name = std::string(layer) + suffix;
+    const std::string path = std::string("output/TestShapefileView") + suffix;
+    if (!Extract(dir, name.c_str(), path.c_str()))
+      return false;
+  }
+
+  return true;
+}
+
+static std::string
+LoadFile(const char *path)
+{
+  std::string result;
+
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr)
+    return result;
+
+  char buffer[4096];
+  size_t nbytes;
+  while ((nbytes = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    result.append(buffer, nbytes);
+
+  fclose(file);
+  return result;
+}
+
+static bool
+Equals(const rectObj &a, const rectObj &b)
+{
+  return a.minx == b.minx && a.miny == b.miny &&
+    a.maxx == b.maxx && a.maxy == b.maxy;
+}
+
+/**
+ * Does the #ShapeRecord describe the same shape as the shapelib
+ * #shapeObj?
+ */
+static bool
+Equals(const ShapeRecord &record, const shapeObj &shape)
+{
+  if (record.type != shape.type ||
+      int(record.n_parts) != shape.numlines)
+    return false;
+
+  if (shape.type == MS_SHAPE_NULL)
+    return true;
+
+  if (!Equals(record.bounds, shape.bounds))
+    return false;
+
+  for (unsigned l = 0; l < record.n_parts; ++l) {
+    const lineObj &line = shape.line[l];
+    const unsigned start = record.GetPartStart(l);
+    if (int(record.GetPartEnd(l) - start) != line.numpoints)
+      return false;
+
+    for (int j = 0; j < line.numpoints; ++j)
+      if (record.GetX(start + j) != line.point[j].x ||
+          record.GetY(start + j) != line.point[j].y)
+        return false;
+  }
+
+  return true;
+}
+
+static void
+TestLayer(zzip_dir *dir, const char *layer)
+{
+  const std::string filename = std::string(layer) + ".shp";
+
+  shapefileObj file;
+  if (msShapefileOpen(&file, "rb", dir, filename.c_str(), 0) == -1 ||
+      !Extract(dir, layer)) {
+    skip(4, 0, "failed to open shapefile");
+    return;
+  }
+
+  MappedShapefile mapped;
+  if (!mapped.Open(nullptr, "output/TestShapefileView.shp")) {
+    skip(4, 0, "failed to map shapefile");
+    msShapefileClose(&file);
+    return;
+  }
+
+  const ShapefileView &view = mapped.GetView();
+  ok(view.GetShapeCount() == unsigned(file.numshapes) &&
+     Equals(view.GetBounds(), file.bounds), layer, 0);
+
+  const int n_fields = file.hDBF->nFields;
+
+  bool shapes_equal = true, bounds_equal = true, attributes_equal = true;
+  for (int i = 0; i < file.numshapes; ++i) {
+    shapeObj shape;
+    msInitShape(&shape);
+    msSHPReadShape(file.hSHP, i, &shape);
+
+    ShapeRecord record;
+    if (view.ReadShape(i, record) != (shape.type != MS_SHAPE_NULL) ||
+        !Equals(record, shape))
+      shapes_equal = false;
+
+    rectObj a, b;
+    const bool have_bounds = view.ReadBounds(i, a);
+    if (have_bounds != (msSHPReadBounds(file.hSHP, i, &b) == MS_SUCCESS) ||
+        (have_bounds && !Equals(a, b)))
+      bounds_equal = false;
+
+    msFreeShape(&shape);
+
+    for (int field = 0; field < n_fields; ++field) {
+      const StringView value = view.ReadAttribute(i, field);
+      const char *expected = msDBFReadStringAttribute(file.hDBF, i, field);
+      if (value.IsNull() || expected == nullptr ||
+          value.size != strlen(expected) ||
+          memcmp(value.data, expected, value.size) != 0)
+        attributes_equal = false;
+    }
+  }
+
+  ok(shapes_equal, "ReadShape", 0);
+  ok(bounds_equal, "ReadBounds", 0);
+  ok(attributes_equal, "ReadAttribute", 0);
+
+  msShapefileClose(&file);
+}
+
+/**
+ * Records which reach beyond the end of a truncated .shp file must
+ * be rejected instead of being read out of bounds.
+ */
+static void
+TestTruncated()
+{
+  const std::string shp = LoadFile("output/TestShapefileView.shp");
+  const std::string shx = LoadFile("output/TestShapefileView.shx");
+  if (shp.size() < 100 || shx.size() < 100) {
+    skip(3, 0, "failed to load shapefile");
+    return;
+  }
+
+  const unsigned n = (shx.size() - 100) / 8;
+
+  ShapefileView view;
+  ok1(!view.Open({shp.data(), 99}, {shx.data(), shx.size()}, nullptr));
+
+  /* cut the .shp file in the middle of the last record */
+  ok1(view.Open({shp.data(), shp.size() - 8}, {shx.data(), shx.size()},
+                nullptr));
+
+  ShapeRecord record;
+  ok1(n > 1 && view.ReadShape(0, record) && !view.ReadShape(n - 1, record));
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(4 * ARRAY_SIZE(layers) + 3);
+
+  zzip_dir *dir = zzip_dir_open(map_path, nullptr);
+  if (dir == nullptr) {
+    skip(4 * ARRAY_SIZE(layers) + 3, 0, "failed to open test map");
+    return exit_status();
+  }
+
+  for (const char *layer : layers)
+    TestLayer(dir, layer);
+
+  /* the last extracted layer is a line layer */
+  TestTruncated();
+
+  zzip_dir_close(dir);
+
+  return exit_status();
+}
@@ -0,0 +1,131 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/SnapshotBuffer.hpp"
+#include "Thread/WorkerPool.hpp"
+#include "TestUtil.hpp"
+
+#include <atomic>
+
+/**
+ * A value which is consistent only if all elements are equal.
+ */
+struct Value {
+  unsigned numbers[64];
+
+  void Set(unsigned n) {
+    for (auto &i : numbers)
+      i = n;
+  }
+
+  bool IsConsistent() const {
+    for (auto i : numbers)
+      if (i != numbers[0])
+        return false;
+    return true;
+  }
+};
+
+static void
+TestSingleThread()
+{
+  SnapshotBuffer<Value> buffer;
+  buffer.BeginWrite().Set(1);
+  buffer.EndWrite();
+
+  {
+    const auto a = buffer.Read();
+    ok1(a->numbers[0] == 1);
+
+    /* a pinned slot is not overwritten */
+    for (unsigned i = 2; i < 10; ++i) {
+      Value v;
+      v.Set(i);
+      buffer.Write(v);
+    }
+
+    ok1(a->IsConsistent());
+    ok1(a->numbers[0] == 1);
+  }
+
+  ok1(buffer.Read()->numbers[63] == 9);
+}
+
+static void
+TestConcurrent()
+{
+  constexpr unsigned N_WRITES = 20000;
+
+  SnapshotBuffer<Value> buffer;
+  buffer.BeginWrite().Set(0);
+  buffer.EndWrite();
+
+  std::atomic<bool> done(false);
+  std::atomic<unsigned> inconsistent(0), backwards(0);
+
+  WorkerPool pool(3);
+  pool.ForEach(4, [&](unsigned job){
+      if (job == 0) {
+        for (unsigned i = 1; i <= N_WRITES; ++i) {
+          Value &v = buffer.BeginWrite();
+          for (unsigned j = 0; j < 64; ++j)
+            v.numbers[j] = i;
+          buffer.EndWrite();
+        }
+
+        done = true;
+        return;
+      }
+
+      unsigned last = 0;
+      while (true) {
+        const bool was_done = done;
+
+        {
+          const auto r = buffer.Read();
+          if (!r->IsConsistent())
+            ++inconsistent;
+          if (r->numbers[0] < last)
+            ++backwards;
+          last = r->numbers[0];
+        }
+
+        if (was_done)
+          break;
+      }
+    });
+
+  ok1(inconsistent == 0);
+  ok1(backwards == 0);
+  ok1(buffer.Read()->numbers[0] == N_WRITES);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(7);
+
+  TestSingleThread();
+  TestConcurrent();
+
+  return exit_status();
+}
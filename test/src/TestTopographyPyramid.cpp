@@ -0,0 +1,388 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+/*
+ * Builds ".lod" pyramids from the layers of a test map, and reads
+ * them back with #TopographyPyramid.
+ */
+
+#include "TopographyPyramidBuilder.hpp"
+#include "Topography/TopographyPyramid.hpp"
+#include "Topography/shapelib/mapshape.h"
+#include "OS/ByteOrder.hpp"
+#include "Util/Macros.hpp"
+#include "TestUtil.hpp"
+
+#include <zzip/lib.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace TopographyPyramidFormat;
+
+static const char *const map_path = "test/data/benalla9.xcm";
+static const char *const lod_path = "output/TestTopographyPyramid.lod";
+static const char *const corrupt_path = "output/TestTopographyPyramid2.lod";
+
+static constexpr unsigned N_LEVELS = 4;
+
+static constexpr struct {
+  const char *name;
+  int label_field;
+} layers[] = {
+  { "mispopppop_point", 0 },
+  { "railrdltrans_line", -1 },
+  { "builtupapop_area", 0 },
+};
+
+static constexpr unsigned TESTS_PER_LAYER = 7;
+static constexpr unsigned CORRUPT_TESTS = 9;
+
+struct Vertex {
+  double x, y;
+
+  bool operator<(const Vertex &other) const {
+    return x < other.x || (x == other.x && y < other.y);
+  }
+};
+
+static std::string
+LoadFile(const char *path)
+{
+  std::string result;
+
+  FILE *file = fopen(path, "rb");
+  if (file == nullptr)
+    return result;
+
+  char buffer[4096];
+  size_t nbytes;
+  while ((nbytes = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    result.append(buffer, nbytes);
+
+  fclose(file);
+  return result;
+}
+
+static bool
+SaveFile(const char *path, const std::string &data)
+{
+  FILE *file = fopen(path, "wb");
+  if (file == nullptr)
+    return false;
+
+  bool success = fwrite(data.data(), 1, data.size(), file) == data.size();
+  return fclose(file) == 0 && success;
+}
+
+static uint32_t
+Get32(const std::string &data, size_t offset)
+{
+  uint32_t value;
+  memcpy(&value, data.data() + offset, sizeof(value));
+  return FromLE32(value);
+}
+
+static void
+Put32(std::string &data, size_t offset, uint32_t value)
+{
+  value = ToLE32(value);
+  memcpy(&data[offset], &value, sizeof(value));
+}
+
+static size_t
+GetTileEntryOffset(unsigned i)
+{
+  return sizeof(Header) + i * sizeof(TileEntry);
+}
+
+/**
+ * Are the keys in the tile table sorted, and do they all refer to
+ * an existing tile?
+ */
+static bool
+CheckKeys(const std::string &data)
+{
+  if (data.size() < sizeof(Header))
+    return false;
+
+  const unsigned n_levels = Get32(data, offsetof(Header, n_levels));
+  const unsigned n_tiles = Get32(data, offsetof(Header, n_tiles));
+  if (data.size() < GetTileEntryOffset(n_tiles))
+    return false;
+
+  for (unsigned i = 0; i < n_tiles; ++i) {
+    const uint32_t key = Get32(data, GetTileEntryOffset(i) +
+                               offsetof(TileEntry, key));
+    const unsigned level = key >> 24;
+    const unsigned x = key & 0xfff, y = (key >> 12) & 0xfff;
+    if (level >= n_levels || x >= (1u << level) || y >= (1u << level))
+      return false;
+
+    if (i > 0 && key <= Get32(data, GetTileEntryOffset(i - 1) +
+                              offsetof(TileEntry, key)))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Read all vertices of the source shapefile, in degrees.
+ */
+static std::vector<Vertex>
+ReadSourceVertices(zzip_dir *dir, const char *name)
+{
+  std::vector<Vertex> vertices;
+
+  const std::string filename = std::string(name) + ".shp";
+  shapefileObj file;
+  if (msShapefileOpen(&file, "rb", dir, filename.c_str(), 0) == -1)
+    return vertices;
+
+  for (int i = 0; i < file.numshapes; ++i) {
+    shapeObj shape;
+    msInitShape(&shape);
+    msSHPReadShape(file.hSHP, i, &shape);
+
+    for (int l = 0; l < shape.numlines; ++l)
+      for (int j = 0; j < shape.line[l].numpoints; ++j)
+        vertices.push_back({shape.line[l].point[j].x,
+                            shape.line[l].point[j].y});
+
+    msFreeShape(&shape);
+  }
+
+  msShapefileClose(&file);
+  return vertices;
+}
+
+/**
+ * Is there a vertex within one quantisation step of the given one?
+ *
+ * @param vertices sorted vertices
+ */
+static bool
+HasNeighbour(const std::vector<Vertex> &vertices, const Vertex &v,
+             double unit_x, double unit_y)
+{
+  auto i = std::lower_bound(vertices.begin(), vertices.end(),
+                            Vertex{v.x - unit_x, v.y - unit_y});
+  for (; i != vertices.end() && i->x <= v.x + unit_x; ++i)
+    if (fabs(i->y - v.y) <= unit_y)
+      return true;
+
+  return false;
+}
+
+static void
+TestLayer(zzip_dir *dir, const char *name, int label_field)
+{
+  ok(BuildTopographyPyramid(dir, name, label_field, N_LEVELS, lod_path),
+     name, 0);
+
+  TopographyPyramid pyramid;
+  if (!pyramid.Open(nullptr, lod_path)) {
+    ok(false, "open", 0);
+    skip(TESTS_PER_LAYER - 2, 0, "failed to open pyramid");
+    return;
+  }
+
+  ok(true, "open", 0);
+  ok1(pyramid.GetLevelCount() == N_LEVELS);
+  ok(CheckKeys(LoadFile(lod_path)), "keys sorted", 0);
+
+  /* decode all tiles; each vertex must lie within its tile, give or
+     take one quantisation step */
+  bool decoded = true, within_tile = true;
+  std::vector<Vertex> deepest;
+  double deepest_unit_x = 0, deepest_unit_y = 0;
+
+  const GeoBounds bounds = pyramid.GetBounds();
+  for (unsigned level = 0; level < N_LEVELS; ++level) {
+    pyramid.VisitTiles(level, bounds, [&](unsigned tile){
+        const bool success =
+          pyramid.ForEachShape(tile, [&](const PyramidShape &shape){
+              for (unsigned i = 0; i < shape.n_points; ++i) {
+                const double x = shape.GetX(i), y = shape.GetY(i);
+                const double qx = (x - shape.origin_x) / shape.unit_x;
+                const double qy = (y - shape.origin_y) / shape.unit_y;
+                if (qx < -1 || qx > QUANTUM + 1 ||
+                    qy < -1 || qy > QUANTUM + 1)
+                  within_tile = false;
+
+                if (level == N_LEVELS - 1) {
+                  deepest.push_back({x, y});
+                  deepest_unit_x = shape.unit_x;
+                  deepest_unit_y = shape.unit_y;
+                }
+              }
+            });
+
+        if (!success)
+          decoded = false;
+      });
+  }
+
+  ok(decoded, "decode", 0);
+  ok(within_tile, "within tile", 0);
+
+  /* the deepest level is not thinned: each original vertex must be
+     there, off by no more than one quantisation step */
+  std::sort(deepest.begin(), deepest.end());
+  const auto source = ReadSourceVertices(dir, name);
+  bool within_quantum = !source.empty();
+  for (const Vertex &v : source)
+    if (!HasNeighbour(deepest, v, deepest_unit_x, deepest_unit_y))
+      within_quantum = false;
+
+  ok(within_quantum, "within one quantum", 0);
+}
+
+/**
+ * Write a modified copy of the pyramid and try to open it.
+ */
+template<typename F>
+static bool
+OpenModified(const std::string &original, F &&modify,
+             TopographyPyramid &pyramid)
+{
+  std::string data = original;
+  modify(data);
+  return SaveFile(corrupt_path, data) &&
+    pyramid.Open(nullptr, corrupt_path);
+}
+
+template<typename F>
+static bool
+OpenModified(const std::string &original, F &&modify)
+{
+  TopographyPyramid pyramid;
+  return OpenModified(original, std::forward<F>(modify), pyramid);
+}
+
+/**
+ * Truncated and corrupt files must be rejected, either by Open() or
+ * while decoding the affected tile.
+ */
+static void
+TestCorrupt()
+{
+  /* the last layer built by TestLayer() */
+  const std::string data = LoadFile(lod_path);
+  if (data.size() < sizeof(Header) ||
+      Get32(data, offsetof(Header, n_tiles)) < 2) {
+    skip(CORRUPT_TESTS, 0, "no pyramid");
+    return;
+  }
+
+  const unsigned n_tiles = Get32(data, offsetof(Header, n_tiles));
+  const size_t table_end = GetTileEntryOffset(n_tiles);
+
+  ok(!OpenModified(data, [](std::string &d){
+        d.resize(sizeof(Header) - 1);
+      }),
+     "truncated header", 0);
+  ok(!OpenModified(data, [table_end](std::string &d){
+        d.resize(table_end - 1);
+      }),
+     "truncated tile table", 0);
+  ok(!OpenModified(data, [](std::string &d){
+        d.resize(d.size() - 1);
+      }),
+     "truncated tile data", 0);
+  ok(!OpenModified(data, [](std::string &d){
+        d[0] = 'Y';
+      }),
+     "bad magic", 0);
+  ok(!OpenModified(data, [](std::string &d){
+        Put32(d, offsetof(Header, version), VERSION + 1);
+      }),
+     "bad version", 0);
+  ok(!OpenModified(data, [](std::string &d){
+        Put32(d, offsetof(Header, n_levels), MAX_LEVELS + 1);
+      }),
+     "too many levels", 0);
+
+  /* unsorted tile keys */
+  ok(!OpenModified(data, [](std::string &d){
+        const size_t a = GetTileEntryOffset(0) + offsetof(TileEntry, key);
+        const size_t b = GetTileEntryOffset(1) + offsetof(TileEntry, key);
+        const uint32_t key = Get32(d, a);
+        Put32(d, a, Get32(d, b));
+        Put32(d, b, key);
+      }),
+     "unsorted keys", 0);
+
+  /* a line size which exceeds the tile; Open() doesn't look at the
+     tile contents, but decoding must fail */
+  const size_t last = GetTileEntryOffset(n_tiles - 1);
+  const uint32_t offset = Get32(data, last + offsetof(TileEntry, offset));
+  {
+    TopographyPyramid pyramid;
+    ok(OpenModified(data, [offset](std::string &d){
+          d[offset + 4] = d[offset + 5] = char(0xff);
+        }, pyramid) &&
+       !pyramid.ForEachShape(n_tiles - 1, [](const PyramidShape &){}),
+       "bad line size", 0);
+  }
+
+  /* more shapes than the tile contains */
+  {
+    TopographyPyramid pyramid;
+    ok(OpenModified(data, [last](std::string &d){
+          Put32(d, last + offsetof(TileEntry, n_shapes),
+                Get32(d, last + offsetof(TileEntry, size)) / 4);
+        }, pyramid) &&
+       !pyramid.ForEachShape(n_tiles - 1, [](const PyramidShape &){}),
+       "too many shapes", 0);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(TESTS_PER_LAYER * ARRAY_SIZE(layers) + CORRUPT_TESTS);
+
+  zzip_dir *dir = zzip_dir_open(map_path, nullptr);
+  if (dir == nullptr) {
+    skip(TESTS_PER_LAYER * ARRAY_SIZE(layers) + CORRUPT_TESTS, 0,
+         "failed to open test map");
+    return exit_status();
+  }
+
+  for (const auto &layer : layers)
+    TestLayer(dir, layer.name, layer.label_field);
+
+  TestCorrupt();
+
+  zzip_dir_close(dir);
+
+  return exit_status();
+}
@@ -0,0 +1,193 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Engine/Waypoint/WaypointIndex.hpp"
+#include "Engine/Waypoint/Waypoint.hpp"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <limits.h>
+#include <stdlib.h>
+
+static std::vector<WaypointPtr>
+MakeWaypoints(unsigned n, int spread)
+{
+  std::vector<WaypointPtr> result;
+  result.reserve(n);
+
+  for (unsigned i = 0; i < n; ++i) {
+    Waypoint *wp = new Waypoint(GeoPoint(Angle::Zero(), Angle::Zero()));
+    wp->id = i;
+    wp->type = i % 3 == 0
+      ? Waypoint::Type::AIRFIELD
+      : Waypoint::Type::NORMAL;
+
+    /* some clusters with duplicate locations, and some outliers */
+    if (i % 50 == 0 && i > 0)
+      wp->flat_location = result[i - 1]->flat_location;
+    else
+      wp->flat_location = FlatGeoPoint(rand() % (2 * spread + 1) - spread,
+                                       rand() % (2 * spread + 1) - spread);
+#ifndef NDEBUG
+    wp->flat_location_initialised = true;
+#endif
+
+    result.emplace_back(wp);
+  }
+
+  return result;
+}
+
+static uint64_t
+SquareDistance(const Waypoint &wp, FlatGeoPoint p)
+{
+  const int64_t dx = int64_t(wp.flat_location.x) - p.x;
+  const int64_t dy = int64_t(wp.flat_location.y) - p.y;
+  return dx * dx + dy * dy;
+}
+
+static bool
+IsAirfield(const Waypoint &wp)
+{
+  return wp.IsAirport();
+}
+
+/**
+ * Compare the index with a linear scan.
+ */
+static bool
+CheckQuery(const WaypointIndex &index,
+           const std::vector<WaypointPtr> &waypoints,
+           FlatGeoPoint location, unsigned range)
+{
+  const uint64_t square_range = uint64_t(range) * range;
+
+  std::vector<unsigned> expected, found;
+  uint64_t nearest = UINT64_MAX, nearest_airfield = UINT64_MAX;
+
+  for (const auto &wp : waypoints) {
+    const uint64_t d = SquareDistance(*wp, location);
+    if (d > square_range)
+      continue;
+
+    expected.push_back(wp->id);
+    nearest = std::min(nearest, d);
+    if (IsAirfield(*wp))
+      nearest_airfield = std::min(nearest_airfield, d);
+  }
+
+  index.VisitWithinRange(location, range, [&found](const WaypointPtr &wp){
+      found.push_back(wp->id);
+    });
+
+  std::sort(expected.begin(), expected.end());
+  std::sort(found.begin(), found.end());
+  if (found != expected)
+    return false;
+
+  /* there may be several waypoints at the same distance; only the
+     distance must match */
+  const auto a = index.FindNearestIf(location, range,
+                                     [](const Waypoint &){ return true; });
+  if (a == nullptr
+      ? nearest != UINT64_MAX
+      : SquareDistance(*a, location) != nearest)
+    return false;
+
+  const auto b = index.FindNearestIf(location, range, IsAirfield);
+  if (b == nullptr
+      ? nearest_airfield != UINT64_MAX
+      : (!IsAirfield(*b) ||
+         SquareDistance(*b, location) != nearest_airfield))
+    return false;
+
+  return true;
+}
+
+static void
+TestEmpty()
+{
+  WaypointIndex index;
+  index.Build(std::vector<WaypointPtr>());
+  ok1(index.IsEmpty());
+  ok1(index.FindNearestIf(FlatGeoPoint(0, 0), 1000,
+                          [](const Waypoint &){ return true; }) == nullptr);
+}
+
+static void
+TestRandom(unsigned n, int spread)
+{
+  const auto waypoints = MakeWaypoints(n, spread);
+
+  WaypointIndex index;
+  index.Build(std::vector<WaypointPtr>(waypoints));
+  ok1(index.size() == n);
+
+  bool success = true;
+  for (unsigned i = 0; i < 200 && success; ++i) {
+    const FlatGeoPoint location(rand() % (4 * spread + 1) - 2 * spread,
+                                rand() % (4 * spread + 1) - 2 * spread);
+    const unsigned range = i % 10 == 0
+      ? 0
+      : rand() % (unsigned(spread) / 2 + 1);
+    success = CheckQuery(index, waypoints, location, range);
+  }
+
+  ok1(success);
+
+  /* exactly at a waypoint, with range zero */
+  ok1(CheckQuery(index, waypoints, waypoints[n / 2]->flat_location, 0));
+}
+
+static void
+TestExtremeRange()
+{
+  const auto waypoints = MakeWaypoints(100, 1000000);
+
+  WaypointIndex index;
+  index.Build(std::vector<WaypointPtr>(waypoints));
+
+  /* the range box must be clipped to the integer range */
+  ok1(CheckQuery(index, waypoints, FlatGeoPoint(INT_MAX - 10, INT_MIN + 10),
+                 UINT_MAX));
+  ok1(CheckQuery(index, waypoints, FlatGeoPoint(0, 0), 5000000));
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(2 + 3 * 5 + 2);
+
+  TestEmpty();
+
+  TestRandom(1, 1000);
+  TestRandom(15, 1000);
+  TestRandom(17, 1000);
+  TestRandom(1000, 100000);
+  TestRandom(20000, 10000000);
+
+  TestExtremeRange();
+
+  return exit_status();
+}
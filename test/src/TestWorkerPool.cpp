@@ -0,0 +1,86 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "Thread/WorkerPool.hpp"
+#include "TestUtil.hpp"
+
+#include <atomic>
+#include <stdexcept>
+
+static void
+TestForEach(WorkerPool &pool, unsigned n)
+{
+  std::atomic<unsigned> counts[64];
+  for (auto &i : counts)
+    i = 0;
+
+  pool.ForEach(n, [&counts](unsigned i){
+      ++counts[i];
+    });
+
+  bool once = true;
+  for (unsigned i = 0; i < 64; ++i)
+    if (counts[i] != (i < n ? 1u : 0u))
+      once = false;
+
+  ok1(once);
+}
+
+static void
+TestException(WorkerPool &pool)
+{
+  std::atomic<unsigned> finished(0);
+
+  bool caught = false;
+  try {
+    pool.ForEach(16, [&finished](unsigned i){
+        if (i == 3)
+          throw std::runtime_error("job failed");
+        ++finished;
+      });
+  } catch (const std::runtime_error &) {
+    caught = true;
+  }
+
+  ok1(caught);
+
+  /* all other jobs have still been run */
+  ok1(finished == 15);
+}
+
+int main(int argc, char **argv)
+{
+  plan_tests(10);
+
+  for (unsigned n_threads : {0u, 3u}) {
+    WorkerPool pool(n_threads);
+    ok1(pool.GetThreadCount() == n_threads);
+
+    TestForEach(pool, 64);
+    TestForEach(pool, 1);
+
+    TestException(pool);
+  }
+
+  return exit_status();
+}
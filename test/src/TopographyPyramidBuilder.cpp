@@ -0,0 +1,592 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#include "TopographyPyramidBuilder.hpp"
+#include "Topography/TopographyPyramid.hpp"
+#include "Topography/shapelib/mapshape.h"
+#include "OS/ByteOrder.hpp"
+#include "Util/ScopeExit.hxx"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace TopographyPyramidFormat;
+
+/**
+ * Limits imposed by #XShape.
+ */
+static constexpr unsigned MAX_LINES = 32;
+static constexpr unsigned MAX_LINE_SIZE = 16384;
+
+/**
+ * A point in normalised coordinates; the layer bounds are mapped to
+ * [0,1].  Within a level, these are multiplied by the number of
+ * tiles per row.
+ */
+struct Point {
+  double x, y;
+
+  bool operator==(const Point &other) const {
+    return x == other.x && y == other.y;
+  }
+};
+
+typedef std::vector<Point> Line;
+
+struct SourceShape {
+  MS_SHAPE_TYPE type;
+  std::vector<Line> lines;
+  std::string label;
+};
+
+struct QuantizedPoint {
+  int16_t x, y;
+
+  bool operator==(const QuantizedPoint &other) const {
+    return x == other.x && y == other.y;
+  }
+};
+
+typedef std::vector<QuantizedPoint> QuantizedLine;
+
+/**
+ * The parts of one shape which fall into a tile, in level
+ * coordinates.
+ */
+struct TileParts {
+  std::vector<Line> lines;
+
+  /**
+   * The index of the last line segment which was added, for joining
+   * consecutive segments of a polyline.
+   */
+  unsigned last_segment;
+};
+
+struct Tile {
+  unsigned n_shapes = 0;
+  std::string data;
+};
+
+static double
+SquareDistanceToSegment(const Point &p, const Point &a, const Point &b)
+{
+  const double dx = b.x - a.x, dy = b.y - a.y;
+  const double length2 = dx * dx + dy * dy;
+
+  double t = length2 > 0
+    ? ((p.x - a.x) * dx + (p.y - a.y) * dy) / length2
+    : 0;
+  t = std::max(0., std::min(t, 1.));
+
+  const double ex = a.x + t * dx - p.x, ey = a.y + t * dy - p.y;
+  return ex * ex + ey * ey;
+}
+
+/**
+ * Douglas-Peucker line simplification; the first and the last point
+ * are always kept.
+ */
+static Line
+Simplify(const Line &line, double tolerance)
+{
+  const unsigned n = line.size();
+  if (n <= 2)
+    return line;
+
+  const double tolerance2 = tolerance * tolerance;
+  std::vector<bool> keep(n, false);
+  keep.front() = keep.back() = true;
+
+  std::vector<std::pair<unsigned, unsigned>> stack;
+  stack.emplace_back(0, n - 1);
+
+  while (!stack.empty()) {
+    const auto range = stack.back();
+    stack.pop_back();
+
+    double max_distance2 = 0;
+    unsigned max_index = 0;
+    for (unsigned i = range.first + 1; i < range.second; ++i) {
+      const double d = SquareDistanceToSegment(line[i], line[range.first],
+                                               line[range.second]);
+      if (d > max_distance2) {
+        max_distance2 = d;
+        max_index = i;
+      }
+    }
+
+    if (max_distance2 > tolerance2) {
+      keep[max_index] = true;
+      stack.emplace_back(range.first, max_index);
+      stack.emplace_back(max_index, range.second);
+    }
+  }
+
+  Line result;
+  for (unsigned i = 0; i < n; ++i)
+    if (keep[i])
+      result.push_back(line[i]);
+
+  return result;
+}
+
+static unsigned
+ClampTile(double v, unsigned n_tiles)
+{
+  if (!(v > 0))
+    return 0;
+
+  return std::min(unsigned(v), n_tiles - 1);
+}
+
+/**
+ * Liang-Barsky clipping of the segment a..b against the square
+ * [x, x+1] x [y, y+1].
+ */
+static bool
+ClipSegment(const Point &a, const Point &b, unsigned x, unsigned y,
+            double &t0, double &t1)
+{
+  const double dx = b.x - a.x, dy = b.y - a.y;
+  const double p[4] = { -dx, dx, -dy, dy };
+  const double q[4] = { a.x - x, x + 1 - a.x, a.y - y, y + 1 - a.y };
+
+  t0 = 0;
+  t1 = 1;
+  for (unsigned i = 0; i < 4; ++i) {
+    if (p[i] == 0) {
+      if (q[i] < 0)
+        return false;
+    } else {
+      const double t = q[i] / p[i];
+      if (p[i] < 0)
+        t0 = std::max(t0, t);
+      else
+        t1 = std::min(t1, t);
+    }
+  }
+
+  return t0 < t1;
+}
+
+static Point
+Interpolate(const Point &a, const Point &b, double t)
+{
+  if (t <= 0)
+    return a;
+  if (t >= 1)
+    return b;
+
+  return { a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t };
+}
+
+/**
+ * Split a polyline at the tile borders.  Consecutive segments within
+ * one tile are joined.
+ */
+static void
+SplitLine(const Line &line, unsigned n_tiles,
+          std::map<uint32_t, TileParts> &parts)
+{
+  for (unsigned i = 0; i + 1 < line.size(); ++i) {
+    const Point &a = line[i], &b = line[i + 1];
+
+    const unsigned x0 = ClampTile(std::min(a.x, b.x), n_tiles);
+    const unsigned x1 = ClampTile(std::max(a.x, b.x), n_tiles);
+    const unsigned y0 = ClampTile(std::min(a.y, b.y), n_tiles);
+    const unsigned y1 = ClampTile(std::max(a.y, b.y), n_tiles);
+
+    for (unsigned y = y0; y <= y1; ++y) {
+      for (unsigned x = x0; x <= x1; ++x) {
+        double t0, t1;
+        if (!ClipSegment(a, b, x, y, t0, t1))
+          continue;
+
+        const Point p0 = Interpolate(a, b, t0), p1 = Interpolate(a, b, t1);
+
+        TileParts &tile = parts[MakeKey(0, x, y)];
+        if (!tile.lines.empty() && tile.last_segment + 1 == i &&
+            tile.lines.back().back() == p0)
+          tile.lines.back().push_back(p1);
+        else
+          tile.lines.push_back({p0, p1});
+
+        tile.last_segment = i;
+      }
+    }
+  }
+}
+
+/**
+ * Sutherland-Hodgman clipping of a ring against one axis-parallel
+ * half plane.
+ */
+static Line
+ClipRing(const Line &ring, double Point::*axis, double value, bool below)
+{
+  Line result;
+  if (ring.empty())
+    return result;
+
+  auto inside = [axis, value, below](const Point &p){
+    return below ? p.*axis <= value : p.*axis >= value;
+  };
+
+  const Point *prev = &ring.back();
+  for (const Point &p : ring) {
+    const bool prev_inside = inside(*prev), p_inside = inside(p);
+    if (prev_inside != p_inside)
+      result.push_back(Interpolate(*prev, p,
+                                   (value - prev->*axis) /
+                                   (p.*axis - prev->*axis)));
+
+    if (p_inside)
+      result.push_back(p);
+
+    prev = &p;
+  }
+
+  return result;
+}
+
+/**
+ * Clip a polygon ring to all tiles of the square (x, y, size) by
+ * recursively splitting it into quadrants.
+ */
+static void
+SplitRing(const Line &ring, unsigned x, unsigned y, unsigned size,
+          std::map<uint32_t, TileParts> &parts)
+{
+  if (ring.size() < 3)
+    return;
+
+  if (size == 1) {
+    parts[MakeKey(0, x, y)].lines.push_back(ring);
+    return;
+  }
+
+  const unsigned half = size / 2;
+  for (unsigned i = 0; i < 2; ++i) {
+    const Line column = ClipRing(ring, &Point::x, x + half, i == 0);
+    if (column.size() < 3)
+      continue;
+
+    for (unsigned j = 0; j < 2; ++j)
+      SplitRing(ClipRing(column, &Point::y, y + half, j == 0),
+                x + i * half, y + j * half, half, parts);
+  }
+}
+
+static QuantizedLine
+Quantize(const Line &line, unsigned x, unsigned y)
+{
+  QuantizedLine result;
+  for (const Point &p : line) {
+    const QuantizedPoint q = {
+      int16_t(lround((p.x - x) * QUANTUM)),
+      int16_t(lround((p.y - y) * QUANTUM)),
+    };
+
+    if (result.empty() || !(result.back() == q))
+      result.push_back(q);
+  }
+
+  return result;
+}
+
+static void
+Put16(std::string &dest, unsigned value)
+{
+  const uint16_t le = ToLE16(value);
+  dest.append((const char *)&le, sizeof(le));
+}
+
+static void
+Put32(std::string &dest, uint32_t value)
+{
+  const uint32_t le = ToLE32(value);
+  dest.append((const char *)&le, sizeof(le));
+}
+
+static void
+PutDouble(std::string &dest, double value)
+{
+  uint64_t i;
+  memcpy(&i, &value, sizeof(i));
+  i = ToLE64(i);
+  dest.append((const char *)&i, sizeof(i));
+}
+
+static void
+PutShape(Tile &tile, MS_SHAPE_TYPE type,
+         const QuantizedLine *lines, unsigned n_lines,
+         const std::string &label)
+{
+  const unsigned label_length = std::min<size_t>(label.length(), 0xffff);
+
+  std::string &dest = tile.data;
+  dest.push_back(char(type));
+  dest.push_back(char(n_lines));
+  Put16(dest, label_length);
+
+  for (unsigned i = 0; i < n_lines; ++i)
+    Put16(dest, lines[i].size());
+
+  for (unsigned i = 0; i < n_lines; ++i) {
+    for (const auto &p : lines[i]) {
+      Put16(dest, uint16_t(p.x));
+      Put16(dest, uint16_t(p.y));
+    }
+  }
+
+  dest.append(label, 0, label_length);
+  ++tile.n_shapes;
+}
+
+/**
+ * Add one shape to all tiles of a level.
+ */
+static void
+AddShape(std::map<uint32_t, Tile> &tiles, unsigned level, bool thin,
+         const SourceShape &shape)
+{
+  const unsigned n_tiles = 1u << level;
+
+  /* thin to 1/1024 of a tile, which is well below the screen
+     resolution when this level gets displayed */
+  const double tolerance = 1. / 1024;
+
+  std::map<uint32_t, TileParts> parts;
+
+  for (const Line &src : shape.lines) {
+    Line line;
+    line.reserve(src.size());
+    for (const Point &p : src)
+      line.push_back({p.x * n_tiles, p.y * n_tiles});
+
+    switch (shape.type) {
+    case MS_SHAPE_POINT:
+      for (const Point &p : line)
+        parts[MakeKey(0, ClampTile(p.x, n_tiles), ClampTile(p.y, n_tiles))]
+          .lines.push_back({p});
+      break;
+
+    case MS_SHAPE_LINE:
+      SplitLine(thin ? Simplify(line, tolerance) : line, n_tiles, parts);
+      break;
+
+    case MS_SHAPE_POLYGON:
+      SplitRing(thin ? Simplify(line, tolerance) : line, 0, 0, n_tiles,
+                parts);
+      break;
+
+    case MS_SHAPE_NULL:
+      break;
+    }
+  }
+
+  const unsigned min_size = shape.type == MS_SHAPE_POINT
+    ? 1
+    : (shape.type == MS_SHAPE_LINE ? 2 : 3);
+
+  for (const auto &i : parts) {
+    const unsigned x = i.first & 0xfff, y = (i.first >> 12) & 0xfff;
+
+    std::vector<QuantizedLine> lines;
+    for (const Line &line : i.second.lines) {
+      QuantizedLine q = Quantize(line, x, y);
+      if (shape.type == MS_SHAPE_POLYGON) {
+        /* close the clipped ring like the shapefile rings are */
+        if (q.size() > 1 && q.front() == q.back())
+          q.pop_back();
+
+        if (q.size() < min_size)
+          continue;
+
+        q.push_back(q.front());
+      } else if (q.size() < min_size)
+        continue;
+
+      if (shape.type == MS_SHAPE_LINE) {
+        /* split long lines, overlapping by one point */
+        while (q.size() > MAX_LINE_SIZE) {
+          lines.emplace_back(q.begin(), q.begin() + MAX_LINE_SIZE);
+          q.erase(q.begin(), q.begin() + MAX_LINE_SIZE - 1);
+        }
+      } else if (q.size() > MAX_LINE_SIZE) {
+        q.resize(MAX_LINE_SIZE - 1);
+        q.push_back(q.front());
+      }
+
+      lines.push_back(std::move(q));
+    }
+
+    if (lines.empty())
+      continue;
+
+    Tile &tile = tiles[MakeKey(level, x, y)];
+    if (shape.type == MS_SHAPE_POINT) {
+      /* XShape uses only the first point of a point shape */
+      for (const auto &line : lines)
+        PutShape(tile, shape.type, &line, 1, shape.label);
+    } else {
+      for (unsigned j = 0; j < lines.size(); j += MAX_LINES)
+        PutShape(tile, shape.type, &lines[j],
+                 std::min<size_t>(lines.size() - j, MAX_LINES),
+                 shape.label);
+    }
+  }
+}
+
+static MS_SHAPE_TYPE
+ToShapeType(int type)
+{
+  switch (type) {
+  case MS_SHAPE_POINT:
+  case MS_SHAPE_LINE:
+  case MS_SHAPE_POLYGON:
+    return MS_SHAPE_TYPE(type);
+
+  default:
+    return MS_SHAPE_NULL;
+  }
+}
+
+bool
+BuildTopographyPyramid(zzip_dir *dir, const char *name, int label_field,
+                       unsigned n_levels, const char *output_path)
+{
+  std::string filename(name);
+  filename += ".shp";
+
+  shapefileObj file;
+  if (msShapefileOpen(&file, "rb", dir, filename.c_str(), 0) == -1) {
+    fprintf(stderr, "Failed to open %s\n", filename.c_str());
+    return false;
+  }
+
+  AtScopeExit(&file) { msShapefileClose(&file); };
+
+  double west = file.bounds.minx, east = file.bounds.maxx;
+  double south = file.bounds.miny, north = file.bounds.maxy;
+  if (!(west < east)) {
+    west -= 0.001;
+    east += 0.001;
+  }
+
+  if (!(south < north)) {
+    south -= 0.001;
+    north += 0.001;
+  }
+
+  const double width = east - west, height = north - south;
+
+  std::vector<SourceShape> shapes;
+  shapes.reserve(file.numshapes);
+
+  for (int i = 0; i < file.numshapes; ++i) {
+    shapeObj src;
+    msInitShape(&src);
+    AtScopeExit(&src) { msFreeShape(&src); };
+    msSHPReadShape(file.hSHP, i, &src);
+
+    SourceShape shape;
+    shape.type = ToShapeType(src.type);
+    if (shape.type == MS_SHAPE_NULL)
+      continue;
+
+    for (int l = 0; l < src.numlines; ++l) {
+      const lineObj &line = src.line[l];
+
+      Line dest;
+      dest.reserve(line.numpoints);
+      for (int j = 0; j < line.numpoints; ++j)
+        dest.push_back({(line.point[j].x - west) / width,
+                        (line.point[j].y - south) / height});
+
+      shape.lines.push_back(std::move(dest));
+    }
+
+    if (label_field >= 0 && file.hDBF != nullptr)
+      shape.label = msDBFReadStringAttribute(file.hDBF, i, label_field);
+
+    shapes.push_back(std::move(shape));
+  }
+
+  std::map<uint32_t, Tile> tiles;
+  for (unsigned level = 0; level < n_levels; ++level)
+    for (const auto &shape : shapes)
+      AddShape(tiles, level, level + 1 < n_levels, shape);
+
+  std::string header;
+  header.append("XCSLOD\0\0", 8);
+  Put32(header, VERSION);
+  Put32(header, n_levels);
+  Put32(header, tiles.size());
+  Put32(header, 0);
+  PutDouble(header, west);
+  PutDouble(header, south);
+  PutDouble(header, east);
+  PutDouble(header, north);
+
+  size_t offset = sizeof(Header) + tiles.size() * sizeof(TileEntry);
+  for (const auto &i : tiles) {
+    Put32(header, i.first);
+    Put32(header, i.second.n_shapes);
+    Put32(header, offset);
+    Put32(header, i.second.data.size());
+    offset += i.second.data.size();
+  }
+
+  if (offset > 0xffffffff) {
+    fprintf(stderr, "%s: too large\n", name);
+    return false;
+  }
+
+  FILE *out = fopen(output_path, "wb");
+  if (out == nullptr) {
+    perror(output_path);
+    return false;
+  }
+
+  bool success = fwrite(header.data(), header.size(), 1, out) == 1;
+  for (const auto &i : tiles)
+    if (!i.second.data.empty())
+      success = success &&
+        fwrite(i.second.data.data(), i.second.data.size(), 1, out) == 1;
+
+  success = fclose(out) == 0 && success;
+  if (!success) {
+    perror(output_path);
+    return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,44 @@
+/*
+Copyright_License {
+
+  XCSoar Glide Computer - http://www.xcsoar.org/
+  Copyright (C) 2000-2016 The XCSoar Project
+  A detailed list of copyright holders can be found in the file "AUTHORS".
+
+  This program is free software; you can redistribute it and/or
+  modify it under the terms of the GNU General Public License
+  as published by the Free Software Foundation; either version 2
+  of the License, or (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+}
+*/
+
+#ifndef XCSOAR_TOPOGRAPHY_PYRAMID_BUILDER_HPP
+#define XCSOAR_TOPOGRAPHY_PYRAMID_BUILDER_HPP
+
+struct zzip_dir;
+
+/**
+ * Convert one shapefile of a map into a ".lod" pyramid (see
+ * #TopographyPyramidFormat).  Errors are printed to stderr.
+ *
+ * @param name the name of the shapefile without the ".shp" suffix
+ * @param label_field the .dbf field containing the labels; -1 for
+ * none
+ * @param n_levels the number of levels; the deepest one keeps the
+ * original vertices
+ * @return true on success
+ */
+bool
+BuildTopographyPyramid(zzip_dir *dir, const char *name, int label_field,
+                       unsigned n_levels, const char *output_path);
+
+#endif
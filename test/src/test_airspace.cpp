@@ -21,7 +21,19 @@
 */
 
 #include "harness_flight.hpp"
+#include "harness_airspace.hpp"
 #include "test_debug.hpp"
+#include "Airspace/AirspaceWarningConfig.hpp"
+#include "GlideSolvers/GlidePolar.hpp"
+#include "GlideSolvers/GlideSettings.hpp"
+#include "GlideSolvers/GlideState.hpp"
+#include "GlideSolvers/MacCready.hpp"
+#include "Task/Stats/TaskStats.hpp"
+#include "Navigation/Aircraft.hpp"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
 
 extern "C" {
 #include "tap.h"
@@ -38,6 +50,101 @@ test_airspace(const unsigned n_airspaces)
   return fine;
 }
 
+/**
+ * Fly one pass across the airspace database, alternating between
+ * cruise and circling, and update the warnings once per second.
+ *
+ * @return the number of Update() calls
+ */
+static unsigned
+FlyWarningPass(AirspaceWarningManager &warnings, const GlidePolar &glide_polar,
+               unsigned &n_warnings, double &checksum)
+{
+  GlideSettings glide_settings;
+  glide_settings.SetDefaults();
+
+  const GeoPoint start(Angle::Degrees(-0.1), Angle::Degrees(0.1));
+  const GeoPoint target(Angle::Degrees(1.1), Angle::Degrees(0.9));
+  const double distance = start.Distance(target);
+  const double speed = 40;
+
+  AircraftState state;
+  state.Reset();
+  state.flying = true;
+  state.ground_speed = speed;
+  state.track = start.Bearing(target);
+  state.location = start;
+  state.altitude = 1500;
+  state.time = 0;
+
+  warnings.Reset(state);
+
+  unsigned n = 0;
+  for (double flown = 0; flown < distance; flown += speed, ++n) {
+    state.time = n;
+    state.location = start.IntermediatePoint(target, flown);
+    state.altitude = 1500 + 600 * sin(n / 300.);
+
+    TaskStats task_stats;
+    task_stats.reset();
+    task_stats.task_valid = true;
+    task_stats.current_leg.location_remaining = target;
+    task_stats.current_leg.solution_remaining =
+      MacCready::Solve(glide_settings, glide_polar,
+                       GlideState(GeoVector(state.location, target), 300,
+                                  state.altitude, SpeedVector::Zero()));
+
+    const bool circling = (n / 60) % 3 == 2;
+    warnings.Update(state, glide_polar, task_stats, circling, 1);
+
+    n_warnings += warnings.size();
+    for (const auto &w : warnings)
+      checksum += unsigned(w.GetWarningState()) +
+        w.GetSolution().elapsed_time + w.GetSolution().distance;
+  }
+
+  return n;
+}
+
+/**
+ * Measure the throughput of AirspaceWarningManager::Update() in a
+ * dense airspace database.
+ */
+static bool
+test_airspace_warnings(const unsigned n_airspaces)
+{
+  Airspaces airspaces;
+  setup_airspaces(airspaces, GeoPoint(Angle::Degrees(0.5), Angle::Degrees(0.5)),
+                  n_airspaces);
+
+  AirspaceWarningConfig config;
+  config.SetDefaults();
+
+  const GlidePolar glide_polar(1);
+
+  std::chrono::steady_clock::duration best = std::chrono::hours(1);
+  unsigned n_updates = 0, n_warnings = 0;
+  double checksum = 0;
+  for (unsigned i = 0; i < 3; ++i) {
+    AirspaceWarningManager warnings(config, airspaces);
+
+    n_warnings = 0;
+    checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    n_updates = FlyWarningPass(warnings, glide_polar, n_warnings, checksum);
+    best = std::min(best, std::chrono::steady_clock::now() - start);
+  }
+
+  const std::chrono::duration<double> seconds = best;
+  printf("# %u airspaces: %.0f warning updates/sec, %u warnings\n",
+         n_airspaces, n_updates / seconds.count(), n_warnings);
+  if (verbose)
+    printf("# checksum %.6f\n", checksum);
+
+  airspaces.Clear();
+  return n_warnings > 0;
+}
+
 int main(int argc, char** argv) 
 {
   // default arguments
@@ -47,10 +154,12 @@ int main(int argc, char** argv)
     return 0;
   }
 
-  plan_tests(3);
+  plan_tests(5);
 
   ok(test_airspace(20),"airspace 20",0);
   ok(test_airspace(100),"airspace 100",0);
+  ok(test_airspace_warnings(200),"airspace warnings 200",0);
+  ok(test_airspace_warnings(2000),"airspace warnings 2000",0);
   
   Airspaces airspaces;
   setup_airspaces(airspaces, GeoPoint(Angle::Zero(), Angle::Zero()), 20);
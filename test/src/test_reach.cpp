@@ -26,6 +26,9 @@
 #include "TestUtil.hpp"
 #include "Route/TerrainRoute.hpp"
 #include "Engine/Route/ReachResult.hpp"
+#include "Engine/Route/ReachFanParms.hpp"
+#include "Engine/Route/FlatTriangleFanTree.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
 #include "Terrain/RasterMap.hpp"
 #include "Terrain/Loader.hpp"
 #include "OS/ConvertPathName.hpp"
@@ -33,11 +36,14 @@
 #include "GlideSolvers/GlideSettings.hpp"
 #include "GlideSolvers/GlidePolar.hpp"
 #include "Geo/SpeedVector.hpp"
+#include "Geo/GeoVector.hpp"
 #include "Operation/Operation.hpp"
 #include "OS/FileUtil.hpp"
 
 #include <zzip/zzip.h>
 
+#include <chrono>
+
 #include <string.h>
 
 static void
@@ -101,6 +107,207 @@ test_reach(const RasterMap &map, double mwind, double mc, double height_min_work
   //  printf("# pixel size %g\n", (double)pd);
 }
 
+/**
+ * Fly a straight line over the terrain and compare full turning reach
+ * solves with incremental ones.  An incremental solve may recycle
+ * fans of the previous one only if that does not change the result;
+ * most importantly, it must never claim a reachable point which the
+ * full solve does not reach.
+ *
+ * @param start the start location
+ * @param track the direction of the flight
+ * @param height the height above terrain at the start (m)
+ * @param sink the altitude change per solve (m)
+ */
+static void
+test_reach_incremental(const RasterMap &map, double mc,
+                       double height_min_working,
+                       const GeoPoint start, Angle track,
+                       int height, int sink)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.reach_calc_mode = RoutePlannerConfig::ReachMode::TURNING;
+
+  GlidePolar polar(mc);
+  SpeedVector wind(Angle::Zero(), 0);
+
+  TerrainRoute full, incremental;
+  full.UpdatePolar(settings, config, polar, polar, wind, height_min_working);
+  full.SetTerrain(&map);
+  incremental.UpdatePolar(settings, config, polar, polar, wind,
+                          height_min_working);
+  incremental.SetTerrain(&map);
+
+  const int h_start = map.GetHeight(start).GetValueOr0() + height;
+
+  typedef std::chrono::steady_clock Clock;
+  Clock::duration full_duration = Clock::duration::zero();
+  Clock::duration incremental_duration = Clock::duration::zero();
+
+  unsigned total = 0, mismatch = 0, overstated = 0, reused = 0;
+
+  /* 30 m/s, solved every 5 seconds */
+  static constexpr unsigned STEPS = 24;
+  for (unsigned i = 0; i < STEPS; ++i) {
+    const GeoPoint location = GeoVector(150. * i, track).EndPoint(start);
+    const AGeoPoint aorigin(location, h_start - sink * int(i));
+
+    auto t = Clock::now();
+    full.SolveReachTerrain(aorigin, config, INT_MAX);
+    full_duration += Clock::now() - t;
+
+    t = Clock::now();
+    incremental.SolveReachTerrain(aorigin, config, INT_MAX, true, true);
+    incremental_duration += Clock::now() - t;
+    reused += incremental.GetReusedFans();
+
+    for (int x = -10; x <= 10; ++x) {
+      for (int y = -10; y <= 10; ++y) {
+        const GeoPoint p(location.longitude + Angle::Degrees(0.02 * x),
+                         location.latitude + Angle::Degrees(0.02 * y));
+        const AGeoPoint adest(p, map.GetInterpolatedHeight(p).GetValueOr0());
+
+        ReachResult a, b;
+        full.FindPositiveArrival(adest, a);
+        incremental.FindPositiveArrival(adest, b);
+
+        ++total;
+        if (a.terrain_valid != b.terrain_valid)
+          ++mismatch;
+
+        if (b.IsReachableTerrain() &&
+            (!a.IsReachableTerrain() || b.terrain > a.terrain))
+          ++overstated;
+      }
+    }
+  }
+
+  const std::chrono::duration<double, std::milli> full_ms = full_duration;
+  const std::chrono::duration<double, std::milli> incremental_ms =
+    incremental_duration;
+  printf("# timing: %u reach solves, full %.1f ms, incremental %.1f ms\n",
+         STEPS, full_ms.count(), incremental_ms.count());
+  printf("# incremental reach: %u fans recycled, "
+         "%u of %u arrivals differ, %u overstated\n",
+         reused, mismatch, total, overstated);
+
+  ok(overstated == 0, "incremental reach not overstated", 0);
+  ok(mismatch == 0, "incremental reach", 0);
+}
+
+/**
+ * Check a straight glide for terrain clearance by sampling the terrain
+ * every 10 m, independently of the terrain scans of the solver.  A
+ * fan vertex is where the glide meets the terrain, so the last flat
+ * unit (the resolution of the vertices) before it is not checked.
+ */
+static bool
+IsGlideClear(const RasterMap &map, const RoutePolars &rpolars,
+             const FlatProjection &projection,
+             const AFlatGeoPoint &origin, const FlatGeoPoint p)
+{
+  const GeoPoint a = projection.Unproject(origin);
+  const GeoPoint b = projection.Unproject(p);
+  const double h_origin = origin.altitude - rpolars.GetSafetyHeight();
+  const double h_glide =
+    origin.altitude - rpolars.CalcGlideArrival(origin, p, projection);
+
+  const unsigned length = p.Distance(origin);
+  if (length <= 1)
+    return true;
+
+  const double t_max = double(length - 1) / length;
+  const unsigned n = unsigned(a.DistanceS(b) / 10) + 1;
+  for (unsigned i = 0; i <= n; ++i) {
+    const double t = t_max * i / n;
+    const double h = h_origin - t * h_glide;
+    const int terrain = map.GetHeight(a.Interpolate(b, t)).GetValueOr0();
+    /* allow 1 m for rounding */
+    if (h + 1 < std::max(terrain, std::max(rpolars.GetFloor(), 0)))
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * Build turning reach fans, move the aircraft a little towards the
+ * hills and let FlatTriangleFanTree::Reuse() decide whether the old
+ * fans may be recycled.  Every recycled fan must be clear of the
+ * terrain at its new location.
+ */
+static void
+test_reach_reuse(const RasterMap &map, const GeoPoint start, Angle track,
+                 int height, int sink,
+                 unsigned &total_accepted, unsigned &total_rejected)
+{
+  GlideSettings settings;
+  settings.SetDefaults();
+  RoutePlannerConfig config;
+  config.SetDefaults();
+  config.reach_calc_mode = RoutePlannerConfig::ReachMode::TURNING;
+
+  RoutePolars rpolars;
+  rpolars.Initialise(settings, GlidePolar(0.1), SpeedVector::Zero());
+  rpolars.SetConfig(config);
+
+  const FlatProjection projection(start);
+  const int h_start = map.GetHeight(start).GetValueOr0() + height;
+
+  unsigned accepted = 0, rejected = 0, overstated = 0;
+
+  static constexpr unsigned STEPS = 24;
+  for (unsigned i = 0; i < STEPS; ++i) {
+    const AFlatGeoPoint old_origin(projection.ProjectInteger(GeoVector(150. * i, track).EndPoint(start)),
+                                   h_start - sink * int(i));
+    const AFlatGeoPoint new_origin(projection.ProjectInteger(GeoVector(150. * (i + 1), track).EndPoint(start)),
+                                   h_start - sink * int(i + 1));
+
+    for (int low = 0; low + ROUTEPOLAR_Q1 <= ROUTEPOLAR_Q3;
+         low += ROUTEPOLAR_Q0) {
+      const int high = low + ROUTEPOLAR_Q1 - 1;
+
+      ReachFanParms parms(rpolars, projection, 0, &map);
+
+      FlatTriangleFanTree old_fan(1);
+      if (!old_fan.FillReach(old_origin, low, high, parms))
+        continue;
+
+      parms.reusable.push_back(&old_fan);
+      parms.shift = (FlatGeoPoint)new_origin - (FlatGeoPoint)old_origin;
+      parms.climb = new_origin.altitude - old_origin.altitude;
+      parms.reuse_distance = 1;
+
+      FlatTriangleFanTree new_fan(1);
+      if (!new_fan.Reuse(new_origin, low, high, parms)) {
+        ++rejected;
+        continue;
+      }
+
+      ++accepted;
+
+      const auto hull = new_fan.GetHull(false);
+      for (unsigned j = 1; j < hull.size; ++j) {
+        if (!IsGlideClear(map, rpolars, projection, new_origin, hull[j])) {
+          ++overstated;
+          break;
+        }
+      }
+    }
+  }
+
+  printf("# recycled fans: %u accepted, %u rejected, %u overstated\n",
+         accepted, rejected, overstated);
+
+  ok(overstated == 0, "recycled fans clear of terrain", 0);
+
+  total_accepted += accepted;
+  total_rejected += rejected;
+}
+
 int main(int argc, char** argv) {
   static const char hc_path[] = "tmp/map.xcm";
   const char *map_path;
@@ -135,12 +342,37 @@ int main(int argc, char** argv) {
   } while (map.IsDirty());
   zzip_dir_close(dir);
 
-  plan_tests(8);
+  plan_tests(24);
   test_reach(map, 0, 0.1, 0);
   test_reach(map, 0, 0.1, 750);
   test_reach(map, 0, 0.1, 500);
   test_reach(map, 0, 0.1, 250);
 
+  const GeoPoint center = map.GetMapCenter();
+
+  /* a slow glide over the plain */
+  test_reach_incremental(map, 0.1, 0, center, Angle::Degrees(45), 1000, 5);
+  test_reach_incremental(map, 0.1, 750, center, Angle::Degrees(45), 1000, 5);
+  test_reach_incremental(map, 0.1, 500, center, Angle::Degrees(45), 1000, 5);
+  test_reach_incremental(map, 0.1, 250, center, Angle::Degrees(45), 1000, 5);
+
+  /* low, sinking and climbing towards the hills in the east, where
+     the terrain under the moved fans changes from one solve to the
+     next */
+  const GeoPoint hills =
+    GeoVector(60000, Angle::Degrees(90)).EndPoint(center);
+  test_reach_incremental(map, 0.1, 0, hills, Angle::Degrees(90), 300, 5);
+  test_reach_incremental(map, 0.1, 0, hills, Angle::Degrees(90), 300, -5);
+
+  unsigned accepted = 0, rejected = 0;
+  test_reach_reuse(map, hills, Angle::Degrees(90), 300, 5,
+                   accepted, rejected);
+  test_reach_reuse(map, hills, Angle::Degrees(90), 300, -5,
+                   accepted, rejected);
+  test_reach_reuse(map, hills, Angle::Degrees(70), 500, 0,
+                   accepted, rejected);
+  ok(accepted > 0 && rejected > 0, "recycled and rejected fans", 0);
+
   return exit_status();
 }
 
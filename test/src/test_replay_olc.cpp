@@ -13,6 +13,7 @@
 #include "Util/PrintException.hxx"
 
 #include <fstream>
+#include <chrono>
 
 extern "C" {
 #include "tap.h"
@@ -169,6 +170,9 @@ test_replay(const Contest olc_type,
 
   DerivedInfo calculated;
 
+  typedef std::chrono::steady_clock Clock;
+  Clock::duration update_duration = Clock::duration::zero();
+
   while (sim.Update(basic)) {
     n_samples++;
 
@@ -180,8 +184,10 @@ test_replay(const Contest olc_type,
     
     trace_computer.Update(settings_computer, basic, calculated);
     
+    const auto update_start = Clock::now();
     contest_manager.UpdateIdle();
-  
+    update_duration += Clock::now() - update_start;
+
     if (verbose>1) {
       sim.print(f, basic);
       f.flush();
@@ -192,7 +198,17 @@ test_replay(const Contest olc_type,
     do_print = (++print_counter % output_skip ==0) && verbose;
   };
 
+  const auto exhaustive_start = Clock::now();
   contest_manager.SolveExhaustive();
+  const auto exhaustive_duration = Clock::now() - exhaustive_start;
+
+  using std::chrono::milliseconds;
+  using std::chrono::duration_cast;
+  std::cout << "# timing: update "
+            << duration_cast<milliseconds>(update_duration).count()
+            << " ms, exhaustive "
+            << duration_cast<milliseconds>(exhaustive_duration).count()
+            << " ms\n";
 
   if (verbose) {
     PrintDistanceCounts();
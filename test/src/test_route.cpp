@@ -40,6 +40,7 @@
 #include <zzip/zzip.h>
 
 #include <fstream>
+#include <chrono>
 
 #include <string.h>
 
@@ -148,6 +149,7 @@ test_route(const unsigned n_airspaces, const RasterMap& map)
     GlideSettings settings;
     settings.SetDefaults();
     RoutePlannerConfig config;
+    config.SetDefaults();
     config.mode = RoutePlannerConfig::Mode::BOTH;
 
     AirspaceRoute route;
@@ -156,12 +158,20 @@ test_route(const unsigned n_airspaces, const RasterMap& map)
 
     AirspacePredicateTrue predicate;
 
+    typedef std::chrono::steady_clock Clock;
+    Clock::duration solve_duration = Clock::duration::zero();
+
     bool sol = false;
     for (int i = 0; i < NUM_SOL; i++) {
       loc_end.latitude += Angle::Degrees(0.1);
       loc_end.altitude = map.GetHeight(loc_end).GetValueOr0() + 100;
       route.Synchronise(airspaces, predicate, loc_start, loc_end);
-      if (route.Solve(loc_start, loc_end, config)) {
+
+      const auto start = Clock::now();
+      const bool solved = route.Solve(loc_start, loc_end, config);
+      solve_duration += Clock::now() - start;
+
+      if (solved) {
         sol = true;
         if (verbose) {
           PrintHelper::print_route(route);
@@ -176,6 +186,9 @@ test_route(const unsigned n_airspaces, const RasterMap& map)
       sprintf(buffer, "route %d solution", i);
       ok(sol, buffer, 0);
     }
+
+    const std::chrono::duration<double, std::milli> ms = solve_duration;
+    printf("# timing: %d solves in %.3f ms\n", NUM_SOL, ms.count());
   }
 
   return true;
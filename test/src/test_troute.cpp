@@ -38,6 +38,8 @@
 
 #include <zzip/zzip.h>
 
+#include <chrono>
+
 #include <string.h>
 
 static void
@@ -46,6 +48,7 @@ test_troute(const RasterMap &map, double mwind, double mc, int ceiling)
   GlideSettings settings;
   settings.SetDefaults();
   RoutePlannerConfig config;
+  config.SetDefaults();
   config.mode = RoutePlannerConfig::Mode::BOTH;
 
   GlidePolar polar(mc);
@@ -81,12 +84,16 @@ test_troute(const RasterMap &map, double mwind, double mc, int ceiling)
     fout << "\n";
   }
 
+  typedef std::chrono::steady_clock Clock;
+  Clock::duration solve_duration = Clock::duration::zero();
+
   unsigned i=0;
   for (double ang = 0; ang < M_2PI; ang += M_PI / 8) {
     GeoPoint dest = GeoVector(40000.0, Angle::Radians(ang)).EndPoint(origin);
 
     int hdest = map.GetHeight(dest).GetValueOr0() + 100;
 
+    const auto start = Clock::now();
     retval = route.Solve(AGeoPoint(origin,
                                    map.GetHeight(origin).GetValueOr0() + 100),
                          AGeoPoint(dest,
@@ -94,6 +101,7 @@ test_troute(const RasterMap &map, double mwind, double mc, int ceiling)
                                    ? hdest
                                    : std::max(hdest, 3200)),
                          config, ceiling);
+    solve_duration += Clock::now() - start;
     char buffer[128];
     sprintf(buffer,"terrain route solve, dir=%g, wind=%g, mc=%g ceiling=%d",
             (double)ang, (double)mwind, (double)mc, (int)ceiling);
@@ -102,6 +110,9 @@ test_troute(const RasterMap &map, double mwind, double mc, int ceiling)
     i++;
   }
 
+  const std::chrono::duration<double, std::milli> ms = solve_duration;
+  printf("# timing: %u solves in %.3f ms\n", i, ms.count());
+
   // polar.SetMC(0);
   // route.UpdatePolar(polar, wind);
 }